@@ -0,0 +1,15 @@
+function test() {
+    let i = 0;
+    let sum = 0;
+
+    while (i < 1000000) {
+        let unit = {
+            health : i,
+            damage : 5,
+        };
+        sum = sum + unit.damage;
+        i = i + 1;
+    }
+
+    return sum;
+}
@@ -0,0 +1,10 @@
+function test() {
+    return fib(30);
+}
+
+function fib(n) {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
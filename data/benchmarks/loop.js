@@ -0,0 +1,12 @@
+function test() {
+    let n = 100000000;
+    let sum = 0;
+    let i = 1;
+
+    while (i <= n) {
+        sum = sum + i;
+        i = i + 1;
+    }
+
+    return sum;
+}
@@ -0,0 +1,18 @@
+function test() {
+    let n = 10000000;
+    let objs = [
+        { a : 1, b : 2, c : 3, d : 4, e : 5, f : 6, g : 7, h : 0 },
+        { h : 0, g : 7, f : 6, e : 5, d : 4, c : 3, b : 2, a : 1 },
+        { d : 4, c : 3, b : 2, a : 1, h : 0, g : 7, f : 6, e : 5 },
+        { e : 5, f : 6, g : 7, h : 0, a : 1, b : 2, c : 3, d : 4 }
+    ];
+    let i = 0;
+
+    while (i < n) {
+        let o = objs[i % 4];
+        o.h = o.h + o.g - o.f;
+        i = i + 1;
+    }
+
+    return i;
+}
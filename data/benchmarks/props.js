@@ -0,0 +1,12 @@
+function test() {
+    let n = 10000000;
+    let o = { a : 1, b : 2, c : 3, d : 4, e : 5, f : 6, g : 7, h : 0 };
+    let i = 0;
+
+    while (i < n) {
+        o.h = o.h + o.g - o.f;
+        i = i + 1;
+    }
+
+    return o.h;
+}
@@ -0,0 +1,30 @@
+function test() {
+    let objs = [{}, {}, {}, {}];
+    let obj = objs[2];
+
+    obj.a = 1;
+    obj.b = 2;
+    obj.c = 3;
+    obj.d = 4;
+    obj.e = 5;
+    obj.f = 6;
+    obj.g = 7;
+    obj.h = 8;
+    obj.i = 9;
+    obj.j = 10;
+    obj.k = 11;
+    obj.l = 12;
+    obj.m = 13;
+    obj.n = 14;
+    obj.o = 15;
+    obj.p = 16;
+    obj.q = 17;
+    obj.r = 18;
+    obj.s = 19;
+    obj.t = 20;
+
+    objs[3] = [1, 2, 3];
+    obj.u = objs[3];
+
+    return objs[2].a + objs[2].b + objs[2].c + objs[2].d + objs[2].e + objs[2].f + objs[2].g + objs[2].h + objs[2].i + objs[2].j + objs[2].k + objs[2].l + objs[2].m + objs[2].n + objs[2].o + objs[2].p + objs[2].q + objs[2].r + objs[2].s + objs[2].t + len(obj.u);
+}
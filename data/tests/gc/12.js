@@ -0,0 +1,2071 @@
+function test() {
+    let obj = big();
+    let i = 0;
+    let res = 0;
+    while (i < 2000) {
+        obj.p0 = {v : i};
+        obj.p1024 = {v : i};
+        obj.p2047 = {v : i};
+        if (i % 100 == 0) {
+            let garbage = big();
+            garbage.p0 = obj;
+        }
+        res = res + obj.p0.v + obj.p1024.v + obj.p2047.v;
+        i = i + 1;
+    }
+
+    return res + obj.p0.v + obj.p1024.v + obj.p2047.v;
+}
+
+function big() {
+    let o = {};
+    o.p0 = 0;
+    o.p1 = 0;
+    o.p2 = 0;
+    o.p3 = 0;
+    o.p4 = 0;
+    o.p5 = 0;
+    o.p6 = 0;
+    o.p7 = 0;
+    o.p8 = 0;
+    o.p9 = 0;
+    o.p10 = 0;
+    o.p11 = 0;
+    o.p12 = 0;
+    o.p13 = 0;
+    o.p14 = 0;
+    o.p15 = 0;
+    o.p16 = 0;
+    o.p17 = 0;
+    o.p18 = 0;
+    o.p19 = 0;
+    o.p20 = 0;
+    o.p21 = 0;
+    o.p22 = 0;
+    o.p23 = 0;
+    o.p24 = 0;
+    o.p25 = 0;
+    o.p26 = 0;
+    o.p27 = 0;
+    o.p28 = 0;
+    o.p29 = 0;
+    o.p30 = 0;
+    o.p31 = 0;
+    o.p32 = 0;
+    o.p33 = 0;
+    o.p34 = 0;
+    o.p35 = 0;
+    o.p36 = 0;
+    o.p37 = 0;
+    o.p38 = 0;
+    o.p39 = 0;
+    o.p40 = 0;
+    o.p41 = 0;
+    o.p42 = 0;
+    o.p43 = 0;
+    o.p44 = 0;
+    o.p45 = 0;
+    o.p46 = 0;
+    o.p47 = 0;
+    o.p48 = 0;
+    o.p49 = 0;
+    o.p50 = 0;
+    o.p51 = 0;
+    o.p52 = 0;
+    o.p53 = 0;
+    o.p54 = 0;
+    o.p55 = 0;
+    o.p56 = 0;
+    o.p57 = 0;
+    o.p58 = 0;
+    o.p59 = 0;
+    o.p60 = 0;
+    o.p61 = 0;
+    o.p62 = 0;
+    o.p63 = 0;
+    o.p64 = 0;
+    o.p65 = 0;
+    o.p66 = 0;
+    o.p67 = 0;
+    o.p68 = 0;
+    o.p69 = 0;
+    o.p70 = 0;
+    o.p71 = 0;
+    o.p72 = 0;
+    o.p73 = 0;
+    o.p74 = 0;
+    o.p75 = 0;
+    o.p76 = 0;
+    o.p77 = 0;
+    o.p78 = 0;
+    o.p79 = 0;
+    o.p80 = 0;
+    o.p81 = 0;
+    o.p82 = 0;
+    o.p83 = 0;
+    o.p84 = 0;
+    o.p85 = 0;
+    o.p86 = 0;
+    o.p87 = 0;
+    o.p88 = 0;
+    o.p89 = 0;
+    o.p90 = 0;
+    o.p91 = 0;
+    o.p92 = 0;
+    o.p93 = 0;
+    o.p94 = 0;
+    o.p95 = 0;
+    o.p96 = 0;
+    o.p97 = 0;
+    o.p98 = 0;
+    o.p99 = 0;
+    o.p100 = 0;
+    o.p101 = 0;
+    o.p102 = 0;
+    o.p103 = 0;
+    o.p104 = 0;
+    o.p105 = 0;
+    o.p106 = 0;
+    o.p107 = 0;
+    o.p108 = 0;
+    o.p109 = 0;
+    o.p110 = 0;
+    o.p111 = 0;
+    o.p112 = 0;
+    o.p113 = 0;
+    o.p114 = 0;
+    o.p115 = 0;
+    o.p116 = 0;
+    o.p117 = 0;
+    o.p118 = 0;
+    o.p119 = 0;
+    o.p120 = 0;
+    o.p121 = 0;
+    o.p122 = 0;
+    o.p123 = 0;
+    o.p124 = 0;
+    o.p125 = 0;
+    o.p126 = 0;
+    o.p127 = 0;
+    o.p128 = 0;
+    o.p129 = 0;
+    o.p130 = 0;
+    o.p131 = 0;
+    o.p132 = 0;
+    o.p133 = 0;
+    o.p134 = 0;
+    o.p135 = 0;
+    o.p136 = 0;
+    o.p137 = 0;
+    o.p138 = 0;
+    o.p139 = 0;
+    o.p140 = 0;
+    o.p141 = 0;
+    o.p142 = 0;
+    o.p143 = 0;
+    o.p144 = 0;
+    o.p145 = 0;
+    o.p146 = 0;
+    o.p147 = 0;
+    o.p148 = 0;
+    o.p149 = 0;
+    o.p150 = 0;
+    o.p151 = 0;
+    o.p152 = 0;
+    o.p153 = 0;
+    o.p154 = 0;
+    o.p155 = 0;
+    o.p156 = 0;
+    o.p157 = 0;
+    o.p158 = 0;
+    o.p159 = 0;
+    o.p160 = 0;
+    o.p161 = 0;
+    o.p162 = 0;
+    o.p163 = 0;
+    o.p164 = 0;
+    o.p165 = 0;
+    o.p166 = 0;
+    o.p167 = 0;
+    o.p168 = 0;
+    o.p169 = 0;
+    o.p170 = 0;
+    o.p171 = 0;
+    o.p172 = 0;
+    o.p173 = 0;
+    o.p174 = 0;
+    o.p175 = 0;
+    o.p176 = 0;
+    o.p177 = 0;
+    o.p178 = 0;
+    o.p179 = 0;
+    o.p180 = 0;
+    o.p181 = 0;
+    o.p182 = 0;
+    o.p183 = 0;
+    o.p184 = 0;
+    o.p185 = 0;
+    o.p186 = 0;
+    o.p187 = 0;
+    o.p188 = 0;
+    o.p189 = 0;
+    o.p190 = 0;
+    o.p191 = 0;
+    o.p192 = 0;
+    o.p193 = 0;
+    o.p194 = 0;
+    o.p195 = 0;
+    o.p196 = 0;
+    o.p197 = 0;
+    o.p198 = 0;
+    o.p199 = 0;
+    o.p200 = 0;
+    o.p201 = 0;
+    o.p202 = 0;
+    o.p203 = 0;
+    o.p204 = 0;
+    o.p205 = 0;
+    o.p206 = 0;
+    o.p207 = 0;
+    o.p208 = 0;
+    o.p209 = 0;
+    o.p210 = 0;
+    o.p211 = 0;
+    o.p212 = 0;
+    o.p213 = 0;
+    o.p214 = 0;
+    o.p215 = 0;
+    o.p216 = 0;
+    o.p217 = 0;
+    o.p218 = 0;
+    o.p219 = 0;
+    o.p220 = 0;
+    o.p221 = 0;
+    o.p222 = 0;
+    o.p223 = 0;
+    o.p224 = 0;
+    o.p225 = 0;
+    o.p226 = 0;
+    o.p227 = 0;
+    o.p228 = 0;
+    o.p229 = 0;
+    o.p230 = 0;
+    o.p231 = 0;
+    o.p232 = 0;
+    o.p233 = 0;
+    o.p234 = 0;
+    o.p235 = 0;
+    o.p236 = 0;
+    o.p237 = 0;
+    o.p238 = 0;
+    o.p239 = 0;
+    o.p240 = 0;
+    o.p241 = 0;
+    o.p242 = 0;
+    o.p243 = 0;
+    o.p244 = 0;
+    o.p245 = 0;
+    o.p246 = 0;
+    o.p247 = 0;
+    o.p248 = 0;
+    o.p249 = 0;
+    o.p250 = 0;
+    o.p251 = 0;
+    o.p252 = 0;
+    o.p253 = 0;
+    o.p254 = 0;
+    o.p255 = 0;
+    o.p256 = 0;
+    o.p257 = 0;
+    o.p258 = 0;
+    o.p259 = 0;
+    o.p260 = 0;
+    o.p261 = 0;
+    o.p262 = 0;
+    o.p263 = 0;
+    o.p264 = 0;
+    o.p265 = 0;
+    o.p266 = 0;
+    o.p267 = 0;
+    o.p268 = 0;
+    o.p269 = 0;
+    o.p270 = 0;
+    o.p271 = 0;
+    o.p272 = 0;
+    o.p273 = 0;
+    o.p274 = 0;
+    o.p275 = 0;
+    o.p276 = 0;
+    o.p277 = 0;
+    o.p278 = 0;
+    o.p279 = 0;
+    o.p280 = 0;
+    o.p281 = 0;
+    o.p282 = 0;
+    o.p283 = 0;
+    o.p284 = 0;
+    o.p285 = 0;
+    o.p286 = 0;
+    o.p287 = 0;
+    o.p288 = 0;
+    o.p289 = 0;
+    o.p290 = 0;
+    o.p291 = 0;
+    o.p292 = 0;
+    o.p293 = 0;
+    o.p294 = 0;
+    o.p295 = 0;
+    o.p296 = 0;
+    o.p297 = 0;
+    o.p298 = 0;
+    o.p299 = 0;
+    o.p300 = 0;
+    o.p301 = 0;
+    o.p302 = 0;
+    o.p303 = 0;
+    o.p304 = 0;
+    o.p305 = 0;
+    o.p306 = 0;
+    o.p307 = 0;
+    o.p308 = 0;
+    o.p309 = 0;
+    o.p310 = 0;
+    o.p311 = 0;
+    o.p312 = 0;
+    o.p313 = 0;
+    o.p314 = 0;
+    o.p315 = 0;
+    o.p316 = 0;
+    o.p317 = 0;
+    o.p318 = 0;
+    o.p319 = 0;
+    o.p320 = 0;
+    o.p321 = 0;
+    o.p322 = 0;
+    o.p323 = 0;
+    o.p324 = 0;
+    o.p325 = 0;
+    o.p326 = 0;
+    o.p327 = 0;
+    o.p328 = 0;
+    o.p329 = 0;
+    o.p330 = 0;
+    o.p331 = 0;
+    o.p332 = 0;
+    o.p333 = 0;
+    o.p334 = 0;
+    o.p335 = 0;
+    o.p336 = 0;
+    o.p337 = 0;
+    o.p338 = 0;
+    o.p339 = 0;
+    o.p340 = 0;
+    o.p341 = 0;
+    o.p342 = 0;
+    o.p343 = 0;
+    o.p344 = 0;
+    o.p345 = 0;
+    o.p346 = 0;
+    o.p347 = 0;
+    o.p348 = 0;
+    o.p349 = 0;
+    o.p350 = 0;
+    o.p351 = 0;
+    o.p352 = 0;
+    o.p353 = 0;
+    o.p354 = 0;
+    o.p355 = 0;
+    o.p356 = 0;
+    o.p357 = 0;
+    o.p358 = 0;
+    o.p359 = 0;
+    o.p360 = 0;
+    o.p361 = 0;
+    o.p362 = 0;
+    o.p363 = 0;
+    o.p364 = 0;
+    o.p365 = 0;
+    o.p366 = 0;
+    o.p367 = 0;
+    o.p368 = 0;
+    o.p369 = 0;
+    o.p370 = 0;
+    o.p371 = 0;
+    o.p372 = 0;
+    o.p373 = 0;
+    o.p374 = 0;
+    o.p375 = 0;
+    o.p376 = 0;
+    o.p377 = 0;
+    o.p378 = 0;
+    o.p379 = 0;
+    o.p380 = 0;
+    o.p381 = 0;
+    o.p382 = 0;
+    o.p383 = 0;
+    o.p384 = 0;
+    o.p385 = 0;
+    o.p386 = 0;
+    o.p387 = 0;
+    o.p388 = 0;
+    o.p389 = 0;
+    o.p390 = 0;
+    o.p391 = 0;
+    o.p392 = 0;
+    o.p393 = 0;
+    o.p394 = 0;
+    o.p395 = 0;
+    o.p396 = 0;
+    o.p397 = 0;
+    o.p398 = 0;
+    o.p399 = 0;
+    o.p400 = 0;
+    o.p401 = 0;
+    o.p402 = 0;
+    o.p403 = 0;
+    o.p404 = 0;
+    o.p405 = 0;
+    o.p406 = 0;
+    o.p407 = 0;
+    o.p408 = 0;
+    o.p409 = 0;
+    o.p410 = 0;
+    o.p411 = 0;
+    o.p412 = 0;
+    o.p413 = 0;
+    o.p414 = 0;
+    o.p415 = 0;
+    o.p416 = 0;
+    o.p417 = 0;
+    o.p418 = 0;
+    o.p419 = 0;
+    o.p420 = 0;
+    o.p421 = 0;
+    o.p422 = 0;
+    o.p423 = 0;
+    o.p424 = 0;
+    o.p425 = 0;
+    o.p426 = 0;
+    o.p427 = 0;
+    o.p428 = 0;
+    o.p429 = 0;
+    o.p430 = 0;
+    o.p431 = 0;
+    o.p432 = 0;
+    o.p433 = 0;
+    o.p434 = 0;
+    o.p435 = 0;
+    o.p436 = 0;
+    o.p437 = 0;
+    o.p438 = 0;
+    o.p439 = 0;
+    o.p440 = 0;
+    o.p441 = 0;
+    o.p442 = 0;
+    o.p443 = 0;
+    o.p444 = 0;
+    o.p445 = 0;
+    o.p446 = 0;
+    o.p447 = 0;
+    o.p448 = 0;
+    o.p449 = 0;
+    o.p450 = 0;
+    o.p451 = 0;
+    o.p452 = 0;
+    o.p453 = 0;
+    o.p454 = 0;
+    o.p455 = 0;
+    o.p456 = 0;
+    o.p457 = 0;
+    o.p458 = 0;
+    o.p459 = 0;
+    o.p460 = 0;
+    o.p461 = 0;
+    o.p462 = 0;
+    o.p463 = 0;
+    o.p464 = 0;
+    o.p465 = 0;
+    o.p466 = 0;
+    o.p467 = 0;
+    o.p468 = 0;
+    o.p469 = 0;
+    o.p470 = 0;
+    o.p471 = 0;
+    o.p472 = 0;
+    o.p473 = 0;
+    o.p474 = 0;
+    o.p475 = 0;
+    o.p476 = 0;
+    o.p477 = 0;
+    o.p478 = 0;
+    o.p479 = 0;
+    o.p480 = 0;
+    o.p481 = 0;
+    o.p482 = 0;
+    o.p483 = 0;
+    o.p484 = 0;
+    o.p485 = 0;
+    o.p486 = 0;
+    o.p487 = 0;
+    o.p488 = 0;
+    o.p489 = 0;
+    o.p490 = 0;
+    o.p491 = 0;
+    o.p492 = 0;
+    o.p493 = 0;
+    o.p494 = 0;
+    o.p495 = 0;
+    o.p496 = 0;
+    o.p497 = 0;
+    o.p498 = 0;
+    o.p499 = 0;
+    o.p500 = 0;
+    o.p501 = 0;
+    o.p502 = 0;
+    o.p503 = 0;
+    o.p504 = 0;
+    o.p505 = 0;
+    o.p506 = 0;
+    o.p507 = 0;
+    o.p508 = 0;
+    o.p509 = 0;
+    o.p510 = 0;
+    o.p511 = 0;
+    o.p512 = 0;
+    o.p513 = 0;
+    o.p514 = 0;
+    o.p515 = 0;
+    o.p516 = 0;
+    o.p517 = 0;
+    o.p518 = 0;
+    o.p519 = 0;
+    o.p520 = 0;
+    o.p521 = 0;
+    o.p522 = 0;
+    o.p523 = 0;
+    o.p524 = 0;
+    o.p525 = 0;
+    o.p526 = 0;
+    o.p527 = 0;
+    o.p528 = 0;
+    o.p529 = 0;
+    o.p530 = 0;
+    o.p531 = 0;
+    o.p532 = 0;
+    o.p533 = 0;
+    o.p534 = 0;
+    o.p535 = 0;
+    o.p536 = 0;
+    o.p537 = 0;
+    o.p538 = 0;
+    o.p539 = 0;
+    o.p540 = 0;
+    o.p541 = 0;
+    o.p542 = 0;
+    o.p543 = 0;
+    o.p544 = 0;
+    o.p545 = 0;
+    o.p546 = 0;
+    o.p547 = 0;
+    o.p548 = 0;
+    o.p549 = 0;
+    o.p550 = 0;
+    o.p551 = 0;
+    o.p552 = 0;
+    o.p553 = 0;
+    o.p554 = 0;
+    o.p555 = 0;
+    o.p556 = 0;
+    o.p557 = 0;
+    o.p558 = 0;
+    o.p559 = 0;
+    o.p560 = 0;
+    o.p561 = 0;
+    o.p562 = 0;
+    o.p563 = 0;
+    o.p564 = 0;
+    o.p565 = 0;
+    o.p566 = 0;
+    o.p567 = 0;
+    o.p568 = 0;
+    o.p569 = 0;
+    o.p570 = 0;
+    o.p571 = 0;
+    o.p572 = 0;
+    o.p573 = 0;
+    o.p574 = 0;
+    o.p575 = 0;
+    o.p576 = 0;
+    o.p577 = 0;
+    o.p578 = 0;
+    o.p579 = 0;
+    o.p580 = 0;
+    o.p581 = 0;
+    o.p582 = 0;
+    o.p583 = 0;
+    o.p584 = 0;
+    o.p585 = 0;
+    o.p586 = 0;
+    o.p587 = 0;
+    o.p588 = 0;
+    o.p589 = 0;
+    o.p590 = 0;
+    o.p591 = 0;
+    o.p592 = 0;
+    o.p593 = 0;
+    o.p594 = 0;
+    o.p595 = 0;
+    o.p596 = 0;
+    o.p597 = 0;
+    o.p598 = 0;
+    o.p599 = 0;
+    o.p600 = 0;
+    o.p601 = 0;
+    o.p602 = 0;
+    o.p603 = 0;
+    o.p604 = 0;
+    o.p605 = 0;
+    o.p606 = 0;
+    o.p607 = 0;
+    o.p608 = 0;
+    o.p609 = 0;
+    o.p610 = 0;
+    o.p611 = 0;
+    o.p612 = 0;
+    o.p613 = 0;
+    o.p614 = 0;
+    o.p615 = 0;
+    o.p616 = 0;
+    o.p617 = 0;
+    o.p618 = 0;
+    o.p619 = 0;
+    o.p620 = 0;
+    o.p621 = 0;
+    o.p622 = 0;
+    o.p623 = 0;
+    o.p624 = 0;
+    o.p625 = 0;
+    o.p626 = 0;
+    o.p627 = 0;
+    o.p628 = 0;
+    o.p629 = 0;
+    o.p630 = 0;
+    o.p631 = 0;
+    o.p632 = 0;
+    o.p633 = 0;
+    o.p634 = 0;
+    o.p635 = 0;
+    o.p636 = 0;
+    o.p637 = 0;
+    o.p638 = 0;
+    o.p639 = 0;
+    o.p640 = 0;
+    o.p641 = 0;
+    o.p642 = 0;
+    o.p643 = 0;
+    o.p644 = 0;
+    o.p645 = 0;
+    o.p646 = 0;
+    o.p647 = 0;
+    o.p648 = 0;
+    o.p649 = 0;
+    o.p650 = 0;
+    o.p651 = 0;
+    o.p652 = 0;
+    o.p653 = 0;
+    o.p654 = 0;
+    o.p655 = 0;
+    o.p656 = 0;
+    o.p657 = 0;
+    o.p658 = 0;
+    o.p659 = 0;
+    o.p660 = 0;
+    o.p661 = 0;
+    o.p662 = 0;
+    o.p663 = 0;
+    o.p664 = 0;
+    o.p665 = 0;
+    o.p666 = 0;
+    o.p667 = 0;
+    o.p668 = 0;
+    o.p669 = 0;
+    o.p670 = 0;
+    o.p671 = 0;
+    o.p672 = 0;
+    o.p673 = 0;
+    o.p674 = 0;
+    o.p675 = 0;
+    o.p676 = 0;
+    o.p677 = 0;
+    o.p678 = 0;
+    o.p679 = 0;
+    o.p680 = 0;
+    o.p681 = 0;
+    o.p682 = 0;
+    o.p683 = 0;
+    o.p684 = 0;
+    o.p685 = 0;
+    o.p686 = 0;
+    o.p687 = 0;
+    o.p688 = 0;
+    o.p689 = 0;
+    o.p690 = 0;
+    o.p691 = 0;
+    o.p692 = 0;
+    o.p693 = 0;
+    o.p694 = 0;
+    o.p695 = 0;
+    o.p696 = 0;
+    o.p697 = 0;
+    o.p698 = 0;
+    o.p699 = 0;
+    o.p700 = 0;
+    o.p701 = 0;
+    o.p702 = 0;
+    o.p703 = 0;
+    o.p704 = 0;
+    o.p705 = 0;
+    o.p706 = 0;
+    o.p707 = 0;
+    o.p708 = 0;
+    o.p709 = 0;
+    o.p710 = 0;
+    o.p711 = 0;
+    o.p712 = 0;
+    o.p713 = 0;
+    o.p714 = 0;
+    o.p715 = 0;
+    o.p716 = 0;
+    o.p717 = 0;
+    o.p718 = 0;
+    o.p719 = 0;
+    o.p720 = 0;
+    o.p721 = 0;
+    o.p722 = 0;
+    o.p723 = 0;
+    o.p724 = 0;
+    o.p725 = 0;
+    o.p726 = 0;
+    o.p727 = 0;
+    o.p728 = 0;
+    o.p729 = 0;
+    o.p730 = 0;
+    o.p731 = 0;
+    o.p732 = 0;
+    o.p733 = 0;
+    o.p734 = 0;
+    o.p735 = 0;
+    o.p736 = 0;
+    o.p737 = 0;
+    o.p738 = 0;
+    o.p739 = 0;
+    o.p740 = 0;
+    o.p741 = 0;
+    o.p742 = 0;
+    o.p743 = 0;
+    o.p744 = 0;
+    o.p745 = 0;
+    o.p746 = 0;
+    o.p747 = 0;
+    o.p748 = 0;
+    o.p749 = 0;
+    o.p750 = 0;
+    o.p751 = 0;
+    o.p752 = 0;
+    o.p753 = 0;
+    o.p754 = 0;
+    o.p755 = 0;
+    o.p756 = 0;
+    o.p757 = 0;
+    o.p758 = 0;
+    o.p759 = 0;
+    o.p760 = 0;
+    o.p761 = 0;
+    o.p762 = 0;
+    o.p763 = 0;
+    o.p764 = 0;
+    o.p765 = 0;
+    o.p766 = 0;
+    o.p767 = 0;
+    o.p768 = 0;
+    o.p769 = 0;
+    o.p770 = 0;
+    o.p771 = 0;
+    o.p772 = 0;
+    o.p773 = 0;
+    o.p774 = 0;
+    o.p775 = 0;
+    o.p776 = 0;
+    o.p777 = 0;
+    o.p778 = 0;
+    o.p779 = 0;
+    o.p780 = 0;
+    o.p781 = 0;
+    o.p782 = 0;
+    o.p783 = 0;
+    o.p784 = 0;
+    o.p785 = 0;
+    o.p786 = 0;
+    o.p787 = 0;
+    o.p788 = 0;
+    o.p789 = 0;
+    o.p790 = 0;
+    o.p791 = 0;
+    o.p792 = 0;
+    o.p793 = 0;
+    o.p794 = 0;
+    o.p795 = 0;
+    o.p796 = 0;
+    o.p797 = 0;
+    o.p798 = 0;
+    o.p799 = 0;
+    o.p800 = 0;
+    o.p801 = 0;
+    o.p802 = 0;
+    o.p803 = 0;
+    o.p804 = 0;
+    o.p805 = 0;
+    o.p806 = 0;
+    o.p807 = 0;
+    o.p808 = 0;
+    o.p809 = 0;
+    o.p810 = 0;
+    o.p811 = 0;
+    o.p812 = 0;
+    o.p813 = 0;
+    o.p814 = 0;
+    o.p815 = 0;
+    o.p816 = 0;
+    o.p817 = 0;
+    o.p818 = 0;
+    o.p819 = 0;
+    o.p820 = 0;
+    o.p821 = 0;
+    o.p822 = 0;
+    o.p823 = 0;
+    o.p824 = 0;
+    o.p825 = 0;
+    o.p826 = 0;
+    o.p827 = 0;
+    o.p828 = 0;
+    o.p829 = 0;
+    o.p830 = 0;
+    o.p831 = 0;
+    o.p832 = 0;
+    o.p833 = 0;
+    o.p834 = 0;
+    o.p835 = 0;
+    o.p836 = 0;
+    o.p837 = 0;
+    o.p838 = 0;
+    o.p839 = 0;
+    o.p840 = 0;
+    o.p841 = 0;
+    o.p842 = 0;
+    o.p843 = 0;
+    o.p844 = 0;
+    o.p845 = 0;
+    o.p846 = 0;
+    o.p847 = 0;
+    o.p848 = 0;
+    o.p849 = 0;
+    o.p850 = 0;
+    o.p851 = 0;
+    o.p852 = 0;
+    o.p853 = 0;
+    o.p854 = 0;
+    o.p855 = 0;
+    o.p856 = 0;
+    o.p857 = 0;
+    o.p858 = 0;
+    o.p859 = 0;
+    o.p860 = 0;
+    o.p861 = 0;
+    o.p862 = 0;
+    o.p863 = 0;
+    o.p864 = 0;
+    o.p865 = 0;
+    o.p866 = 0;
+    o.p867 = 0;
+    o.p868 = 0;
+    o.p869 = 0;
+    o.p870 = 0;
+    o.p871 = 0;
+    o.p872 = 0;
+    o.p873 = 0;
+    o.p874 = 0;
+    o.p875 = 0;
+    o.p876 = 0;
+    o.p877 = 0;
+    o.p878 = 0;
+    o.p879 = 0;
+    o.p880 = 0;
+    o.p881 = 0;
+    o.p882 = 0;
+    o.p883 = 0;
+    o.p884 = 0;
+    o.p885 = 0;
+    o.p886 = 0;
+    o.p887 = 0;
+    o.p888 = 0;
+    o.p889 = 0;
+    o.p890 = 0;
+    o.p891 = 0;
+    o.p892 = 0;
+    o.p893 = 0;
+    o.p894 = 0;
+    o.p895 = 0;
+    o.p896 = 0;
+    o.p897 = 0;
+    o.p898 = 0;
+    o.p899 = 0;
+    o.p900 = 0;
+    o.p901 = 0;
+    o.p902 = 0;
+    o.p903 = 0;
+    o.p904 = 0;
+    o.p905 = 0;
+    o.p906 = 0;
+    o.p907 = 0;
+    o.p908 = 0;
+    o.p909 = 0;
+    o.p910 = 0;
+    o.p911 = 0;
+    o.p912 = 0;
+    o.p913 = 0;
+    o.p914 = 0;
+    o.p915 = 0;
+    o.p916 = 0;
+    o.p917 = 0;
+    o.p918 = 0;
+    o.p919 = 0;
+    o.p920 = 0;
+    o.p921 = 0;
+    o.p922 = 0;
+    o.p923 = 0;
+    o.p924 = 0;
+    o.p925 = 0;
+    o.p926 = 0;
+    o.p927 = 0;
+    o.p928 = 0;
+    o.p929 = 0;
+    o.p930 = 0;
+    o.p931 = 0;
+    o.p932 = 0;
+    o.p933 = 0;
+    o.p934 = 0;
+    o.p935 = 0;
+    o.p936 = 0;
+    o.p937 = 0;
+    o.p938 = 0;
+    o.p939 = 0;
+    o.p940 = 0;
+    o.p941 = 0;
+    o.p942 = 0;
+    o.p943 = 0;
+    o.p944 = 0;
+    o.p945 = 0;
+    o.p946 = 0;
+    o.p947 = 0;
+    o.p948 = 0;
+    o.p949 = 0;
+    o.p950 = 0;
+    o.p951 = 0;
+    o.p952 = 0;
+    o.p953 = 0;
+    o.p954 = 0;
+    o.p955 = 0;
+    o.p956 = 0;
+    o.p957 = 0;
+    o.p958 = 0;
+    o.p959 = 0;
+    o.p960 = 0;
+    o.p961 = 0;
+    o.p962 = 0;
+    o.p963 = 0;
+    o.p964 = 0;
+    o.p965 = 0;
+    o.p966 = 0;
+    o.p967 = 0;
+    o.p968 = 0;
+    o.p969 = 0;
+    o.p970 = 0;
+    o.p971 = 0;
+    o.p972 = 0;
+    o.p973 = 0;
+    o.p974 = 0;
+    o.p975 = 0;
+    o.p976 = 0;
+    o.p977 = 0;
+    o.p978 = 0;
+    o.p979 = 0;
+    o.p980 = 0;
+    o.p981 = 0;
+    o.p982 = 0;
+    o.p983 = 0;
+    o.p984 = 0;
+    o.p985 = 0;
+    o.p986 = 0;
+    o.p987 = 0;
+    o.p988 = 0;
+    o.p989 = 0;
+    o.p990 = 0;
+    o.p991 = 0;
+    o.p992 = 0;
+    o.p993 = 0;
+    o.p994 = 0;
+    o.p995 = 0;
+    o.p996 = 0;
+    o.p997 = 0;
+    o.p998 = 0;
+    o.p999 = 0;
+    o.p1000 = 0;
+    o.p1001 = 0;
+    o.p1002 = 0;
+    o.p1003 = 0;
+    o.p1004 = 0;
+    o.p1005 = 0;
+    o.p1006 = 0;
+    o.p1007 = 0;
+    o.p1008 = 0;
+    o.p1009 = 0;
+    o.p1010 = 0;
+    o.p1011 = 0;
+    o.p1012 = 0;
+    o.p1013 = 0;
+    o.p1014 = 0;
+    o.p1015 = 0;
+    o.p1016 = 0;
+    o.p1017 = 0;
+    o.p1018 = 0;
+    o.p1019 = 0;
+    o.p1020 = 0;
+    o.p1021 = 0;
+    o.p1022 = 0;
+    o.p1023 = 0;
+    o.p1024 = 0;
+    o.p1025 = 0;
+    o.p1026 = 0;
+    o.p1027 = 0;
+    o.p1028 = 0;
+    o.p1029 = 0;
+    o.p1030 = 0;
+    o.p1031 = 0;
+    o.p1032 = 0;
+    o.p1033 = 0;
+    o.p1034 = 0;
+    o.p1035 = 0;
+    o.p1036 = 0;
+    o.p1037 = 0;
+    o.p1038 = 0;
+    o.p1039 = 0;
+    o.p1040 = 0;
+    o.p1041 = 0;
+    o.p1042 = 0;
+    o.p1043 = 0;
+    o.p1044 = 0;
+    o.p1045 = 0;
+    o.p1046 = 0;
+    o.p1047 = 0;
+    o.p1048 = 0;
+    o.p1049 = 0;
+    o.p1050 = 0;
+    o.p1051 = 0;
+    o.p1052 = 0;
+    o.p1053 = 0;
+    o.p1054 = 0;
+    o.p1055 = 0;
+    o.p1056 = 0;
+    o.p1057 = 0;
+    o.p1058 = 0;
+    o.p1059 = 0;
+    o.p1060 = 0;
+    o.p1061 = 0;
+    o.p1062 = 0;
+    o.p1063 = 0;
+    o.p1064 = 0;
+    o.p1065 = 0;
+    o.p1066 = 0;
+    o.p1067 = 0;
+    o.p1068 = 0;
+    o.p1069 = 0;
+    o.p1070 = 0;
+    o.p1071 = 0;
+    o.p1072 = 0;
+    o.p1073 = 0;
+    o.p1074 = 0;
+    o.p1075 = 0;
+    o.p1076 = 0;
+    o.p1077 = 0;
+    o.p1078 = 0;
+    o.p1079 = 0;
+    o.p1080 = 0;
+    o.p1081 = 0;
+    o.p1082 = 0;
+    o.p1083 = 0;
+    o.p1084 = 0;
+    o.p1085 = 0;
+    o.p1086 = 0;
+    o.p1087 = 0;
+    o.p1088 = 0;
+    o.p1089 = 0;
+    o.p1090 = 0;
+    o.p1091 = 0;
+    o.p1092 = 0;
+    o.p1093 = 0;
+    o.p1094 = 0;
+    o.p1095 = 0;
+    o.p1096 = 0;
+    o.p1097 = 0;
+    o.p1098 = 0;
+    o.p1099 = 0;
+    o.p1100 = 0;
+    o.p1101 = 0;
+    o.p1102 = 0;
+    o.p1103 = 0;
+    o.p1104 = 0;
+    o.p1105 = 0;
+    o.p1106 = 0;
+    o.p1107 = 0;
+    o.p1108 = 0;
+    o.p1109 = 0;
+    o.p1110 = 0;
+    o.p1111 = 0;
+    o.p1112 = 0;
+    o.p1113 = 0;
+    o.p1114 = 0;
+    o.p1115 = 0;
+    o.p1116 = 0;
+    o.p1117 = 0;
+    o.p1118 = 0;
+    o.p1119 = 0;
+    o.p1120 = 0;
+    o.p1121 = 0;
+    o.p1122 = 0;
+    o.p1123 = 0;
+    o.p1124 = 0;
+    o.p1125 = 0;
+    o.p1126 = 0;
+    o.p1127 = 0;
+    o.p1128 = 0;
+    o.p1129 = 0;
+    o.p1130 = 0;
+    o.p1131 = 0;
+    o.p1132 = 0;
+    o.p1133 = 0;
+    o.p1134 = 0;
+    o.p1135 = 0;
+    o.p1136 = 0;
+    o.p1137 = 0;
+    o.p1138 = 0;
+    o.p1139 = 0;
+    o.p1140 = 0;
+    o.p1141 = 0;
+    o.p1142 = 0;
+    o.p1143 = 0;
+    o.p1144 = 0;
+    o.p1145 = 0;
+    o.p1146 = 0;
+    o.p1147 = 0;
+    o.p1148 = 0;
+    o.p1149 = 0;
+    o.p1150 = 0;
+    o.p1151 = 0;
+    o.p1152 = 0;
+    o.p1153 = 0;
+    o.p1154 = 0;
+    o.p1155 = 0;
+    o.p1156 = 0;
+    o.p1157 = 0;
+    o.p1158 = 0;
+    o.p1159 = 0;
+    o.p1160 = 0;
+    o.p1161 = 0;
+    o.p1162 = 0;
+    o.p1163 = 0;
+    o.p1164 = 0;
+    o.p1165 = 0;
+    o.p1166 = 0;
+    o.p1167 = 0;
+    o.p1168 = 0;
+    o.p1169 = 0;
+    o.p1170 = 0;
+    o.p1171 = 0;
+    o.p1172 = 0;
+    o.p1173 = 0;
+    o.p1174 = 0;
+    o.p1175 = 0;
+    o.p1176 = 0;
+    o.p1177 = 0;
+    o.p1178 = 0;
+    o.p1179 = 0;
+    o.p1180 = 0;
+    o.p1181 = 0;
+    o.p1182 = 0;
+    o.p1183 = 0;
+    o.p1184 = 0;
+    o.p1185 = 0;
+    o.p1186 = 0;
+    o.p1187 = 0;
+    o.p1188 = 0;
+    o.p1189 = 0;
+    o.p1190 = 0;
+    o.p1191 = 0;
+    o.p1192 = 0;
+    o.p1193 = 0;
+    o.p1194 = 0;
+    o.p1195 = 0;
+    o.p1196 = 0;
+    o.p1197 = 0;
+    o.p1198 = 0;
+    o.p1199 = 0;
+    o.p1200 = 0;
+    o.p1201 = 0;
+    o.p1202 = 0;
+    o.p1203 = 0;
+    o.p1204 = 0;
+    o.p1205 = 0;
+    o.p1206 = 0;
+    o.p1207 = 0;
+    o.p1208 = 0;
+    o.p1209 = 0;
+    o.p1210 = 0;
+    o.p1211 = 0;
+    o.p1212 = 0;
+    o.p1213 = 0;
+    o.p1214 = 0;
+    o.p1215 = 0;
+    o.p1216 = 0;
+    o.p1217 = 0;
+    o.p1218 = 0;
+    o.p1219 = 0;
+    o.p1220 = 0;
+    o.p1221 = 0;
+    o.p1222 = 0;
+    o.p1223 = 0;
+    o.p1224 = 0;
+    o.p1225 = 0;
+    o.p1226 = 0;
+    o.p1227 = 0;
+    o.p1228 = 0;
+    o.p1229 = 0;
+    o.p1230 = 0;
+    o.p1231 = 0;
+    o.p1232 = 0;
+    o.p1233 = 0;
+    o.p1234 = 0;
+    o.p1235 = 0;
+    o.p1236 = 0;
+    o.p1237 = 0;
+    o.p1238 = 0;
+    o.p1239 = 0;
+    o.p1240 = 0;
+    o.p1241 = 0;
+    o.p1242 = 0;
+    o.p1243 = 0;
+    o.p1244 = 0;
+    o.p1245 = 0;
+    o.p1246 = 0;
+    o.p1247 = 0;
+    o.p1248 = 0;
+    o.p1249 = 0;
+    o.p1250 = 0;
+    o.p1251 = 0;
+    o.p1252 = 0;
+    o.p1253 = 0;
+    o.p1254 = 0;
+    o.p1255 = 0;
+    o.p1256 = 0;
+    o.p1257 = 0;
+    o.p1258 = 0;
+    o.p1259 = 0;
+    o.p1260 = 0;
+    o.p1261 = 0;
+    o.p1262 = 0;
+    o.p1263 = 0;
+    o.p1264 = 0;
+    o.p1265 = 0;
+    o.p1266 = 0;
+    o.p1267 = 0;
+    o.p1268 = 0;
+    o.p1269 = 0;
+    o.p1270 = 0;
+    o.p1271 = 0;
+    o.p1272 = 0;
+    o.p1273 = 0;
+    o.p1274 = 0;
+    o.p1275 = 0;
+    o.p1276 = 0;
+    o.p1277 = 0;
+    o.p1278 = 0;
+    o.p1279 = 0;
+    o.p1280 = 0;
+    o.p1281 = 0;
+    o.p1282 = 0;
+    o.p1283 = 0;
+    o.p1284 = 0;
+    o.p1285 = 0;
+    o.p1286 = 0;
+    o.p1287 = 0;
+    o.p1288 = 0;
+    o.p1289 = 0;
+    o.p1290 = 0;
+    o.p1291 = 0;
+    o.p1292 = 0;
+    o.p1293 = 0;
+    o.p1294 = 0;
+    o.p1295 = 0;
+    o.p1296 = 0;
+    o.p1297 = 0;
+    o.p1298 = 0;
+    o.p1299 = 0;
+    o.p1300 = 0;
+    o.p1301 = 0;
+    o.p1302 = 0;
+    o.p1303 = 0;
+    o.p1304 = 0;
+    o.p1305 = 0;
+    o.p1306 = 0;
+    o.p1307 = 0;
+    o.p1308 = 0;
+    o.p1309 = 0;
+    o.p1310 = 0;
+    o.p1311 = 0;
+    o.p1312 = 0;
+    o.p1313 = 0;
+    o.p1314 = 0;
+    o.p1315 = 0;
+    o.p1316 = 0;
+    o.p1317 = 0;
+    o.p1318 = 0;
+    o.p1319 = 0;
+    o.p1320 = 0;
+    o.p1321 = 0;
+    o.p1322 = 0;
+    o.p1323 = 0;
+    o.p1324 = 0;
+    o.p1325 = 0;
+    o.p1326 = 0;
+    o.p1327 = 0;
+    o.p1328 = 0;
+    o.p1329 = 0;
+    o.p1330 = 0;
+    o.p1331 = 0;
+    o.p1332 = 0;
+    o.p1333 = 0;
+    o.p1334 = 0;
+    o.p1335 = 0;
+    o.p1336 = 0;
+    o.p1337 = 0;
+    o.p1338 = 0;
+    o.p1339 = 0;
+    o.p1340 = 0;
+    o.p1341 = 0;
+    o.p1342 = 0;
+    o.p1343 = 0;
+    o.p1344 = 0;
+    o.p1345 = 0;
+    o.p1346 = 0;
+    o.p1347 = 0;
+    o.p1348 = 0;
+    o.p1349 = 0;
+    o.p1350 = 0;
+    o.p1351 = 0;
+    o.p1352 = 0;
+    o.p1353 = 0;
+    o.p1354 = 0;
+    o.p1355 = 0;
+    o.p1356 = 0;
+    o.p1357 = 0;
+    o.p1358 = 0;
+    o.p1359 = 0;
+    o.p1360 = 0;
+    o.p1361 = 0;
+    o.p1362 = 0;
+    o.p1363 = 0;
+    o.p1364 = 0;
+    o.p1365 = 0;
+    o.p1366 = 0;
+    o.p1367 = 0;
+    o.p1368 = 0;
+    o.p1369 = 0;
+    o.p1370 = 0;
+    o.p1371 = 0;
+    o.p1372 = 0;
+    o.p1373 = 0;
+    o.p1374 = 0;
+    o.p1375 = 0;
+    o.p1376 = 0;
+    o.p1377 = 0;
+    o.p1378 = 0;
+    o.p1379 = 0;
+    o.p1380 = 0;
+    o.p1381 = 0;
+    o.p1382 = 0;
+    o.p1383 = 0;
+    o.p1384 = 0;
+    o.p1385 = 0;
+    o.p1386 = 0;
+    o.p1387 = 0;
+    o.p1388 = 0;
+    o.p1389 = 0;
+    o.p1390 = 0;
+    o.p1391 = 0;
+    o.p1392 = 0;
+    o.p1393 = 0;
+    o.p1394 = 0;
+    o.p1395 = 0;
+    o.p1396 = 0;
+    o.p1397 = 0;
+    o.p1398 = 0;
+    o.p1399 = 0;
+    o.p1400 = 0;
+    o.p1401 = 0;
+    o.p1402 = 0;
+    o.p1403 = 0;
+    o.p1404 = 0;
+    o.p1405 = 0;
+    o.p1406 = 0;
+    o.p1407 = 0;
+    o.p1408 = 0;
+    o.p1409 = 0;
+    o.p1410 = 0;
+    o.p1411 = 0;
+    o.p1412 = 0;
+    o.p1413 = 0;
+    o.p1414 = 0;
+    o.p1415 = 0;
+    o.p1416 = 0;
+    o.p1417 = 0;
+    o.p1418 = 0;
+    o.p1419 = 0;
+    o.p1420 = 0;
+    o.p1421 = 0;
+    o.p1422 = 0;
+    o.p1423 = 0;
+    o.p1424 = 0;
+    o.p1425 = 0;
+    o.p1426 = 0;
+    o.p1427 = 0;
+    o.p1428 = 0;
+    o.p1429 = 0;
+    o.p1430 = 0;
+    o.p1431 = 0;
+    o.p1432 = 0;
+    o.p1433 = 0;
+    o.p1434 = 0;
+    o.p1435 = 0;
+    o.p1436 = 0;
+    o.p1437 = 0;
+    o.p1438 = 0;
+    o.p1439 = 0;
+    o.p1440 = 0;
+    o.p1441 = 0;
+    o.p1442 = 0;
+    o.p1443 = 0;
+    o.p1444 = 0;
+    o.p1445 = 0;
+    o.p1446 = 0;
+    o.p1447 = 0;
+    o.p1448 = 0;
+    o.p1449 = 0;
+    o.p1450 = 0;
+    o.p1451 = 0;
+    o.p1452 = 0;
+    o.p1453 = 0;
+    o.p1454 = 0;
+    o.p1455 = 0;
+    o.p1456 = 0;
+    o.p1457 = 0;
+    o.p1458 = 0;
+    o.p1459 = 0;
+    o.p1460 = 0;
+    o.p1461 = 0;
+    o.p1462 = 0;
+    o.p1463 = 0;
+    o.p1464 = 0;
+    o.p1465 = 0;
+    o.p1466 = 0;
+    o.p1467 = 0;
+    o.p1468 = 0;
+    o.p1469 = 0;
+    o.p1470 = 0;
+    o.p1471 = 0;
+    o.p1472 = 0;
+    o.p1473 = 0;
+    o.p1474 = 0;
+    o.p1475 = 0;
+    o.p1476 = 0;
+    o.p1477 = 0;
+    o.p1478 = 0;
+    o.p1479 = 0;
+    o.p1480 = 0;
+    o.p1481 = 0;
+    o.p1482 = 0;
+    o.p1483 = 0;
+    o.p1484 = 0;
+    o.p1485 = 0;
+    o.p1486 = 0;
+    o.p1487 = 0;
+    o.p1488 = 0;
+    o.p1489 = 0;
+    o.p1490 = 0;
+    o.p1491 = 0;
+    o.p1492 = 0;
+    o.p1493 = 0;
+    o.p1494 = 0;
+    o.p1495 = 0;
+    o.p1496 = 0;
+    o.p1497 = 0;
+    o.p1498 = 0;
+    o.p1499 = 0;
+    o.p1500 = 0;
+    o.p1501 = 0;
+    o.p1502 = 0;
+    o.p1503 = 0;
+    o.p1504 = 0;
+    o.p1505 = 0;
+    o.p1506 = 0;
+    o.p1507 = 0;
+    o.p1508 = 0;
+    o.p1509 = 0;
+    o.p1510 = 0;
+    o.p1511 = 0;
+    o.p1512 = 0;
+    o.p1513 = 0;
+    o.p1514 = 0;
+    o.p1515 = 0;
+    o.p1516 = 0;
+    o.p1517 = 0;
+    o.p1518 = 0;
+    o.p1519 = 0;
+    o.p1520 = 0;
+    o.p1521 = 0;
+    o.p1522 = 0;
+    o.p1523 = 0;
+    o.p1524 = 0;
+    o.p1525 = 0;
+    o.p1526 = 0;
+    o.p1527 = 0;
+    o.p1528 = 0;
+    o.p1529 = 0;
+    o.p1530 = 0;
+    o.p1531 = 0;
+    o.p1532 = 0;
+    o.p1533 = 0;
+    o.p1534 = 0;
+    o.p1535 = 0;
+    o.p1536 = 0;
+    o.p1537 = 0;
+    o.p1538 = 0;
+    o.p1539 = 0;
+    o.p1540 = 0;
+    o.p1541 = 0;
+    o.p1542 = 0;
+    o.p1543 = 0;
+    o.p1544 = 0;
+    o.p1545 = 0;
+    o.p1546 = 0;
+    o.p1547 = 0;
+    o.p1548 = 0;
+    o.p1549 = 0;
+    o.p1550 = 0;
+    o.p1551 = 0;
+    o.p1552 = 0;
+    o.p1553 = 0;
+    o.p1554 = 0;
+    o.p1555 = 0;
+    o.p1556 = 0;
+    o.p1557 = 0;
+    o.p1558 = 0;
+    o.p1559 = 0;
+    o.p1560 = 0;
+    o.p1561 = 0;
+    o.p1562 = 0;
+    o.p1563 = 0;
+    o.p1564 = 0;
+    o.p1565 = 0;
+    o.p1566 = 0;
+    o.p1567 = 0;
+    o.p1568 = 0;
+    o.p1569 = 0;
+    o.p1570 = 0;
+    o.p1571 = 0;
+    o.p1572 = 0;
+    o.p1573 = 0;
+    o.p1574 = 0;
+    o.p1575 = 0;
+    o.p1576 = 0;
+    o.p1577 = 0;
+    o.p1578 = 0;
+    o.p1579 = 0;
+    o.p1580 = 0;
+    o.p1581 = 0;
+    o.p1582 = 0;
+    o.p1583 = 0;
+    o.p1584 = 0;
+    o.p1585 = 0;
+    o.p1586 = 0;
+    o.p1587 = 0;
+    o.p1588 = 0;
+    o.p1589 = 0;
+    o.p1590 = 0;
+    o.p1591 = 0;
+    o.p1592 = 0;
+    o.p1593 = 0;
+    o.p1594 = 0;
+    o.p1595 = 0;
+    o.p1596 = 0;
+    o.p1597 = 0;
+    o.p1598 = 0;
+    o.p1599 = 0;
+    o.p1600 = 0;
+    o.p1601 = 0;
+    o.p1602 = 0;
+    o.p1603 = 0;
+    o.p1604 = 0;
+    o.p1605 = 0;
+    o.p1606 = 0;
+    o.p1607 = 0;
+    o.p1608 = 0;
+    o.p1609 = 0;
+    o.p1610 = 0;
+    o.p1611 = 0;
+    o.p1612 = 0;
+    o.p1613 = 0;
+    o.p1614 = 0;
+    o.p1615 = 0;
+    o.p1616 = 0;
+    o.p1617 = 0;
+    o.p1618 = 0;
+    o.p1619 = 0;
+    o.p1620 = 0;
+    o.p1621 = 0;
+    o.p1622 = 0;
+    o.p1623 = 0;
+    o.p1624 = 0;
+    o.p1625 = 0;
+    o.p1626 = 0;
+    o.p1627 = 0;
+    o.p1628 = 0;
+    o.p1629 = 0;
+    o.p1630 = 0;
+    o.p1631 = 0;
+    o.p1632 = 0;
+    o.p1633 = 0;
+    o.p1634 = 0;
+    o.p1635 = 0;
+    o.p1636 = 0;
+    o.p1637 = 0;
+    o.p1638 = 0;
+    o.p1639 = 0;
+    o.p1640 = 0;
+    o.p1641 = 0;
+    o.p1642 = 0;
+    o.p1643 = 0;
+    o.p1644 = 0;
+    o.p1645 = 0;
+    o.p1646 = 0;
+    o.p1647 = 0;
+    o.p1648 = 0;
+    o.p1649 = 0;
+    o.p1650 = 0;
+    o.p1651 = 0;
+    o.p1652 = 0;
+    o.p1653 = 0;
+    o.p1654 = 0;
+    o.p1655 = 0;
+    o.p1656 = 0;
+    o.p1657 = 0;
+    o.p1658 = 0;
+    o.p1659 = 0;
+    o.p1660 = 0;
+    o.p1661 = 0;
+    o.p1662 = 0;
+    o.p1663 = 0;
+    o.p1664 = 0;
+    o.p1665 = 0;
+    o.p1666 = 0;
+    o.p1667 = 0;
+    o.p1668 = 0;
+    o.p1669 = 0;
+    o.p1670 = 0;
+    o.p1671 = 0;
+    o.p1672 = 0;
+    o.p1673 = 0;
+    o.p1674 = 0;
+    o.p1675 = 0;
+    o.p1676 = 0;
+    o.p1677 = 0;
+    o.p1678 = 0;
+    o.p1679 = 0;
+    o.p1680 = 0;
+    o.p1681 = 0;
+    o.p1682 = 0;
+    o.p1683 = 0;
+    o.p1684 = 0;
+    o.p1685 = 0;
+    o.p1686 = 0;
+    o.p1687 = 0;
+    o.p1688 = 0;
+    o.p1689 = 0;
+    o.p1690 = 0;
+    o.p1691 = 0;
+    o.p1692 = 0;
+    o.p1693 = 0;
+    o.p1694 = 0;
+    o.p1695 = 0;
+    o.p1696 = 0;
+    o.p1697 = 0;
+    o.p1698 = 0;
+    o.p1699 = 0;
+    o.p1700 = 0;
+    o.p1701 = 0;
+    o.p1702 = 0;
+    o.p1703 = 0;
+    o.p1704 = 0;
+    o.p1705 = 0;
+    o.p1706 = 0;
+    o.p1707 = 0;
+    o.p1708 = 0;
+    o.p1709 = 0;
+    o.p1710 = 0;
+    o.p1711 = 0;
+    o.p1712 = 0;
+    o.p1713 = 0;
+    o.p1714 = 0;
+    o.p1715 = 0;
+    o.p1716 = 0;
+    o.p1717 = 0;
+    o.p1718 = 0;
+    o.p1719 = 0;
+    o.p1720 = 0;
+    o.p1721 = 0;
+    o.p1722 = 0;
+    o.p1723 = 0;
+    o.p1724 = 0;
+    o.p1725 = 0;
+    o.p1726 = 0;
+    o.p1727 = 0;
+    o.p1728 = 0;
+    o.p1729 = 0;
+    o.p1730 = 0;
+    o.p1731 = 0;
+    o.p1732 = 0;
+    o.p1733 = 0;
+    o.p1734 = 0;
+    o.p1735 = 0;
+    o.p1736 = 0;
+    o.p1737 = 0;
+    o.p1738 = 0;
+    o.p1739 = 0;
+    o.p1740 = 0;
+    o.p1741 = 0;
+    o.p1742 = 0;
+    o.p1743 = 0;
+    o.p1744 = 0;
+    o.p1745 = 0;
+    o.p1746 = 0;
+    o.p1747 = 0;
+    o.p1748 = 0;
+    o.p1749 = 0;
+    o.p1750 = 0;
+    o.p1751 = 0;
+    o.p1752 = 0;
+    o.p1753 = 0;
+    o.p1754 = 0;
+    o.p1755 = 0;
+    o.p1756 = 0;
+    o.p1757 = 0;
+    o.p1758 = 0;
+    o.p1759 = 0;
+    o.p1760 = 0;
+    o.p1761 = 0;
+    o.p1762 = 0;
+    o.p1763 = 0;
+    o.p1764 = 0;
+    o.p1765 = 0;
+    o.p1766 = 0;
+    o.p1767 = 0;
+    o.p1768 = 0;
+    o.p1769 = 0;
+    o.p1770 = 0;
+    o.p1771 = 0;
+    o.p1772 = 0;
+    o.p1773 = 0;
+    o.p1774 = 0;
+    o.p1775 = 0;
+    o.p1776 = 0;
+    o.p1777 = 0;
+    o.p1778 = 0;
+    o.p1779 = 0;
+    o.p1780 = 0;
+    o.p1781 = 0;
+    o.p1782 = 0;
+    o.p1783 = 0;
+    o.p1784 = 0;
+    o.p1785 = 0;
+    o.p1786 = 0;
+    o.p1787 = 0;
+    o.p1788 = 0;
+    o.p1789 = 0;
+    o.p1790 = 0;
+    o.p1791 = 0;
+    o.p1792 = 0;
+    o.p1793 = 0;
+    o.p1794 = 0;
+    o.p1795 = 0;
+    o.p1796 = 0;
+    o.p1797 = 0;
+    o.p1798 = 0;
+    o.p1799 = 0;
+    o.p1800 = 0;
+    o.p1801 = 0;
+    o.p1802 = 0;
+    o.p1803 = 0;
+    o.p1804 = 0;
+    o.p1805 = 0;
+    o.p1806 = 0;
+    o.p1807 = 0;
+    o.p1808 = 0;
+    o.p1809 = 0;
+    o.p1810 = 0;
+    o.p1811 = 0;
+    o.p1812 = 0;
+    o.p1813 = 0;
+    o.p1814 = 0;
+    o.p1815 = 0;
+    o.p1816 = 0;
+    o.p1817 = 0;
+    o.p1818 = 0;
+    o.p1819 = 0;
+    o.p1820 = 0;
+    o.p1821 = 0;
+    o.p1822 = 0;
+    o.p1823 = 0;
+    o.p1824 = 0;
+    o.p1825 = 0;
+    o.p1826 = 0;
+    o.p1827 = 0;
+    o.p1828 = 0;
+    o.p1829 = 0;
+    o.p1830 = 0;
+    o.p1831 = 0;
+    o.p1832 = 0;
+    o.p1833 = 0;
+    o.p1834 = 0;
+    o.p1835 = 0;
+    o.p1836 = 0;
+    o.p1837 = 0;
+    o.p1838 = 0;
+    o.p1839 = 0;
+    o.p1840 = 0;
+    o.p1841 = 0;
+    o.p1842 = 0;
+    o.p1843 = 0;
+    o.p1844 = 0;
+    o.p1845 = 0;
+    o.p1846 = 0;
+    o.p1847 = 0;
+    o.p1848 = 0;
+    o.p1849 = 0;
+    o.p1850 = 0;
+    o.p1851 = 0;
+    o.p1852 = 0;
+    o.p1853 = 0;
+    o.p1854 = 0;
+    o.p1855 = 0;
+    o.p1856 = 0;
+    o.p1857 = 0;
+    o.p1858 = 0;
+    o.p1859 = 0;
+    o.p1860 = 0;
+    o.p1861 = 0;
+    o.p1862 = 0;
+    o.p1863 = 0;
+    o.p1864 = 0;
+    o.p1865 = 0;
+    o.p1866 = 0;
+    o.p1867 = 0;
+    o.p1868 = 0;
+    o.p1869 = 0;
+    o.p1870 = 0;
+    o.p1871 = 0;
+    o.p1872 = 0;
+    o.p1873 = 0;
+    o.p1874 = 0;
+    o.p1875 = 0;
+    o.p1876 = 0;
+    o.p1877 = 0;
+    o.p1878 = 0;
+    o.p1879 = 0;
+    o.p1880 = 0;
+    o.p1881 = 0;
+    o.p1882 = 0;
+    o.p1883 = 0;
+    o.p1884 = 0;
+    o.p1885 = 0;
+    o.p1886 = 0;
+    o.p1887 = 0;
+    o.p1888 = 0;
+    o.p1889 = 0;
+    o.p1890 = 0;
+    o.p1891 = 0;
+    o.p1892 = 0;
+    o.p1893 = 0;
+    o.p1894 = 0;
+    o.p1895 = 0;
+    o.p1896 = 0;
+    o.p1897 = 0;
+    o.p1898 = 0;
+    o.p1899 = 0;
+    o.p1900 = 0;
+    o.p1901 = 0;
+    o.p1902 = 0;
+    o.p1903 = 0;
+    o.p1904 = 0;
+    o.p1905 = 0;
+    o.p1906 = 0;
+    o.p1907 = 0;
+    o.p1908 = 0;
+    o.p1909 = 0;
+    o.p1910 = 0;
+    o.p1911 = 0;
+    o.p1912 = 0;
+    o.p1913 = 0;
+    o.p1914 = 0;
+    o.p1915 = 0;
+    o.p1916 = 0;
+    o.p1917 = 0;
+    o.p1918 = 0;
+    o.p1919 = 0;
+    o.p1920 = 0;
+    o.p1921 = 0;
+    o.p1922 = 0;
+    o.p1923 = 0;
+    o.p1924 = 0;
+    o.p1925 = 0;
+    o.p1926 = 0;
+    o.p1927 = 0;
+    o.p1928 = 0;
+    o.p1929 = 0;
+    o.p1930 = 0;
+    o.p1931 = 0;
+    o.p1932 = 0;
+    o.p1933 = 0;
+    o.p1934 = 0;
+    o.p1935 = 0;
+    o.p1936 = 0;
+    o.p1937 = 0;
+    o.p1938 = 0;
+    o.p1939 = 0;
+    o.p1940 = 0;
+    o.p1941 = 0;
+    o.p1942 = 0;
+    o.p1943 = 0;
+    o.p1944 = 0;
+    o.p1945 = 0;
+    o.p1946 = 0;
+    o.p1947 = 0;
+    o.p1948 = 0;
+    o.p1949 = 0;
+    o.p1950 = 0;
+    o.p1951 = 0;
+    o.p1952 = 0;
+    o.p1953 = 0;
+    o.p1954 = 0;
+    o.p1955 = 0;
+    o.p1956 = 0;
+    o.p1957 = 0;
+    o.p1958 = 0;
+    o.p1959 = 0;
+    o.p1960 = 0;
+    o.p1961 = 0;
+    o.p1962 = 0;
+    o.p1963 = 0;
+    o.p1964 = 0;
+    o.p1965 = 0;
+    o.p1966 = 0;
+    o.p1967 = 0;
+    o.p1968 = 0;
+    o.p1969 = 0;
+    o.p1970 = 0;
+    o.p1971 = 0;
+    o.p1972 = 0;
+    o.p1973 = 0;
+    o.p1974 = 0;
+    o.p1975 = 0;
+    o.p1976 = 0;
+    o.p1977 = 0;
+    o.p1978 = 0;
+    o.p1979 = 0;
+    o.p1980 = 0;
+    o.p1981 = 0;
+    o.p1982 = 0;
+    o.p1983 = 0;
+    o.p1984 = 0;
+    o.p1985 = 0;
+    o.p1986 = 0;
+    o.p1987 = 0;
+    o.p1988 = 0;
+    o.p1989 = 0;
+    o.p1990 = 0;
+    o.p1991 = 0;
+    o.p1992 = 0;
+    o.p1993 = 0;
+    o.p1994 = 0;
+    o.p1995 = 0;
+    o.p1996 = 0;
+    o.p1997 = 0;
+    o.p1998 = 0;
+    o.p1999 = 0;
+    o.p2000 = 0;
+    o.p2001 = 0;
+    o.p2002 = 0;
+    o.p2003 = 0;
+    o.p2004 = 0;
+    o.p2005 = 0;
+    o.p2006 = 0;
+    o.p2007 = 0;
+    o.p2008 = 0;
+    o.p2009 = 0;
+    o.p2010 = 0;
+    o.p2011 = 0;
+    o.p2012 = 0;
+    o.p2013 = 0;
+    o.p2014 = 0;
+    o.p2015 = 0;
+    o.p2016 = 0;
+    o.p2017 = 0;
+    o.p2018 = 0;
+    o.p2019 = 0;
+    o.p2020 = 0;
+    o.p2021 = 0;
+    o.p2022 = 0;
+    o.p2023 = 0;
+    o.p2024 = 0;
+    o.p2025 = 0;
+    o.p2026 = 0;
+    o.p2027 = 0;
+    o.p2028 = 0;
+    o.p2029 = 0;
+    o.p2030 = 0;
+    o.p2031 = 0;
+    o.p2032 = 0;
+    o.p2033 = 0;
+    o.p2034 = 0;
+    o.p2035 = 0;
+    o.p2036 = 0;
+    o.p2037 = 0;
+    o.p2038 = 0;
+    o.p2039 = 0;
+    o.p2040 = 0;
+    o.p2041 = 0;
+    o.p2042 = 0;
+    o.p2043 = 0;
+    o.p2044 = 0;
+    o.p2045 = 0;
+    o.p2046 = 0;
+    o.p2047 = 0;
+    return o;
+}
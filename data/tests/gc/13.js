@@ -0,0 +1,34 @@
+function test() {
+    let head = {v : 0, next : 0};
+    let i = 1;
+    while (i < 300) {
+        head = {v : i, next : head};
+        i = i + 1;
+    }
+
+    let round = 0;
+    while (round < 20) {
+        let copy = {v : head.v + 1, next : 0};
+        let node = head.next;
+        i = 1;
+        while (i < 300) {
+            copy = {v : node.v + 1, next : copy};
+            node.v = [node.v, round];
+            node = node.next;
+            i = i + 1;
+        }
+        head = copy;
+        round = round + 1;
+    }
+
+    let res = 0;
+    let node = head;
+    i = 0;
+    while (i < 300) {
+        res = res + node.v;
+        node = node.next;
+        i = i + 1;
+    }
+
+    return res;
+}
@@ -0,0 +1,37 @@
+function test() {
+    let trees = [0, 0, 0];
+    let i = 0;
+    while (i < 3) {
+        trees[i] = make(10);
+        i = i + 1;
+    }
+
+    i = 0;
+    while (i < 3) {
+        trees[i] = make(10);
+        i = i + 1;
+    }
+
+    let res = 0;
+    i = 0;
+    while (i < 3) {
+        res = res + count(trees[i], 10);
+        i = i + 1;
+    }
+
+    return res;
+}
+
+function make(depth) {
+    if (depth == 0) {
+        return {v : 1, l : 0, r : 0};
+    }
+    return {v : 1, l : make(depth - 1), r : make(depth - 1)};
+}
+
+function count(tree, depth) {
+    if (depth == 0) {
+        return tree.v;
+    }
+    return tree.v + count(tree.l, depth - 1) + count(tree.r, depth - 1);
+}
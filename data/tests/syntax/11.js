@@ -0,0 +1,32 @@
+function test() {
+    let s = 0;
+    let i = 0;
+
+    while (i < 100) {
+        i = i + 1;
+        if (i % 2 == 0) {
+            continue;
+        }
+        s = s + i * 2 - i * 1;
+        s = s + i * 3 - i * 2;
+        s = s + i * 4 - i * 3;
+        s = s + i * 5 - i * 4;
+        s = s + i * 6 - i * 5;
+        s = s + i * 7 - i * 6;
+        s = s + i * 8 - i * 7;
+        s = s + i * 9 - i * 8;
+        s = s + i * 10 - i * 9;
+        s = s + i * 11 - i * 10;
+        s = s + i * 12 - i * 11;
+        s = s + i * 13 - i * 12;
+        s = s + i * 14 - i * 13;
+        s = s + i * 15 - i * 14;
+        s = s + i * 16 - i * 15;
+        s = s + i * 17 - i * 16;
+        if (i > 50) {
+            break;
+        }
+    }
+
+    return s;
+}
@@ -0,0 +1,15 @@
+function test() {
+    let res = 0;
+
+    let a = { x : 1, y : 2 };
+    let b = { y : 20, x : 10 };
+    let c = { x : 100, y : 200 };
+    b.z = 1000;
+    c.z = 2000;
+    a.y = 3;
+
+    res = res + a.x + a.y + b.x + b.y + b.z + c.x + c.y + c.z;
+    res = res + has_property(a, z) * 10000 + has_property(b, z) * 100000;
+
+    return res;
+}
@@ -0,0 +1,19 @@
+function test() {
+    let objs = [
+        { x : 1 },
+        { y : 0, x : 2 },
+        { z : 0, y : 0, x : 3 },
+        { w : 0, z : 0, y : 0, x : 4 },
+        { v : 0, w : 0, z : 0, y : 0, x : 5 },
+        { x : 6, y : 0 }
+    ];
+    let i = 0;
+    let sum = 0;
+    while (i < 60) {
+        let o = objs[i % len(objs)];
+        sum = sum + o.x;
+        o.x = o.x + 1;
+        i = i + 1;
+    }
+    return sum;
+}
@@ -0,0 +1,35 @@
+function test() {
+    let obj = { x : 0 };
+    let i = 0;
+    while (i < 10) {
+        inc(obj, i);
+        i = i + 1;
+    }
+    return add3(fact(5), obj.x, nothing()) + fib(15);
+}
+
+function add3(a, b, c) {
+    let sum = a + b;
+    return sum + c;
+}
+
+function fact(n) {
+    if (n < 2) {
+        return 1;
+    }
+    return n * fact(n - 1);
+}
+
+function fib(n) {
+    if (n < 2) {
+        return n;
+    }
+    return fib(n - 1) + fib(n - 2);
+}
+
+function inc(o, d) {
+    o.x = o.x + d;
+}
+
+function nothing() {
+}
@@ -0,0 +1,64 @@
+function test() {
+    let items = [
+        { w : 3, v : 1 },
+        { v : 2, w : 5 },
+        { w : 7, v : 3 },
+        { v : 4, w : 11 },
+        7,
+        [1, 2, 3]
+    ];
+    let sum = 0;
+    let i = 0;
+    while (i < 200) {
+        let k = i % 6;
+        if (k < 4) {
+            let it = items[k];
+            sum = sum + it.w * it.v;
+        } else {
+            if (k == 4) {
+                sum = sum - i / 7;
+            } else {
+                sum = sum + len(items[k]);
+            }
+        }
+        i = i + 1;
+    }
+
+    let j = 0;
+    let swaps = 0;
+    let a = 1;
+    let b = 2;
+    while (j < 100) {
+        let t = a;
+        a = b;
+        b = t;
+        if (j == 90) {
+            break;
+        }
+        swaps = swaps + a - b;
+        j = j + 1;
+    }
+
+    let x = 0;
+    let c = 0;
+    while (c < 10) {
+        if (c == 5) {
+            x = items;
+        } else {
+            x = c;
+        }
+        c = c + 1;
+    }
+
+    let n = 0;
+    let acc = 0;
+    while (n < 50) {
+        let m = 0;
+        while (m < n % 5) {
+            acc = acc + m * n;
+            m = m + 1;
+        }
+        n = n + 1;
+    }
+    return sum + swaps + a * 10 + b + x + acc;
+}
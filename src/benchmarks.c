@@ -0,0 +1,842 @@
+#include "lexer.h"
+#include "parser.h"
+#include "bytecode-generator.h"
+#include "register-generator.h"
+#include "virtual-machine.h"
+#include "garbage-collector.h"
+#include "shape.h"
+
+#include <stdio.h>
+
+#define STACKSIZE 1024
+
+#define GC_BENCHMARK_HEAPSIZE (1024 * 1024)
+#define GC_BENCHMARK_RUNS     5
+
+#define ALLOC_BENCHMARK_NUM 10000000
+
+#define PARALLEL_BENCHMARK_WIDTH   1024
+#define PARALLEL_BENCHMARK_DEPTH   512
+#define PARALLEL_BENCHMARK_THREADS 8
+
+#define DISPATCH_BENCHMARK_ITERATIONS 100000000
+/* about 6 GB of records: cost of tracing in VM is measured, not cost of disk. */
+#define DISPATCH_BENCHMARK_TRACE "/dev/null"
+
+#define PROPERTY_BENCHMARK_ITERATIONS 10000000
+
+#define JIT_BENCHMARK_RUNS         3
+#define JIT_BENCHMARK_SYNTAX_TESTS 15
+#define JIT_BENCHMARK_GC_TESTS     14
+
+#define ALLOCATOR_BENCHMARK_POOL  (64 * 1024 * 1024)
+#define ALLOCATOR_BENCHMARK_SLOTS 8192
+#define ALLOCATOR_BENCHMARK_OPS   2000000
+
+/* number of calls of fib(30). */
+#define CALL_BENCHMARK_CALLS 2692537
+
+/* bytecode, which script is compiled to. */
+enum SCRIPT_BYTECODE
+{
+    SCRIPT_BYTECODE_PLAIN,    /* stack bytecode without superinstructions. */
+    SCRIPT_BYTECODE_FUSED,    /* stack bytecode with superinstructions.    */
+    SCRIPT_BYTECODE_REGISTER,
+};
+
+static const char*script_bytecode_names[] = {"plain", "fused", "register"};
+
+static bytecode_type_t compile_script(const char*fname, enum SCRIPT_BYTECODE kind)
+{
+    lexer_type_t  lexer;
+    parser_type_t parser;
+    int r;
+
+    struct UNIT_AST*unit;
+    bytecode_type_t bc;
+
+    lexer = create_lexer();
+    lexer_conf_from_file(lexer, fname);
+
+    parser = create_parser();
+    parser_conf(parser, lexer);
+    if (parser_parse(parser, &unit) != PARSER_OK) {
+        printf("%s: PARSER ERROR\n", fname);
+        exit(EXIT_FAILURE);
+    }
+
+    lexer_free(lexer);
+    parser_free(parser);
+
+    if (kind == SCRIPT_BYTECODE_REGISTER) {
+        register_generator_type_t rg = create_register_generator();
+        register_generator_conf(rg, unit);
+        r = register_generator_generate(rg, &bc);
+        register_generator_free(rg);
+    } else {
+        bytecode_generator_type_t bc_gen = create_bytecode_generator();
+        bytecode_generator_conf(bc_gen, unit, kind == SCRIPT_BYTECODE_FUSED);
+        r = bytecode_generator_generate(bc_gen, &bc);
+        bytecode_generator_free(bc_gen);
+    }
+    if (r != BYTECODE_GENERATOR_OK) {
+        printf("%s: BYTECODE GENERATOR ERROR\n", fname);
+        exit(EXIT_FAILURE);
+    }
+
+    unit_ast_free(unit);
+
+    return bc;
+}
+
+/* runs script and returns time of its execution in nanoseconds; stats of JIT are filled, if they are not NULL. */
+unsigned long long run_jit_script_benchmark(const char*fname, enum SCRIPT_BYTECODE kind, int quickening,
+                                            size_t jit_hotness, enum VIRTUAL_MACHINE_JIT_MODE jit_mode,
+                                            const struct GARBAGE_COLLECTOR_PARAMS*gc_params,
+                                            struct VIRTUAL_MACHINE_JIT_STATS*jit_stats)
+{
+    bytecode_type_t bc = compile_script(fname, kind);
+    virtual_machine_type_t vm;
+
+    unsigned long long start, total;
+
+    vm = create_virtual_machine();
+    virtual_machine_conf(vm, bc, STACKSIZE, gc_params, NULL, quickening);
+    virtual_machine_conf_jit(vm, jit_hotness, jit_mode);
+
+    start = get_time_ns();
+    virtual_machine_run(vm);
+    total = get_time_ns() - start;
+
+    if (jit_stats != NULL) {
+        virtual_machine_get_jit_stats(vm, jit_stats);
+    }
+
+    virtual_machine_free(vm);
+    bytecode_free(bc);
+
+    return total;
+}
+
+unsigned long long run_script_benchmark(const char*fname, enum SCRIPT_BYTECODE kind, int quickening, size_t jit_hotness,
+                                        const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    return run_jit_script_benchmark(fname, kind, quickening, jit_hotness, VIRTUAL_MACHINE_JIT_TEMPLATE, gc_params, NULL);
+}
+
+/* the same run, while every step is written to binary trace. */
+unsigned long long run_traced_script_benchmark(const char*fname, enum SCRIPT_BYTECODE kind, int quickening,
+                                               const char*trace_fname, const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    bytecode_type_t bc = compile_script(fname, kind);
+    virtual_machine_type_t vm;
+    FILE*trace = file_open(trace_fname, "wb");
+
+    unsigned long long start, total;
+
+    vm = create_virtual_machine();
+    virtual_machine_conf(vm, bc, STACKSIZE, gc_params, trace, quickening);
+
+    start = get_time_ns();
+    virtual_machine_run(vm);
+    total = get_time_ns() - start;
+
+    virtual_machine_free(vm);
+    bytecode_free(bc);
+    fclose(trace);
+
+    return total;
+}
+
+/*
+  Builds linked list of live_num objects (every object has
+  one property, which points to the next object) and measures
+  average pause of full collection.
+*/
+void run_gc_benchmark(size_t live_num, const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    size_t i;
+
+    garbage_collector_type_t gc;
+
+    struct VALUE*stack;
+    struct VALUE*stack_top;
+
+    struct SHAPE*root = create_shape_root();
+    struct SHAPE*shape = shape_add_property(root, 0);
+
+    unsigned long long start, total = 0;
+
+    SAFE_MALLOC(stack, 1);
+    stack[0] = create_value_from_int(0);
+    stack_top = stack + 1;
+
+    gc = create_garbage_collector();
+    garbage_collector_conf(gc, gc_params, &stack, &stack_top, 0);
+
+    for (i = 0; i < live_num; i++) {
+        struct OBJECT*obj = garbage_collector_malloc_obj(gc, shape);
+        obj->properties[0] = stack[0];
+        stack[0] = create_value_from_obj(obj);
+    }
+
+    for (i = 0; i < GC_BENCHMARK_RUNS; i++) {
+        start = get_time_ns();
+        garbage_collector_collect(gc);
+        total += get_time_ns() - start;
+    }
+
+    printf("live objects = %8zu; GC pause = %10.3f ms\n",
+           live_num, (double) total / GC_BENCHMARK_RUNS / 1000000.0);
+
+    garbage_collector_free(gc);
+    shape_tree_free(root);
+    SAFE_FREE(stack);
+}
+
+/* measures heap usage and full collection pause for one big array of numbers. */
+void run_gc_array_benchmark(size_t arr_len, const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    size_t i;
+
+    garbage_collector_type_t gc;
+
+    struct VALUE*stack;
+    struct VALUE*stack_top;
+
+    struct ARRAY*arr;
+
+    unsigned long long start, total = 0;
+
+    SAFE_MALLOC(stack, 1);
+    stack[0] = create_value_from_int(0);
+    stack_top = stack + 1;
+
+    gc = create_garbage_collector();
+    garbage_collector_conf(gc, gc_params, &stack, &stack_top, 0);
+
+    arr = garbage_collector_malloc_arr(gc, arr_len);
+    for (i = 0; i < arr_len; i++) {
+        arr->values[i] = create_value_from_int(i);
+    }
+    arr->len = arr_len;
+    stack[0] = create_value_from_arr(arr);
+
+    for (i = 0; i < GC_BENCHMARK_RUNS; i++) {
+        start = get_time_ns();
+        garbage_collector_collect(gc);
+        total += get_time_ns() - start;
+    }
+
+    printf("array of %zu numbers: heap used = %9zu b (large = %9zu b); GC pause = %8.3f ms\n",
+           arr_len, SEMISPACE_USED(&(gc->sa)) + gc->large_sizemem, gc->large_sizemem,
+           (double) total / GC_BENCHMARK_RUNS / 1000000.0);
+
+    garbage_collector_free(gc);
+    SAFE_FREE(stack);
+}
+
+/*
+  Builds wide graph: array of PARALLEL_BENCHMARK_WIDTH arrays of PARALLEL_BENCHMARK_DEPTH objects,
+  so parallel evacuation has a lot of independent work, and measures full collection pause
+  for 1, 2, 4... threads on the same heap.
+*/
+void run_parallel_gc_benchmark(const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    size_t i, j;
+
+    garbage_collector_type_t gc;
+
+    struct VALUE*stack;
+    struct VALUE*stack_top;
+
+    struct SHAPE*root = create_shape_root();
+    struct SHAPE*shape = shape_add_property(root, 0);
+
+    struct ARRAY*arr;
+
+    unsigned long long start, total, single = 0;
+
+    SAFE_MALLOC(stack, 2);
+    stack[0] = stack[1] = create_value_from_int(0);
+    stack_top = stack + 2;
+
+    gc = create_garbage_collector();
+    garbage_collector_conf(gc, gc_params, &stack, &stack_top, 0);
+
+    arr = garbage_collector_malloc_arr(gc, PARALLEL_BENCHMARK_WIDTH);
+    for (i = 0; i < PARALLEL_BENCHMARK_WIDTH; i++) {
+        arr->values[i] = create_value_from_int(0);
+    }
+    arr->len = PARALLEL_BENCHMARK_WIDTH;
+    stack[0] = create_value_from_arr(arr);
+
+    for (i = 0; i < PARALLEL_BENCHMARK_WIDTH; i++) {
+        arr = garbage_collector_malloc_arr(gc, PARALLEL_BENCHMARK_DEPTH);
+        for (j = 0; j < PARALLEL_BENCHMARK_DEPTH; j++) {
+            arr->values[j] = create_value_from_int(0);
+        }
+        arr->len = PARALLEL_BENCHMARK_DEPTH;
+        stack[1] = create_value_from_arr(arr);
+
+        /* arrays may be moved by every allocation, so they are always loaded from stack. */
+        for (j = 0; j < PARALLEL_BENCHMARK_DEPTH; j++) {
+            struct OBJECT*obj = garbage_collector_malloc_obj(gc, shape);
+            obj->properties[0] = create_value_from_int(j);
+            VALUE_GET_ARR(stack[1])->values[j] = create_value_from_obj(obj);
+        }
+        VALUE_GET_ARR(stack[0])->values[i] = stack[1];
+    }
+    stack[1] = create_value_from_int(0);
+
+    printf("wide graph of %d objects, heap = %zu b:\n",
+           PARALLEL_BENCHMARK_WIDTH * PARALLEL_BENCHMARK_DEPTH, gc->sa.sizemem);
+
+    for (gc->threads_num = 1; gc->threads_num <= PARALLEL_BENCHMARK_THREADS; gc->threads_num *= 2) {
+        garbage_collector_collect(gc);
+
+        total = 0;
+        for (i = 0; i < GC_BENCHMARK_RUNS; i++) {
+            start = get_time_ns();
+            garbage_collector_collect(gc);
+            total += get_time_ns() - start;
+        }
+        if (gc->threads_num == 1) {
+            single = total;
+        }
+
+        printf("threads = %zu; GC pause = %8.3f ms; speedup = %5.2f\n",
+               gc->threads_num, (double) total / GC_BENCHMARK_RUNS / 1000000.0, (double) single / total);
+    }
+
+    garbage_collector_free(gc);
+    shape_tree_free(root);
+    SAFE_FREE(stack);
+}
+
+void run_gc_benchmarks(const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    size_t live_num;
+
+    printf("RUNNING GC BENCHMARKS (sizeof(struct VALUE) = %zu):\n", sizeof(struct VALUE));
+    for (live_num = 1000; live_num <= 1000000; live_num *= 10) {
+        run_gc_benchmark(live_num, gc_params);
+    }
+    run_gc_array_benchmark(1000000, gc_params);
+    run_parallel_gc_benchmark(gc_params);
+    printf("\n");
+}
+
+/*
+  Builds linked list of live_num old objects and allocates short-lived
+  objects on top of it, so minor pauses can be compared with full ones.
+*/
+void run_generational_benchmark(size_t live_num, const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    size_t i;
+
+    garbage_collector_type_t gc;
+
+    struct VALUE*stack;
+    struct VALUE*stack_top;
+
+    struct SHAPE*root = create_shape_root();
+    struct SHAPE*shape = shape_add_property(root, 0);
+    struct SHAPE*pair = shape_add_property(shape, 1);
+
+    SAFE_MALLOC(stack, 1);
+    stack[0] = create_value_from_int(0);
+    stack_top = stack + 1;
+
+    gc = create_garbage_collector();
+    garbage_collector_conf(gc, gc_params, &stack, &stack_top, 0);
+
+    for (i = 0; i < live_num; i++) {
+        struct OBJECT*obj = garbage_collector_malloc_obj(gc, shape);
+        obj->properties[0] = stack[0];
+        stack[0] = create_value_from_obj(obj);
+    }
+
+    memset(&(gc->minor_pauses), 0, sizeof(gc->minor_pauses));
+    memset(&(gc->major_pauses), 0, sizeof(gc->major_pauses));
+
+    for (i = 0; i < ALLOC_BENCHMARK_NUM; i++) {
+        struct OBJECT*obj = garbage_collector_malloc_obj(gc, pair);
+        obj->properties[0] = obj->properties[1] = create_value_from_int(i);
+    }
+    garbage_collector_collect(gc);
+
+    printf("old objects = %8zu; minor GC: %6zu x %8.3f us (max %9.3f us); major GC: %4zu x %11.3f us\n",
+           live_num,
+           gc->minor_pauses.count,
+           (gc->minor_pauses.count == 0) ? 0.0 :
+           (double) gc->minor_pauses.total_ns / gc->minor_pauses.count / 1000.0,
+           (double) gc->minor_pauses.max_ns / 1000.0,
+           gc->major_pauses.count,
+           (gc->major_pauses.count == 0) ? 0.0 :
+           (double) gc->major_pauses.total_ns / gc->major_pauses.count / 1000.0);
+
+    garbage_collector_free(gc);
+    shape_tree_free(root);
+    SAFE_FREE(stack);
+}
+
+void run_generational_benchmarks(struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    size_t live_num;
+
+    printf("RUNNING GENERATIONAL GC BENCHMARKS:\n");
+    gc_params->generational = 1;
+    for (live_num = 1000; live_num <= 1000000; live_num *= 10) {
+        run_generational_benchmark(live_num, gc_params);
+    }
+    gc_params->generational = 0;
+    printf("\n");
+}
+
+#define INCREMENTAL_BENCHMARK_BUDGET_NS 250000
+
+/*
+  The same heap shape as in generational benchmark, but collection is
+  incremental, so every pause is bounded by budget instead of live size.
+*/
+void run_incremental_benchmark(size_t live_num, const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    size_t i;
+
+    garbage_collector_type_t gc;
+
+    struct VALUE*stack;
+    struct VALUE*stack_top;
+
+    struct SHAPE*root = create_shape_root();
+    struct SHAPE*shape = shape_add_property(root, 0);
+    struct SHAPE*pair = shape_add_property(shape, 1);
+
+    SAFE_MALLOC(stack, 1);
+    stack[0] = create_value_from_int(0);
+    stack_top = stack + 1;
+
+    gc = create_garbage_collector();
+    garbage_collector_conf(gc, gc_params, &stack, &stack_top, 0);
+
+    for (i = 0; i < live_num; i++) {
+        struct OBJECT*obj = garbage_collector_malloc_obj(gc, shape);
+        obj->properties[0] = stack[0];
+        stack[0] = create_value_from_obj(obj);
+    }
+
+    memset(&(gc->incremental_pauses), 0, sizeof(gc->incremental_pauses));
+    memset(&(gc->major_pauses), 0, sizeof(gc->major_pauses));
+
+    for (i = 0; i < ALLOC_BENCHMARK_NUM; i++) {
+        struct OBJECT*obj = garbage_collector_malloc_obj(gc, pair);
+        obj->properties[0] = obj->properties[1] = create_value_from_int(i);
+    }
+
+    printf("old objects = %8zu; incremental GC: %6zu x %8.3f us (max %9.3f us; over 1 ms %6.3f%%); major GC: %4zu\n",
+           live_num,
+           gc->incremental_pauses.count,
+           (gc->incremental_pauses.count == 0) ? 0.0 :
+           (double) gc->incremental_pauses.total_ns / gc->incremental_pauses.count / 1000.0,
+           (double) gc->incremental_pauses.max_ns / 1000.0,
+           (gc->incremental_pauses.count == 0) ? 0.0 :
+           100.0 * gc->incremental_pauses.long_count / gc->incremental_pauses.count,
+           gc->major_pauses.count);
+
+    garbage_collector_free(gc);
+    shape_tree_free(root);
+    SAFE_FREE(stack);
+}
+
+void run_incremental_benchmarks(struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    size_t live_num;
+
+    printf("RUNNING INCREMENTAL GC BENCHMARKS (budget %llu us):\n", INCREMENTAL_BENCHMARK_BUDGET_NS / 1000ULL);
+    gc_params->pause_budget_ns = INCREMENTAL_BENCHMARK_BUDGET_NS;
+    for (live_num = 1000; live_num <= 1000000; live_num *= 10) {
+        run_incremental_benchmark(live_num, gc_params);
+    }
+    gc_params->pause_budget_ns = 0;
+    printf("\n");
+}
+
+/*
+  Every second object of list is garbage, so mark-compact collection slides half of heap,
+  copying collection evacuates the same live objects; reserved is size of both spaces.
+*/
+void run_compact_benchmark(size_t live_num, const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    size_t i;
+
+    garbage_collector_type_t gc;
+
+    struct VALUE*stack;
+    struct VALUE*stack_top;
+
+    struct SHAPE*root = create_shape_root();
+    struct SHAPE*shape = shape_add_property(root, 0);
+
+    unsigned long long start, total = 0;
+
+    SAFE_MALLOC(stack, 1);
+    stack[0] = create_value_from_int(0);
+    stack_top = stack + 1;
+
+    gc = create_garbage_collector();
+    garbage_collector_conf(gc, gc_params, &stack, &stack_top, 0);
+
+    for (i = 0; i < live_num; i++) {
+        struct OBJECT*obj = garbage_collector_malloc_obj(gc, shape);
+        struct OBJECT*garbage;
+        obj->properties[0] = stack[0];
+        stack[0] = create_value_from_obj(obj);
+
+        garbage = garbage_collector_malloc_obj(gc, shape);
+        garbage->properties[0] = stack[0];
+    }
+
+    for (i = 0; i < GC_BENCHMARK_RUNS; i++) {
+        start = get_time_ns();
+        garbage_collector_collect(gc);
+        total += get_time_ns() - start;
+    }
+
+    printf("%-13s: live objects = %8zu; GC pause = %10.3f ms; reserved = %10zu bytes\n",
+           gc_params->compacting ? "mark-compact" : "copying",
+           live_num, (double) total / GC_BENCHMARK_RUNS / 1000000.0,
+           gc->sa.sizemem + gc->sb.sizemem);
+
+    garbage_collector_free(gc);
+    shape_tree_free(root);
+    SAFE_FREE(stack);
+}
+
+void run_compact_benchmarks(struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    size_t live_num;
+
+    printf("RUNNING MARK-COMPACT GC BENCHMARKS:\n");
+    for (live_num = 1000; live_num <= 1000000; live_num *= 10) {
+        run_compact_benchmark(live_num, gc_params);
+        gc_params->compacting = 1;
+        run_compact_benchmark(live_num, gc_params);
+        gc_params->compacting = 0;
+    }
+    printf("\n");
+}
+
+/* allocates short-lived objects through GC and measures average time of allocation. */
+void run_alloc_benchmark(const char*conf_name, const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    size_t i;
+
+    garbage_collector_type_t gc;
+
+    struct VALUE*stack;
+    struct VALUE*stack_top;
+
+    struct SHAPE*root = create_shape_root();
+    struct SHAPE*pair = shape_add_property(shape_add_property(root, 0), 1);
+
+    unsigned long long start, total;
+
+    SAFE_MALLOC(stack, 1);
+    stack_top = stack;
+
+    gc = create_garbage_collector();
+    garbage_collector_conf(gc, gc_params, &stack, &stack_top, 0);
+
+    start = get_time_ns();
+    for (i = 0; i < ALLOC_BENCHMARK_NUM; i++) {
+        struct OBJECT*obj = garbage_collector_malloc_obj(gc, pair);
+        obj->properties[0] = obj->properties[1] = create_value_from_int(i);
+    }
+    total = get_time_ns() - start;
+
+    printf("%-16s: %6.2f ns per object; data/benchmarks/alloc.js: %8.3f ms\n",
+           conf_name, (double) total / ALLOC_BENCHMARK_NUM,
+           run_script_benchmark("data/benchmarks/alloc.js", SCRIPT_BYTECODE_FUSED, 1, 0, gc_params) / 1000000.0);
+
+    garbage_collector_free(gc);
+    shape_tree_free(root);
+    SAFE_FREE(stack);
+}
+
+void run_alloc_benchmarks(struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    printf("RUNNING ALLOCATION BENCHMARKS:\n");
+
+    gc_params->allocation = GARBAGE_COLLECTOR_ALLOCATION_FREE_LIST;
+    run_alloc_benchmark("free-list", gc_params);
+
+    gc_params->allocation = GARBAGE_COLLECTOR_ALLOCATION_BUMP;
+    run_alloc_benchmark("bump-pointer", gc_params);
+
+    gc_params->generational = 1;
+    run_alloc_benchmark("generational", gc_params);
+    gc_params->generational = 0;
+
+    gc_params->compacting = 1;
+    run_alloc_benchmark("mark-compact", gc_params);
+    gc_params->compacting = 0;
+
+    printf("\n");
+}
+
+/*
+  Tight while loop, which is dominated by opcode dispatch: stack bytecode with and without
+  superinstructions and quickening, register bytecode, where one iteration is about half of instructions,
+  traced stack bytecode and machine code of template and tracing JIT (make JIT=1).
+*/
+void run_dispatch_benchmarks(const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    unsigned long long total, untraced = 0;
+    int kind, quickening;
+
+    printf("RUNNING DISPATCH BENCHMARKS:\n");
+    for (kind = SCRIPT_BYTECODE_PLAIN; kind <= SCRIPT_BYTECODE_REGISTER; kind++) {
+        /* register VM has no generic opcodes to quicken. */
+        for (quickening = (kind == SCRIPT_BYTECODE_REGISTER); quickening <= 1; quickening++) {
+            total = run_script_benchmark("data/benchmarks/loop.js", kind, quickening, 0, gc_params);
+            printf("%-8s %-8s %-8s: data/benchmarks/loop.js: %8.3f ms; %6.3f ns per iteration\n",
+                   VIRTUAL_MACHINE_THREADED_DISPATCH ? "threaded" : "switch", script_bytecode_names[kind],
+                   quickening ? "quick" : "generic",
+                   total / 1000000.0, (double) total / DISPATCH_BENCHMARK_ITERATIONS);
+            if ((kind == SCRIPT_BYTECODE_FUSED) && quickening) {
+                untraced = total;
+            }
+        }
+    }
+    /* traced loop of the same bytecode writes one record per step. */
+    total = run_traced_script_benchmark("data/benchmarks/loop.js", SCRIPT_BYTECODE_FUSED, 1,
+                                        DISPATCH_BENCHMARK_TRACE, gc_params);
+    printf("%-8s %-8s %-8s: data/benchmarks/loop.js: %8.3f ms; %6.3f ns per iteration; %5.2fx of untraced\n",
+           "traced", script_bytecode_names[SCRIPT_BYTECODE_FUSED], "quick",
+           total / 1000000.0, (double) total / DISPATCH_BENCHMARK_ITERATIONS, (double) total / untraced);
+    /* the same loop in machine code of template and tracing JIT. */
+    if (VIRTUAL_MACHINE_JIT) {
+        for (kind = SCRIPT_BYTECODE_PLAIN; kind <= SCRIPT_BYTECODE_FUSED; kind++) {
+            total = run_script_benchmark("data/benchmarks/loop.js", kind, 1, VIRTUAL_MACHINE_JIT_HOTNESS, gc_params);
+            printf("%-8s %-8s %-8s: data/benchmarks/loop.js: %8.3f ms; %6.3f ns per iteration\n",
+                   "jit", script_bytecode_names[kind], "quick",
+                   total / 1000000.0, (double) total / DISPATCH_BENCHMARK_ITERATIONS);
+        }
+        for (kind = SCRIPT_BYTECODE_PLAIN; kind <= SCRIPT_BYTECODE_FUSED; kind++) {
+            total = run_jit_script_benchmark("data/benchmarks/loop.js", kind, 1, VIRTUAL_MACHINE_JIT_HOTNESS,
+                                             VIRTUAL_MACHINE_JIT_TRACING, gc_params, NULL);
+            printf("%-8s %-8s %-8s: data/benchmarks/loop.js: %8.3f ms; %6.3f ns per iteration\n",
+                   "trace", script_bytecode_names[kind], "quick",
+                   total / 1000000.0, (double) total / DISPATCH_BENCHMARK_ITERATIONS);
+        }
+    }
+    printf("\n");
+}
+
+/* xorshift, so every run sees the same sequence. */
+static unsigned long long benchmark_random(unsigned long long*state)
+{
+    (*state) ^= (*state) << 13;
+    (*state) ^= (*state) >> 7;
+    (*state) ^= (*state) << 17;
+    return (*state);
+}
+
+/*
+  Randomly frees and allocates blocks of random sizes directly in ALLOCATOR,
+  so free blocks of many sizes are mixed in fragmented heap.
+*/
+void run_allocator_benchmark(size_t max_sizemem)
+{
+    size_t i;
+
+    struct ALLOCATOR*a;
+    void**slots;
+
+    unsigned long long state = 88172645463325252ULL;
+    unsigned long long start, total;
+
+    SAFE_CALLOC(a, 1);
+    SAFE_CALLOC(slots, ALLOCATOR_BENCHMARK_SLOTS);
+    allocator_malloc_pool(a, ALLOCATOR_BENCHMARK_POOL, 0);
+
+    start = get_time_ns();
+    for (i = 0; i < ALLOCATOR_BENCHMARK_OPS; i++) {
+        size_t slot = benchmark_random(&state) % ALLOCATOR_BENCHMARK_SLOTS;
+        if (slots[slot] != NULL) {
+            allocator_free_block(a, slots[slot]);
+            slots[slot] = NULL;
+        } else {
+            size_t sizemem = 16 + benchmark_random(&state) % max_sizemem;
+            slots[slot] = allocator_malloc_block(a, sizemem);
+        }
+    }
+    total = get_time_ns() - start;
+
+    printf("sizes 16..%-6zu: %7.2f ns per operation; free blocks = %zu\n",
+           16 + max_sizemem, (double) total / ALLOCATOR_BENCHMARK_OPS, a->free_count);
+
+    allocator_free_pool(a);
+    SAFE_FREE(slots);
+    SAFE_FREE(a);
+}
+
+/* fills whole pool with blocks of one size, so per-block overhead is visible. */
+void run_allocator_density_benchmark(size_t sizemem)
+{
+    struct ALLOCATOR*a;
+    size_t count = 0;
+
+    SAFE_CALLOC(a, 1);
+    allocator_malloc_pool(a, ALLOCATOR_BENCHMARK_POOL, 0);
+
+    while (allocator_malloc_block(a, sizemem) != NULL) {
+        count++;
+    }
+
+    printf("density %-8zu: %7.2f bytes per block; %zu blocks\n",
+           sizemem, (double) a->busy_sizemem / count, count);
+
+    allocator_free_pool(a);
+    SAFE_FREE(a);
+}
+
+void run_allocator_benchmarks()
+{
+    printf("RUNNING FREE-LIST ALLOCATOR BENCHMARKS:\n");
+    run_allocator_benchmark(64);
+    run_allocator_benchmark(1024);
+    run_allocator_benchmark(4096);
+    run_allocator_density_benchmark(16);
+    run_allocator_density_benchmark(40);
+    run_allocator_density_benchmark(64);
+    printf("\n");
+}
+
+/* field accesses from one site to objects of one shape and of four different shapes. */
+void run_property_benchmarks(const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    unsigned long long total;
+
+    printf("RUNNING PROPERTY ACCESS BENCHMARKS:\n");
+    total = run_script_benchmark("data/benchmarks/props.js", SCRIPT_BYTECODE_FUSED, 1, 0, gc_params);
+    printf("%-16s: data/benchmarks/props.js: %8.3f ms; %6.3f ns per iteration\n",
+           "monomorphic", total / 1000000.0, (double) total / PROPERTY_BENCHMARK_ITERATIONS);
+    total = run_script_benchmark("data/benchmarks/props.js", SCRIPT_BYTECODE_REGISTER, 1, 0, gc_params);
+    printf("%-16s: data/benchmarks/props.js: %8.3f ms; %6.3f ns per iteration\n",
+           "register", total / 1000000.0, (double) total / PROPERTY_BENCHMARK_ITERATIONS);
+    total = run_script_benchmark("data/benchmarks/props-poly.js", SCRIPT_BYTECODE_FUSED, 1, 0, gc_params);
+    printf("%-16s: data/benchmarks/props-poly.js: %8.3f ms; %6.3f ns per iteration\n",
+           "polymorphic", total / 1000000.0, (double) total / PROPERTY_BENCHMARK_ITERATIONS);
+    printf("\n");
+}
+
+/* recursive fib(30) is dominated by CALL/RETURN; register VM has to clear frame of callee. */
+void run_call_benchmarks(const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    unsigned long long total;
+
+    printf("RUNNING CALL BENCHMARKS:\n");
+    total = run_script_benchmark("data/benchmarks/fib.js", SCRIPT_BYTECODE_FUSED, 1, 0, gc_params);
+    printf("%-16s: data/benchmarks/fib.js: %8.3f ms; %6.3f ns per call\n",
+           "fib(30)", total / 1000000.0, (double) total / CALL_BENCHMARK_CALLS);
+    total = run_script_benchmark("data/benchmarks/fib.js", SCRIPT_BYTECODE_REGISTER, 1, 0, gc_params);
+    printf("%-16s: data/benchmarks/fib.js: %8.3f ms; %6.3f ns per call\n",
+           "fib(30) register", total / 1000000.0, (double) total / CALL_BENCHMARK_CALLS);
+    printf("\n");
+}
+
+/* best time of JIT_BENCHMARK_RUNS runs of script. */
+static unsigned long long run_best_script_benchmark(const char*fname, size_t jit_hotness,
+                                                    enum VIRTUAL_MACHINE_JIT_MODE jit_mode,
+                                                    const struct GARBAGE_COLLECTOR_PARAMS*gc_params,
+                                                    struct VIRTUAL_MACHINE_JIT_STATS*jit_stats)
+{
+    unsigned long long total, best = 0;
+    int i;
+
+    for (i = 0; i < JIT_BENCHMARK_RUNS; i++) {
+        total = run_jit_script_benchmark(fname, SCRIPT_BYTECODE_FUSED, 1, jit_hotness, jit_mode, gc_params, jit_stats);
+        if (i == 0 || total < best) {
+            best = total;
+        }
+    }
+    return best;
+}
+
+void run_jit_benchmark(const char*fname, const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    struct VIRTUAL_MACHINE_JIT_STATS stats;
+    unsigned long long interpreter, template, tracing;
+
+    interpreter = run_best_script_benchmark(fname, 0, VIRTUAL_MACHINE_JIT_TEMPLATE, gc_params, NULL);
+    template = run_best_script_benchmark(fname, VIRTUAL_MACHINE_JIT_HOTNESS, VIRTUAL_MACHINE_JIT_TEMPLATE,
+                                         gc_params, NULL);
+    tracing = run_best_script_benchmark(fname, VIRTUAL_MACHINE_JIT_HOTNESS, VIRTUAL_MACHINE_JIT_TRACING,
+                                        gc_params, &stats);
+
+    /* side exit frequency is number of side exits per iteration of traces. */
+    printf("%-30s: %9.3f ms; template %5.2fx; tracing %5.2fx; traces = %zu; aborts = %zu; side exits = %.4f\n",
+           fname, interpreter / 1000000.0,
+           (double) interpreter / (template ? template : 1), (double) interpreter / (tracing ? tracing : 1),
+           stats.compiled, stats.aborts,
+           stats.iterations ? (double) stats.exits / stats.iterations : 0.0);
+}
+
+/*
+  Every test and benchmark script in interpreter, template JIT and tracing JIT (make JIT=1):
+  speedup of both JIT over interpreter and traces, which tracing JIT compiled, with their side exits.
+*/
+void run_jit_benchmarks(const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    static const char*dirs[] = {"data/tests/syntax", "data/tests/gc"};
+    static const size_t dirs_num[] = {JIT_BENCHMARK_SYNTAX_TESTS, JIT_BENCHMARK_GC_TESTS};
+    static const char*benchmarks[] = {"data/benchmarks/loop.js", "data/benchmarks/props.js",
+                                      "data/benchmarks/props-poly.js", "data/benchmarks/alloc.js",
+                                      "data/benchmarks/fib.js"};
+
+    char fname[64];
+    size_t i, j;
+
+    if (!VIRTUAL_MACHINE_JIT) {
+        return;
+    }
+
+    printf("RUNNING JIT BENCHMARKS:\n");
+    for (i = 0; i < sizeof(dirs) / sizeof(dirs[0]); i++) {
+        for (j = 1; j <= dirs_num[i]; j++) {
+            snprintf(fname, sizeof(fname), "%s/%02zu.js", dirs[i], j);
+            run_jit_benchmark(fname, gc_params);
+        }
+    }
+    for (i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        run_jit_benchmark(benchmarks[i], gc_params);
+    }
+    printf("\n");
+}
+
+int main(int argc, char**argv)
+{
+    struct GARBAGE_COLLECTOR_PARAMS gc_params;
+
+    PREFIX_UNUSED(argc);
+    PREFIX_UNUSED(argv);
+
+    garbage_collector_default_params(&gc_params);
+    gc_params.sizemem_start = GC_BENCHMARK_HEAPSIZE;
+
+    printf("RUNNING BENCHMARKS:\n\n");
+    run_gc_benchmarks(&gc_params);
+    run_generational_benchmarks(&gc_params);
+    run_incremental_benchmarks(&gc_params);
+    run_compact_benchmarks(&gc_params);
+    run_alloc_benchmarks(&gc_params);
+    run_allocator_benchmarks();
+    run_dispatch_benchmarks(&gc_params);
+    run_property_benchmarks(&gc_params);
+    run_call_benchmarks(&gc_params);
+    run_jit_benchmarks(&gc_params);
+
+    return 0;
+}
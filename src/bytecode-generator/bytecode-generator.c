@@ -1,7 +1,9 @@
 #include "bytecode-generator.h"
+#include "register-generator.h"
 
 #include "utils.h"
 
+#include <stdio.h>
 #include <string.h>
 
 struct BYTECODE_GENERATOR
@@ -15,6 +17,8 @@ struct BYTECODE_GENERATOR
 
     size_t scope_depth;
 
+    int superinstructions;
+
     struct BYTECODE_ERROR err;
 };
 
@@ -56,7 +60,7 @@ struct CONSTANT create_constant_from_functionref(const char*str_cnst)
     return cnst;
 }
 
-static int constant_pool_push_back(bytecode_type_t bc, struct CONSTANT cnst)
+int constant_pool_push_back(bytecode_type_t bc, struct CONSTANT cnst)
 {
     size_t i;
 
@@ -100,6 +104,38 @@ static int local_variable_index(bytecode_generator_type_t bc_gen, const char*var
     return -1;
 }
 
+/* functions functions. */
+
+static const struct FUNCTION_DECL_AST*function_decl(bytecode_generator_type_t bc_gen, const char*function_name)
+{
+    size_t i;
+
+    for (i = 0; i < bc_gen->ast->functions_len; i++) {
+        if (strcmp(bc_gen->ast->functions[i]->function_name->ident, function_name) == 0) {
+            return bc_gen->ast->functions[i];
+        }
+    }
+
+    return NULL;
+}
+
+size_t function_decl_args_num(const struct FUNCTION_DECL_AST*f)
+{
+    return (f->formal_parameters_list != NULL) ? f->formal_parameters_list->params_len : 0;
+}
+
+struct BYTECODE_FUNCTION create_bytecode_function(const struct FUNCTION_DECL_AST*f, size_t start)
+{
+    struct BYTECODE_FUNCTION bf;
+
+    memset(&bf, 0, sizeof(bf));
+    snprintf(bf.name, sizeof(bf.name), "%s", f->function_name->ident);
+    bf.args_num = function_decl_args_num(f);
+    bf.start = start;
+
+    return bf;
+}
+
 /* bytecode generator functions. */
 
 bytecode_generator_type_t create_bytecode_generator()
@@ -109,10 +145,11 @@ bytecode_generator_type_t create_bytecode_generator()
     return bc_gen;
 }
 
-void bytecode_generator_conf(bytecode_generator_type_t bc_gen, struct UNIT_AST*ast)
+void bytecode_generator_conf(bytecode_generator_type_t bc_gen, struct UNIT_AST*ast, int superinstructions)
 {
     bc_gen->ast = ast;
     bc_gen->bc = create_bytecode();
+    bc_gen->superinstructions = superinstructions;
 }
 
 static void set_bytecode_generator_error(bytecode_generator_type_t bc_gen, size_t line, size_t pos, enum BYTECODE_GENERATOR_CODES code)
@@ -122,6 +159,36 @@ static void set_bytecode_generator_error(bytecode_generator_type_t bc_gen, size_
     bc_gen->err.code = code;
 }
 
+/* bytecode encoding functions. */
+
+void bytecode_emit_byte(bytecode_type_t bc, uint8_t byte)
+{
+    PUSH_BACK(bc->op_codes, byte);
+}
+
+void bytecode_emit_uleb128(bytecode_type_t bc, size_t val)
+{
+    do {
+        uint8_t byte = val & 0x7F;
+        val >>= 7;
+        if (val != 0) {
+            byte |= 0x80;
+        }
+        bytecode_emit_byte(bc, byte);
+    } while (val != 0);
+}
+
+void bytecode_emit_i32(bytecode_type_t bc, int32_t val)
+{
+    uint8_t bytes[sizeof(val)];
+    size_t i;
+
+    memcpy(bytes, &val, sizeof(val));
+    for (i = 0; i < sizeof(val); i++) {
+        bytecode_emit_byte(bc, bytes[i]);
+    }
+}
+
 static enum BYTECODE_GENERATOR_CODES assignment_expr_ast_bytecode_generate(bytecode_generator_type_t bc_gen, const struct ASSIGNMENT_EXPR_AST*ast);
 
 static enum BYTECODE_GENERATOR_CODES property_ast_bytecode_generate(bytecode_generator_type_t bc_gen, const struct PROPERTY_AST*ast) {
@@ -132,9 +199,9 @@ static enum BYTECODE_GENERATOR_CODES property_ast_bytecode_generate(bytecode_gen
         return r;
     }    
 
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_INIT_OBJ_PROP);
+    bytecode_emit_byte(bc_gen->bc, BC_OP_INIT_OBJ_PROP);
     cnst = create_constant_from_fieldref(ast->key->ident);
-    PUSH_BACK(bc_gen->bc->op_codes, constant_pool_push_back(bc_gen->bc, cnst));
+    bytecode_emit_uleb128(bc_gen->bc, constant_pool_push_back(bc_gen->bc, cnst));
 
     return BYTECODE_GENERATOR_OK;
 }
@@ -150,8 +217,8 @@ static enum BYTECODE_GENERATOR_CODES object_literal_ast_bytecode_generate(byteco
         }
     }
 
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_CREATE_OBJ);
-    PUSH_BACK(bc_gen->bc->op_codes, ast->properties_len);
+    bytecode_emit_byte(bc_gen->bc, BC_OP_CREATE_OBJ);
+    bytecode_emit_uleb128(bc_gen->bc, ast->properties_len);
 
     return BYTECODE_GENERATOR_OK;
 }
@@ -169,12 +236,12 @@ static enum BYTECODE_GENERATOR_CODES array_literal_ast_bytecode_generate(bytecod
         }
     }
 
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_CREATE_ARR);
+    bytecode_emit_byte(bc_gen->bc, BC_OP_CREATE_ARR);
 
     if (ast->args_list != NULL) {
-        PUSH_BACK(bc_gen->bc->op_codes, ast->args_list->assignment_exprs_len);
+        bytecode_emit_uleb128(bc_gen->bc, ast->args_list->assignment_exprs_len);
     } else {
-        PUSH_BACK(bc_gen->bc->op_codes, 0);
+        bytecode_emit_uleb128(bc_gen->bc, 0);
     }
 
     return BYTECODE_GENERATOR_OK;
@@ -185,8 +252,8 @@ static enum BYTECODE_GENERATOR_CODES number_ast_bytecode_generate(bytecode_gener
     struct CONSTANT cnst = create_constant_from_int(ast->number);
     size_t index = constant_pool_push_back(bc_gen->bc, cnst);
 
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_CONSTANT);
-    PUSH_BACK(bc_gen->bc->op_codes, index);
+    bytecode_emit_byte(bc_gen->bc, BC_OP_CONSTANT);
+    bytecode_emit_uleb128(bc_gen->bc, index);
 
     return BYTECODE_GENERATOR_OK;
 }
@@ -203,8 +270,8 @@ static enum BYTECODE_GENERATOR_CODES variable_ast_bytecode_generate_inner(byteco
     }
 
     if (ast->parts_len == 0) {
-        PUSH_BACK(bc_gen->bc->op_codes, is_set_op ? BC_OP_SET_LOCAL : BC_OP_GET_LOCAL);
-        PUSH_BACK(bc_gen->bc->op_codes, idx);        
+        bytecode_emit_byte(bc_gen->bc, is_set_op ? BC_OP_SET_LOCAL : BC_OP_GET_LOCAL);
+        bytecode_emit_uleb128(bc_gen->bc, idx);        
     } else {
         size_t i;
         size_t count = 0;
@@ -217,19 +284,20 @@ static enum BYTECODE_GENERATOR_CODES variable_ast_bytecode_generate_inner(byteco
             }
         }
         
-        PUSH_BACK(bc_gen->bc->op_codes, is_set_op ? BC_OP_SET_HEAP : BC_OP_GET_HEAP);
-        PUSH_BACK(bc_gen->bc->op_codes, idx);
-        PUSH_BACK(bc_gen->bc->op_codes, ast->parts_len);
+        bytecode_emit_byte(bc_gen->bc, is_set_op ? BC_OP_SET_HEAP : BC_OP_GET_HEAP);
+        bytecode_emit_uleb128(bc_gen->bc, idx);
+        bytecode_emit_uleb128(bc_gen->bc, ast->parts_len);
 
         for (i = 0; i < ast->parts_len; i++) {
             if (ast->parts[i]->type == AST_VARIABLE_PART_TYPE_FIELD) {
                 struct CONSTANT cnst = create_constant_from_fieldref(ast->parts[i]->field->ident);
-                PUSH_BACK(bc_gen->bc->op_codes, BC_OBJECT_FIELD);
-                PUSH_BACK(bc_gen->bc->op_codes, constant_pool_push_back(bc_gen->bc, cnst));   
+                bytecode_emit_byte(bc_gen->bc, BC_OBJECT_FIELD);
+                bytecode_emit_uleb128(bc_gen->bc, constant_pool_push_back(bc_gen->bc, cnst));
+                bytecode_emit_uleb128(bc_gen->bc, bc_gen->bc->inline_caches_num++);
             } else if (ast->parts[i]->type == AST_VARIABLE_PART_TYPE_INDEX) {
-                PUSH_BACK(bc_gen->bc->op_codes, BC_ARRAY_INDEX);
+                bytecode_emit_byte(bc_gen->bc, BC_ARRAY_INDEX);
                 count--;
-                PUSH_BACK(bc_gen->bc->op_codes, count);
+                bytecode_emit_uleb128(bc_gen->bc, count);
             } else {
                 fprintf(stderr, "Invalid VARIALE_PART_TYPE: %d\n", ast->parts[i]->type);
                 exit(EXIT_FAILURE);        
@@ -252,9 +320,9 @@ static enum BYTECODE_GENERATOR_CODES has_property_expr_ast_bytecode_generate(byt
     if (r != BYTECODE_GENERATOR_OK) {
         return r;
     }    
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_HAS_PROPERTY);
+    bytecode_emit_byte(bc_gen->bc, BC_OP_HAS_PROPERTY);
     cnst = create_constant_from_fieldref(ast->ident->ident);
-    PUSH_BACK(bc_gen->bc->op_codes, constant_pool_push_back(bc_gen->bc, cnst));    
+    bytecode_emit_uleb128(bc_gen->bc, constant_pool_push_back(bc_gen->bc, cnst));    
 
     return BYTECODE_GENERATOR_OK;    
 }
@@ -265,16 +333,41 @@ static enum BYTECODE_GENERATOR_CODES len_expr_ast_bytecode_generate(bytecode_gen
     if (r != BYTECODE_GENERATOR_OK) {
         return r;
     }
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_LEN);
+    bytecode_emit_byte(bc_gen->bc, BC_OP_LEN);
 
     return BYTECODE_GENERATOR_OK;
 }
 
 static enum BYTECODE_GENERATOR_CODES function_call_expr_ast_bytecode_generate(bytecode_generator_type_t bc_gen, const struct FUNCTION_CALL_AST*ast)
 {
-    /* TODO */
-    PREFIX_UNUSED(bc_gen);
-    PREFIX_UNUSED(ast);
+    size_t i;
+    size_t args_num = (ast->args_list != NULL) ? ast->args_list->assignment_exprs_len : 0;
+
+    struct CONSTANT cnst;
+    
+    const struct FUNCTION_DECL_AST*f = function_decl(bc_gen, ast->function_name->ident);
+
+    if (f == NULL) {
+        set_bytecode_generator_error(bc_gen, ast->line, ast->pos, BYTECODE_GENERATOR_NO_FUNCTION);
+        return BYTECODE_GENERATOR_NO_FUNCTION;
+    }
+
+    if (function_decl_args_num(f) != args_num) {
+        set_bytecode_generator_error(bc_gen, ast->line, ast->pos, BYTECODE_GENERATOR_INVALID_ARGS_NUM);
+        return BYTECODE_GENERATOR_INVALID_ARGS_NUM;
+    }
+
+    /* arguments are left on stack in order, so they are first locals of callee. */
+    for (i = 0; i < args_num; i++) {
+        enum BYTECODE_GENERATOR_CODES r = assignment_expr_ast_bytecode_generate(bc_gen, ast->args_list->assignment_exprs[i]);
+        if (r != BYTECODE_GENERATOR_OK) {
+            return r;
+        }
+    }
+
+    cnst = create_constant_from_functionref(ast->function_name->ident);
+    bytecode_emit_byte(bc_gen->bc, BC_OP_CALL);
+    bytecode_emit_uleb128(bc_gen->bc, constant_pool_push_back(bc_gen->bc, cnst));
     
     return BYTECODE_GENERATOR_OK;
 }
@@ -320,7 +413,7 @@ static enum BYTECODE_GENERATOR_CODES left_unary_expr_ast_bytecode_generate(bytec
     }
     if (ast->op != AST_LEFT_UNARY_OP_PLUS) {
         if (ast->op == AST_LEFT_UNARY_OP_MINUS) {
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_NEGATE);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_NEGATE);
         }
     }
 
@@ -342,13 +435,13 @@ static enum BYTECODE_GENERATOR_CODES multiplicative_expr_ast_bytecode_generate(b
         }
         switch (ast->ops[i - 1]) {
         case AST_MULTIPLICATIVE_OP_MUL:
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_MULTIPLICATIVE_MUL);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_MULTIPLICATIVE_MUL);
             break;
         case AST_MULTIPLICATIVE_OP_DIV:
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_MULTIPLICATIVE_DIV);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_MULTIPLICATIVE_DIV);
             break;
         case AST_MULTIPLICATIVE_OP_MOD:
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_MULTIPLICATIVE_MOD);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_MULTIPLICATIVE_MOD);
             break;
         default:
             fprintf(stderr, "Invalid AST_MULTIPLICATIVE_OP type: %d\n", ast->ops[i - 1]);
@@ -374,9 +467,9 @@ static enum BYTECODE_GENERATOR_CODES additive_expr_ast_bytecode_generate(bytecod
             return r;
         }
         if (ast->ops[i - 1] == AST_ADDITIVE_OP_PLUS) {
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_ADDITIVE_PLUS);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_ADDITIVE_PLUS);
         } else if (ast->ops[i - 1] == AST_ADDITIVE_OP_MINUS) {
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_ADDITIVE_MINUS);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_ADDITIVE_MINUS);
         } else {
             fprintf(stderr, "Invalid AST_ADDITIVE_OP type: %d\n", ast->ops[i - 1]);
             exit(EXIT_FAILURE);
@@ -399,16 +492,16 @@ static enum BYTECODE_GENERATOR_CODES relational_expr_ast_bytecode_generate(bytec
         }
         switch (ast->rel_op) {
         case AST_REL_OP_LT:
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_REL_LT);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_REL_LT);
             break;
         case AST_REL_OP_GT:
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_REL_GT);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_REL_GT);
             break;
         case AST_REL_OP_LE:
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_REL_LE);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_REL_LE);
             break;
         case AST_REL_OP_GE:
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_REL_GE);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_REL_GE);
             break;
         default:
             fprintf(stderr, "Invalid AST_REL_OP type: %d\n", ast->rel_op);
@@ -432,9 +525,9 @@ static enum BYTECODE_GENERATOR_CODES eq_expr_ast_bytecode_generate(bytecode_gene
             return r;
         }
         if (ast->eq_op == AST_EQ_OP_EQEQ) {
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_EQ_EQEQ);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_EQ_EQEQ);
         } else if (ast->eq_op == AST_EQ_OP_NEQ) {
-            PUSH_BACK(bc_gen->bc->op_codes, BC_OP_EQ_NEQ);
+            bytecode_emit_byte(bc_gen->bc, BC_OP_EQ_NEQ);
         } else {
             fprintf(stderr, "Invalid AST_EQ_OP type: %d\n", ast->eq_op);
             exit(EXIT_FAILURE);            
@@ -457,7 +550,7 @@ static enum BYTECODE_GENERATOR_CODES logical_and_expr_ast_bytecode_generate(byte
         if (r != BYTECODE_GENERATOR_OK) {
             return r;
         }
-        PUSH_BACK(bc_gen->bc->op_codes, BC_OP_LOGICAL_AND);
+        bytecode_emit_byte(bc_gen->bc, BC_OP_LOGICAL_AND);
     }
 
     return BYTECODE_GENERATOR_OK;    
@@ -477,7 +570,7 @@ static enum BYTECODE_GENERATOR_CODES logical_or_expr_ast_bytecode_generate(bytec
         if (r != BYTECODE_GENERATOR_OK) {
             return r;
         }
-        PUSH_BACK(bc_gen->bc->op_codes, BC_OP_LOGICAL_OR);
+        bytecode_emit_byte(bc_gen->bc, BC_OP_LOGICAL_OR);
     }
 
     return BYTECODE_GENERATOR_OK;    
@@ -528,27 +621,146 @@ static enum BYTECODE_GENERATOR_CODES decl_stmt_ast_bytecode_generate(bytecode_ge
     PUSH_BACK(bc_gen->locals, lv);
     idx = bc_gen->locals_len - 1;
 
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_SET_LOCAL);
-    PUSH_BACK(bc_gen->bc->op_codes, idx);
+    bytecode_emit_byte(bc_gen->bc, BC_OP_SET_LOCAL);
+    bytecode_emit_uleb128(bc_gen->bc, idx);
 
     return BYTECODE_GENERATOR_OK;
 }
 
+/*
+  Superinstructions: code of one statement or condition, which is emitted from start,
+  is rewritten in place, when it is exactly one of fused sequences.
+  Nothing jumps into the middle of such code, so it is safe to fuse it.
+*/
+
+/*
+  Matches GET_LOCAL idx; CONSTANT cnst; op in [ip, end);
+  returns position after op or NULL. Operands of emitted code are complete,
+  so only opcodes are checked against end.
+*/
+static uint8_t*match_local_const_op(uint8_t*ip, uint8_t*end, size_t*idx, size_t*cnst, uint8_t*op)
+{
+    if ((ip == end) || (*(ip++) != BC_OP_GET_LOCAL)) {
+        return NULL;
+    }
+    (*idx) = bytecode_read_uleb128(&ip);
+
+    if ((ip == end) || (*(ip++) != BC_OP_CONSTANT)) {
+        return NULL;
+    }
+    (*cnst) = bytecode_read_uleb128(&ip);
+
+    if (ip == end) {
+        return NULL;
+    }
+    (*op) = *(ip++);
+
+    return ip;
+}
+
+static int local_const_jump_op(uint8_t op)
+{
+    switch (op) {
+    case BC_OP_REL_LT:
+        return BC_OP_LT_LOCAL_CONST_JUMP;
+    case BC_OP_REL_GT:
+        return BC_OP_GT_LOCAL_CONST_JUMP;
+    case BC_OP_REL_LE:
+        return BC_OP_LE_LOCAL_CONST_JUMP;
+    case BC_OP_REL_GE:
+        return BC_OP_GE_LOCAL_CONST_JUMP;
+    case BC_OP_EQ_EQEQ:
+        return BC_OP_EQ_LOCAL_CONST_JUMP;
+    case BC_OP_EQ_NEQ:
+        return BC_OP_NEQ_LOCAL_CONST_JUMP;
+    default:
+        return -1;
+    }
+}
+
+/*
+  Fuses condition GET_LOCAL; CONSTANT; <cmp> from start with following JUMP_IF_FALSE and POP.
+  Returns offset of empty jump offset like emit_jump, or -1, if condition isn't fused
+  and must be followed by jump and POPs as usual.
+*/
+static int emit_fused_condition_jump(bytecode_generator_type_t bc_gen, size_t start)
+{
+    uint8_t*end = bc_gen->bc->op_codes + bc_gen->bc->op_codes_len;
+    uint8_t*ip;
+    size_t idx = 0, cnst = 0;
+    uint8_t op = 0;
+    int fused;
+
+    if (!bc_gen->superinstructions) {
+        return -1;
+    }
+
+    ip = match_local_const_op(bc_gen->bc->op_codes + start, end, &idx, &cnst, &op);
+    if ((ip != end) || ((fused = local_const_jump_op(op)) == -1)) {
+        return -1;
+    }
+
+    bc_gen->bc->op_codes_len = start;
+    bytecode_emit_byte(bc_gen->bc, fused);
+    bytecode_emit_uleb128(bc_gen->bc, idx);
+    bytecode_emit_uleb128(bc_gen->bc, cnst);
+    bytecode_emit_i32(bc_gen->bc, 0x0); /* empty offset. */
+
+    return bc_gen->bc->op_codes_len - sizeof(int32_t);
+}
+
+/* fuses local = local + constant from start into INC_LOCAL. */
+static void fuse_increment(bytecode_generator_type_t bc_gen, size_t start)
+{
+    uint8_t*end = bc_gen->bc->op_codes + bc_gen->bc->op_codes_len;
+    uint8_t*ip;
+    size_t idx = 0, cnst = 0;
+    uint8_t op = 0;
+
+    if (!bc_gen->superinstructions) {
+        return;
+    }
+
+    ip = match_local_const_op(bc_gen->bc->op_codes + start, end, &idx, &cnst, &op);
+    if ((ip == NULL) || (ip == end) || (op != BC_OP_ADDITIVE_PLUS) ||
+        (*(ip++) != BC_OP_SET_LOCAL) || (bytecode_read_uleb128(&ip) != idx) || (ip != end)) {
+        return;
+    }
+
+    bc_gen->bc->op_codes_len = start;
+    bytecode_emit_byte(bc_gen->bc, BC_OP_INC_LOCAL);
+    bytecode_emit_uleb128(bc_gen->bc, idx);
+    bytecode_emit_uleb128(bc_gen->bc, cnst);
+}
+
 static enum BYTECODE_GENERATOR_CODES assign_stmt_ast_bytecode_generate(bytecode_generator_type_t bc_gen, const struct ASSIGN_STMT_AST*ast)
 {
+    size_t start = bc_gen->bc->op_codes_len;
+
     enum BYTECODE_GENERATOR_CODES r = assignment_expr_ast_bytecode_generate(bc_gen, ast->assignment);
     if (r != BYTECODE_GENERATOR_OK) {
         return r;
     }    
 
-    return variable_ast_bytecode_generate_inner(bc_gen, ast->var_name, 1);
+    r = variable_ast_bytecode_generate_inner(bc_gen, ast->var_name, 1);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+
+    fuse_increment(bc_gen, start);
+
+    return BYTECODE_GENERATOR_OK;
 }
 
 enum BYTECODE_GENERATOR_CODES function_call_stmt_ast_bytecode_generate(bytecode_generator_type_t bc_gen, const struct FUNCTION_CALL_STMT_AST*ast)
 {
-    /* TODO */
-    PREFIX_UNUSED(bc_gen);
-    PREFIX_UNUSED(ast);
+    enum BYTECODE_GENERATOR_CODES r = function_call_expr_ast_bytecode_generate(bc_gen, ast->function_call);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+
+    /* result is not used. */
+    bytecode_emit_byte(bc_gen->bc, BC_OP_POP);
     
     return BYTECODE_GENERATOR_OK;
 }
@@ -556,19 +768,23 @@ enum BYTECODE_GENERATOR_CODES function_call_stmt_ast_bytecode_generate(bytecode_
 static enum BYTECODE_GENERATOR_CODES body_ast_bytecode_generate(bytecode_generator_type_t bc_gen, const struct BODY_AST*ast, int*loop_start_idxs,
                                                                 int**loop_exit_idxs, size_t*loop_exit_idxs_len, size_t*loop_exit_idxs_cap);
 
-static int emit_jump(bytecode_generator_type_t bc_gen, size_t instruction)
+/*
+  Jumps are always emitted wide, because forward offsets are unknown
+  before patch_jump; relax_jumps shrinks them after generation.
+*/
+static int emit_jump(bytecode_generator_type_t bc_gen, enum BC_OP_CODES instruction)
 {
-    PUSH_BACK(bc_gen->bc->op_codes, instruction);
-    PUSH_BACK(bc_gen->bc->op_codes, 0x0); /* empty instruction. */
+    bytecode_emit_byte(bc_gen->bc, (instruction == BC_OP_JUMP_IF_FALSE) ? BC_OP_JUMP_IF_FALSE_WIDE : BC_OP_JUMP_WIDE);
+    bytecode_emit_i32(bc_gen->bc, 0x0); /* empty offset. */
 
-    return bc_gen->bc->op_codes_len - 1;
+    return bc_gen->bc->op_codes_len - sizeof(int32_t);
 }
 
 static void patch_jump(bytecode_generator_type_t bc_gen, size_t offset)
 {
-    int jump = bc_gen->bc->op_codes_len - offset - 1;
+    int32_t jump = bc_gen->bc->op_codes_len - offset - sizeof(int32_t);
 
-    bc_gen->bc->op_codes[offset] = jump;
+    memcpy(bc_gen->bc->op_codes + offset, &jump, sizeof(jump));
 }
 
 static enum BYTECODE_GENERATOR_CODES if_stmt_ast_bytecode_generate(bytecode_generator_type_t bc_gen, const struct IF_STMT_AST*ast, int*loop_start_idx,
@@ -578,14 +794,21 @@ static enum BYTECODE_GENERATOR_CODES if_stmt_ast_bytecode_generate(bytecode_gene
     
     int if_idx;
     int else_idx;
+    int fused;
+
+    size_t start = bc_gen->bc->op_codes_len;
     
     r = logical_or_expr_ast_bytecode_generate(bc_gen, ast->condition);
     if (r != BYTECODE_GENERATOR_OK) {
         return r;
     }    
 
-    if_idx = emit_jump(bc_gen, BC_OP_JUMP_IF_FALSE);
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_POP);
+    if_idx = emit_fused_condition_jump(bc_gen, start);
+    fused = (if_idx != -1);
+    if (!fused) {
+        if_idx = emit_jump(bc_gen, BC_OP_JUMP_IF_FALSE);
+        bytecode_emit_byte(bc_gen->bc, BC_OP_POP);
+    }
 
     r = body_ast_bytecode_generate(bc_gen, ast->if_body, loop_start_idx,
                                    loop_exit_idxs, loop_exit_idxs_len, loop_exit_idxs_cap);
@@ -596,7 +819,9 @@ static enum BYTECODE_GENERATOR_CODES if_stmt_ast_bytecode_generate(bytecode_gene
     else_idx = emit_jump(bc_gen, BC_OP_JUMP);
 
     patch_jump(bc_gen, if_idx);
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_POP);
+    if (!fused) {
+        bytecode_emit_byte(bc_gen->bc, BC_OP_POP);
+    }
 
     if (ast->else_body != NULL) {
         r = body_ast_bytecode_generate(bc_gen, ast->else_body, loop_start_idx,
@@ -613,13 +838,13 @@ static enum BYTECODE_GENERATOR_CODES if_stmt_ast_bytecode_generate(bytecode_gene
 
 static void emit_loop(bytecode_generator_type_t bc_gen, size_t loop_start)
 {
-    int offset;
+    int32_t offset;
     
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_JUMP);
+    bytecode_emit_byte(bc_gen->bc, BC_OP_JUMP_WIDE);
 
-    offset = ((int) (bc_gen->bc->op_codes_len - loop_start + 1)) * (-1);
+    offset = ((int32_t) (bc_gen->bc->op_codes_len + sizeof(int32_t) - loop_start)) * (-1);
     
-    PUSH_BACK(bc_gen->bc->op_codes, offset);
+    bytecode_emit_i32(bc_gen->bc, offset);
 }
 
 static enum BYTECODE_GENERATOR_CODES while_stmt_ast_bytecode_generate(bytecode_generator_type_t bc_gen, const struct WHILE_STMT_AST*ast)
@@ -629,6 +854,7 @@ static enum BYTECODE_GENERATOR_CODES while_stmt_ast_bytecode_generate(bytecode_g
     size_t i;
     
     int loop_start_idx;
+    int fused;
     
     int*loop_exit_idxs = NULL;
     size_t loop_exit_idxs_len = 0;
@@ -641,8 +867,12 @@ static enum BYTECODE_GENERATOR_CODES while_stmt_ast_bytecode_generate(bytecode_g
         return r;
     }
 
-    PUSH_BACK(loop_exit_idxs, emit_jump(bc_gen, BC_OP_JUMP_IF_FALSE));
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_POP);
+    PUSH_BACK(loop_exit_idxs, emit_fused_condition_jump(bc_gen, loop_start_idx));
+    fused = (loop_exit_idxs[0] != -1);
+    if (!fused) {
+        loop_exit_idxs[0] = emit_jump(bc_gen, BC_OP_JUMP_IF_FALSE);
+        bytecode_emit_byte(bc_gen->bc, BC_OP_POP);
+    }
 
     r = body_ast_bytecode_generate(bc_gen, ast->body, &loop_start_idx,
                                    &loop_exit_idxs, &loop_exit_idxs_len, &loop_exit_idxs_cap);
@@ -653,7 +883,9 @@ static enum BYTECODE_GENERATOR_CODES while_stmt_ast_bytecode_generate(bytecode_g
     emit_loop(bc_gen, loop_start_idx);
 
     patch_jump(bc_gen, loop_exit_idxs[0]);
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_POP);
+    if (!fused) {
+        bytecode_emit_byte(bc_gen->bc, BC_OP_POP);
+    }
     
     for (i = 1; i < loop_exit_idxs_len; i++) {
         patch_jump(bc_gen, loop_exit_idxs[i]);
@@ -722,7 +954,7 @@ static enum BYTECODE_GENERATOR_CODES return_stmt_ast_bytecode_generate(bytecode_
         }
     }
 
-    PUSH_BACK(bc_gen->bc->op_codes, BC_OP_RETURN);
+    bytecode_emit_byte(bc_gen->bc, BC_OP_RETURN);
 
     return BYTECODE_GENERATOR_OK;    
 }
@@ -793,24 +1025,243 @@ static enum BYTECODE_GENERATOR_CODES body_ast_bytecode_generate(bytecode_generat
     while ((bc_gen->locals_len > 0) &&
            (bc_gen->locals[bc_gen->locals_len - 1].depth >
             bc_gen->scope_depth)) {
-        PUSH_BACK(bc_gen->bc->op_codes, BC_OP_POP);
+        bytecode_emit_byte(bc_gen->bc, BC_OP_POP);
         bc_gen->locals_len--;
     }
 
     return BYTECODE_GENERATOR_OK;    
 }
 
-enum BYTECODE_GENERATOR_CODES bytecode_generator_generate(bytecode_generator_type_t bc_gen, struct BYTECODE**bc)
-{   
-    /* now only one function without arguments is supported. */
-    struct FUNCTION_DECL_AST*f = bc_gen->ast->functions[0];
-    enum BYTECODE_GENERATOR_CODES r = body_ast_bytecode_generate(bc_gen, f->body, NULL,
-                                                                 NULL, NULL, NULL);
+size_t bytecode_instruction_len(uint8_t*ip)
+{
+    uint8_t*start = ip;
+
+    switch (*(ip++)) {
+    case BC_OP_CONSTANT:
+    case BC_OP_GET_LOCAL:
+    case BC_OP_SET_LOCAL:
+    case BC_OP_CREATE_OBJ:
+    case BC_OP_INIT_OBJ_PROP:
+    case BC_OP_CREATE_ARR:
+    case BC_OP_HAS_PROPERTY:
+    case BC_OP_CALL:
+        bytecode_read_uleb128(&ip);
+        break;
+
+    case BC_OP_GET_HEAP:
+    case BC_OP_SET_HEAP: {
+        size_t i, n;
+        bytecode_read_uleb128(&ip);
+        n = bytecode_read_uleb128(&ip);
+        for (i = 0; i < n; i++) {
+            if (*(ip++) == BC_OBJECT_FIELD) {
+                bytecode_read_uleb128(&ip);
+            }
+            bytecode_read_uleb128(&ip);
+        }
+        break;
+    }
+
+    case BC_OP_JUMP_IF_FALSE:
+    case BC_OP_JUMP:
+        ip += sizeof(int8_t);
+        break;
+    case BC_OP_JUMP_IF_FALSE_WIDE:
+    case BC_OP_JUMP_WIDE:
+        ip += sizeof(int32_t);
+        break;
+
+    case BC_OP_LT_LOCAL_CONST_JUMP:
+    case BC_OP_GT_LOCAL_CONST_JUMP:
+    case BC_OP_LE_LOCAL_CONST_JUMP:
+    case BC_OP_GE_LOCAL_CONST_JUMP:
+    case BC_OP_EQ_LOCAL_CONST_JUMP:
+    case BC_OP_NEQ_LOCAL_CONST_JUMP:
+        bytecode_read_uleb128(&ip);
+        bytecode_read_uleb128(&ip);
+        ip += sizeof(int32_t);
+        break;
+    case BC_OP_INC_LOCAL:
+        bytecode_read_uleb128(&ip);
+        bytecode_read_uleb128(&ip);
+        break;
+    }
+
+    return ip - start;
+}
+
+#define IS_WIDE_JUMP(op) (((op) == BC_OP_JUMP_IF_FALSE_WIDE) || ((op) == BC_OP_JUMP_WIDE))
+/* superinstructions, which end with 32-bit jump offset, keep their length. */
+#define IS_FUSED_JUMP(op) (((op) >= BC_OP_LT_LOCAL_CONST_JUMP) && ((op) <= BC_OP_NEQ_LOCAL_CONST_JUMP))
+
+#define SHORT_JUMP_LEN (1 + sizeof(int8_t))
+#define WIDE_JUMP_LEN  (1 + sizeof(int32_t))
+
+/*
+  Replaces wide jumps by short ones, when offset fits into 8 bits.
+  Shrinking of one jump can only make other offsets shorter,
+  so jumps are shrinked until nothing changes.
+*/
+static void relax_jumps(bytecode_type_t bc)
+{
+    size_t i, n = 0, pos;
+    int changed;
+
+    size_t*starts;     /* old start of every instruction.                  */
+    size_t*new_starts; /* new start of every instruction.                  */
+    size_t*targets;    /* index of jump target instruction.                */
+    size_t*lens;       /* new length of every instruction.                 */
+    size_t*idxs;       /* index of instruction, which starts at old offset. */
+
+    uint8_t*op_codes;
+    size_t op_codes_len = 0;
+
+    for (pos = 0; pos < bc->op_codes_len; pos += bytecode_instruction_len(bc->op_codes + pos)) {
+        n++;
+    }
+
+    SAFE_MALLOC(starts, n + 1);
+    SAFE_MALLOC(new_starts, n + 1);
+    SAFE_MALLOC(targets, n);
+    SAFE_MALLOC(lens, n);
+    SAFE_MALLOC(idxs, bc->op_codes_len + 1);
+
+    for (i = 0, pos = 0; i < n; i++) {
+        starts[i] = pos;
+        lens[i] = bytecode_instruction_len(bc->op_codes + pos);
+        idxs[pos] = i;
+        pos += lens[i];
+    }
+    starts[n] = pos;
+    idxs[pos] = n;
+
+    for (i = 0; i < n; i++) {
+        uint8_t op = bc->op_codes[starts[i]];
+        if (IS_WIDE_JUMP(op) || IS_FUSED_JUMP(op)) {
+            uint8_t*ip = bc->op_codes + starts[i] + lens[i] - sizeof(int32_t);
+            int32_t offset = bytecode_read_i32(&ip);
+            targets[i] = idxs[starts[i] + lens[i] + offset];
+        }
+    }
+
+    do {
+        changed = 0;
+
+        new_starts[0] = 0;
+        for (i = 0; i < n; i++) {
+            new_starts[i + 1] = new_starts[i] + lens[i];
+        }
+
+        for (i = 0; i < n; i++) {
+            if (IS_WIDE_JUMP(bc->op_codes[starts[i]]) && (lens[i] == WIDE_JUMP_LEN)) {
+                long long offset = (long long) new_starts[targets[i]] - (long long) (new_starts[i] + SHORT_JUMP_LEN);
+                if ((offset >= INT8_MIN) && (offset <= INT8_MAX)) {
+                    lens[i] = SHORT_JUMP_LEN;
+                    changed = 1;
+                }
+            }
+        }
+    } while (changed);
+
+    SAFE_MALLOC(op_codes, new_starts[n] == 0 ? 1 : new_starts[n]);
+
+    for (i = 0; i < n; i++) {
+        uint8_t op = bc->op_codes[starts[i]];
+        if (IS_WIDE_JUMP(op)) {
+            int32_t offset = new_starts[targets[i]] - (new_starts[i] + lens[i]);
+            if (lens[i] == SHORT_JUMP_LEN) {
+                op_codes[op_codes_len++] = (op == BC_OP_JUMP_WIDE) ? BC_OP_JUMP : BC_OP_JUMP_IF_FALSE;
+                op_codes[op_codes_len++] = (uint8_t) (int8_t) offset;
+            } else {
+                op_codes[op_codes_len++] = op;
+                memcpy(op_codes + op_codes_len, &offset, sizeof(offset));
+                op_codes_len += sizeof(offset);
+            }
+        } else if (IS_FUSED_JUMP(op)) {
+            int32_t offset = new_starts[targets[i]] - (new_starts[i] + lens[i]);
+            memcpy(op_codes + op_codes_len, bc->op_codes + starts[i], lens[i] - sizeof(offset));
+            op_codes_len += lens[i] - sizeof(offset);
+            memcpy(op_codes + op_codes_len, &offset, sizeof(offset));
+            op_codes_len += sizeof(offset);
+        } else {
+            memcpy(op_codes + op_codes_len, bc->op_codes + starts[i], lens[i]);
+            op_codes_len += lens[i];
+        }
+    }
+
+    for (i = 0; i < bc->functions_len; i++) {
+        bc->functions[i].start = new_starts[idxs[bc->functions[i].start]];
+    }
+
+    SAFE_FREE(bc->op_codes);
+    bc->op_codes = op_codes;
+    bc->op_codes_len = op_codes_len;
+    bc->op_codes_cap = new_starts[n];
+
+    SAFE_FREE(starts);
+    SAFE_FREE(new_starts);
+    SAFE_FREE(targets);
+    SAFE_FREE(lens);
+    SAFE_FREE(idxs);
+}
+
+static enum BYTECODE_GENERATOR_CODES function_decl_ast_bytecode_generate(bytecode_generator_type_t bc_gen, const struct FUNCTION_DECL_AST*ast)
+{
+    size_t i;
+
+    enum BYTECODE_GENERATOR_CODES r;
+
+    struct BYTECODE_FUNCTION bf;
+
+    if (function_decl(bc_gen, ast->function_name->ident) != ast) {
+        set_bytecode_generator_error(bc_gen, ast->line, ast->pos, BYTECODE_GENERATOR_ALREADY_HAVE_FUNCTION);
+        return BYTECODE_GENERATOR_ALREADY_HAVE_FUNCTION;
+    }
+
+    bf = create_bytecode_function(ast, bc_gen->bc->op_codes_len);
+    PUSH_BACK(bc_gen->bc->functions, bf);
+
+    /* arguments are locals of function's body. */
+    bc_gen->locals_len = 0;
+    bc_gen->scope_depth = 0;
+    for (i = 0; i < bf.args_num; i++) {
+        const struct IDENT_AST*param = ast->formal_parameters_list->params[i];
+        struct LOCAL_VARIABLE lv;
+        if (local_variable_index(bc_gen, param->ident) != -1) {
+            set_bytecode_generator_error(bc_gen, param->line, param->pos, BYTECODE_GENERATOR_ALREADY_HAVE_LOCAL_VARIABLE);
+            return BYTECODE_GENERATOR_ALREADY_HAVE_LOCAL_VARIABLE;
+        }
+        lv = create_local_variable(param->ident, 1);
+        PUSH_BACK(bc_gen->locals, lv);
+    }
+
+    r = body_ast_bytecode_generate(bc_gen, ast->body, NULL, NULL, NULL, NULL);
     if (r != BYTECODE_GENERATOR_OK) {
-        bytecode_free(bc_gen->bc);
         return r;
     }
 
+    /* function without return returns 0. */
+    bytecode_emit_byte(bc_gen->bc, BC_OP_CONSTANT);
+    bytecode_emit_uleb128(bc_gen->bc, constant_pool_push_back(bc_gen->bc, create_constant_from_int(0)));
+    bytecode_emit_byte(bc_gen->bc, BC_OP_RETURN);
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+enum BYTECODE_GENERATOR_CODES bytecode_generator_generate(bytecode_generator_type_t bc_gen, struct BYTECODE**bc)
+{
+    size_t i;
+
+    for (i = 0; i < bc_gen->ast->functions_len; i++) {
+        enum BYTECODE_GENERATOR_CODES r = function_decl_ast_bytecode_generate(bc_gen, bc_gen->ast->functions[i]);
+        if (r != BYTECODE_GENERATOR_OK) {
+            bytecode_free(bc_gen->bc);
+            return r;
+        }
+    }
+
+    relax_jumps(bc_gen->bc);
+
     (*bc) = bc_gen->bc;
     return BYTECODE_GENERATOR_OK;
 }
@@ -828,9 +1279,73 @@ bytecode_type_t create_bytecode()
     return bc;
 }
 
+static const char*op_names[BC_OPS_NUM] = {
+    "POP",
+    "CONSTANT",
+    "CREATE_LOCAL",
+    "GET_LOCAL",
+    "SET_LOCAL",
+    "CREATE_OBJ",
+    "INIT_OBJ_PROP",
+    "CREATE_ARR",
+    "GET_HEAP",
+    "SET_HEAP",
+    "APPEND",
+    "DELETE",
+    "LOGICAL_OR",
+    "LOGICAL_AND",
+    "EQ_EQEQ",
+    "EQ_NEQ",
+    "REL_LT",
+    "REL_GT",
+    "REL_LE",
+    "REL_GE",
+    "ADDITIVE_PLUS",
+    "ADDITIVE_MINUS",
+    "MULTIPLICATIVE_MUL",
+    "MULTIPLICATIVE_DIV",
+    "MULTIPLICATIVE_MOD",
+    "NEGATE",
+    "HAS_PROPERTY",
+    "LEN",
+    "JUMP_IF_FALSE",
+    "JUMP",
+    "JUMP_IF_FALSE_WIDE",
+    "JUMP_WIDE",
+    "CALL",
+    "RETURN",
+    "LT_LOCAL_CONST_JUMP",
+    "GT_LOCAL_CONST_JUMP",
+    "LE_LOCAL_CONST_JUMP",
+    "GE_LOCAL_CONST_JUMP",
+    "EQ_LOCAL_CONST_JUMP",
+    "NEQ_LOCAL_CONST_JUMP",
+    "INC_LOCAL",
+    "LOGICAL_OR_INT",
+    "LOGICAL_AND_INT",
+    "EQ_EQEQ_INT",
+    "EQ_NEQ_INT",
+    "REL_LT_INT",
+    "REL_GT_INT",
+    "REL_LE_INT",
+    "REL_GE_INT",
+    "ADDITIVE_PLUS_INT",
+    "ADDITIVE_MINUS_INT",
+    "MULTIPLICATIVE_MUL_INT",
+    "MULTIPLICATIVE_DIV_INT",
+    "MULTIPLICATIVE_MOD_INT",
+    "NEGATE_INT",
+};
+
+const char*bytecode_op_name(unsigned op)
+{
+    return (op < BC_OPS_NUM) ? op_names[op] : NULL;
+}
+
 void dump_bytecode_to_xml_file(FILE*f, const bytecode_type_t bc)
 {
     size_t i;
+    uint8_t*ip;
     
     fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
     fprintf(f, "<bytecode>\n");
@@ -854,69 +1369,71 @@ void dump_bytecode_to_xml_file(FILE*f, const bytecode_type_t bc)
     }
     fprintf(f, "\t</constant_pool>\n");
 
-    fprintf(f, "\t<op_codes>\n");
+    fprintf(f, "\t<functions>\n");
+    for (i = 0; i < bc->functions_len; i++) {
+        if (bc->kind == BYTECODE_REGISTER) {
+            fprintf(f, "\t\t<function name=\"%s\" args=\"%zu\" regs=\"%zu\" start=\"%zu\"/>\n",
+                    bc->functions[i].name, bc->functions[i].args_num, bc->functions[i].regs_num, bc->functions[i].start);
+        } else {
+            fprintf(f, "\t\t<function name=\"%s\" args=\"%zu\" start=\"%zu\"/>\n",
+                    bc->functions[i].name, bc->functions[i].args_num, bc->functions[i].start);
+        }
+    }
+    fprintf(f, "\t</functions>\n");
+
+    if (bc->kind == BYTECODE_REGISTER) {
+        dump_register_op_codes_to_xml_file(f, bc);
+        fprintf(f, "</bytecode>\n");
+        return;
+    }
+
+    fprintf(f, "\t<op_codes len=\"%zu\">\n", bc->op_codes_len);
     
-    i = 0;
-    while (i < bc->op_codes_len) {
+    ip = bc->op_codes;
+    while (ip < bc->op_codes + bc->op_codes_len) {
         size_t j, n;
         
-        switch (bc->op_codes[i]) {
+        switch (*(ip++)) {
         case BC_OP_POP:
-            fprintf(f, "\t\t<op>POP<op>\n");
+            fprintf(f, "\t\t<op>POP</op>\n");
             break;
 
         case BC_OP_CONSTANT:
-            i++;
-            fprintf(f, "\t\t<op>CONSTANT %zu</op>\n", bc->op_codes[i]);
+            fprintf(f, "\t\t<op>CONSTANT %zu</op>\n", bytecode_read_uleb128(&ip));
             break;
 
         case BC_OP_GET_LOCAL:
-            i++;
-            fprintf(f, "\t\t<op>GET_LOCAL %zu</op>\n", bc->op_codes[i]);
+            fprintf(f, "\t\t<op>GET_LOCAL %zu</op>\n", bytecode_read_uleb128(&ip));
             break;
         case BC_OP_SET_LOCAL:
-            i++;
-            fprintf(f, "\t\t<op>SET_LOCAL %zu</op>\n", bc->op_codes[i]);
+            fprintf(f, "\t\t<op>SET_LOCAL %zu</op>\n", bytecode_read_uleb128(&ip));
             break;
 
         case BC_OP_CREATE_OBJ:
-            i++;
-            fprintf(f, "\t\t<op>CREATE_OBJ %zu</op>\n", bc->op_codes[i]);
+            fprintf(f, "\t\t<op>CREATE_OBJ %zu</op>\n", bytecode_read_uleb128(&ip));
             break;
         case BC_OP_INIT_OBJ_PROP:
-            i++;
-            fprintf(f, "\t\t<op>INIT_OBJ_PROP %zu</op>\n", bc->op_codes[i]);
+            fprintf(f, "\t\t<op>INIT_OBJ_PROP %zu</op>\n", bytecode_read_uleb128(&ip));
             break;
 
         case BC_OP_CREATE_ARR:
-            i++;
-            fprintf(f, "\t\t<op>CREATE_ARR %zu</op>\n", bc->op_codes[i]);
+            fprintf(f, "\t\t<op>CREATE_ARR %zu</op>\n", bytecode_read_uleb128(&ip));
             break;
 
         case BC_OP_GET_HEAP:
         case BC_OP_SET_HEAP:
-            if (bc->op_codes[i] == BC_OP_GET_HEAP) {
-                i++;
-                fprintf(f, "\t\t<op>GET_HEAP %zu", bc->op_codes[i]);
-            } else if (bc->op_codes[i] == BC_OP_SET_HEAP) {
-                i++;
-                fprintf(f, "\t\t<op>SET_HEAP %zu", bc->op_codes[i]);
-            }
+            fprintf(f, "\t\t<op>%s", (*(ip - 1) == BC_OP_GET_HEAP) ? "GET_HEAP" : "SET_HEAP");
+            fprintf(f, " %zu", bytecode_read_uleb128(&ip));
 
-            i++;
-            n = bc->op_codes[i];
-            i++;
+            n = bytecode_read_uleb128(&ip);
             for (j = 0; j < n; j++) {
-                if (bc->op_codes[i] == BC_OBJECT_FIELD) {
-                    i++;
-                    fprintf(f, " field(%zu)", bc->op_codes[i]);
-                } else if (bc->op_codes[i] == BC_ARRAY_INDEX) {
-                    i++;
-                    fprintf(f, " index(%zu)", bc->op_codes[i]);
+                if (*(ip++) == BC_OBJECT_FIELD) {
+                    size_t key = bytecode_read_uleb128(&ip);
+                    fprintf(f, " field(%zu; ic %zu)", key, bytecode_read_uleb128(&ip));
+                } else {
+                    fprintf(f, " index(%zu)", bytecode_read_uleb128(&ip));
                 }
-                i++;
             }
-            i--;
             fprintf(f, "</op>\n");
             break;
 
@@ -976,25 +1493,51 @@ void dump_bytecode_to_xml_file(FILE*f, const bytecode_type_t bc)
             fprintf(f, "\t\t<op>LEN</op>\n");
             break;
         case BC_OP_HAS_PROPERTY:
-            i++;
-            fprintf(f, "\t\t<op>HAS_PROPERTY %zu</op>\n", bc->op_codes[i]);
+            fprintf(f, "\t\t<op>HAS_PROPERTY %zu</op>\n", bytecode_read_uleb128(&ip));
             break;            
 
         case BC_OP_JUMP_IF_FALSE:
-            i++;
-            fprintf(f, "\t\t<op>JUMP_IF_FALSE %d</op>\n", (int) bc->op_codes[i]);
+            fprintf(f, "\t\t<op>JUMP_IF_FALSE %d</op>\n", (int) bytecode_read_i8(&ip));
             break;
         case BC_OP_JUMP:
-            i++;
-            fprintf(f, "\t\t<op>JUMP %d</op>\n", (int) bc->op_codes[i]);
+            fprintf(f, "\t\t<op>JUMP %d</op>\n", (int) bytecode_read_i8(&ip));
+            break;
+        case BC_OP_JUMP_IF_FALSE_WIDE:
+            fprintf(f, "\t\t<op>JUMP_IF_FALSE_WIDE %d</op>\n", (int) bytecode_read_i32(&ip));
+            break;
+        case BC_OP_JUMP_WIDE:
+            fprintf(f, "\t\t<op>JUMP_WIDE %d</op>\n", (int) bytecode_read_i32(&ip));
             break;
 
+        case BC_OP_CALL:
+            fprintf(f, "\t\t<op>CALL %zu</op>\n", bytecode_read_uleb128(&ip));
+            break;
         case BC_OP_RETURN:
             fprintf(f, "\t\t<op>RETURN</op>\n");
             break;
-        }
 
-        i++;
+        case BC_OP_LT_LOCAL_CONST_JUMP:
+        case BC_OP_GT_LOCAL_CONST_JUMP:
+        case BC_OP_LE_LOCAL_CONST_JUMP:
+        case BC_OP_GE_LOCAL_CONST_JUMP:
+        case BC_OP_EQ_LOCAL_CONST_JUMP:
+        case BC_OP_NEQ_LOCAL_CONST_JUMP:
+            fprintf(f, "\t\t<op>%s", bytecode_op_name(*(ip - 1)));
+            fprintf(f, " %zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " %zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " %d</op>\n", (int) bytecode_read_i32(&ip));
+            break;
+        case BC_OP_INC_LOCAL:
+            fprintf(f, "\t\t<op>INC_LOCAL");
+            fprintf(f, " %zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " %zu</op>\n", bytecode_read_uleb128(&ip));
+            break;
+
+        default:
+            /* quickened opcodes have no operands. */
+            fprintf(f, "\t\t<op>%s</op>\n", bytecode_op_name(*(ip - 1)));
+            break;
+        }
     }
     fprintf(f, "\t</op_codes>\n");    
 
@@ -1031,6 +1574,18 @@ void print_bytecode_error(const struct BYTECODE_ERROR*err)
         error_str = "continue outside of while!";
         break;
     }
+    case BYTECODE_GENERATOR_NO_FUNCTION: {
+        error_str = "no function!";
+        break;
+    }
+    case BYTECODE_GENERATOR_ALREADY_HAVE_FUNCTION: {
+        error_str = "already have function!";
+        break;
+    }
+    case BYTECODE_GENERATOR_INVALID_ARGS_NUM: {
+        error_str = "invalid number of arguments!";
+        break;
+    }
     }
     
     fprintf(stderr, "%zu:%zu: error: %s\n",
@@ -1041,6 +1596,7 @@ void bytecode_free(bytecode_type_t bc)
 {
     SAFE_FREE(bc->op_codes);
     SAFE_FREE(bc->constant_pool);
+    SAFE_FREE(bc->functions);
     SAFE_FREE(bc);
 }
 
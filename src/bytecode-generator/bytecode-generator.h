@@ -3,6 +3,9 @@
 
 #include "parser.h"
 
+#include <stdint.h>
+#include <string.h>
+
 enum BYTECODE_GENERATOR_CODES
 {
     BYTECODE_GENERATOR_OK                          =  0,
@@ -10,6 +13,9 @@ enum BYTECODE_GENERATOR_CODES
     BYTECODE_GENERATOR_ALREADY_HAVE_LOCAL_VARIABLE = -2,
     BYTECODE_GENERATOR_INVALID_BREAK               = -3,
     BYTECODE_GENERATOR_INVALID_CONTINUE            = -4,
+    BYTECODE_GENERATOR_NO_FUNCTION                 = -5,
+    BYTECODE_GENERATOR_ALREADY_HAVE_FUNCTION       = -6,
+    BYTECODE_GENERATOR_INVALID_ARGS_NUM            = -7,
 };
 
 struct BYTECODE_ERROR
@@ -24,7 +30,8 @@ typedef struct BYTECODE_GENERATOR* bytecode_generator_type_t;
 
 bytecode_generator_type_t create_bytecode_generator();
 
-void bytecode_generator_conf(bytecode_generator_type_t bc_gen, struct UNIT_AST*ast);
+/* superinstructions - 1, if common opcode sequences are fused into superinstructions. */
+void bytecode_generator_conf(bytecode_generator_type_t bc_gen, struct UNIT_AST*ast, int superinstructions);
 
 struct BYTECODE;
 
@@ -86,12 +93,57 @@ enum BC_OP_CODES
     BC_OP_HAS_PROPERTY, /* check if property exists in obj; (-1) - not obj. */
     BC_OP_LEN,          /* get len of array; (-1) - not array.              */
 
-    BC_OP_JUMP_IF_FALSE, /* conditional jump.   */
-    BC_OP_JUMP,          /* unconditional jump. */
+    BC_OP_JUMP_IF_FALSE,      /* conditional jump with 8-bit offset.    */
+    BC_OP_JUMP,               /* unconditional jump with 8-bit offset.  */
+    BC_OP_JUMP_IF_FALSE_WIDE, /* conditional jump with 32-bit offset.   */
+    BC_OP_JUMP_WIDE,          /* unconditional jump with 32-bit offset. */
 
+    BC_OP_CALL,   /* call function; arguments become its first locals. */
     BC_OP_RETURN, /* return from function */
+
+    /*
+      Superinstructions, which are chosen by opcode n-grams of traces (trace-decoder -f ngrams).
+      <cmp>_LOCAL_CONST_JUMP replaces condition of while or if
+      GET_LOCAL idx; CONSTANT cnst; <cmp>; JUMP_IF_FALSE offset; POP
+      and jumps by 32-bit offset without pushing anything, when comparison is false.
+    */
+    BC_OP_LT_LOCAL_CONST_JUMP,  /* jump, unless local <  constant. */
+    BC_OP_GT_LOCAL_CONST_JUMP,  /* jump, unless local >  constant. */
+    BC_OP_LE_LOCAL_CONST_JUMP,  /* jump, unless local <= constant. */
+    BC_OP_GE_LOCAL_CONST_JUMP,  /* jump, unless local >= constant. */
+    BC_OP_EQ_LOCAL_CONST_JUMP,  /* jump, unless local == constant. */
+    BC_OP_NEQ_LOCAL_CONST_JUMP, /* jump, unless local != constant. */
+    BC_OP_INC_LOCAL, /* local = local + constant; replaces GET_LOCAL; CONSTANT; ADDITIVE_PLUS; SET_LOCAL. */
+
+    /*
+      Quickened opcodes aren't generated: VM rewrites generic opcode from LOGICAL_OR to NEGATE
+      in place, when it sees integer operands, and rewrites it back (deoptimizes), when guard fails.
+      They are in the same order as generic ones.
+    */
+    BC_OP_LOGICAL_OR_INT,
+    BC_OP_LOGICAL_AND_INT,
+    BC_OP_EQ_EQEQ_INT,
+    BC_OP_EQ_NEQ_INT,
+    BC_OP_REL_LT_INT,
+    BC_OP_REL_GT_INT,
+    BC_OP_REL_LE_INT,
+    BC_OP_REL_GE_INT,
+    BC_OP_ADDITIVE_PLUS_INT,
+    BC_OP_ADDITIVE_MINUS_INT,
+    BC_OP_MULTIPLICATIVE_MUL_INT,
+    BC_OP_MULTIPLICATIVE_DIV_INT,
+    BC_OP_MULTIPLICATIVE_MOD_INT,
+    BC_OP_NEGATE_INT,
 };
 
+#define BC_OPS_NUM (BC_OP_NEGATE_INT + 1)
+
+#define BC_OP_QUICKENED(op)   ((op) - BC_OP_LOGICAL_OR + BC_OP_LOGICAL_OR_INT)
+#define BC_OP_DEOPTIMIZED(op) ((op) - BC_OP_LOGICAL_OR_INT + BC_OP_LOGICAL_OR)
+
+/* name of opcode as it is printed in dumps; NULL for unknown opcode. */
+const char*bytecode_op_name(unsigned op);
+
 enum CONSTANT_TYPE
 {
     CONSTANT_TYPE_INTEGER,
@@ -116,12 +168,43 @@ struct CONSTANT
 
 struct CONSTANT create_constant_from_int(long long int_cnst);
 struct CONSTANT create_constant_from_double(double double_cnst);
-struct CONSTANT create_constant_from_fieldred(const char*str_cnst);
+struct CONSTANT create_constant_from_fieldref(const char*str_cnst);
 struct CONSTANT create_constant_from_functionref(const char*str_cnst);
 
+/* function starts at op_codes[start]; entry point is the first function. */
+struct BYTECODE_FUNCTION
+{
+    char name[32];
+    size_t args_num;
+    size_t start;
+    size_t regs_num; /* size of frame in register bytecode (arguments are its first registers). */
+};
+
+size_t function_decl_args_num(const struct FUNCTION_DECL_AST*f);
+
+/* function of declaration, whose code starts at op_codes[start]. */
+struct BYTECODE_FUNCTION create_bytecode_function(const struct FUNCTION_DECL_AST*f, size_t start);
+
+enum BYTECODE_KIND
+{
+    BYTECODE_STACK,    /* BC_OP_CODES of stack VM.                            */
+    BYTECODE_REGISTER, /* RC_OP_CODES of register VM (see register-generator.h). */
+};
+
+/*
+  Bytecode is stream of bytes: every opcode takes one byte,
+  indexes and counters are unsigned LEB128, jump offsets are
+  signed 8-bit or 32-bit (WIDE jumps and superinstructions) little-endian
+  numbers, counted from the end of jump instruction, and are always the last
+  operand. Every field access in GET_HEAP/SET_HEAP is
+  followed by index of its own inline cache site. CALL refers to
+  FUNCTIONREF constant, which is resolved by VM, when bytecode is loaded.
+*/
 struct BYTECODE
 {
-    size_t*op_codes;
+    enum BYTECODE_KIND kind;
+
+    uint8_t*op_codes;
     size_t op_codes_len;
     size_t op_codes_cap;
 
@@ -129,6 +212,12 @@ struct BYTECODE
     size_t constant_pool_len;
     size_t constant_pool_cap;
 
+    struct BYTECODE_FUNCTION*functions;
+    size_t functions_len;
+    size_t functions_cap;
+
+    size_t inline_caches_num;
+
     struct BYTECODE_POS*poss;
 };
 
@@ -136,6 +225,46 @@ typedef struct BYTECODE* bytecode_type_t;
 
 bytecode_type_t create_bytecode();
 
+/* returns index of constant; equal constants share one index. */
+int constant_pool_push_back(bytecode_type_t bc, struct CONSTANT cnst);
+
+/* appends opcode or operand to op_codes; bytecode_read_* decode them back. */
+void bytecode_emit_byte(bytecode_type_t bc, uint8_t byte);
+void bytecode_emit_uleb128(bytecode_type_t bc, size_t val);
+void bytecode_emit_i32(bytecode_type_t bc, int32_t val);
+
+/* decodes unsigned LEB128 operand and moves ptr past it. */
+static inline size_t bytecode_read_uleb128(uint8_t**ptr)
+{
+    size_t res = 0;
+    size_t shift = 0;
+    uint8_t byte;
+
+    do {
+        byte = *((*ptr)++);
+        res |= ((size_t) (byte & 0x7F)) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return res;
+}
+
+static inline int8_t bytecode_read_i8(uint8_t**ptr)
+{
+    return (int8_t) *((*ptr)++);
+}
+
+static inline int32_t bytecode_read_i32(uint8_t**ptr)
+{
+    int32_t res;
+    memcpy(&res, *ptr, sizeof(res));
+    (*ptr) += sizeof(res);
+    return res;
+}
+
+/* length of instruction in bytes together with its operands. */
+size_t bytecode_instruction_len(uint8_t*ip);
+
 void dump_bytecode_to_xml_file(FILE*f, const bytecode_type_t bc);
 
 void bytecode_free(bytecode_type_t bc);
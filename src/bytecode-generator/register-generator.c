@@ -0,0 +1,1202 @@
+#include "register-generator.h"
+
+#include "utils.h"
+
+#include <string.h>
+
+/* local variable i lives in register i. */
+struct REGISTER_LOCAL
+{
+    char name[32];
+    size_t depth;
+};
+
+/* jumps of the innermost loop. */
+struct REGISTER_LOOP
+{
+    size_t start;
+
+    int*exits; /* offsets of jump offsets, which are patched at the end of loop. */
+    size_t exits_len;
+    size_t exits_cap;
+};
+
+struct REGISTER_GENERATOR
+{
+    struct UNIT_AST*ast;
+    struct BYTECODE*bc;
+
+    struct REGISTER_LOCAL*locals;
+    size_t locals_len;
+    size_t locals_cap;
+
+    size_t scope_depth;
+
+    /*
+      Temporaries are allocated above locals in stack order,
+      so regs_top is equal to locals_len between statements.
+    */
+    size_t regs_top;
+    size_t regs_num; /* registers used by current function. */
+
+    struct BYTECODE_ERROR err;
+};
+
+/* local variables functions. */
+
+static int register_local_index(register_generator_type_t rg, const char*var_name)
+{
+    int i;
+
+    for (i = rg->locals_len - 1; i >= 0; i--) {
+        if (strcmp(rg->locals[i].name, var_name) == 0) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static void push_register_local(register_generator_type_t rg, const char*name, size_t depth)
+{
+    struct REGISTER_LOCAL lv;
+
+    memset(&lv, 0, sizeof(lv));
+    strncpy(lv.name, name, sizeof(lv.name) - 1);
+    lv.depth = depth;
+    PUSH_BACK(rg->locals, lv);
+}
+
+/* functions functions. */
+
+static const struct FUNCTION_DECL_AST*register_function_decl(register_generator_type_t rg, const char*function_name)
+{
+    size_t i;
+
+    for (i = 0; i < rg->ast->functions_len; i++) {
+        if (strcmp(rg->ast->functions[i]->function_name->ident, function_name) == 0) {
+            return rg->ast->functions[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* register generator functions. */
+
+register_generator_type_t create_register_generator()
+{
+    struct REGISTER_GENERATOR*rg;
+    SAFE_CALLOC(rg, 1);
+    return rg;
+}
+
+void register_generator_conf(register_generator_type_t rg, struct UNIT_AST*ast)
+{
+    rg->ast = ast;
+    rg->bc = create_bytecode();
+    rg->bc->kind = BYTECODE_REGISTER;
+}
+
+static enum BYTECODE_GENERATOR_CODES set_register_generator_error(register_generator_type_t rg, size_t line, size_t pos,
+                                                                  enum BYTECODE_GENERATOR_CODES code)
+{
+    rg->err.pos.line = line;
+    rg->err.pos.pos = pos;
+    rg->err.code = code;
+
+    return code;
+}
+
+/* bytecode encoding functions. */
+
+static void emit_op2(register_generator_type_t rg, enum RC_OP_CODES op, size_t a, size_t b)
+{
+    bytecode_emit_byte(rg->bc, op);
+    bytecode_emit_uleb128(rg->bc, a);
+    bytecode_emit_uleb128(rg->bc, b);
+}
+
+static void emit_op3(register_generator_type_t rg, enum RC_OP_CODES op, size_t a, size_t b, size_t c)
+{
+    emit_op2(rg, op, a, b);
+    bytecode_emit_uleb128(rg->bc, c);
+}
+
+/* returns offset of empty jump offset for patch_jump. */
+static int emit_jump(register_generator_type_t rg)
+{
+    bytecode_emit_byte(rg->bc, RC_OP_JUMP);
+    bytecode_emit_i32(rg->bc, 0x0);
+
+    return rg->bc->op_codes_len - sizeof(int32_t);
+}
+
+static int emit_jump_if_false(register_generator_type_t rg, size_t reg)
+{
+    bytecode_emit_byte(rg->bc, RC_OP_JUMP_IF_FALSE);
+    bytecode_emit_uleb128(rg->bc, reg);
+    bytecode_emit_i32(rg->bc, 0x0);
+
+    return rg->bc->op_codes_len - sizeof(int32_t);
+}
+
+static void patch_jump(register_generator_type_t rg, size_t offset)
+{
+    int32_t jump = rg->bc->op_codes_len - offset - sizeof(int32_t);
+
+    memcpy(rg->bc->op_codes + offset, &jump, sizeof(jump));
+}
+
+static void emit_loop(register_generator_type_t rg, size_t loop_start)
+{
+    bytecode_emit_byte(rg->bc, RC_OP_JUMP);
+    bytecode_emit_i32(rg->bc, ((int32_t) (rg->bc->op_codes_len + sizeof(int32_t) - loop_start)) * (-1));
+}
+
+/* registers allocation functions. */
+
+static size_t alloc_reg(register_generator_type_t rg)
+{
+    size_t reg = rg->regs_top++;
+
+    if (rg->regs_top > rg->regs_num) {
+        rg->regs_num = rg->regs_top;
+    }
+
+    return reg;
+}
+
+/*
+  Every expression is generated into dst register, or, when dst is -1, into any
+  register, which is returned in res: local variable is used in place and
+  other values get new temporary. Temporaries of operands are freed after
+  the instruction, which consumes them.
+*/
+static size_t result_reg(register_generator_type_t rg, int dst)
+{
+    return (dst == -1) ? alloc_reg(rg) : (size_t) dst;
+}
+
+/*
+  Intermediate values of chains like a + b + c go to accumulator, which isn't dst,
+  so dst (which may be local variable) is written only by the last instruction
+  and operands still see its old value.
+*/
+static size_t chain_acc_reg(register_generator_type_t rg, int dst, size_t res, size_t len)
+{
+    return ((dst != -1) && (len > 2)) ? alloc_reg(rg) : res;
+}
+
+/* expressions. */
+
+static enum BYTECODE_GENERATOR_CODES assignment_expr_generate(register_generator_type_t rg, const struct ASSIGNMENT_EXPR_AST*ast,
+                                                              int dst, size_t*res);
+static enum BYTECODE_GENERATOR_CODES logical_or_expr_generate(register_generator_type_t rg, const struct LOGICAL_OR_EXPR_AST*ast,
+                                                              int dst, size_t*res);
+
+static enum BYTECODE_GENERATOR_CODES object_literal_generate(register_generator_type_t rg, const struct OBJECT_LITERAL_AST*ast,
+                                                             int dst, size_t*res)
+{
+    size_t i, first, mark;
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    first = rg->regs_top;
+    for (i = 0; i < ast->properties_len; i++) {
+        alloc_reg(rg);
+    }
+    for (i = 0; i < ast->properties_len; i++) {
+        size_t reg;
+        enum BYTECODE_GENERATOR_CODES r = assignment_expr_generate(rg, ast->properties[i]->value, first + i, &reg);
+        if (r != BYTECODE_GENERATOR_OK) {
+            return r;
+        }
+    }
+
+    emit_op3(rg, RC_OP_CREATE_OBJ, *res, first, ast->properties_len);
+    for (i = 0; i < ast->properties_len; i++) {
+        struct CONSTANT cnst = create_constant_from_fieldref(ast->properties[i]->key->ident);
+        bytecode_emit_uleb128(rg->bc, constant_pool_push_back(rg->bc, cnst));
+    }
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES array_literal_generate(register_generator_type_t rg, const struct ARRAY_LITERAL_AST*ast,
+                                                            int dst, size_t*res)
+{
+    size_t len = (ast->args_list != NULL) ? ast->args_list->assignment_exprs_len : 0;
+    size_t i, first, mark;
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    first = rg->regs_top;
+    for (i = 0; i < len; i++) {
+        alloc_reg(rg);
+    }
+    /* values are evaluated from the last one, as in stack bytecode. */
+    for (i = len; i > 0; i--) {
+        size_t reg;
+        enum BYTECODE_GENERATOR_CODES r = assignment_expr_generate(rg, ast->args_list->assignment_exprs[i - 1], first + i - 1, &reg);
+        if (r != BYTECODE_GENERATOR_OK) {
+            return r;
+        }
+    }
+
+    emit_op3(rg, RC_OP_CREATE_ARR, *res, first, len);
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES number_generate(register_generator_type_t rg, const struct NUMBER_AST*ast, int dst, size_t*res)
+{
+    struct CONSTANT cnst = create_constant_from_int(ast->number);
+
+    (*res) = result_reg(rg, dst);
+    emit_op2(rg, RC_OP_CONSTANT, *res, constant_pool_push_back(rg->bc, cnst));
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+/* generates index registers and emits parts of GET_HEAP/SET_HEAP for them. */
+static enum BYTECODE_GENERATOR_CODES heap_parts_generate(register_generator_type_t rg, const struct VARIABLE_AST*ast,
+                                                         size_t*index_regs)
+{
+    size_t i;
+
+    for (i = 0; i < ast->parts_len; i++) {
+        if (ast->parts[i]->type == AST_VARIABLE_PART_TYPE_INDEX) {
+            enum BYTECODE_GENERATOR_CODES r = logical_or_expr_generate(rg, ast->parts[i]->index, -1, index_regs + i);
+            if (r != BYTECODE_GENERATOR_OK) {
+                return r;
+            }
+        }
+    }
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static void emit_heap_parts(register_generator_type_t rg, const struct VARIABLE_AST*ast, const size_t*index_regs)
+{
+    size_t i;
+
+    bytecode_emit_uleb128(rg->bc, ast->parts_len);
+    for (i = 0; i < ast->parts_len; i++) {
+        if (ast->parts[i]->type == AST_VARIABLE_PART_TYPE_FIELD) {
+            struct CONSTANT cnst = create_constant_from_fieldref(ast->parts[i]->field->ident);
+            bytecode_emit_byte(rg->bc, BC_OBJECT_FIELD);
+            bytecode_emit_uleb128(rg->bc, constant_pool_push_back(rg->bc, cnst));
+            bytecode_emit_uleb128(rg->bc, rg->bc->inline_caches_num++);
+        } else if (ast->parts[i]->type == AST_VARIABLE_PART_TYPE_INDEX) {
+            bytecode_emit_byte(rg->bc, BC_ARRAY_INDEX);
+            bytecode_emit_uleb128(rg->bc, index_regs[i]);
+        } else {
+            fprintf(stderr, "Invalid VARIALE_PART_TYPE: %d\n", ast->parts[i]->type);
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static enum BYTECODE_GENERATOR_CODES variable_generate(register_generator_type_t rg, const struct VARIABLE_AST*ast, int dst, size_t*res)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t*index_regs;
+    size_t mark;
+
+    int idx = register_local_index(rg, ast->ident->ident);
+
+    if (idx == -1) {
+        return set_register_generator_error(rg, ast->line, ast->pos, BYTECODE_GENERATOR_NO_LOCAL_VARIABLE);
+    }
+
+    if (ast->parts_len == 0) {
+        if (dst == -1) {
+            (*res) = idx;
+        } else {
+            (*res) = dst;
+            if (dst != idx) {
+                emit_op2(rg, RC_OP_MOVE, dst, idx);
+            }
+        }
+        return BYTECODE_GENERATOR_OK;
+    }
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    SAFE_MALLOC(index_regs, ast->parts_len);
+    r = heap_parts_generate(rg, ast, index_regs);
+    if (r == BYTECODE_GENERATOR_OK) {
+        emit_op2(rg, RC_OP_GET_HEAP, *res, idx);
+        emit_heap_parts(rg, ast, index_regs);
+    }
+    SAFE_FREE(index_regs);
+
+    rg->regs_top = mark;
+
+    return r;
+}
+
+static enum BYTECODE_GENERATOR_CODES has_property_expr_generate(register_generator_type_t rg, const struct HAS_PROPERTY_EXPR_AST*ast,
+                                                                int dst, size_t*res)
+{
+    struct CONSTANT cnst = create_constant_from_fieldref(ast->ident->ident);
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t a, mark;
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    r = variable_generate(rg, ast->obj, -1, &a);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    emit_op3(rg, RC_OP_HAS_PROPERTY, *res, a, constant_pool_push_back(rg->bc, cnst));
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES len_expr_generate(register_generator_type_t rg, const struct LEN_EXPR_AST*ast, int dst, size_t*res)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t a, mark;
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    r = variable_generate(rg, ast->arr, -1, &a);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    emit_op2(rg, RC_OP_LEN, *res, a);
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES function_call_expr_generate(register_generator_type_t rg, const struct FUNCTION_CALL_AST*ast,
+                                                                 int dst, size_t*res)
+{
+    size_t args_num = (ast->args_list != NULL) ? ast->args_list->assignment_exprs_len : 0;
+    size_t i, first, mark;
+
+    struct CONSTANT cnst;
+
+    const struct FUNCTION_DECL_AST*f = register_function_decl(rg, ast->function_name->ident);
+
+    if (f == NULL) {
+        return set_register_generator_error(rg, ast->line, ast->pos, BYTECODE_GENERATOR_NO_FUNCTION);
+    }
+
+    if (function_decl_args_num(f) != args_num) {
+        return set_register_generator_error(rg, ast->line, ast->pos, BYTECODE_GENERATOR_INVALID_ARGS_NUM);
+    }
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    /* arguments are put into the top registers, which become the first registers of callee. */
+    first = rg->regs_top;
+    for (i = 0; i < args_num; i++) {
+        alloc_reg(rg);
+    }
+    for (i = 0; i < args_num; i++) {
+        size_t reg;
+        enum BYTECODE_GENERATOR_CODES r = assignment_expr_generate(rg, ast->args_list->assignment_exprs[i], first + i, &reg);
+        if (r != BYTECODE_GENERATOR_OK) {
+            return r;
+        }
+    }
+
+    cnst = create_constant_from_functionref(ast->function_name->ident);
+    emit_op3(rg, RC_OP_CALL, *res, constant_pool_push_back(rg->bc, cnst), first);
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES primary_expr_generate(register_generator_type_t rg, const struct PRIMARY_EXPR_AST*ast, int dst, size_t*res)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+
+    switch (ast->type) {
+    case AST_PRIMARY_EXPR_TYPE_HAS_PROPERTY:
+        r = has_property_expr_generate(rg, ast->has_property_expr, dst, res);
+        break;
+    case AST_PRIMARY_EXPR_TYPE_LEN:
+        r = len_expr_generate(rg, ast->len_expr, dst, res);
+        break;
+    case AST_PRIMARY_EXPR_TYPE_FUNCTION_CALL:
+        r = function_call_expr_generate(rg, ast->function_call, dst, res);
+        break;
+    case AST_PRIMARY_EXPR_TYPE_VARIABLE:
+        r = variable_generate(rg, ast->var_name, dst, res);
+        break;
+    case AST_PRIMARY_EXPR_TYPE_NUMBER:
+        r = number_generate(rg, ast->number, dst, res);
+        break;
+    case AST_PRIMARY_EXPR_TYPE_LOGICAL_OR_EXPR:
+        r = logical_or_expr_generate(rg, ast->logical_or_expr, dst, res);
+        break;
+    default:
+        fprintf(stderr, "Invalid PRIMARY_EXPR_AST type: %d\n", ast->type);
+        exit(EXIT_FAILURE);
+        break;
+    }
+
+    return r;
+}
+
+static enum BYTECODE_GENERATOR_CODES left_unary_expr_generate(register_generator_type_t rg, const struct LEFT_UNARY_EXPR_AST*ast,
+                                                              int dst, size_t*res)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t a, mark;
+
+    if (ast->op != AST_LEFT_UNARY_OP_MINUS) {
+        return primary_expr_generate(rg, ast->expr, dst, res);
+    }
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    r = primary_expr_generate(rg, ast->expr, -1, &a);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    emit_op2(rg, RC_OP_NEG, *res, a);
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES multiplicative_expr_generate(register_generator_type_t rg, const struct MULTIPLICATIVE_EXPR_AST*ast,
+                                                                  int dst, size_t*res)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t i, a, acc, mark;
+
+    if (ast->lues_len == 1) {
+        return left_unary_expr_generate(rg, ast->lues[0], dst, res);
+    }
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    r = left_unary_expr_generate(rg, ast->lues[0], -1, &a);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    acc = chain_acc_reg(rg, dst, *res, ast->lues_len);
+
+    for (i = 1; i < ast->lues_len; i++) {
+        size_t b, operand_mark = rg->regs_top;
+        enum RC_OP_CODES op;
+
+        r = left_unary_expr_generate(rg, ast->lues[i], -1, &b);
+        if (r != BYTECODE_GENERATOR_OK) {
+            return r;
+        }
+        switch (ast->ops[i - 1]) {
+        case AST_MULTIPLICATIVE_OP_MUL:
+            op = RC_OP_MUL;
+            break;
+        case AST_MULTIPLICATIVE_OP_DIV:
+            op = RC_OP_DIV;
+            break;
+        case AST_MULTIPLICATIVE_OP_MOD:
+            op = RC_OP_MOD;
+            break;
+        default:
+            fprintf(stderr, "Invalid AST_MULTIPLICATIVE_OP type: %d\n", ast->ops[i - 1]);
+            exit(EXIT_FAILURE);
+            break;
+        }
+        emit_op3(rg, op, (i == ast->lues_len - 1) ? *res : acc, a, b);
+
+        rg->regs_top = operand_mark;
+        a = acc;
+    }
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES additive_expr_generate(register_generator_type_t rg, const struct ADDITIVE_EXPR_AST*ast,
+                                                            int dst, size_t*res)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t i, a, acc, mark;
+
+    if (ast->muls_len == 1) {
+        return multiplicative_expr_generate(rg, ast->muls[0], dst, res);
+    }
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    r = multiplicative_expr_generate(rg, ast->muls[0], -1, &a);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    acc = chain_acc_reg(rg, dst, *res, ast->muls_len);
+
+    for (i = 1; i < ast->muls_len; i++) {
+        size_t b, operand_mark = rg->regs_top;
+        enum RC_OP_CODES op;
+
+        r = multiplicative_expr_generate(rg, ast->muls[i], -1, &b);
+        if (r != BYTECODE_GENERATOR_OK) {
+            return r;
+        }
+        if (ast->ops[i - 1] == AST_ADDITIVE_OP_PLUS) {
+            op = RC_OP_ADD;
+        } else if (ast->ops[i - 1] == AST_ADDITIVE_OP_MINUS) {
+            op = RC_OP_SUB;
+        } else {
+            fprintf(stderr, "Invalid AST_ADDITIVE_OP type: %d\n", ast->ops[i - 1]);
+            exit(EXIT_FAILURE);
+        }
+        emit_op3(rg, op, (i == ast->muls_len - 1) ? *res : acc, a, b);
+
+        rg->regs_top = operand_mark;
+        a = acc;
+    }
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES relational_expr_generate(register_generator_type_t rg, const struct RELATIONAL_EXPR_AST*ast,
+                                                              int dst, size_t*res)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    enum RC_OP_CODES op;
+    size_t a, b, mark;
+
+    if (ast->right == NULL) {
+        return additive_expr_generate(rg, ast->left, dst, res);
+    }
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    r = additive_expr_generate(rg, ast->left, -1, &a);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    r = additive_expr_generate(rg, ast->right, -1, &b);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    switch (ast->rel_op) {
+    case AST_REL_OP_LT:
+        op = RC_OP_LT;
+        break;
+    case AST_REL_OP_GT:
+        op = RC_OP_GT;
+        break;
+    case AST_REL_OP_LE:
+        op = RC_OP_LE;
+        break;
+    case AST_REL_OP_GE:
+        op = RC_OP_GE;
+        break;
+    default:
+        fprintf(stderr, "Invalid AST_REL_OP type: %d\n", ast->rel_op);
+        exit(EXIT_FAILURE);
+        break;
+    }
+    emit_op3(rg, op, *res, a, b);
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES eq_expr_generate(register_generator_type_t rg, const struct EQ_EXPR_AST*ast, int dst, size_t*res)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    enum RC_OP_CODES op;
+    size_t a, b, mark;
+
+    if (ast->right == NULL) {
+        return relational_expr_generate(rg, ast->left, dst, res);
+    }
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    r = relational_expr_generate(rg, ast->left, -1, &a);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    r = relational_expr_generate(rg, ast->right, -1, &b);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    if (ast->eq_op == AST_EQ_OP_EQEQ) {
+        op = RC_OP_EQ;
+    } else if (ast->eq_op == AST_EQ_OP_NEQ) {
+        op = RC_OP_NEQ;
+    } else {
+        fprintf(stderr, "Invalid AST_EQ_OP type: %d\n", ast->eq_op);
+        exit(EXIT_FAILURE);
+    }
+    emit_op3(rg, op, *res, a, b);
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES logical_and_expr_generate(register_generator_type_t rg, const struct LOGICAL_AND_EXPR_AST*ast,
+                                                               int dst, size_t*res)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t i, a, acc, mark;
+
+    if (ast->eq_exprs_len == 1) {
+        return eq_expr_generate(rg, ast->eq_exprs[0], dst, res);
+    }
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    r = eq_expr_generate(rg, ast->eq_exprs[0], -1, &a);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    acc = chain_acc_reg(rg, dst, *res, ast->eq_exprs_len);
+
+    for (i = 1; i < ast->eq_exprs_len; i++) {
+        size_t b, operand_mark = rg->regs_top;
+
+        r = eq_expr_generate(rg, ast->eq_exprs[i], -1, &b);
+        if (r != BYTECODE_GENERATOR_OK) {
+            return r;
+        }
+        emit_op3(rg, RC_OP_AND, (i == ast->eq_exprs_len - 1) ? *res : acc, a, b);
+
+        rg->regs_top = operand_mark;
+        a = acc;
+    }
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES logical_or_expr_generate(register_generator_type_t rg, const struct LOGICAL_OR_EXPR_AST*ast,
+                                                              int dst, size_t*res)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t i, a, acc, mark;
+
+    if (ast->and_exprs_len == 1) {
+        return logical_and_expr_generate(rg, ast->and_exprs[0], dst, res);
+    }
+
+    (*res) = result_reg(rg, dst);
+    mark = rg->regs_top;
+
+    r = logical_and_expr_generate(rg, ast->and_exprs[0], -1, &a);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    acc = chain_acc_reg(rg, dst, *res, ast->and_exprs_len);
+
+    for (i = 1; i < ast->and_exprs_len; i++) {
+        size_t b, operand_mark = rg->regs_top;
+
+        r = logical_and_expr_generate(rg, ast->and_exprs[i], -1, &b);
+        if (r != BYTECODE_GENERATOR_OK) {
+            return r;
+        }
+        emit_op3(rg, RC_OP_OR, (i == ast->and_exprs_len - 1) ? *res : acc, a, b);
+
+        rg->regs_top = operand_mark;
+        a = acc;
+    }
+
+    rg->regs_top = mark;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES assignment_expr_generate(register_generator_type_t rg, const struct ASSIGNMENT_EXPR_AST*ast,
+                                                              int dst, size_t*res)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+
+    switch (ast->type) {
+    case AST_ASSIGNMENT_EXPR_TYPE_OBJECT_LITERAL:
+        r = object_literal_generate(rg, ast->object_literal, dst, res);
+        break;
+    case AST_ASSIGNMENT_EXPR_TYPE_ARRAY_LITERAL:
+        r = array_literal_generate(rg, ast->array_literal, dst, res);
+        break;
+    case AST_ASSIGNMENT_EXPR_TYPE_LOGICAL_OR_EXPR:
+        r = logical_or_expr_generate(rg, ast->logical_or_expr, dst, res);
+        break;
+    default:
+        fprintf(stderr, "Invalid ASSIGNMENT_EXPR_AST type: %d\n", ast->type);
+        exit(EXIT_FAILURE);
+        break;
+    }
+
+    return r;
+}
+
+/* statements. */
+
+static enum BYTECODE_GENERATOR_CODES body_generate(register_generator_type_t rg, const struct BODY_AST*ast, struct REGISTER_LOOP*loop);
+
+static enum BYTECODE_GENERATOR_CODES decl_stmt_generate(register_generator_type_t rg, const struct DECL_STMT_AST*ast)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t res;
+    int idx;
+
+    /* new local takes the first free register, but isn't visible in its own initializer. */
+    r = assignment_expr_generate(rg, ast->assignment, alloc_reg(rg), &res);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+
+    idx = register_local_index(rg, ast->new_var_name->ident);
+    if ((idx != -1) && (rg->locals[idx].depth == rg->scope_depth)) {
+        return set_register_generator_error(rg, ast->line, ast->pos, BYTECODE_GENERATOR_ALREADY_HAVE_LOCAL_VARIABLE);
+    }
+
+    push_register_local(rg, ast->new_var_name->ident, rg->scope_depth);
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES assign_stmt_generate(register_generator_type_t rg, const struct ASSIGN_STMT_AST*ast)
+{
+    const struct VARIABLE_AST*var = ast->var_name;
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t*index_regs;
+    size_t src;
+
+    int idx = register_local_index(rg, var->ident->ident);
+
+    if (idx == -1) {
+        /* value is generated first, as in stack bytecode, so its errors are reported first. */
+        r = assignment_expr_generate(rg, ast->assignment, -1, &src);
+        if (r != BYTECODE_GENERATOR_OK) {
+            return r;
+        }
+        return set_register_generator_error(rg, var->line, var->pos, BYTECODE_GENERATOR_NO_LOCAL_VARIABLE);
+    }
+
+    /* value is computed right into local. */
+    if (var->parts_len == 0) {
+        r = assignment_expr_generate(rg, ast->assignment, idx, &src);
+        rg->regs_top = rg->locals_len;
+        return r;
+    }
+
+    r = assignment_expr_generate(rg, ast->assignment, -1, &src);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+
+    SAFE_MALLOC(index_regs, var->parts_len);
+    r = heap_parts_generate(rg, var, index_regs);
+    if (r == BYTECODE_GENERATOR_OK) {
+        emit_op2(rg, RC_OP_SET_HEAP, idx, src);
+        emit_heap_parts(rg, var, index_regs);
+    }
+    SAFE_FREE(index_regs);
+
+    rg->regs_top = rg->locals_len;
+
+    return r;
+}
+
+static enum BYTECODE_GENERATOR_CODES function_call_stmt_generate(register_generator_type_t rg, const struct FUNCTION_CALL_STMT_AST*ast)
+{
+    size_t res;
+
+    /* result is not used. */
+    enum BYTECODE_GENERATOR_CODES r = function_call_expr_generate(rg, ast->function_call, -1, &res);
+    rg->regs_top = rg->locals_len;
+
+    return r;
+}
+
+static enum BYTECODE_GENERATOR_CODES if_stmt_generate(register_generator_type_t rg, const struct IF_STMT_AST*ast, struct REGISTER_LOOP*loop)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t cond;
+    int if_idx, else_idx;
+
+    r = logical_or_expr_generate(rg, ast->condition, -1, &cond);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+    if_idx = emit_jump_if_false(rg, cond);
+    rg->regs_top = rg->locals_len;
+
+    r = body_generate(rg, ast->if_body, loop);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+
+    if (ast->else_body == NULL) {
+        patch_jump(rg, if_idx);
+        return BYTECODE_GENERATOR_OK;
+    }
+
+    else_idx = emit_jump(rg);
+    patch_jump(rg, if_idx);
+
+    r = body_generate(rg, ast->else_body, loop);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+
+    patch_jump(rg, else_idx);
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES while_stmt_generate(register_generator_type_t rg, const struct WHILE_STMT_AST*ast)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    struct REGISTER_LOOP loop;
+    size_t cond, i;
+
+    memset(&loop, 0, sizeof(loop));
+    loop.start = rg->bc->op_codes_len;
+
+    r = logical_or_expr_generate(rg, ast->condition, -1, &cond);
+    if (r == BYTECODE_GENERATOR_OK) {
+        PUSH_BACK(loop.exits, emit_jump_if_false(rg, cond));
+        rg->regs_top = rg->locals_len;
+
+        r = body_generate(rg, ast->body, &loop);
+    }
+
+    if (r == BYTECODE_GENERATOR_OK) {
+        emit_loop(rg, loop.start);
+        for (i = 0; i < loop.exits_len; i++) {
+            patch_jump(rg, loop.exits[i]);
+        }
+    }
+
+    SAFE_FREE(loop.exits);
+
+    return r;
+}
+
+static enum BYTECODE_GENERATOR_CODES return_stmt_generate(register_generator_type_t rg, const struct RETURN_STMT_AST*ast)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    size_t res;
+
+    if (ast->result != NULL) {
+        r = assignment_expr_generate(rg, ast->result, -1, &res);
+        if (r != BYTECODE_GENERATOR_OK) {
+            return r;
+        }
+    } else {
+        res = alloc_reg(rg);
+        emit_op2(rg, RC_OP_CONSTANT, res, constant_pool_push_back(rg->bc, create_constant_from_int(0)));
+    }
+
+    bytecode_emit_byte(rg->bc, RC_OP_RETURN);
+    bytecode_emit_uleb128(rg->bc, res);
+
+    rg->regs_top = rg->locals_len;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES stmt_generate(register_generator_type_t rg, const struct STMT_AST*ast, struct REGISTER_LOOP*loop)
+{
+    enum BYTECODE_GENERATOR_CODES r = BYTECODE_GENERATOR_OK;
+
+    switch (ast->type) {
+    case AST_STMT_TYPE_DECL:
+        r = decl_stmt_generate(rg, ast->decl_stmt);
+        break;
+    case AST_STMT_TYPE_ASSIGN:
+        r = assign_stmt_generate(rg, ast->assign_stmt);
+        break;
+    case AST_STMT_TYPE_FUNCTION_CALL:
+        r = function_call_stmt_generate(rg, ast->function_call_stmt);
+        break;
+    case AST_STMT_TYPE_IF:
+        r = if_stmt_generate(rg, ast->if_stmt, loop);
+        break;
+    case AST_STMT_TYPE_WHILE:
+        r = while_stmt_generate(rg, ast->while_stmt);
+        break;
+    case AST_STMT_TYPE_BREAK:
+        if (loop == NULL) {
+            return set_register_generator_error(rg, ast->break_stmt->line, ast->break_stmt->pos, BYTECODE_GENERATOR_INVALID_BREAK);
+        }
+        PUSH_BACK(loop->exits, emit_jump(rg));
+        break;
+    case AST_STMT_TYPE_CONTINUE:
+        if (loop == NULL) {
+            return set_register_generator_error(rg, ast->continue_stmt->line, ast->continue_stmt->pos, BYTECODE_GENERATOR_INVALID_CONTINUE);
+        }
+        emit_loop(rg, loop->start);
+        break;
+    case AST_STMT_TYPE_APPEND:
+    case AST_STMT_TYPE_DELETE:
+        /* not generated yet, as in stack bytecode. */
+        break;
+    case AST_STMT_TYPE_RETURN:
+        r = return_stmt_generate(rg, ast->return_stmt);
+        break;
+    default:
+        fprintf(stderr, "Invalid STMT_AST type: %d\n", ast->type);
+        exit(EXIT_FAILURE);
+        break;
+    }
+
+    return r;
+}
+
+/* locals of body are dropped at its end just by reusing their registers. */
+static enum BYTECODE_GENERATOR_CODES body_generate(register_generator_type_t rg, const struct BODY_AST*ast, struct REGISTER_LOOP*loop)
+{
+    size_t i;
+
+    rg->scope_depth++;
+
+    for (i = 0; i < ast->stmts_len; i++) {
+        enum BYTECODE_GENERATOR_CODES r = stmt_generate(rg, ast->stmts[i], loop);
+        if (r != BYTECODE_GENERATOR_OK) {
+            return r;
+        }
+    }
+
+    rg->scope_depth--;
+
+    while ((rg->locals_len > 0) && (rg->locals[rg->locals_len - 1].depth > rg->scope_depth)) {
+        rg->locals_len--;
+    }
+    rg->regs_top = rg->locals_len;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+static enum BYTECODE_GENERATOR_CODES function_decl_generate(register_generator_type_t rg, const struct FUNCTION_DECL_AST*ast)
+{
+    enum BYTECODE_GENERATOR_CODES r;
+    struct BYTECODE_FUNCTION bf;
+    size_t i, res;
+
+    if (register_function_decl(rg, ast->function_name->ident) != ast) {
+        return set_register_generator_error(rg, ast->line, ast->pos, BYTECODE_GENERATOR_ALREADY_HAVE_FUNCTION);
+    }
+
+    bf = create_bytecode_function(ast, rg->bc->op_codes_len);
+    PUSH_BACK(rg->bc->functions, bf);
+
+    /* arguments are locals of function's body. */
+    rg->locals_len = 0;
+    rg->scope_depth = 0;
+    for (i = 0; i < bf.args_num; i++) {
+        const struct IDENT_AST*param = ast->formal_parameters_list->params[i];
+        if (register_local_index(rg, param->ident) != -1) {
+            return set_register_generator_error(rg, param->line, param->pos, BYTECODE_GENERATOR_ALREADY_HAVE_LOCAL_VARIABLE);
+        }
+        push_register_local(rg, param->ident, 1);
+    }
+    rg->regs_top = rg->regs_num = bf.args_num;
+
+    r = body_generate(rg, ast->body, NULL);
+    if (r != BYTECODE_GENERATOR_OK) {
+        return r;
+    }
+
+    /* function without return returns 0. */
+    res = alloc_reg(rg);
+    emit_op2(rg, RC_OP_CONSTANT, res, constant_pool_push_back(rg->bc, create_constant_from_int(0)));
+    bytecode_emit_byte(rg->bc, RC_OP_RETURN);
+    bytecode_emit_uleb128(rg->bc, res);
+
+    rg->bc->functions[rg->bc->functions_len - 1].regs_num = rg->regs_num;
+
+    return BYTECODE_GENERATOR_OK;
+}
+
+enum BYTECODE_GENERATOR_CODES register_generator_generate(register_generator_type_t rg, struct BYTECODE**bc)
+{
+    size_t i;
+
+    for (i = 0; i < rg->ast->functions_len; i++) {
+        enum BYTECODE_GENERATOR_CODES r = function_decl_generate(rg, rg->ast->functions[i]);
+        if (r != BYTECODE_GENERATOR_OK) {
+            bytecode_free(rg->bc);
+            return r;
+        }
+    }
+
+    (*bc) = rg->bc;
+    return BYTECODE_GENERATOR_OK;
+}
+
+struct BYTECODE_ERROR register_generator_get_error(const register_generator_type_t rg)
+{
+    return rg->err;
+}
+
+void register_generator_free(register_generator_type_t rg)
+{
+    SAFE_FREE(rg->locals);
+    SAFE_FREE(rg);
+}
+
+static const char*op_names[RC_OPS_NUM] = {
+    "MOVE",
+    "CONSTANT",
+    "CREATE_OBJ",
+    "CREATE_ARR",
+    "GET_HEAP",
+    "SET_HEAP",
+    "OR",
+    "AND",
+    "EQ",
+    "NEQ",
+    "LT",
+    "GT",
+    "LE",
+    "GE",
+    "ADD",
+    "SUB",
+    "MUL",
+    "DIV",
+    "MOD",
+    "NEG",
+    "HAS_PROPERTY",
+    "LEN",
+    "JUMP_IF_FALSE",
+    "JUMP",
+    "CALL",
+    "RETURN",
+};
+
+const char*register_op_name(unsigned op)
+{
+    return (op < RC_OPS_NUM) ? op_names[op] : NULL;
+}
+
+void dump_register_op_codes_to_xml_file(FILE*f, const bytecode_type_t bc)
+{
+    uint8_t*ip;
+
+    fprintf(f, "\t<op_codes len=\"%zu\">\n", bc->op_codes_len);
+
+    ip = bc->op_codes;
+    while (ip < bc->op_codes + bc->op_codes_len) {
+        uint8_t op = *(ip++);
+        size_t j, n;
+
+        if (op >= RC_OPS_NUM) {
+            fprintf(stderr, "Invalid RC_OP_CODES: %d\n", op);
+            exit(EXIT_FAILURE);
+        }
+        fprintf(f, "\t\t<op>%s", op_names[op]);
+
+        switch (op) {
+        case RC_OP_CREATE_OBJ:
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            n = bytecode_read_uleb128(&ip);
+            fprintf(f, " %zu", n);
+            for (j = 0; j < n; j++) {
+                fprintf(f, " field(%zu)", bytecode_read_uleb128(&ip));
+            }
+            break;
+
+        case RC_OP_GET_HEAP:
+        case RC_OP_SET_HEAP:
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            n = bytecode_read_uleb128(&ip);
+            for (j = 0; j < n; j++) {
+                if (*(ip++) == BC_OBJECT_FIELD) {
+                    size_t key = bytecode_read_uleb128(&ip);
+                    fprintf(f, " field(%zu; ic %zu)", key, bytecode_read_uleb128(&ip));
+                } else {
+                    fprintf(f, " index(r%zu)", bytecode_read_uleb128(&ip));
+                }
+            }
+            break;
+
+        case RC_OP_MOVE:
+        case RC_OP_NEG:
+        case RC_OP_LEN:
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            break;
+
+        case RC_OP_CONSTANT:
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " %zu", bytecode_read_uleb128(&ip));
+            break;
+
+        case RC_OP_CREATE_ARR:
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " %zu", bytecode_read_uleb128(&ip));
+            break;
+
+        case RC_OP_HAS_PROPERTY:
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " %zu", bytecode_read_uleb128(&ip));
+            break;
+
+        case RC_OP_JUMP_IF_FALSE:
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " %d", (int) bytecode_read_i32(&ip));
+            break;
+        case RC_OP_JUMP:
+            fprintf(f, " %d", (int) bytecode_read_i32(&ip));
+            break;
+
+        case RC_OP_CALL:
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " %zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            break;
+        case RC_OP_RETURN:
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            break;
+
+        default:
+            /* three registers. */
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            fprintf(f, " r%zu", bytecode_read_uleb128(&ip));
+            break;
+        }
+
+        fprintf(f, "</op>\n");
+    }
+    fprintf(f, "\t</op_codes>\n");
+}
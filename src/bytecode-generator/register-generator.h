@@ -0,0 +1,81 @@
+#ifndef REGISTER_GENERATOR_H_INCLUDED
+#define REGISTER_GENERATOR_H_INCLUDED
+
+#include "bytecode-generator.h"
+
+/*
+  Register bytecode is generated from the same AST as stack bytecode
+  and is kept in struct BYTECODE of kind BYTECODE_REGISTER.
+  Registers are slots of function's frame: arguments and locals come
+  first, temporaries follow them; size of frame is regs_num of function.
+  Every operand is unsigned LEB128 (register, constant, counter, fieldref
+  or inline cache), except of jump offset, which is signed 32-bit number,
+  counted from the end of instruction and always the last operand.
+  Parts of GET_HEAP/SET_HEAP are BC_OBJECT_FIELD with fieldref and inline
+  cache or BC_ARRAY_INDEX with register of index.
+*/
+enum RC_OP_CODES
+{
+    RC_OP_MOVE,     /* r_dst, r_src. */
+    RC_OP_CONSTANT, /* r_dst, k.     */
+
+    RC_OP_CREATE_OBJ, /* r_dst, r_first, n, n fieldrefs: property values are in n registers from r_first. */
+    RC_OP_CREATE_ARR, /* r_dst, r_first, n: values are in n registers from r_first.                      */
+
+    RC_OP_GET_HEAP, /* r_dst, r_base, n, n parts. */
+    RC_OP_SET_HEAP, /* r_base, r_src, n, n parts. */
+
+    RC_OP_OR,  /* r_dst, r_a, r_b: r_dst = r_a || r_b */
+    RC_OP_AND, /* r_dst, r_a, r_b: r_dst = r_a && r_b */
+
+    RC_OP_EQ,  /* r_dst, r_a, r_b: r_dst = r_a == r_b */
+    RC_OP_NEQ, /* r_dst, r_a, r_b: r_dst = r_a != r_b */
+
+    RC_OP_LT, /* r_dst, r_a, r_b: r_dst = r_a <  r_b */
+    RC_OP_GT, /* r_dst, r_a, r_b: r_dst = r_a >  r_b */
+    RC_OP_LE, /* r_dst, r_a, r_b: r_dst = r_a <= r_b */
+    RC_OP_GE, /* r_dst, r_a, r_b: r_dst = r_a >= r_b */
+
+    RC_OP_ADD, /* r_dst, r_a, r_b: r_dst = r_a + r_b */
+    RC_OP_SUB, /* r_dst, r_a, r_b: r_dst = r_a - r_b */
+
+    RC_OP_MUL, /* r_dst, r_a, r_b: r_dst = r_a * r_b */
+    RC_OP_DIV, /* r_dst, r_a, r_b: r_dst = r_a / r_b */
+    RC_OP_MOD, /* r_dst, r_a, r_b: r_dst = r_a % r_b */
+
+    RC_OP_NEG, /* r_dst, r_a: r_dst = -r_a */
+
+    RC_OP_HAS_PROPERTY, /* r_dst, r_a, fieldref; (-1) - not obj. */
+    RC_OP_LEN,          /* r_dst, r_a; (-1) - not array.         */
+
+    RC_OP_JUMP_IF_FALSE, /* r_a, offset. */
+    RC_OP_JUMP,          /* offset.      */
+
+    RC_OP_CALL,   /* r_dst, function, r_first: arguments are in registers from r_first, where callee's frame starts. */
+    RC_OP_RETURN, /* r_a. */
+};
+
+#define RC_OPS_NUM (RC_OP_RETURN + 1)
+
+/* name of opcode as it is printed in dumps; NULL for unknown opcode. */
+const char*register_op_name(unsigned op);
+
+struct REGISTER_GENERATOR;
+
+typedef struct REGISTER_GENERATOR* register_generator_type_t;
+
+register_generator_type_t create_register_generator();
+
+void register_generator_conf(register_generator_type_t rg, struct UNIT_AST*ast);
+
+/* errors are the same, as errors of stack bytecode generator. */
+enum BYTECODE_GENERATOR_CODES register_generator_generate(register_generator_type_t rg, struct BYTECODE**bc);
+
+struct BYTECODE_ERROR register_generator_get_error(const register_generator_type_t rg);
+
+void register_generator_free(register_generator_type_t rg);
+
+/* op_codes part of dump_bytecode_to_xml_file for register bytecode. */
+void dump_register_op_codes_to_xml_file(FILE*f, const bytecode_type_t bc);
+
+#endif  /* REGISTER_GENERATOR_H_INCLUDED */
@@ -1,7 +1,9 @@
 #ifndef DATA_TYPES_H_INCLUDED
 #define DATA_TYPES_H_INCLUDED
 
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 enum VALUE_TYPE
 {
@@ -11,10 +13,92 @@ enum VALUE_TYPE
     VALUE_TYPE_ARR,
 };
 
+struct OBJECT;
+struct ARRAY;
+
+/*
+  VALUE is either tagged union (16 bytes) or,
+  when VALUE_NAN_BOXING is defined, one 64-bit word:
+  doubles are stored as is (every NaN is canonicalized), other types
+  are hidden in payload of negative quiet NaN, marked by tag in bits 48-49:
+    [11111111111111|tag(2)|payload(48)].
+  Heap pointers fit into 48 bits on x86-64 and AArch64, but integers
+  are truncated to 48 bits (sign-extended on read).
+  Fields must be accessed only by VALUE_GET_* macros and create_value_from_* functions.
+*/
+
+#ifdef VALUE_NAN_BOXING
+
+struct VALUE
+{
+    uint64_t bits;
+};
+
+/* tag - VALUE_NAN_BOXING_TAG_BASE == enum VALUE_TYPE for every boxed type. */
+#define VALUE_NAN_BOXING_TAG_BASE    0xFFFCULL
+#define VALUE_NAN_BOXING_TAG_INTEGER ((VALUE_NAN_BOXING_TAG_BASE + VALUE_TYPE_INTEGER) << 48)
+#define VALUE_NAN_BOXING_TAG_OBJ     ((VALUE_NAN_BOXING_TAG_BASE + VALUE_TYPE_OBJ) << 48)
+#define VALUE_NAN_BOXING_TAG_ARR     ((VALUE_NAN_BOXING_TAG_BASE + VALUE_TYPE_ARR) << 48)
+#define VALUE_NAN_BOXING_PAYLOAD     0x0000FFFFFFFFFFFFULL
+#define VALUE_NAN_BOXING_CANONIC_NAN 0x7FF8000000000000ULL
+
+static inline enum VALUE_TYPE value_get_type(struct VALUE val)
+{
+    uint64_t tag = val.bits >> 48;
+    return (tag >= VALUE_NAN_BOXING_TAG_BASE) ? (enum VALUE_TYPE) (tag - VALUE_NAN_BOXING_TAG_BASE) : VALUE_TYPE_DOUBLE;
+}
+
+static inline double value_get_double(struct VALUE val)
+{
+    double res;
+    memcpy(&res, &(val.bits), sizeof(res));
+    return res;
+}
+
+#define VALUE_GET_TYPE(val)   value_get_type(val)
+/* both tags are integer, when all 16 high bits of both values match integer tag. */
+#define VALUE_BOTH_INT(a, b)  (((((a).bits ^ VALUE_NAN_BOXING_TAG_INTEGER) | ((b).bits ^ VALUE_NAN_BOXING_TAG_INTEGER)) >> 48) == 0)
+#define VALUE_GET_INT(val)    (((long long) ((val).bits << 16)) >> 16)
+#define VALUE_GET_DOUBLE(val) value_get_double(val)
+#define VALUE_GET_OBJ(val)    ((struct OBJECT*) (uintptr_t) ((val).bits & VALUE_NAN_BOXING_PAYLOAD))
+#define VALUE_GET_ARR(val)    ((struct ARRAY*) (uintptr_t) ((val).bits & VALUE_NAN_BOXING_PAYLOAD))
+
+static inline struct VALUE create_value_from_int(long long int_val)
+{
+    struct VALUE val;
+    val.bits = VALUE_NAN_BOXING_TAG_INTEGER | (((uint64_t) int_val) & VALUE_NAN_BOXING_PAYLOAD);
+    return val;
+}
+
+static inline struct VALUE create_value_from_double(double double_val)
+{
+    struct VALUE val;
+    if (double_val != double_val) {
+        val.bits = VALUE_NAN_BOXING_CANONIC_NAN;
+    } else {
+        memcpy(&(val.bits), &double_val, sizeof(val.bits));
+    }
+    return val;
+}
+
+static inline struct VALUE create_value_from_obj(struct OBJECT*obj_val)
+{
+    struct VALUE val;
+    val.bits = VALUE_NAN_BOXING_TAG_OBJ | (uint64_t) (uintptr_t) obj_val;
+    return val;
+}
+
+static inline struct VALUE create_value_from_arr(struct ARRAY*arr_val)
+{
+    struct VALUE val;
+    val.bits = VALUE_NAN_BOXING_TAG_ARR | (uint64_t) (uintptr_t) arr_val;
+    return val;
+}
+
+#else
+
 struct VALUE
 {
-    char mark;
-    
     union
     {
         long long int_val;
@@ -26,24 +110,92 @@ struct VALUE
     enum VALUE_TYPE type;
 };
 
-struct PROPERTY
+#define VALUE_GET_TYPE(val)   ((val).type)
+/* VALUE_TYPE_INTEGER is 0. */
+#define VALUE_BOTH_INT(a, b)  ((((a).type) | ((b).type)) == VALUE_TYPE_INTEGER)
+#define VALUE_GET_INT(val)    ((val).int_val)
+#define VALUE_GET_DOUBLE(val) ((val).double_val)
+#define VALUE_GET_OBJ(val)    ((val).obj_val)
+#define VALUE_GET_ARR(val)    ((val).arr_val)
+
+static inline struct VALUE create_value_from_int(long long int_val)
+{
+    struct VALUE val;
+    val.type = VALUE_TYPE_INTEGER;
+    val.int_val = int_val;
+    return val;
+}
+
+static inline struct VALUE create_value_from_double(double double_val)
+{
+    struct VALUE val;
+    val.type = VALUE_TYPE_DOUBLE;
+    val.double_val = double_val;
+    return val;
+}
+
+static inline struct VALUE create_value_from_obj(struct OBJECT*obj_val)
+{
+    struct VALUE val;
+    val.obj_val = obj_val;
+    val.type = VALUE_TYPE_OBJ;
+    return val;
+}
+
+static inline struct VALUE create_value_from_arr(struct ARRAY*arr_val)
 {
-    size_t key;
     struct VALUE val;
+    val.arr_val = arr_val;
+    val.type = VALUE_TYPE_ARR;
+    return val;
+}
+
+#endif  /* VALUE_NAN_BOXING */
+
+/*
+  Shape describes layout of object: key of every slot.
+  Shapes form tree, where child differs from parent by one property
+  added to the end, so objects, which got the same keys in the same order,
+  share one shape. Shape keeps only its own key, which is in slot len - 1,
+  keys of other slots are found in parents. Shapes are not allocated by GC.
+*/
+
+struct SHAPE_TRANSITION
+{
+    size_t key;
+    struct SHAPE*shape;
+};
+
+struct SHAPE
+{
+    size_t key; /* key of the last slot; root has no slots. */
+    size_t len;
+
+    struct SHAPE*parent;
+
+    struct SHAPE_TRANSITION*transitions;
+    size_t transitions_len;
+    size_t transitions_cap;
 };
 
+/*
+  Values of object's properties and values of array are kept
+  in separate backing stores, so they can grow in place
+  without moving object or array itself.
+*/
+
 struct OBJECT
 {
-    size_t properties_len;
+    struct SHAPE*shape;
     size_t properties_cap;
-    struct PROPERTY properties[];
+    struct VALUE*properties;
 };
 
 struct ARRAY
 {
     size_t len;
     size_t cap;
-    struct VALUE values[];
+    struct VALUE*values;
 };
 
 #endif  /* DATA_TYPES_H_INCLUDED */
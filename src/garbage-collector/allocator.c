@@ -1,49 +1,75 @@
 #include "allocator.h"
+#include "pages.h"
 
 #include "utils.h"
 
-void allocator_malloc_pool(allocator_type_t a, size_t sizemem)
+void allocator_malloc_pool(allocator_type_t a, size_t sizemem, int huge_pages)
 {
-    if (sizemem < MIN_BLOCK_LEN) {
+    if (sizemem < MIN_POOL_LEN) {
         fprintf(stderr, "not enough memory for allocator:\n");
         fprintf(stderr, "got:         %ld bytes\n", sizemem);
-        fprintf(stderr, "minimum:     %ld bytes;\n", MIN_BLOCK_LEN);
-        fprintf(stderr, "recommended: %ld bytes;\n", MIN_BLOCK_LEN * 1024 * 1024);
+        fprintf(stderr, "minimum:     %ld bytes;\n", MIN_POOL_LEN);
+        fprintf(stderr, "recommended: %ld bytes;\n", MIN_POOL_LEN * 1024 * 1024);
         
         exit(EXIT_FAILURE);
     }
     
     a->sizemem = sizemem;
-    SAFE_MALLOC(a->mem, a->sizemem);
+    a->mem = pages_map(a->sizemem, huge_pages);
 
     allocator_clean_pool(a);
 }
 
 void allocator_free_pool(allocator_type_t a)
 {
-    SAFE_FREE(a->mem);
+    pages_unmap(a->mem, a->sizemem);
+    a->mem = NULL;
 }
 
-void allocator_clean_pool(allocator_type_t a)
+void allocator_release_pool(allocator_type_t a)
+{
+    pages_release(a->mem, a->sizemem);
+}
+
+/* index of the most significant bit; x must not be 0. */
+static inline unsigned allocator_msb(unsigned long long x)
 {
-    size_t len = a->sizemem - BLOCK_OVERHEAD;
-
-    BLOCK_L_FLAG(a->mem) = FREE_BLOCK;
-    BLOCK_L_DATA_LEN(a->mem) = len;
-    BLOCK_LIST_PREV(a->mem) = NULL;
-    BLOCK_LIST_NEXT(a->mem) = NULL;
-    BLOCK_R_DATA_LEN(a->mem) = len;
-    BLOCK_R_FLAG(a->mem) = FREE_BLOCK;
-
-    a->free_list.first = a->mem;
-    a->free_list.last = a->mem;
-    a->free_list.count = 1;
-    a->free_list.sizemem = a->sizemem - BLOCK_OVERHEAD;
-
-    a->busy_list.first = NULL;
-    a->busy_list.last = NULL;
-    a->busy_list.count = 0;
-    a->busy_list.sizemem = 0;
+#if defined(__GNUC__)
+    return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(x);
+#else
+    unsigned r = 0;
+    while (x >>= 1) {
+        r++;
+    }
+    return r;
+#endif
+}
+
+/* index of the least significant bit; x must not be 0. */
+static inline unsigned allocator_lsb(unsigned long long x)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(x);
+#else
+    unsigned r = 0;
+    while ((x & 1) == 0) {
+        x >>= 1;
+        r++;
+    }
+    return r;
+#endif
+}
+
+static void allocator_mapping(size_t sizemem, unsigned*fl, unsigned*sl)
+{
+    if (sizemem < ((size_t) 1 << ALLOCATOR_FL_SHIFT)) {
+        *fl = 0;
+        *sl = sizemem >> (ALLOCATOR_FL_SHIFT - ALLOCATOR_SL_BITS);
+    } else {
+        unsigned msb = allocator_msb(sizemem);
+        *fl = msb - ALLOCATOR_FL_SHIFT + 1;
+        *sl = (sizemem >> (msb - ALLOCATOR_SL_BITS)) - ALLOCATOR_SL_COUNT;
+    }
 }
 
 static void allocator_list_remove_elem(struct ALLOCATOR_LIST*list, void*elem)
@@ -67,22 +93,7 @@ static void allocator_list_remove_elem(struct ALLOCATOR_LIST*list, void*elem)
     }
 
     list->count--;
-    list->sizemem -= BLOCK_L_DATA_LEN(elem);
-}
-
-static void*allocator_list_search_by_sizemem(struct ALLOCATOR_LIST*list, size_t sizemem)
-{
-    void*cur = list->first;
-
-    while (cur != NULL) {
-        if (BLOCK_L_DATA_LEN(cur) >= sizemem) {
-            return cur;
-        }
-
-        cur = BLOCK_LIST_NEXT(cur);
-    }
-
-    return NULL;
+    list->sizemem -= BLOCK_LEN(elem);
 }
 
 static void allocator_list_push_front(struct ALLOCATOR_LIST*list, void*elem)
@@ -101,210 +112,239 @@ static void allocator_list_push_front(struct ALLOCATOR_LIST*list, void*elem)
     }
 
     list->count++;
-    list->sizemem += BLOCK_L_DATA_LEN(elem);
+    list->sizemem += BLOCK_LEN(elem);
 }
 
-static void allocator_list_push_back(struct ALLOCATOR_LIST*list, void*elem)
+static void allocator_free_lists_insert_elem(allocator_type_t a, void*elem)
 {
-    BLOCK_LIST_NEXT(elem) = NULL;
-    BLOCK_LIST_PREV(elem) = list->last;
-    
-    if (list->last != NULL) {
-        BLOCK_LIST_NEXT(list->last) = elem;
+    unsigned fl, sl;
+
+    allocator_mapping(BLOCK_LEN(elem), &fl, &sl);
+    allocator_list_push_front(&(a->free_lists[fl][sl]), elem);
+
+    a->fl_bitmap |= 1ULL << fl;
+    a->sl_bitmap[fl] |= 1U << sl;
+    a->free_count++;
+}
+
+static void allocator_free_lists_remove_elem_at(allocator_type_t a, void*elem, unsigned fl, unsigned sl)
+{
+    allocator_list_remove_elem(&(a->free_lists[fl][sl]), elem);
+
+    if (a->free_lists[fl][sl].first == NULL) {
+        a->sl_bitmap[fl] &= ~(1U << sl);
+        if (a->sl_bitmap[fl] == 0) {
+            a->fl_bitmap &= ~(1ULL << fl);
+        }
     }
-    
-    list->last = elem;
-    
-    if (list->first == NULL) {
+    a->free_count--;
+}
+
+static void allocator_free_lists_remove_elem(allocator_type_t a, void*elem)
+{
+    unsigned fl, sl;
+
+    allocator_mapping(BLOCK_LEN(elem), &fl, &sl);
+    allocator_free_lists_remove_elem_at(a, elem, fl, sl);
+}
+
+/* puts elem to the place of old_elem (which had length old_len) in list. */
+static void allocator_list_replace_elem(struct ALLOCATOR_LIST*list, void*old_elem, size_t old_len, void*elem)
+{
+    void*list_prev = BLOCK_LIST_PREV(old_elem);
+    void*list_next = BLOCK_LIST_NEXT(old_elem);
+
+    BLOCK_LIST_PREV(elem) = list_prev;
+    BLOCK_LIST_NEXT(elem) = list_next;
+
+    if (list_prev != NULL) {
+        BLOCK_LIST_NEXT(list_prev) = elem;
+    } else {
         list->first = elem;
     }
+    if (list_next != NULL) {
+        BLOCK_LIST_PREV(list_next) = elem;
+    } else {
+        list->last = elem;
+    }
 
-    list->count++;
-    list->sizemem += BLOCK_L_DATA_LEN(elem);
+    list->sizemem -= old_len;
+    list->sizemem += BLOCK_LEN(elem);
 }
 
-static void allocator_list_insert_elem(struct ALLOCATOR_LIST*list, void*elem)
+/* makes block free with given length; block on the left must be busy. */
+static void allocator_set_free(void*block, size_t len)
 {
-    size_t len = BLOCK_L_DATA_LEN(elem);
-    void*list_next = allocator_list_search_by_sizemem(list, len);
+    BLOCK_HDR(block) = len | BLOCK_PREV_BUSY;
+    BLOCK_R_LEN(block) = len;
+    BLOCK_HDR(BLOCK_ARR_NEXT(block)) &= ~BLOCK_PREV_BUSY;
+}
 
-    if (list_next == NULL) {
-        allocator_list_push_back(list, elem);
+void allocator_clean_pool(allocator_type_t a)
+{
+    /* data of every block must be aligned, so first block starts right before alignment boundary. */
+    size_t len = (a->sizemem - BLOCK_ALIGN) & ~BLOCK_FLAGS;
+
+    memset(a->free_lists, 0, sizeof(a->free_lists));
+    memset(a->sl_bitmap, 0, sizeof(a->sl_bitmap));
+    a->fl_bitmap = 0;
+    a->free_count = 0;
+
+    a->busy_count = 0;
+    a->busy_sizemem = 0;
+
+    a->start = a->mem + BLOCK_ALIGN - BLOCK_HEADER_SIZE;
+    a->end = a->start + len;
+
+    BLOCK_HDR(a->end) = BLOCK_BUSY;
+    allocator_set_free(a->start, len);
+
+    allocator_free_lists_insert_elem(a, a->start);
+}
+
+/*
+  Size is rounded up to the next class, so any block of found class fits.
+  If there is no such class, only own class of size is scanned,
+  so block is found if and only if it exists. Class of found block is returned too.
+  Here sizemem is length of whole block.
+*/
+static void*allocator_free_lists_search(allocator_type_t a, size_t sizemem, unsigned*fl, unsigned*sl)
+{
+    unsigned long long fl_map;
+    unsigned sl_map;
+    size_t rounded = sizemem;
+    void*cur;
+
+    if (sizemem >= ((size_t) 1 << ALLOCATOR_FL_SHIFT)) {
+        rounded += ((size_t) 1 << (allocator_msb(sizemem) - ALLOCATOR_SL_BITS)) - 1;
     } else {
-        void*prev_elem;
-        
-        if (BLOCK_LIST_PREV(list_next) == NULL) {
-            allocator_list_push_front(list, elem);
-            return;
+        rounded += ((size_t) 1 << (ALLOCATOR_FL_SHIFT - ALLOCATOR_SL_BITS)) - 1;
+    }
+
+    if (rounded >= sizemem) {
+        allocator_mapping(rounded, fl, sl);
+
+        sl_map = a->sl_bitmap[*fl] & (~0U << *sl);
+        if (sl_map != 0) {
+            *sl = allocator_lsb(sl_map);
+            return a->free_lists[*fl][*sl].first;
         }
 
-        BLOCK_LIST_PREV(elem) = BLOCK_LIST_PREV(list_next);
-        prev_elem = BLOCK_LIST_PREV(list_next);
-        BLOCK_LIST_NEXT(prev_elem) = elem;
-        BLOCK_LIST_NEXT(elem) = list_next;
-        BLOCK_LIST_PREV(list_next) = elem;
+        fl_map = ((*fl) + 1 < ALLOCATOR_FL_COUNT) ? (a->fl_bitmap & (~0ULL << ((*fl) + 1))) : 0;
+        if (fl_map != 0) {
+            *fl = allocator_lsb(fl_map);
+            *sl = allocator_lsb(a->sl_bitmap[*fl]);
+            return a->free_lists[*fl][*sl].first;
+        }
+    }
 
-        list->count++;
-        list->sizemem += BLOCK_L_DATA_LEN(elem);
+    allocator_mapping(sizemem, fl, sl);
+    for (cur = a->free_lists[*fl][*sl].first; cur != NULL; cur = BLOCK_LIST_NEXT(cur)) {
+        if (BLOCK_LEN(cur) >= sizemem) {
+            return cur;
+        }
     }
+
+    return NULL;
+}
+
+int allocator_can_malloc_block(allocator_type_t a, size_t sizemem)
+{
+    unsigned fl, sl;
+    return allocator_free_lists_search(a, BLOCK_LEN_FOR(sizemem), &fl, &sl) != NULL;
 }
 
 void*allocator_malloc_block(allocator_type_t a, size_t sizemem)
 {
-    void*cur;
+    unsigned fl, sl, tmp_fl, tmp_sl;
+    size_t block_len = BLOCK_LEN_FOR(sizemem);
+    void*cur = allocator_free_lists_search(a, block_len, &fl, &sl);
+    void*tmp_block;
+    size_t cur_len, len;
 
-    if ((BLOCK_L_DATA_LEN(a->free_list.last) + BLOCK_OVERHEAD) < sizemem) {
+    if (cur == NULL) {
         return NULL;
     }
 
-    cur = allocator_list_search_by_sizemem(&(a->free_list), sizemem);
+    cur_len = BLOCK_LEN(cur);
 
-    /* remove block from list. */
-    allocator_list_remove_elem(&(a->free_list), cur);
-    
-    if (BLOCK_L_DATA_LEN(cur) < (sizemem + MIN_BLOCK_LEN)) {
+    if (cur_len < (block_len + MIN_BLOCK_LEN)) {
         /* don't need to divide block. */
-        BLOCK_L_FLAG(cur) = BUSY_BLOCK;
-        BLOCK_R_FLAG(cur) = BUSY_BLOCK;
-        allocator_list_push_back(&(a->busy_list), cur);
-        
+        allocator_free_lists_remove_elem_at(a, cur, fl, sl);
+        BLOCK_HDR(cur) |= BLOCK_BUSY;
+        BLOCK_HDR(BLOCK_ARR_NEXT(cur)) |= BLOCK_PREV_BUSY;
+
+        a->busy_count++;
+        a->busy_sizemem += cur_len;
+
         return BLOCK_DATA(cur);
     }
 
-    size_t len = BLOCK_L_DATA_LEN(cur) - sizemem - BLOCK_OVERHEAD;
-    void*tmp_block;
-    /* have to divide block. */
-    
-    /* split block into two smaller blocks (one of them will contain data). */
-    
-    /* put busy block to busy list. */
-    BLOCK_L_FLAG(cur) = BUSY_BLOCK;
-    BLOCK_L_DATA_LEN(cur) = sizemem;
-    BLOCK_LIST_PREV(cur) = NULL;
-    BLOCK_LIST_NEXT(cur) = NULL;
-    BLOCK_R_DATA_LEN(cur) = sizemem;
-    BLOCK_R_FLAG(cur) = BUSY_BLOCK;
-    allocator_list_push_back(&(a->busy_list), cur);
-    
-    /* put free block to free list. */
-    tmp_block = BLOCK_ARR_NEXT(cur);
-    BLOCK_L_FLAG(tmp_block) = FREE_BLOCK;
-    BLOCK_L_DATA_LEN(tmp_block) = len;
-    BLOCK_LIST_PREV(tmp_block) = NULL;
-    BLOCK_LIST_NEXT(tmp_block) = NULL;
-    BLOCK_R_DATA_LEN(tmp_block) = len;
-    BLOCK_R_FLAG(tmp_block) = FREE_BLOCK;
-    allocator_list_insert_elem(&(a->free_list), tmp_block);
-    
-    return BLOCK_DATA(cur);
-}
+    /* have to divide block into busy head and free tail. */
+    len = cur_len - block_len;
 
-void*allocator_realloc_block(allocator_type_t a, void*ptrmem, size_t sizemem)
-{
-    void*orig;
-    void*cur;
+    /* free tail of block; block on the right already knows, that its left neighbour is free. */
+    tmp_block = ((char*) cur) + block_len;
+    BLOCK_HDR(tmp_block) = len | BLOCK_PREV_BUSY;
+    BLOCK_R_LEN(tmp_block) = len;
 
-    if ((BLOCK_L_DATA_LEN(a->free_list.last) + BLOCK_OVERHEAD) < sizemem) {
-        return NULL;
+    /* tail usually stays in the same class, then it just takes place of block in list. */
+    allocator_mapping(len, &tmp_fl, &tmp_sl);
+    if ((tmp_fl == fl) && (tmp_sl == sl)) {
+        allocator_list_replace_elem(&(a->free_lists[fl][sl]), cur, cur_len, tmp_block);
+    } else {
+        allocator_free_lists_remove_elem_at(a, cur, fl, sl);
+        allocator_free_lists_insert_elem(a, tmp_block);
     }
 
-    orig = BLOCK_PTR_FROM_DATA(ptrmem);
+    /* free block always has busy block on its left. */
+    BLOCK_HDR(cur) = block_len | BLOCK_BUSY | BLOCK_PREV_BUSY;
 
-    cur = allocator_list_search_by_sizemem(&(a->free_list), sizemem);
+    a->busy_count++;
+    a->busy_sizemem += block_len;
 
-    /* remove block from list. */
-    allocator_list_remove_elem(&(a->free_list), cur);
+    return BLOCK_DATA(cur);
+}
 
-    if (BLOCK_L_DATA_LEN(cur) < (sizemem + MIN_BLOCK_LEN)) {
-        /* don't need to divide block. */
-        BLOCK_L_FLAG(cur) = BUSY_BLOCK;
-        BLOCK_R_FLAG(cur) = BUSY_BLOCK;
-        allocator_list_push_back(&(a->busy_list), cur);
-        memcpy(BLOCK_DATA(cur), BLOCK_DATA(orig), BLOCK_L_DATA_LEN(orig));
-        allocator_free_block(a, ptrmem);
-        return BLOCK_DATA(cur);
+void*allocator_realloc_block(allocator_type_t a, void*ptrmem, size_t sizemem)
+{
+    void*orig = BLOCK_PTR_FROM_DATA(ptrmem);
+    void*res = allocator_malloc_block(a, sizemem);
+    size_t len = BLOCK_DATA_LEN(orig);
+
+    if (res == NULL) {
+        return NULL;
     }
 
-    size_t len = BLOCK_L_DATA_LEN(cur) - sizemem - BLOCK_OVERHEAD;
-    void*tmp_block;
-    /* have to divide block. */
-    
-    /* split block into two smaller blocks (one of them will contain data). */
-    
-    /* put busy block to busy list. */
-    BLOCK_L_FLAG(cur) = BUSY_BLOCK;
-    BLOCK_L_DATA_LEN(cur) = sizemem;
-    BLOCK_LIST_PREV(cur) = NULL;
-    BLOCK_LIST_NEXT(cur) = NULL;
-    BLOCK_R_DATA_LEN(cur) = sizemem;
-    BLOCK_R_FLAG(cur) = BUSY_BLOCK;
-    allocator_list_push_back(&(a->busy_list), cur);
-    memcpy(BLOCK_DATA(cur), BLOCK_DATA(orig), BLOCK_L_DATA_LEN(orig));
-    
-    /* put free block to free list. */
-    tmp_block = BLOCK_ARR_NEXT(cur);
-    BLOCK_L_FLAG(tmp_block) = FREE_BLOCK;
-    BLOCK_L_DATA_LEN(tmp_block) = len;
-    BLOCK_LIST_PREV(tmp_block) = NULL;
-    BLOCK_LIST_NEXT(tmp_block) = NULL;
-    BLOCK_R_DATA_LEN(tmp_block) = len;
-    BLOCK_R_FLAG(tmp_block) = FREE_BLOCK;
-    allocator_list_insert_elem(&(a->free_list), tmp_block);
+    memcpy(res, ptrmem, (len < sizemem) ? len : sizemem);
     allocator_free_block(a, ptrmem);
 
-    return BLOCK_DATA(cur);
+    return res;
 }
 
 void allocator_free_block(allocator_type_t a, void*ptrmem)
 {
     void*cur = BLOCK_PTR_FROM_DATA(ptrmem);
-    void*arr_prev = NULL;
-    void*arr_next = NULL;
-    if ((cur == a->mem) ||
-        (BLOCK_L_FLAG(BLOCK_ARR_PREV(cur)) == BUSY_BLOCK)) {
-        arr_prev = NULL;
-    } else {
-        arr_prev = BLOCK_ARR_PREV(cur);
+    void*arr_next = BLOCK_ARR_NEXT(cur);
+    size_t len = BLOCK_LEN(cur);
+
+    a->busy_count--;
+    a->busy_sizemem -= len;
+
+    /* concatenate previous free array block with current block. */
+    if (!BLOCK_IS_PREV_BUSY(cur)) {
+        void*arr_prev = BLOCK_ARR_PREV(cur);
+        allocator_free_lists_remove_elem(a, arr_prev);
+        len += BLOCK_LEN(arr_prev);
+        cur = arr_prev;
     }
 
-    if (((cur + BLOCK_L_DATA_LEN(cur) + BLOCK_OVERHEAD) >= (void*) (a->mem + a->sizemem)) ||
-        (BLOCK_L_FLAG(BLOCK_ARR_NEXT(cur)) == BUSY_BLOCK)) {
-        arr_next = NULL;
-    } else {
-        arr_next = BLOCK_ARR_NEXT(cur);
+    /* concatenate current block with next free array block (last block is always busy). */
+    if (!BLOCK_IS_BUSY(arr_next)) {
+        allocator_free_lists_remove_elem(a, arr_next);
+        len += BLOCK_LEN(arr_next);
     }
 
-    allocator_list_remove_elem(&(a->busy_list), cur);
-    
-    if ((arr_prev != NULL) && (arr_next == NULL)) {
-        /* concatenate previous free array block with current block. */
-        size_t len = BLOCK_L_DATA_LEN(arr_prev) + BLOCK_R_OVERHEAD + BLOCK_L_OVERHEAD + BLOCK_L_DATA_LEN(cur);
-        allocator_list_remove_elem(&(a->free_list), arr_prev);
-        BLOCK_L_DATA_LEN(arr_prev) = len;
-        BLOCK_R_DATA_LEN(cur) = len;
-        allocator_list_insert_elem(&(a->free_list), arr_prev);
-    } else if ((arr_prev == NULL) && (arr_next != NULL)) {
-        /* concatenate current block with next free array block. */
-        size_t len = BLOCK_L_DATA_LEN(cur) + BLOCK_R_OVERHEAD + BLOCK_L_OVERHEAD + BLOCK_L_DATA_LEN(arr_next);
-        allocator_list_remove_elem(&(a->free_list), arr_next);
-        BLOCK_L_DATA_LEN(cur) = len;
-        BLOCK_R_DATA_LEN(arr_next) = len;
-        allocator_list_insert_elem(&(a->free_list), cur);
-    } else if ((arr_prev != NULL) && (arr_next != NULL)) {
-        /* concatenate previous free array block with current block with next free array block. */
-        size_t len =
-            BLOCK_L_DATA_LEN(arr_prev) + BLOCK_R_OVERHEAD +
-            BLOCK_L_OVERHEAD + BLOCK_L_DATA_LEN(cur) + BLOCK_R_OVERHEAD +
-            BLOCK_L_OVERHEAD + BLOCK_L_DATA_LEN(arr_next);
-        allocator_list_remove_elem(&(a->free_list), arr_prev);
-        allocator_list_remove_elem(&(a->free_list), arr_next);
-        BLOCK_L_DATA_LEN(arr_prev) = len;
-        BLOCK_R_DATA_LEN(arr_next) = len;
-        allocator_list_insert_elem(&(a->free_list), arr_prev);
-    } else {
-        BLOCK_L_FLAG(cur) = FREE_BLOCK;
-        BLOCK_R_FLAG(cur) = FREE_BLOCK;
-        allocator_list_insert_elem(&(a->free_list), cur);
-    }
+    allocator_set_free(cur, len);
+    allocator_free_lists_insert_elem(a, cur);
 }
-
@@ -5,45 +5,52 @@
 
 /*
   Allocator is a dynamic array divided into blocks.
-  Each block consists of data and two boundary descriptors:
-  [flag][len][prev][next]...[len][flag], where
-  [flag] takes values 0 (block is free) and 1 (block is busy) and uses 1 byte of memory,
-  [len] is size of block (including boundary descriptors) in bytes and uses 8 bytes of memory,
-  [prev] is pointer to previous block (to its left [flag]) and uses 8 bytes of memory,
-  [next] is pointer to next block and (to its left [flag]) also uses 8 bytes of memory,
-  so every block has 34 bytes size overhead.
+  Every block starts with [hdr] word: size of whole block in bytes
+  (multiple of BLOCK_ALIGN) with flags in its low bits:
+  BLOCK_BUSY (block is busy) and BLOCK_PREV_BUSY (block on the left is busy).
+  Busy block is [hdr][data...], so its overhead is 8 bytes plus alignment.
+  Free block is [hdr][next][prev]...[size]: list links live only in free blocks,
+  and right [size] lets block on the right find start of free block on its left.
+  Blocks start at 8 bytes before BLOCK_ALIGN boundary, so data is 16-byte aligned.
+  Array of blocks ends with busy [hdr] of zero size.
 */
 
-#define BLOCK_L_OVERHEAD (sizeof(char) + sizeof(size_t) + 2 * sizeof(void*))
-#define BLOCK_R_OVERHEAD (sizeof(size_t) + sizeof(char))
-#define BLOCK_OVERHEAD (BLOCK_L_OVERHEAD + BLOCK_R_OVERHEAD)
-#define MIN_BLOCK_LEN (BLOCK_OVERHEAD + sizeof(char))
+#define BLOCK_ALIGN       ((size_t) 16)
+#define BLOCK_HEADER_SIZE sizeof(size_t)
+#define MIN_BLOCK_LEN     (BLOCK_HEADER_SIZE + 2 * sizeof(void*) + sizeof(size_t))
+/* worst-case size overhead of one block (used to estimate memory for several blocks). */
+#define BLOCK_OVERHEAD    (MIN_BLOCK_LEN - 1)
+/* alignment padding before first block and zero-sized last block. */
+#define MIN_POOL_LEN      (BLOCK_ALIGN + MIN_BLOCK_LEN)
 
-/*      -position-                 -type-          -l flag-         -l len-        -list prev-      -list next-      -data-                              -r len-                          -r flag-         -arr next-   */
-#define BLOCK_L_FLAG(block)     (*((char*)   (((char*) (block)))))
-#define BLOCK_L_DATA_LEN(block) (*((size_t*) (((char*) (block)) + sizeof(char))))
+#define BLOCK_BUSY      ((size_t) 1)
+#define BLOCK_PREV_BUSY ((size_t) 2)
+#define BLOCK_FLAGS     (BLOCK_ALIGN - 1)
 
-#define BLOCK_LIST_PREV(block)  (*((void**)  (((char*) (block)) + sizeof(char) + sizeof(size_t))))
-#define BLOCK_LIST_NEXT(block)  (*((void**)  (((char*) (block)) + sizeof(char) + sizeof(size_t) + sizeof(void*))))
+/* size of block, which can hold sizemem bytes of data. */
+#define BLOCK_LEN_FOR(sizemem) \
+    ((((sizemem) + BLOCK_HEADER_SIZE + BLOCK_FLAGS) & ~BLOCK_FLAGS) < MIN_BLOCK_LEN ? \
+     MIN_BLOCK_LEN : (((sizemem) + BLOCK_HEADER_SIZE + BLOCK_FLAGS) & ~BLOCK_FLAGS))
 
-#define BLOCK_DATA(block)       ((void*)     (((char*) (block)) + sizeof(char) + sizeof(size_t) + sizeof(void*) + sizeof(void*)))
+/*      -position-                  -type-          -hdr-            */
+#define BLOCK_HDR(block)            (*((size_t*) (((char*) (block)))))
+#define BLOCK_LEN(block)            (BLOCK_HDR(block) & ~BLOCK_FLAGS)
+#define BLOCK_IS_BUSY(block)        ((BLOCK_HDR(block) & BLOCK_BUSY) != 0)
+#define BLOCK_IS_PREV_BUSY(block)   ((BLOCK_HDR(block) & BLOCK_PREV_BUSY) != 0)
 
-#define BLOCK_R_DATA_LEN(block) (*((size_t*) (((char*) (block)) + sizeof(char) + sizeof(size_t) + sizeof(void*) + sizeof(void*) + ((BLOCK_L_DATA_LEN((char*) (block))) * sizeof(char)))))
-#define BLOCK_R_FLAG(block)     (*((char*)   (((char*) (block)) + sizeof(char) + sizeof(size_t) + sizeof(void*) + sizeof(void*) + ((BLOCK_L_DATA_LEN((char*) (block))) * sizeof(char)) + sizeof(size_t))))
+#define BLOCK_DATA(block)           ((void*)     (((char*) (block)) + BLOCK_HEADER_SIZE))
+#define BLOCK_DATA_LEN(block)       (BLOCK_LEN(block) - BLOCK_HEADER_SIZE)
+#define BLOCK_PTR_FROM_DATA(ptr)    ((void*)     (((char*) (ptr)) - BLOCK_HEADER_SIZE))
 
-#define BLOCK_ARR_NEXT(block)   ((void*)     (((char*) (block)) + sizeof(char) + sizeof(size_t) + sizeof(void*) + sizeof(void*) + ((BLOCK_L_DATA_LEN((char*) (block))) * sizeof(char)) + sizeof(size_t) + sizeof(char)))
+#define BLOCK_ARR_NEXT(block)       ((void*)     (((char*) (block)) + BLOCK_LEN(block)))
 
-/*      -position-                   -type-         -cur-         -list next-     -list prev-       -l len-         -l flag-    */
-#define BLOCK_PTR_FROM_DATA(block) ((void*) (((char*) (block)) - sizeof(void*) - sizeof(void*) - sizeof(size_t) - sizeof(char)))
+/* only for free blocks. */
+#define BLOCK_LIST_NEXT(block)      (*((void**)  (((char*) (block)) + BLOCK_HEADER_SIZE)))
+#define BLOCK_LIST_PREV(block)      (*((void**)  (((char*) (block)) + BLOCK_HEADER_SIZE + sizeof(void*))))
+#define BLOCK_R_LEN(block)          (*((size_t*) (((char*) (block)) + BLOCK_LEN(block) - sizeof(size_t))))
 
-/*      -position-                   -type-          -cur-            -r flag-       -r len- */
-#define BLOCK_ARR_PREV_INNER(block) ((char*) (((char*) (block)) - sizeof(char) - sizeof(size_t)))
-/*      -position-                    -type-          -r len-                                           -data-                             -list next-     -list prev-       -l len-         -l flag-    */
-#define BLOCK_ARR_PREV(block)       ((void*) (BLOCK_ARR_PREV_INNER(block) - ((*((size_t*) BLOCK_ARR_PREV_INNER(block))) * sizeof(char)) - sizeof(void*) - sizeof(void*) - sizeof(size_t) - sizeof(char)))
-
-#define FREE_BLOCK 0
-#define BUSY_BLOCK 1
-#define ANY_BLOCK  2
+/* only if block on the left is free. */
+#define BLOCK_ARR_PREV(block)       ((void*)     (((char*) (block)) - *((size_t*) (((char*) (block)) - sizeof(size_t)))))
 
 struct ALLOCATOR_LIST
 {
@@ -52,25 +59,49 @@ struct ALLOCATOR_LIST
     size_t sizemem;
 };
 
+/*
+  Free blocks are segregated by size classes like in TLSF:
+  first level is power of two (all sizes below 2^ALLOCATOR_FL_SHIFT are first level 0),
+  second level splits it into ALLOCATOR_SL_COUNT equal ranges.
+  Bitmaps of non-empty classes make search of fitting block O(1).
+*/
+#define ALLOCATOR_SL_BITS  3
+#define ALLOCATOR_SL_COUNT (1 << ALLOCATOR_SL_BITS)
+#define ALLOCATOR_FL_SHIFT 7
+#define ALLOCATOR_FL_COUNT (sizeof(size_t) * 8 - ALLOCATOR_FL_SHIFT + 1)
+
 struct ALLOCATOR
 {
     char*mem;
     size_t sizemem;
 
     /* free blocks. */
-    struct ALLOCATOR_LIST free_list;
+    struct ALLOCATOR_LIST free_lists[ALLOCATOR_FL_COUNT][ALLOCATOR_SL_COUNT];
+    unsigned long long fl_bitmap;
+    unsigned sl_bitmap[ALLOCATOR_FL_COUNT];
+    size_t free_count;
 
-    /* busy blocks. */
-    struct ALLOCATOR_LIST busy_list;
+    /* busy blocks aren't linked, only counted (sizemem includes headers). */
+    size_t busy_count;
+    size_t busy_sizemem;
+
+    /* first block and zero-sized last block. */
+    char*start, *end;
 };
 
 typedef struct ALLOCATOR* allocator_type_t;
 
-void allocator_malloc_pool(allocator_type_t a, size_t sizemem);
+void allocator_malloc_pool(allocator_type_t a, size_t sizemem, int huge_pages);
 void allocator_free_pool(allocator_type_t a);
 
+/* gives memory of idle pool back to OS; pool must be cleaned before next use. */
+void allocator_release_pool(allocator_type_t a);
+
 void allocator_clean_pool(allocator_type_t a);
 
+/* checks, if allocator_malloc_block(a, sizemem) will succeed. */
+int allocator_can_malloc_block(allocator_type_t a, size_t sizemem);
+
 void*allocator_malloc_block(allocator_type_t a, size_t sizemem);
 void*allocator_realloc_block(allocator_type_t a, void*ptrmem, size_t sizemem);
 void allocator_free_block(allocator_type_t a, void*ptrmem);
@@ -0,0 +1,202 @@
+#include "compact.h"
+
+#include "utils.h"
+
+struct MARK_STACK
+{
+    struct GC_HEADER**blocks;
+    size_t blocks_len;
+    size_t blocks_cap;
+    size_t marked_sizemem;
+};
+
+static void mark_block(struct MARK_STACK*stack, void*ptr)
+{
+    struct GC_HEADER*hdr = GC_HEADER_FROM_PTR(ptr);
+
+    if (GC_HEADER_FLAGS(hdr) & GC_FLAG_MARKED) {
+        return;
+    }
+    GC_HEADER_SET_FLAG(hdr, GC_FLAG_MARKED);
+
+    /* large blocks are only marked, they are freed by sweep. */
+    if (GC_HEADER_FLAGS(hdr) & GC_FLAG_LARGE) {
+        return;
+    }
+    stack->marked_sizemem += GC_HEADER_SIZEMEM(hdr);
+
+    /* backing stores are scanned together with their owners. */
+    if ((GC_HEADER_TYPE(hdr) == GC_BLOCK_OBJ) || (GC_HEADER_TYPE(hdr) == GC_BLOCK_ARR)) {
+        struct GC_HEADER**blocks = stack->blocks;
+        size_t blocks_len = stack->blocks_len;
+        size_t blocks_cap = stack->blocks_cap;
+        PUSH_BACK(blocks, hdr);
+        stack->blocks = blocks;
+        stack->blocks_len = blocks_len;
+        stack->blocks_cap = blocks_cap;
+    }
+}
+
+static void mark_value(struct MARK_STACK*stack, const struct VALUE*val)
+{
+    if (VALUE_GET_TYPE(*val) == VALUE_TYPE_OBJ) {
+        mark_block(stack, VALUE_GET_OBJ(*val));
+    } else if (VALUE_GET_TYPE(*val) == VALUE_TYPE_ARR) {
+        mark_block(stack, VALUE_GET_ARR(*val));
+    }
+}
+
+size_t compact_mark(garbage_collector_type_t gc, void**ptr)
+{
+    struct VALUE*stack = (*(gc->stack));
+    struct VALUE*stack_top = (*(gc->stack_top));
+    struct VALUE*val;
+
+    struct MARK_STACK mark_stack = {NULL, 0, 0, 0};
+    size_t i;
+
+    for (val = stack; val != stack_top; val++) {
+        mark_value(&mark_stack, val);
+    }
+
+    if (ptr != NULL) {
+        mark_block(&mark_stack, *ptr);
+    }
+
+    while (mark_stack.blocks_len != 0) {
+        struct GC_HEADER*hdr = mark_stack.blocks[--mark_stack.blocks_len];
+
+        if (GC_HEADER_TYPE(hdr) == GC_BLOCK_OBJ) {
+            struct OBJECT*obj = GC_PTR_FROM_HEADER(hdr);
+            if (obj->properties != NULL) {
+                mark_block(&mark_stack, obj->properties);
+            }
+            for (i = 0; i < obj->shape->len; i++) {
+                mark_value(&mark_stack, &(obj->properties[i]));
+            }
+        } else {
+            struct ARRAY*arr = GC_PTR_FROM_HEADER(hdr);
+            if (arr->values != NULL) {
+                mark_block(&mark_stack, arr->values);
+            }
+            for (i = 0; i < arr->len; i++) {
+                mark_value(&mark_stack, &(arr->values[i]));
+            }
+        }
+    }
+
+    SAFE_FREE(mark_stack.blocks);
+
+    return mark_stack.marked_sizemem;
+}
+
+static void*new_location(void*ptr)
+{
+    struct GC_HEADER*hdr = GC_HEADER_FROM_PTR(ptr);
+
+    /* large blocks are never moved. */
+    return (GC_HEADER_FLAGS(hdr) & GC_FLAG_LARGE) ? ptr : hdr->forward;
+}
+
+static void update_value(struct VALUE*val)
+{
+    if (VALUE_GET_TYPE(*val) == VALUE_TYPE_OBJ) {
+        (*val) = create_value_from_obj(new_location(VALUE_GET_OBJ(*val)));
+    } else if (VALUE_GET_TYPE(*val) == VALUE_TYPE_ARR) {
+        (*val) = create_value_from_arr(new_location(VALUE_GET_ARR(*val)));
+    }
+}
+
+/* dead blocks from start till end are turned into one dead block. */
+static void coalesce_dead_blocks(char*start, char*end)
+{
+    struct GC_HEADER*hdr = (struct GC_HEADER*) start;
+    hdr->info = GC_HEADER_INFO(GC_HEADER_TYPE(hdr), end - start);
+}
+
+void compact_slide(garbage_collector_type_t gc, void**ptr, struct SEMISPACE*to)
+{
+    struct VALUE*stack = (*(gc->stack));
+    struct VALUE*stack_top = (*(gc->stack_top));
+    struct VALUE*val;
+
+    char*free_ptr = to->mem;
+    char*dead_ptr = NULL;
+    char*block_ptr;
+    size_t i;
+
+    /* 2) new locations; runs of dead blocks become one block, so next walks skip them at once. */
+    for (block_ptr = gc->sa.mem; block_ptr != gc->sa.top; block_ptr += GC_HEADER_SIZEMEM((struct GC_HEADER*) block_ptr)) {
+        struct GC_HEADER*hdr = (struct GC_HEADER*) block_ptr;
+        if (GC_HEADER_FLAGS(hdr) & GC_FLAG_MARKED) {
+            if (dead_ptr != NULL) {
+                coalesce_dead_blocks(dead_ptr, block_ptr);
+                dead_ptr = NULL;
+            }
+            hdr->forward = GC_PTR_FROM_HEADER(free_ptr);
+            free_ptr += GC_HEADER_SIZEMEM(hdr);
+        } else if (dead_ptr == NULL) {
+            dead_ptr = block_ptr;
+        }
+    }
+    if (dead_ptr != NULL) {
+        coalesce_dead_blocks(dead_ptr, gc->sa.top);
+    }
+
+    /* 3) pointers; stores are still in old locations, so they are updated through their owners. */
+    for (val = stack; val != stack_top; val++) {
+        update_value(val);
+    }
+
+    if (ptr != NULL) {
+        (*ptr) = new_location(*ptr);
+    }
+
+    for (block_ptr = gc->sa.mem; block_ptr != gc->sa.top; block_ptr += GC_HEADER_SIZEMEM((struct GC_HEADER*) block_ptr)) {
+        struct GC_HEADER*hdr = (struct GC_HEADER*) block_ptr;
+
+        if (!(GC_HEADER_FLAGS(hdr) & GC_FLAG_MARKED)) {
+            continue;
+        }
+
+        if (GC_HEADER_TYPE(hdr) == GC_BLOCK_OBJ) {
+            struct OBJECT*obj = GC_PTR_FROM_HEADER(hdr);
+            if (obj->properties != NULL) {
+                for (i = 0; i < obj->shape->len; i++) {
+                    update_value(&(obj->properties[i]));
+                }
+                obj->properties = new_location(obj->properties);
+            }
+        } else if (GC_HEADER_TYPE(hdr) == GC_BLOCK_ARR) {
+            struct ARRAY*arr = GC_PTR_FROM_HEADER(hdr);
+            if (arr->values != NULL) {
+                for (i = 0; i < arr->len; i++) {
+                    update_value(&(arr->values[i]));
+                }
+                arr->values = new_location(arr->values);
+            }
+        }
+    }
+
+    /* 4) sliding; block never moves to higher address, so the next header is intact after memmove. */
+    block_ptr = gc->sa.mem;
+    while (block_ptr != gc->sa.top) {
+        struct GC_HEADER*hdr = (struct GC_HEADER*) block_ptr;
+        size_t sizemem = GC_HEADER_SIZEMEM(hdr);
+
+        if (GC_HEADER_FLAGS(hdr) & GC_FLAG_MARKED) {
+            struct GC_HEADER*new_hdr = GC_HEADER_FROM_PTR(hdr->forward);
+            if (new_hdr != hdr) {
+                memmove(new_hdr, hdr, sizemem);
+                gc->copied_sizemem += sizemem;
+                gc->copied_num++;
+            }
+            new_hdr->forward = NULL;
+            GC_HEADER_CLEAR_FLAG(new_hdr, GC_FLAG_MARKED);
+        }
+
+        block_ptr += sizemem;
+    }
+
+    to->top = free_ptr;
+}
@@ -0,0 +1,25 @@
+#ifndef COMPACT_H_INCLUDED
+#define COMPACT_H_INCLUDED
+
+#include "garbage-collector.h"
+
+/*
+  Mark-compact (Lisp2) collection of the only bump-pointer space (sa):
+  1) blocks, which are reachable from stack and additional root, are marked;
+  2) new location of every marked block is stored in its [forward] by linear walk;
+  3) roots and pointers of marked blocks are updated to new locations;
+  4) marked blocks slide to new locations in address order, so they never overlap.
+  Every block already has [forward], so no memory is needed except mark stack,
+  and there is no TO space, which halves memory of copying collector.
+*/
+
+/* marks reachable blocks (including large ones) and returns size of marked blocks in sa. */
+size_t compact_mark(garbage_collector_type_t gc, void**ptr);
+
+/*
+  Slides marked blocks of sa to the start of space to (which is sa itself or new clean space),
+  ptr is additional root.
+*/
+void compact_slide(garbage_collector_type_t gc, void**ptr, struct SEMISPACE*to);
+
+#endif  /* COMPACT_H_INCLUDED */
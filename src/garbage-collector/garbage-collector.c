@@ -1,7 +1,26 @@
 #include "garbage-collector.h"
+#include "parallel.h"
+#include "compact.h"
 
 #include "utils.h"
 
+void garbage_collector_default_params(struct GARBAGE_COLLECTOR_PARAMS*params)
+{
+    params->sizemem_start = 1024 * 1024;
+    params->allocation = GARBAGE_COLLECTOR_ALLOCATION_BUMP;
+    params->generational = 0;
+    params->nursery_sizemem = 256 * 1024;
+    params->target_occupancy = 0.5;
+    params->growth_factor = 2.0;
+    params->shrink_after = 4;
+    params->max_sizemem = 0;
+    params->huge_pages = 0;
+    params->pause_budget_ns = 0;
+    params->threads_num = 1;
+    params->compacting = 0;
+    params->stats = 0;
+}
+
 garbage_collector_type_t create_garbage_collector()
 {
     struct GARBAGE_COLLECTOR*gc;
@@ -9,28 +28,301 @@ garbage_collector_type_t create_garbage_collector()
     return gc;
 }
 
-void garbage_collector_conf(garbage_collector_type_t gc, size_t sizemem_start, struct VALUE**stack, struct VALUE**stack_top, int trace)
+static void malloc_pool(garbage_collector_type_t gc, int to_space, size_t sizemem)
+{
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+        semispace_malloc_pool(to_space ? &(gc->sb) : &(gc->sa), sizemem, gc->huge_pages);
+    } else {
+        allocator_malloc_pool(to_space ? &(gc->b) : &(gc->a), sizemem, gc->huge_pages);
+    }
+}
+
+static void free_pool(garbage_collector_type_t gc, int to_space)
 {
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+        semispace_free_pool(to_space ? &(gc->sb) : &(gc->sa));
+    } else {
+        allocator_free_pool(to_space ? &(gc->b) : &(gc->a));
+    }
+}
+
+static void release_pool(garbage_collector_type_t gc, int to_space)
+{
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+        semispace_release_pool(to_space ? &(gc->sb) : &(gc->sa));
+    } else {
+        allocator_release_pool(to_space ? &(gc->b) : &(gc->a));
+    }
+}
+
+void garbage_collector_conf(garbage_collector_type_t gc, const struct GARBAGE_COLLECTOR_PARAMS*params,
+                            struct VALUE**stack, struct VALUE**stack_top, int trace)
+{
+    size_t sizemem_start = params->sizemem_start;
+
     gc->stack = stack;
     gc->stack_top = stack_top;
-    allocator_malloc_pool(&(gc->a), sizemem_start);
-    allocator_malloc_pool(&(gc->b), sizemem_start);
+
+    gc->generational = params->generational;
+    gc->incremental = !gc->generational && (params->pause_budget_ns != 0);
+    gc->pause_budget_ns = params->pause_budget_ns;
+    gc->threads_num = (params->threads_num == 0) ? 1 : params->threads_num;
+    gc->compacting = !gc->generational && !gc->incremental && params->compacting;
+    gc->allocation = (gc->generational || gc->incremental || gc->compacting) ?
+        GARBAGE_COLLECTOR_ALLOCATION_BUMP : params->allocation;
+
+    /* old generation must be able to take whole nursery. */
+    if (gc->generational && (sizemem_start < 2 * params->nursery_sizemem)) {
+        sizemem_start = 2 * params->nursery_sizemem;
+    }
+
+    gc->huge_pages = params->huge_pages;
+    gc->target_occupancy = params->target_occupancy;
+    gc->growth_factor = params->growth_factor;
+    gc->shrink_after = params->shrink_after;
+    gc->low_occupancy_count = 0;
+
+    gc->max_sizemem = params->max_sizemem;
+    if (params->max_sizemem != 0) {
+        size_t max_space_sizemem;
+        size_t nursery_sizemem = gc->generational ? params->nursery_sizemem : 0;
+        size_t min_sizemem = gc->generational ? 2 * params->nursery_sizemem : 0;
+
+        max_space_sizemem = (params->max_sizemem > nursery_sizemem) ? (params->max_sizemem - nursery_sizemem) / 2 : 0;
+        if (gc->compacting) {
+            max_space_sizemem = params->max_sizemem;
+        }
+        if (max_space_sizemem < min_sizemem) {
+            fprintf(stderr, "heap limit is too small:\n");
+            fprintf(stderr, "got:     %zu bytes\n", params->max_sizemem);
+            fprintf(stderr, "minimum: %zu bytes;\n", 2 * min_sizemem + nursery_sizemem);
+            exit(EXIT_FAILURE);
+        }
+        if (sizemem_start > max_space_sizemem) {
+            sizemem_start = max_space_sizemem;
+        }
+    }
+
+    gc->min_space_sizemem = sizemem_start;
+
+    gc->large_limit = sizemem_start;
+
+    malloc_pool(gc, 0, sizemem_start);
+    if (!gc->compacting) {
+        malloc_pool(gc, 1, sizemem_start);
+    }
+
+    if (gc->generational) {
+        semispace_malloc_pool(&(gc->nursery), params->nursery_sizemem, gc->huge_pages);
+    }
+
+    gc->stats = params->stats;
 
     gc->trace = trace;
 }
 
+/* memory, which is needed to allocate blocks_num blocks with total size sizemem. */
+static size_t required_sizemem(garbage_collector_type_t gc, size_t sizemem, size_t blocks_num)
+{
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+        return sizemem;
+    }
+
+    return sizemem + blocks_num * BLOCK_OVERHEAD;
+}
+
+/* big spaces of non-generational and non-incremental bump-pointer mode are evacuated by several threads. */
+static int is_parallel(garbage_collector_type_t gc, size_t sizemem)
+{
+    return (gc->threads_num > 1) && (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) &&
+        !gc->generational && !gc->incremental && !gc->compacting && (sizemem >= GARBAGE_COLLECTOR_PARALLEL_SIZEMEM);
+}
+
+static int has_space(garbage_collector_type_t gc, size_t required)
+{
+    if (gc->generational) {
+        /* old generation always keeps nursery-sized headroom, so major collection can't overflow TO space. */
+        return gc->pretenure ?
+            (required + gc->nursery.sizemem <= SEMISPACE_FREE(&(gc->sa))) :
+            (required <= SEMISPACE_FREE(&(gc->nursery)));
+    }
+
+    if (gc->incremental) {
+        /* flip is made at half of FROM space, so TO space has room for copies and new blocks. */
+        return gc->cycle ?
+            (required + gc->cycle_remaining <= SEMISPACE_FREE(&(gc->sb))) :
+            (SEMISPACE_USED(&(gc->sa)) + required <= gc->sa.sizemem / 2);
+    }
+
+    /* FROM space keeps headroom for holes, which parallel evacuation leaves in TO space. */
+    if (is_parallel(gc, gc->sa.sizemem)) {
+        return PARALLEL_TO_SPACE_SIZEMEM(SEMISPACE_USED(&(gc->sa)) + required, gc->threads_num) <= gc->sa.sizemem;
+    }
+
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+        return required <= SEMISPACE_FREE(&(gc->sa));
+    }
+
+    return allocator_can_malloc_block(&(gc->a), required);
+}
+
+/* large blocks don't need space in FROM space. */
+static size_t store_required_sizemem(garbage_collector_type_t gc, size_t sizemem)
+{
+    return (sizemem >= GARBAGE_COLLECTOR_LARGE_SIZEMEM) ? 0 : required_sizemem(gc, sizemem, 1);
+}
+
+static size_t store_large_sizemem(size_t sizemem)
+{
+    return (sizemem >= GARBAGE_COLLECTOR_LARGE_SIZEMEM) ? sizemem : 0;
+}
+
+/* allocates block in FROM space (or in large object space); space must be checked by reserve. */
+static void*malloc_block(garbage_collector_type_t gc, enum GC_BLOCK_TYPE type, size_t sizemem)
+{
+    struct GC_HEADER*hdr;
+
+    if (sizemem >= GARBAGE_COLLECTOR_LARGE_SIZEMEM) {
+        hdr = pages_map(sizemem, gc->huge_pages);
+        hdr->forward = NULL;
+        hdr->info = GC_HEADER_INFO(type, sizemem);
+        GC_HEADER_SET_FLAG(hdr, GC_FLAG_LARGE);
+
+        /* blocks, which are allocated during incremental collection, are reachable. */
+        if (gc->cycle) {
+            GC_HEADER_SET_FLAG(hdr, GC_FLAG_MARKED);
+        }
+
+        PUSH_BACK(gc->large, hdr);
+        gc->large_sizemem += sizemem;
+
+        return GC_PTR_FROM_HEADER(hdr);
+    }
+
+    if (gc->generational) {
+        hdr = semispace_malloc_block(gc->pretenure ? &(gc->sa) : &(gc->nursery), sizemem);
+    } else if (gc->cycle) {
+        hdr = semispace_malloc_block(&(gc->sb), sizemem);
+    } else if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+        hdr = semispace_malloc_block(&(gc->sa), sizemem);
+    } else {
+        hdr = allocator_malloc_block(&(gc->a), sizemem);
+    }
+
+    hdr->forward = NULL;
+    hdr->info = GC_HEADER_INFO(type, sizemem);
+
+    return GC_PTR_FROM_HEADER(hdr);
+}
+
+static void free_large_block(garbage_collector_type_t gc, struct GC_HEADER*hdr)
+{
+    gc->large_sizemem -= GC_HEADER_SIZEMEM(hdr);
+    pages_unmap(hdr, GC_HEADER_SIZEMEM(hdr));
+}
+
+static void free_block(garbage_collector_type_t gc, void*ptr)
+{
+    struct GC_HEADER*hdr = GC_HEADER_FROM_PTR(ptr);
+
+    if (GC_HEADER_FLAGS(hdr) & GC_FLAG_LARGE) {
+        size_t i;
+        for (i = 0; gc->large[i] != hdr; i++) {
+            /* do nothing. */
+        }
+        gc->large[i] = gc->large[--gc->large_len];
+        free_large_block(gc, hdr);
+        return;
+    }
+
+    /* in bump-pointer mode block just becomes garbage. */
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_FREE_LIST) {
+        allocator_free_block(&(gc->a), GC_HEADER_FROM_PTR(ptr));
+    }
+}
+
+#define IN_SEMISPACE(s, ptr) ((((char*) (ptr)) >= (s)->mem) && (((char*) (ptr)) < (s)->top))
+
 static void*lookup_new_location(garbage_collector_type_t gc, void*ptr)
 {
-    void*o = BLOCK_PTR_FROM_DATA((((char*) ptr) - 1));
-    
-    if (ptrs_map_get(&(gc->ptrs_map), o) == NULL) {
-        ptrs_map_set(&(gc->ptrs_map), o, gc->b.free_list.first);
+    struct GC_HEADER*hdr = GC_HEADER_FROM_PTR(ptr);
+
+    /* minor collection evacuates only nursery. */
+    if (gc->minor && !IN_SEMISPACE(&(gc->nursery), ptr)) {
+        return ptr;
+    }
 
-        allocator_malloc_block(&(gc->b), BLOCK_L_DATA_LEN(o));
-        memcpy(BLOCK_DATA(gc->b.busy_list.last), BLOCK_DATA(o), BLOCK_L_DATA_LEN(o));
+    /* large blocks are never moved, major collection only marks them. */
+    if (GC_HEADER_FLAGS(hdr) & GC_FLAG_LARGE) {
+        GC_HEADER_SET_FLAG(hdr, GC_FLAG_MARKED);
+        return ptr;
     }
 
-    return (((char*) BLOCK_DATA(ptrs_map_get(&(gc->ptrs_map), o))) + 1);
+    /* during incremental collection blocks of TO space are already in place. */
+    if (gc->cycle && !IN_SEMISPACE(&(gc->sa), ptr)) {
+        return ptr;
+    }
+
+    if (hdr->forward == NULL) {
+        size_t sizemem = GC_HEADER_SIZEMEM(hdr);
+        struct GC_HEADER*new_hdr;
+
+        if (gc->minor) {
+            /* survivors of minor collection are promoted to old generation. */
+            new_hdr = semispace_malloc_block(&(gc->sa), sizemem);
+        } else if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+            new_hdr = semispace_malloc_block(&(gc->sb), sizemem);
+            gc->cycle_remaining -= gc->cycle ? sizemem : 0;
+        } else {
+            new_hdr = allocator_malloc_block(&(gc->b), sizemem);
+        }
+
+        /* copy is made before forwarding, so new header is not forwarded. */
+        memcpy(new_hdr, hdr, sizemem);
+        hdr->forward = GC_PTR_FROM_HEADER(new_hdr);
+
+        gc->copied_sizemem += sizemem;
+        gc->copied_num++;
+    }
+
+    return hdr->forward;
+}
+
+static void scan_value(garbage_collector_type_t gc, struct VALUE*val)
+{
+    if (VALUE_GET_TYPE(*val) == VALUE_TYPE_OBJ) {
+        (*val) = create_value_from_obj(lookup_new_location(gc, VALUE_GET_OBJ(*val)));
+    } else if (VALUE_GET_TYPE(*val) == VALUE_TYPE_ARR) {
+        (*val) = create_value_from_arr(lookup_new_location(gc, VALUE_GET_ARR(*val)));
+    }
+}
+
+/*
+  Backing stores are owned by exactly one object or array,
+  so they are evacuated and scanned together with their owner
+  (only owner knows, how many elements of store are initialized).
+*/
+static void scan_block(garbage_collector_type_t gc, struct GC_HEADER*hdr)
+{
+    size_t i;
+
+    if (GC_HEADER_TYPE(hdr) == GC_BLOCK_OBJ) {
+        struct OBJECT*obj = GC_PTR_FROM_HEADER(hdr);
+        if (obj->properties != NULL) {
+            obj->properties = lookup_new_location(gc, obj->properties);
+        }
+        for (i = 0; i < obj->shape->len; i++) {
+            scan_value(gc, &(obj->properties[i]));
+        }
+    } else if (GC_HEADER_TYPE(hdr) == GC_BLOCK_ARR) {
+        struct ARRAY*arr = GC_PTR_FROM_HEADER(hdr);
+        if (arr->values != NULL) {
+            arr->values = lookup_new_location(gc, arr->values);
+        }
+        for (i = 0; i < arr->len; i++) {
+            scan_value(gc, &(arr->values[i]));
+        }
+    }
 }
 
 static void run_gc_inner(garbage_collector_type_t gc, void**ptr)
@@ -39,262 +331,791 @@ static void run_gc_inner(garbage_collector_type_t gc, void**ptr)
     struct VALUE*stack_top = (*(gc->stack_top));
     
     struct VALUE*val;
-    void*unscanned_ptr;
 
-    allocator_clean_pool(&(gc->b));
+    size_t used = SEMISPACE_USED(&(gc->sa));
+
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+        semispace_clean_pool(&(gc->sb));
+    } else {
+        allocator_clean_pool(&(gc->b));
+    }
+
+    /* nobody walks TO space linearly in this mode, so holes of parallel evacuation are harmless. */
+    if (is_parallel(gc, gc->sb.sizemem) && (PARALLEL_TO_SPACE_SIZEMEM(used, gc->threads_num) <= gc->sb.sizemem)) {
+        parallel_evacuate(gc, ptr);
+        return;
+    }
 
     /* Cheneys GC from Aho-Ullman. */
 
     /* 2) for (All o in FROM) NewLocation(o) = NULL; */
-    ptrs_map_conf(&(gc->ptrs_map), gc->a.busy_list.count);
+    /* Nothing to do: every header is created with NULL forward. */
 
     /* 3) unscanned = free = start TO address. */
     /* Nothing to do */
 
     /* 4-5) for (every link R in root subset) R = LookupNewLocation(r) */
     for (val = stack; val != stack_top; val++) {
-        if (val->type == VALUE_TYPE_OBJ) {
-            val->obj_val = lookup_new_location(gc, val->obj_val);
-        } else if (val->type == VALUE_TYPE_ARR) {
-            val->arr_val = lookup_new_location(gc, val->arr_val);
-        }
+        scan_value(gc, val);
+    }
+
+    if (ptr != NULL) {
+        (*ptr) = lookup_new_location(gc, *ptr);
     }
 
     /* 6-7-8-9-10) */
-    unscanned_ptr = gc->b.busy_list.first;
-    while (unscanned_ptr != NULL) {
-        char*ptr = BLOCK_DATA(unscanned_ptr);
-        if (ptr[0] == VALUE_TYPE_OBJ) {
-            size_t i;
-            struct OBJECT*obj = (struct OBJECT*) (ptr + 1);
-            for (i = 0; i < obj->properties_len; i++) {
-                if (obj->properties[i].val.type == VALUE_TYPE_OBJ) {
-                    obj->properties[i].val.obj_val = lookup_new_location(gc, obj->properties[i].val.obj_val);
-                } else if (obj->properties[i].val.type == VALUE_TYPE_ARR) {
-                    obj->properties[i].val.arr_val = lookup_new_location(gc, obj->properties[i].val.arr_val);
-                }
-            }
-        } else if (ptr[0] == VALUE_TYPE_ARR) {
-            size_t i;
-            struct ARRAY*arr = (struct ARRAY*) (ptr + 1);
-            for (i = 0; i < arr->len; i++) {
-                if (arr->values[i].type == VALUE_TYPE_OBJ) {
-                    arr->values[i].obj_val = lookup_new_location(gc, arr->values[i].obj_val);
-                } else if (arr->values[i].type == VALUE_TYPE_ARR) {
-                    arr->values[i].arr_val = lookup_new_location(gc, arr->values[i].arr_val);
-                }
-            }
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+        /* TO space is walked linearly, because blocks are allocated one after another. */
+        char*unscanned_ptr = gc->sb.mem;
+        while (unscanned_ptr != gc->sb.top) {
+            struct GC_HEADER*hdr = (struct GC_HEADER*) unscanned_ptr;
+            scan_block(gc, hdr);
+            unscanned_ptr += GC_HEADER_SIZEMEM(hdr);
+        }
+    } else {
+        /*
+          TO space is clean, so its only free block is split from the left
+          and busy blocks are walked linearly in allocation order up to free tail.
+        */
+        char*unscanned_ptr = gc->b.start;
+        while ((unscanned_ptr != gc->b.end) && BLOCK_IS_BUSY(unscanned_ptr)) {
+            scan_block(gc, BLOCK_DATA(unscanned_ptr));
+            unscanned_ptr = BLOCK_ARR_NEXT(unscanned_ptr);
         }
-        unscanned_ptr = BLOCK_LIST_NEXT(unscanned_ptr);
     }
+}
 
-    if (ptr != NULL) {
-        (*ptr) = lookup_new_location(gc, *ptr);
+static void swap_pools(garbage_collector_type_t gc)
+{
+    struct ALLOCATOR tmp = gc->a;
+    struct SEMISPACE stmp = gc->sa;
+
+    gc->a = gc->b;
+    gc->b = tmp;
+
+    gc->sa = gc->sb;
+    gc->sb = stmp;
+}
+
+static void forget_remembered(garbage_collector_type_t gc)
+{
+    size_t i;
+
+    for (i = 0; i < gc->remembered_len; i++) {
+        GC_HEADER_CLEAR_FLAG(gc->remembered[i], GC_FLAG_REMEMBERED);
+    }
+    gc->remembered_len = 0;
+}
+
+/* all memory of heap: spaces, nursery and large object space. */
+static size_t heap_sizemem(garbage_collector_type_t gc)
+{
+    size_t sizemem = gc->nursery.sizemem + gc->large_sizemem;
+
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+        return sizemem + gc->sa.sizemem + gc->sb.sizemem;
+    }
+
+    return sizemem + gc->a.sizemem + gc->b.sizemem;
+}
+
+/* copy counters and heap size are remembered at start of pause, so pause gets only its own copies. */
+static void start_pause(garbage_collector_type_t gc, struct GC_COLLECTION*c, enum GC_COLLECTION_KIND kind)
+{
+    c->kind = kind;
+    c->trigger = gc->trigger;
+    c->copied_sizemem = gc->copied_sizemem;
+    c->copied_num = gc->copied_num;
+    c->heap_before_sizemem = heap_sizemem(gc);
+    c->start_ns = get_time_ns();
+}
+
+static void finish_pause(garbage_collector_type_t gc, struct GC_COLLECTION*c, struct GC_PAUSES*pauses,
+                         size_t survivors_sizemem)
+{
+    unsigned long long pause = get_time_ns() - c->start_ns;
+
+    pauses->count++;
+    pauses->long_count += (pause > GARBAGE_COLLECTOR_LONG_PAUSE_NS) ? 1 : 0;
+    pauses->total_ns += pause;
+    if (pause > pauses->max_ns) {
+        pauses->max_ns = pause;
     }
 
-    ptrs_map_free(&(gc->ptrs_map));
+    if (gc->stats) {
+        c->pause_ns = pause;
+        c->copied_sizemem = gc->copied_sizemem - c->copied_sizemem;
+        c->copied_num = gc->copied_num - c->copied_num;
+        c->survivors_sizemem = survivors_sizemem;
+        c->heap_after_sizemem = heap_sizemem(gc);
+        PUSH_BACK(gc->collections, *c);
+    }
 }
 
-static void run_gc(garbage_collector_type_t gc, void**ptr, size_t ptr_sizemem)
+/*
+  Minor collection: roots are stack and remembered set,
+  nursery survivors are appended to old generation and scanned there linearly.
+  Caller must check, that old generation can take whole nursery.
+*/
+static void run_minor_gc(garbage_collector_type_t gc, void**ptr)
 {
-    struct ALLOCATOR tmp;
+    struct VALUE*stack = (*(gc->stack));
+    struct VALUE*stack_top = (*(gc->stack_top));
+
+    struct VALUE*val;
+    char*unscanned_ptr = gc->sa.top;
+    size_t promoted_start = SEMISPACE_USED(&(gc->sa));
+    size_t i;
 
-    int need_realloc;
+    struct GC_COLLECTION c;
+    start_pause(gc, &c, GC_COLLECTION_MINOR);
 
     if (gc->trace) {
-        printf("\t<info>GC</info>\n");
+        printf("\t<info>minor GC</info>\n");
     }
 
-    run_gc_inner(gc, ptr);
+    gc->minor = 1;
 
-    /* check if realloc is needed. */
-    need_realloc = ((gc->b.busy_list.sizemem + gc->b.busy_list.count * BLOCK_OVERHEAD) +
-                    (ptr_sizemem + BLOCK_OVERHEAD)) >= gc->b.sizemem / 2;
+    for (val = stack; val != stack_top; val++) {
+        scan_value(gc, val);
+    }
 
-    if (need_realloc) {
-        size_t new_sizemem = (gc->b.sizemem + (ptr_sizemem + BLOCK_OVERHEAD)) * 2;
+    if (ptr != NULL) {
+        (*ptr) = lookup_new_location(gc, *ptr);
+    }
 
-        tmp = gc->a;
-        gc->a = gc->b;
-        gc->b = tmp;
-        
-        allocator_free_pool(&(gc->b));
-        allocator_malloc_pool(&(gc->b), new_sizemem);
+    for (i = 0; i < gc->remembered_len; i++) {
+        scan_block(gc, gc->remembered[i]);
+    }
+    forget_remembered(gc);
 
-        run_gc_inner(gc, ptr);
+    while (unscanned_ptr != gc->sa.top) {
+        struct GC_HEADER*hdr = (struct GC_HEADER*) unscanned_ptr;
+        scan_block(gc, hdr);
+        unscanned_ptr += GC_HEADER_SIZEMEM(hdr);
+    }
+
+    gc->minor = 0;
+
+    semispace_clean_pool(&(gc->nursery));
+
+    finish_pause(gc, &c, &(gc->minor_pauses), SEMISPACE_USED(&(gc->sa)) - promoted_start);
+}
+
+static void out_of_memory(garbage_collector_type_t gc, size_t live, size_t required)
+{
+    fprintf(stderr, "out of memory:\n");
+    fprintf(stderr, "live:       %zu bytes\n", live);
+    fprintf(stderr, "required:   %zu bytes\n", required);
+    fprintf(stderr, "heap limit: %zu bytes\n", gc->max_sizemem);
+    exit(EXIT_FAILURE);
+}
+
+/* frees unmarked large blocks and unmarks others. */
+static void sweep_large(garbage_collector_type_t gc)
+{
+    size_t i, j = 0;
 
-        allocator_free_pool(&(gc->a));
-        allocator_malloc_pool(&(gc->a), new_sizemem);
+    for (i = 0; i < gc->large_len; i++) {
+        struct GC_HEADER*hdr = gc->large[i];
+        if (GC_HEADER_FLAGS(hdr) & GC_FLAG_MARKED) {
+            GC_HEADER_CLEAR_FLAG(hdr, GC_FLAG_MARKED);
+            gc->large[j++] = hdr;
+        } else {
+            free_large_block(gc, hdr);
+        }
     }
+    gc->large_len = j;
+}
 
-    tmp = gc->a;
-    gc->a = gc->b;
-    gc->b = tmp;
+/* checks, if required bytes can be allocated in TO space after collection. */
+static int to_space_has_space(garbage_collector_type_t gc, size_t required)
+{
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+        return required <= SEMISPACE_FREE(&(gc->sb));
+    }
+
+    return allocator_can_malloc_block(&(gc->b), required);
 }
 
-static struct OBJECT*malloc_obj_force(garbage_collector_type_t gc, size_t start_properties_cap, size_t sizemem)
+/* maximum size of one space, which leaves room for nursery and large object space in heap limit (0 means no limit). */
+static size_t space_limit(garbage_collector_type_t gc)
 {
-    struct OBJECT*obj;
-    char*ptr = allocator_malloc_block(&(gc->a), sizemem);
+    size_t reserved;
 
-    ptr[0] = VALUE_TYPE_OBJ;
-    obj = (struct OBJECT*) (ptr + 1);
-    obj->properties_len = 0;
-    obj->properties_cap = start_properties_cap;
-    
-    return obj;
+    if (gc->max_sizemem == 0) {
+        return 0;
+    }
+
+    reserved = gc->nursery.sizemem + gc->large_sizemem + gc->large_required;
+    if (reserved >= gc->max_sizemem) {
+        return 1;
+    }
+
+    /* mark-compact collection has no TO space. */
+    return gc->compacting ? (gc->max_sizemem - reserved) : (gc->max_sizemem - reserved) / 2;
 }
 
-struct OBJECT*garbage_collector_malloc_obj(garbage_collector_type_t gc, size_t start_properties_num)
+/* new size of spaces for live data and required bytes by heap sizing policy. */
+static size_t next_space_sizemem(garbage_collector_type_t gc, size_t sizemem, size_t live, size_t required)
 {
-    size_t start_properties_cap = start_properties_num * 2;
-    size_t sizemem = sizeof(char) + sizeof(struct OBJECT) + sizeof(struct PROPERTY) * start_properties_cap;
-    
-    if ((gc->a.free_list.last != NULL) && (BLOCK_L_DATA_LEN(gc->a.free_list.last) >= (sizemem + BLOCK_OVERHEAD))) {
-        return malloc_obj_force(gc, start_properties_cap, sizemem);
+    double needed = (double) live + (double) required;
+    double new_sizemem;
+    size_t limit = space_limit(gc);
+
+    if ((limit != 0) && (needed > limit)) {
+        out_of_memory(gc, live, required);
+    }
+
+    if ((limit != 0) && (sizemem > limit)) {
+        /* large object space takes memory of spaces. */
+        gc->low_occupancy_count = 0;
+        return limit;
+    }
+
+    if (needed >= gc->target_occupancy * sizemem) {
+        gc->low_occupancy_count = 0;
+
+        new_sizemem = sizemem * gc->growth_factor;
+        if (new_sizemem < needed / gc->target_occupancy) {
+            new_sizemem = needed / gc->target_occupancy;
+        }
+        if ((limit != 0) && (new_sizemem > limit)) {
+            new_sizemem = limit;
+        }
+
+        return (size_t) new_sizemem;
     }
 
-    /* need garbage collection. */
-    run_gc(gc, NULL, sizemem);
+    if (needed * gc->growth_factor * gc->growth_factor >= gc->target_occupancy * sizemem) {
+        gc->low_occupancy_count = 0;
+        return sizemem;
+    }
 
-    return malloc_obj_force(gc, start_properties_cap, sizemem);
+    gc->low_occupancy_count++;
+    if ((gc->low_occupancy_count < gc->shrink_after) || (sizemem <= gc->min_space_sizemem)) {
+        return sizemem;
+    }
+
+    gc->low_occupancy_count = 0;
+
+    new_sizemem = sizemem / gc->growth_factor;
+    if (new_sizemem < gc->min_space_sizemem) {
+        new_sizemem = gc->min_space_sizemem;
+    }
+
+    return (size_t) new_sizemem;
 }
 
-static void change_vals_ptr(struct VALUE*val, char*prev_ptr, char*new_ptr)
+/* scans TO space for at most budget_ns nanoseconds since start (0 means no limit); returns 1, if all is scanned. */
+static int scan_to_space(garbage_collector_type_t gc, unsigned long long start, unsigned long long budget_ns)
 {
-    if ((val->type == VALUE_TYPE_OBJ) &&
-        (val->obj_val == (struct OBJECT*) (prev_ptr + 1))) {
-        val->obj_val = (struct OBJECT*) (new_ptr + 1);
-    } else if ((val->type == VALUE_TYPE_ARR) &&
-               (val->arr_val == (struct ARRAY*) (prev_ptr + 1))) {
-        val->arr_val = (struct ARRAY*) (new_ptr + 1);
+    size_t n = 0;
+
+    while (gc->unscanned != gc->sb.top) {
+        struct GC_HEADER*hdr = (struct GC_HEADER*) gc->unscanned;
+        scan_block(gc, hdr);
+        gc->unscanned += GC_HEADER_SIZEMEM(hdr);
+
+        if ((budget_ns != 0) && ((++n % GARBAGE_COLLECTOR_STEP_BLOCKS) == 0) && (get_time_ns() - start >= budget_ns)) {
+            return 0;
+        }
     }
+
+    return 1;
 }
 
-static void change_one_ptr(garbage_collector_type_t gc, char*prev_ptr, char*new_ptr)
+static void finish_cycle(garbage_collector_type_t gc)
+{
+    scan_to_space(gc, 0, 0);
+    sweep_large(gc);
+
+    gc->cycle = 0;
+    gc->live_sizemem = SEMISPACE_USED(&(gc->sb));
+
+    /* idle space is not released: it costs milliseconds for big heaps, and next cycle reuses it. */
+    swap_pools(gc);
+
+    if (gc->trace) {
+        printf("\t<info>incremental GC end</info>\n");
+    }
+}
+
+/* flips spaces and evacuates roots; ptr is additional root. */
+static void start_cycle(garbage_collector_type_t gc, void**ptr, size_t required)
 {
     struct VALUE*stack = (*(gc->stack));
     struct VALUE*stack_top = (*(gc->stack_top));
-
     struct VALUE*val;
-    
-    void*cur;
+
+    size_t used = SEMISPACE_USED(&(gc->sa));
+    size_t sizemem = next_space_sizemem(gc, gc->sa.sizemem, gc->live_sizemem, required);
+    size_t limit = space_limit(gc);
+
+    /* everything from FROM space and required bytes must fit into TO space, rest of it is for new blocks. */
+    if (sizemem < used + required) {
+        sizemem = 2 * (used + required);
+        if ((limit != 0) && (sizemem > limit)) {
+            sizemem = limit;
+        }
+        if (sizemem < used + required) {
+            out_of_memory(gc, used, required);
+        }
+    }
+
+    if (gc->trace) {
+        printf("\t<info>incremental GC start</info>\n");
+    }
+
+    /* fresh pages fault during copying, so TO space is reused, while it is big enough and not too big. */
+    if ((gc->sb.sizemem < sizemem) || (gc->sb.sizemem / 2 > sizemem)) {
+        free_pool(gc, 1);
+        malloc_pool(gc, 1, sizemem);
+    } else {
+        semispace_clean_pool(&(gc->sb));
+    }
+
+    gc->cycle = 1;
+    gc->unscanned = gc->sb.mem;
+    gc->cycle_remaining = used;
+    gc->step_allocated = 0;
 
     for (val = stack; val != stack_top; val++) {
-        change_vals_ptr(val, prev_ptr, new_ptr);
+        scan_value(gc, val);
     }
 
-    cur = gc->a.busy_list.first;
+    if (ptr != NULL) {
+        (*ptr) = lookup_new_location(gc, *ptr);
+    }
+}
 
-    while (cur != NULL) {
-        size_t i;
-        char*ptr = BLOCK_DATA(cur);
-        if (ptr[0] == VALUE_TYPE_OBJ) {
-            struct OBJECT*obj = (struct OBJECT*) (ptr + 1);
-            for (i = 0; i < obj->properties_len; i++) {
-                val = &(obj->properties[i].val);
-                change_vals_ptr(val, prev_ptr, new_ptr);
-            }
-        } else if (ptr[0] == VALUE_TYPE_ARR) {
-            size_t i;
-            struct ARRAY*arr = (struct ARRAY*) (ptr + 1);
-            for (i = 0; i < arr->len; i++) {
-                val = &(arr->values[i]);
-                change_vals_ptr(val, prev_ptr, new_ptr);
-            }
+/* makes step of incremental collection, if enough bytes were allocated since previous one. */
+static void step_cycle(garbage_collector_type_t gc, size_t allocated)
+{
+    size_t step_sizemem = gc->sb.sizemem / 8;
+    struct GC_COLLECTION c;
+
+    if (step_sizemem > GARBAGE_COLLECTOR_STEP_SIZEMEM) {
+        step_sizemem = GARBAGE_COLLECTOR_STEP_SIZEMEM;
+    }
+
+    gc->step_allocated += allocated;
+    if (gc->step_allocated < step_sizemem) {
+        return;
+    }
+    gc->step_allocated = 0;
+
+    start_pause(gc, &c, GC_COLLECTION_INCREMENTAL);
+    if (scan_to_space(gc, c.start_ns, gc->pause_budget_ns)) {
+        finish_cycle(gc);
+    }
+    finish_pause(gc, &c, &(gc->incremental_pauses), gc->cycle ? 0 : gc->live_sizemem);
+}
+
+/*
+  Mark-compact collection: when space is resized, marked blocks slide to new space,
+  so for a moment two spaces exist, as in copying collection.
+*/
+static void run_compacting_gc(garbage_collector_type_t gc, void**ptr, size_t required)
+{
+    size_t sizemem = gc->sa.sizemem;
+    size_t new_sizemem, live;
+
+    struct GC_COLLECTION c;
+    start_pause(gc, &c, GC_COLLECTION_MAJOR);
+
+    if (gc->trace) {
+        printf("\t<info>GC</info>\n");
+    }
+
+    live = compact_mark(gc, ptr);
+
+    /* large blocks are marked, so their memory is known before resize. */
+    sweep_large(gc);
+
+    new_sizemem = next_space_sizemem(gc, sizemem, live, required);
+
+    if (new_sizemem != sizemem) {
+        struct SEMISPACE space;
+
+        if (gc->trace) {
+            printf("\t<info>heap resize: %zu -> %zu bytes</info>\n", sizemem, new_sizemem);
         }
-        cur = BLOCK_LIST_NEXT(cur);
+
+        semispace_malloc_pool(&space, new_sizemem, gc->huge_pages);
+        compact_slide(gc, ptr, &space);
+        semispace_free_pool(&(gc->sa));
+        gc->sa = space;
+    } else {
+        compact_slide(gc, ptr, &(gc->sa));
+    }
+
+    if (required > SEMISPACE_FREE(&(gc->sa))) {
+        out_of_memory(gc, live, required);
     }
+
+    gc->live_sizemem = live;
+
+    finish_pause(gc, &c, &(gc->major_pauses), live);
 }
 
-static struct OBJECT*realloc_obj_force(garbage_collector_type_t gc,
-                                       struct OBJECT*obj,
-                                       size_t new_properties_cap, size_t sizemem)
+/* collects garbage, so that at least required bytes are free; ptr is additional root. */
+static void run_gc(garbage_collector_type_t gc, void**ptr, size_t required)
 {
-    char*prev_ptr = ((char*) obj) - 1;
-    char*new_ptr = allocator_realloc_block(&(gc->a), prev_ptr, sizemem);
+    size_t sizemem, new_sizemem, live;
 
-    change_one_ptr(gc, prev_ptr, new_ptr);
-    obj = (struct OBJECT*) (new_ptr + 1);
-    obj->properties_cap = new_properties_cap;
+    struct GC_COLLECTION c;
 
-    return obj;
+    if (gc->compacting) {
+        run_compacting_gc(gc, ptr, required);
+        return;
+    }
+
+    start_pause(gc, &c, GC_COLLECTION_MAJOR);
+
+    if (gc->incremental) {
+        if (gc->cycle) {
+            finish_cycle(gc);
+        }
+        /* spaces may have different sizes after incremental collection. */
+        if (gc->sb.sizemem != gc->sa.sizemem) {
+            free_pool(gc, 1);
+            malloc_pool(gc, 1, gc->sa.sizemem);
+        }
+    }
+
+    if (gc->trace) {
+        printf(gc->generational ? "\t<info>major GC</info>\n" : "\t<info>GC</info>\n");
+    }
+
+    if (gc->generational) {
+        /* every pointer from old generation to nursery is updated by major collection. */
+        forget_remembered(gc);
+
+        /* old generation must be able to take whole nursery at next minor collection and keep headroom. */
+        required += 2 * gc->nursery.sizemem;
+    }
+
+    run_gc_inner(gc, ptr);
+
+    /* large blocks are marked, so their memory is known before resize. */
+    sweep_large(gc);
+
+    /* check if resize is needed. */
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) {
+        sizemem = gc->sb.sizemem;
+        live = SEMISPACE_USED(&(gc->sb));
+        if (is_parallel(gc, sizemem)) {
+            required = PARALLEL_TO_SPACE_SIZEMEM(live + required, gc->threads_num) - live;
+        }
+    } else {
+        sizemem = gc->b.sizemem;
+        live = gc->b.busy_sizemem;
+    }
+
+    new_sizemem = next_space_sizemem(gc, sizemem, live, required);
+
+    if (new_sizemem != sizemem) {
+        if (gc->trace) {
+            printf("\t<info>heap resize: %zu -> %zu bytes</info>\n", sizemem, new_sizemem);
+        }
+
+        /* live data are copied once more, old FROM space is freed first, so only two spaces exist at once. */
+        swap_pools(gc);
+        
+        free_pool(gc, 1);
+        malloc_pool(gc, 1, new_sizemem);
+
+        run_gc_inner(gc, ptr);
+
+        /* nothing is freed, marks of second copying are cleared. */
+        sweep_large(gc);
+
+        free_pool(gc, 0);
+        malloc_pool(gc, 0, new_sizemem);
+    }
+
+    if (!to_space_has_space(gc, required)) {
+        out_of_memory(gc, live, required);
+    }
+
+    swap_pools(gc);
+
+    gc->live_sizemem = live;
+
+    /*
+      Evacuated FROM space is idle until next collection, so it doesn't need physical memory.
+      Released pages are faulted in again by next allocations, so small spaces are kept.
+    */
+    if (new_sizemem >= GARBAGE_COLLECTOR_RELEASE_SIZEMEM) {
+        release_pool(gc, 1);
+    }
+
+    if (gc->generational) {
+        semispace_clean_pool(&(gc->nursery));
+    }
+
+    finish_pause(gc, &c, &(gc->major_pauses), live);
 }
 
-struct OBJECT*garbage_collector_realloc_obj(garbage_collector_type_t gc, struct OBJECT*obj, size_t new_properties_num)
+/* large blocks are freed only by major collection, so it is started, when large object space grows too much. */
+static int reserve_large(garbage_collector_type_t gc, void**ptr, size_t required, size_t large_required)
 {
-    size_t new_properties_cap = new_properties_num * 2;
-    size_t sizemem = sizeof(char) + sizeof(struct OBJECT) + sizeof(struct PROPERTY) * new_properties_cap;
+    size_t space_sizemem;
 
-    if ((gc->a.free_list.last != NULL) && (BLOCK_L_DATA_LEN(gc->a.free_list.last) >= (sizemem + BLOCK_OVERHEAD))) {
-        return realloc_obj_force(gc, obj, new_properties_cap, sizemem);
+    if ((large_required == 0) || (gc->large_sizemem + large_required <= gc->large_limit)) {
+        return 0;
     }
 
-    /* need garbage collection. */
-    run_gc(gc, (void**) &obj, sizemem);
+    gc->large_required = large_required;
+    run_gc(gc, ptr, (gc->generational && !gc->pretenure) ? 0 : required);
+    gc->large_required = 0;
+
+    gc->large_limit = (size_t) ((gc->large_sizemem + large_required) * gc->growth_factor);
+    if (gc->large_limit < gc->min_space_sizemem) {
+        gc->large_limit = gc->min_space_sizemem;
+    }
 
-    return realloc_obj_force(gc, obj, new_properties_cap, sizemem);
+    space_sizemem = (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_BUMP) ? gc->sa.sizemem : gc->a.sizemem;
+    if ((gc->max_sizemem != 0) &&
+        ((gc->compacting ? 1 : 2) * space_sizemem + gc->nursery.sizemem + gc->large_sizemem + large_required > gc->max_sizemem)) {
+        out_of_memory(gc, gc->large_sizemem, large_required);
+    }
+
+    return 1;
 }
 
-void garbage_collector_free(garbage_collector_type_t gc)
+/*
+  Makes sure, that required bytes can be allocated by malloc_block in FROM space
+  and large_required bytes in large object space; ptr is additional root.
+*/
+static void reserve(garbage_collector_type_t gc, void**ptr, size_t required, size_t large_required)
 {
-    allocator_free_pool(&(gc->a));
-    allocator_free_pool(&(gc->b));
-    SAFE_FREE(gc);
+    struct GC_COLLECTION c;
+
+    if (gc->incremental) {
+        if (reserve_large(gc, ptr, required, large_required)) {
+            return;
+        }
+
+        if (gc->cycle) {
+            step_cycle(gc, required);
+        }
+        if (has_space(gc, required)) {
+            return;
+        }
+
+        if (gc->cycle) {
+            /* mutator allocates faster, than TO space is scanned. */
+            start_pause(gc, &c, GC_COLLECTION_INCREMENTAL);
+            finish_cycle(gc);
+            finish_pause(gc, &c, &(gc->incremental_pauses), gc->live_sizemem);
+            if (has_space(gc, required)) {
+                return;
+            }
+        }
+
+        start_pause(gc, &c, GC_COLLECTION_INCREMENTAL);
+        start_cycle(gc, ptr, required);
+        finish_pause(gc, &c, &(gc->incremental_pauses), 0);
+        return;
+    }
+
+    if (gc->generational) {
+        /* blocks, which don't fit into nursery, are allocated in old generation. */
+        gc->pretenure = required > gc->nursery.sizemem;
+
+        if (reserve_large(gc, ptr, required, large_required) || has_space(gc, required)) {
+            return;
+        }
+
+        if (!gc->pretenure &&
+            (SEMISPACE_USED(&(gc->nursery)) + gc->nursery.sizemem <= SEMISPACE_FREE(&(gc->sa)))) {
+            run_minor_gc(gc, ptr);
+        } else {
+            run_gc(gc, ptr, gc->pretenure ? required : 0);
+        }
+        return;
+    }
+
+    if (!reserve_large(gc, ptr, required, large_required) && !has_space(gc, required)) {
+        /* need garbage collection. */
+        run_gc(gc, ptr, required);
+    }
 }
 
-static struct ARRAY*malloc_arr_force(garbage_collector_type_t gc, size_t start_cap, size_t sizemem)
+void garbage_collector_read_barrier(garbage_collector_type_t gc, struct VALUE*val)
 {
-    struct ARRAY*arr;
-    char*ptr = allocator_malloc_block(&(gc->a), sizemem);
-    ptr[0] = VALUE_TYPE_ARR;
-    arr = (struct ARRAY*) (ptr + 1);
-    arr->len = 0;
-    arr->cap = start_cap;
-    
-    return arr;
+    scan_value(gc, val);
 }
 
-struct ARRAY*garbage_collector_malloc_arr(garbage_collector_type_t gc, size_t arr_len)
+void garbage_collector_remember(garbage_collector_type_t gc, void*owner)
 {
-    size_t start_arr_cap = arr_len * 2;
-    size_t sizemem = sizeof(char) + sizeof(struct ARRAY) + sizeof(struct VALUE) * start_arr_cap;
-    
-    if ((gc->a.free_list.last != NULL) && (BLOCK_L_DATA_LEN(gc->a.free_list.last) >= (sizemem + BLOCK_OVERHEAD))) {
-        return malloc_arr_force(gc, start_arr_cap, sizemem);
+    struct GC_HEADER*hdr = GC_HEADER_FROM_PTR(owner);
+
+    if (IN_SEMISPACE(&(gc->nursery), owner) || (GC_HEADER_FLAGS(hdr) & GC_FLAG_REMEMBERED)) {
+        return;
+    }
+
+    GC_HEADER_SET_FLAG(hdr, GC_FLAG_REMEMBERED);
+    PUSH_BACK(gc->remembered, hdr);
+}
+
+#define OBJECT_SIZEMEM        SEMISPACE_ALIGN_SIZEMEM(sizeof(struct GC_HEADER) + sizeof(struct OBJECT))
+#define ARRAY_SIZEMEM         SEMISPACE_ALIGN_SIZEMEM(sizeof(struct GC_HEADER) + sizeof(struct ARRAY))
+#define PROPERTIES_SIZEMEM(n) SEMISPACE_ALIGN_SIZEMEM(sizeof(struct GC_HEADER) + sizeof(struct VALUE) * (n))
+#define VALUES_SIZEMEM(n)     SEMISPACE_ALIGN_SIZEMEM(sizeof(struct GC_HEADER) + sizeof(struct VALUE) * (n))
+
+struct OBJECT*garbage_collector_malloc_obj(garbage_collector_type_t gc, struct SHAPE*shape)
+{
+    size_t start_properties_cap = shape->len * 2;
+    size_t required = required_sizemem(gc, OBJECT_SIZEMEM, 1);
+    size_t large_required = 0;
+
+    struct OBJECT*obj;
+
+    if (start_properties_cap != 0) {
+        required += store_required_sizemem(gc, PROPERTIES_SIZEMEM(start_properties_cap));
+        large_required = store_large_sizemem(PROPERTIES_SIZEMEM(start_properties_cap));
+    }
+
+    gc->trigger = GC_TRIGGER_MALLOC_OBJ;
+    reserve(gc, NULL, required, large_required);
+
+    /* object and its store are allocated together, so GC can't happen between them. */
+    obj = malloc_block(gc, GC_BLOCK_OBJ, OBJECT_SIZEMEM);
+    obj->shape = shape;
+    obj->properties_cap = start_properties_cap;
+    obj->properties = (start_properties_cap == 0) ? NULL :
+        malloc_block(gc, GC_BLOCK_PROPERTIES, PROPERTIES_SIZEMEM(start_properties_cap));
+
+    if (gc->generational) {
+        /* pretenured object will be initialized by values from nursery. */
+        garbage_collector_remember(gc, obj);
     }
 
-    /* need garbage collection. */
-    run_gc(gc, NULL, sizemem);
+    return obj;
+}
 
-    return malloc_arr_force(gc, start_arr_cap, sizemem);
+struct OBJECT*garbage_collector_realloc_obj(garbage_collector_type_t gc, struct OBJECT*obj, size_t new_properties_num)
+{
+    size_t new_properties_cap = new_properties_num * 2;
+    size_t i;
+    size_t required = store_required_sizemem(gc, PROPERTIES_SIZEMEM(new_properties_cap));
+
+    struct VALUE*properties;
+
+    gc->trigger = GC_TRIGGER_REALLOC_OBJ;
+    reserve(gc, (void**) &obj, required, store_large_sizemem(PROPERTIES_SIZEMEM(new_properties_cap)));
+
+    /* only backing store is moved, so nobody has to know about it except object. */
+    properties = malloc_block(gc, GC_BLOCK_PROPERTIES, PROPERTIES_SIZEMEM(new_properties_cap));
+    if (obj->properties != NULL) {
+        memcpy(properties, obj->properties, sizeof(struct VALUE) * obj->shape->len);
+        free_block(gc, obj->properties);
+    }
+    if (gc->cycle) {
+        /* new store may be never scanned, so it must not point to FROM space. */
+        for (i = 0; i < obj->shape->len; i++) {
+            scan_value(gc, &(properties[i]));
+        }
+    }
+    obj->properties = properties;
+    obj->properties_cap = new_properties_cap;
+
+    if (gc->generational) {
+        /* old object may get store in nursery. */
+        garbage_collector_remember(gc, obj);
+    }
+
+    return obj;
 }
 
-static struct ARRAY*realloc_arr_force(garbage_collector_type_t gc,
-                                       struct ARRAY*arr,
-                                       size_t new_arr_cap, size_t sizemem)
+struct ARRAY*garbage_collector_malloc_arr(garbage_collector_type_t gc, size_t arr_len)
 {
-    char*prev_ptr = ((char*) arr) - 1;
-    char*new_ptr = allocator_realloc_block(&(gc->a), prev_ptr, sizemem);
+    size_t start_arr_cap = arr_len * 2;
+    size_t required = required_sizemem(gc, ARRAY_SIZEMEM, 1);
+    size_t large_required = 0;
+
+    struct ARRAY*arr;
+
+    if (start_arr_cap != 0) {
+        required += store_required_sizemem(gc, VALUES_SIZEMEM(start_arr_cap));
+        large_required = store_large_sizemem(VALUES_SIZEMEM(start_arr_cap));
+    }
+
+    gc->trigger = GC_TRIGGER_MALLOC_ARR;
+    reserve(gc, NULL, required, large_required);
+
+    /* array and its store are allocated together, so GC can't happen between them. */
+    arr = malloc_block(gc, GC_BLOCK_ARR, ARRAY_SIZEMEM);
+    arr->len = 0;
+    arr->cap = start_arr_cap;
+    arr->values = (start_arr_cap == 0) ? NULL :
+        malloc_block(gc, GC_BLOCK_VALUES, VALUES_SIZEMEM(start_arr_cap));
+
+    if (gc->generational) {
+        /* pretenured array will be initialized by values from nursery. */
+        garbage_collector_remember(gc, arr);
+    }
 
-    change_one_ptr(gc, prev_ptr, new_ptr);
-    arr = (struct ARRAY*) (new_ptr + 1);
-    arr->cap = new_arr_cap;
-    
     return arr;
 }
 
 struct ARRAY*garbage_collector_realloc_arr(garbage_collector_type_t gc, struct ARRAY*arr, size_t new_arr_len)
 {
     size_t new_arr_cap = new_arr_len * 2;
-    size_t sizemem = sizeof(struct ARRAY) + sizeof(struct VALUE) * new_arr_cap;
+    size_t i;
+    size_t required = store_required_sizemem(gc, VALUES_SIZEMEM(new_arr_cap));
+
+    struct VALUE*values;
+
+    gc->trigger = GC_TRIGGER_REALLOC_ARR;
+    reserve(gc, (void**) &arr, required, store_large_sizemem(VALUES_SIZEMEM(new_arr_cap)));
+
+    /* only backing store is moved, so nobody has to know about it except array. */
+    values = malloc_block(gc, GC_BLOCK_VALUES, VALUES_SIZEMEM(new_arr_cap));
+    if (arr->values != NULL) {
+        memcpy(values, arr->values, sizeof(struct VALUE) * arr->len);
+        free_block(gc, arr->values);
+    }
+    if (gc->cycle) {
+        /* new store may be never scanned, so it must not point to FROM space. */
+        for (i = 0; i < arr->len; i++) {
+            scan_value(gc, &(values[i]));
+        }
+    }
+    arr->values = values;
+    arr->cap = new_arr_cap;
 
-    if ((gc->a.free_list.last != NULL) && (BLOCK_L_DATA_LEN(gc->a.free_list.last) >= (sizemem + BLOCK_OVERHEAD))) {
-        return realloc_arr_force(gc, arr, new_arr_cap, sizemem);
+    if (gc->generational) {
+        /* old array may get store in nursery. */
+        garbage_collector_remember(gc, arr);
     }
 
-    /* need garbage collection. */
-    run_gc(gc, (void**) &arr, sizemem);
+    return arr;
+}
+
+void garbage_collector_collect(garbage_collector_type_t gc)
+{
+    gc->trigger = GC_TRIGGER_COLLECT;
+    run_gc(gc, NULL, 0);
+}
 
-    return realloc_arr_force(gc, arr, new_arr_cap, sizemem);
+void garbage_collector_free(garbage_collector_type_t gc)
+{
+    free_pool(gc, 0);
+    if (!gc->compacting) {
+        free_pool(gc, 1);
+    }
+    if (gc->generational) {
+        semispace_free_pool(&(gc->nursery));
+    }
+    while (gc->large_len != 0) {
+        free_large_block(gc, gc->large[--gc->large_len]);
+    }
+    SAFE_FREE(gc->large);
+    SAFE_FREE(gc->remembered);
+    SAFE_FREE(gc->collections);
+    SAFE_FREE(gc);
 }
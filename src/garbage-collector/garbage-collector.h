@@ -4,19 +4,246 @@
 #include "data-types.h"
 
 #include "allocator.h"
-#include "ptrs-map.h"
+#include "semispace.h"
+#include "pages.h"
 
 #include <string.h>
 
+/*
+  Every heap block is prefixed by header:
+  [forward][info][data...], where
+  [forward] is new location of block in TO space and is NULL, until block is evacuated,
+  [info] contains type of block (bits 0-7), flags (bits 8-15) and size of block with header in bytes (other bits),
+  so forwarding is O(1) and copying is linear in live data.
+*/
+
+struct GC_HEADER
+{
+    void*forward;
+    size_t info;
+};
+
+enum GC_BLOCK_TYPE
+{
+    GC_BLOCK_OBJ,        /* OBJECT.                     */
+    GC_BLOCK_ARR,        /* ARRAY.                      */
+    GC_BLOCK_PROPERTIES, /* backing store of OBJECT.    */
+    GC_BLOCK_VALUES,     /* backing store of ARRAY.     */
+};
+
+#define GC_FLAG_REMEMBERED 0x01 /* block is in remembered set.           */
+#define GC_FLAG_LARGE      0x02 /* block is in large object space.       */
+#define GC_FLAG_MARKED     0x04 /* block is reachable (major GC).         */
+
+#define GC_HEADER_INFO(type, sizemem)    ((((size_t) (sizemem)) << 16) | ((size_t) (type)))
+#define GC_HEADER_TYPE(hdr)              ((enum GC_BLOCK_TYPE) ((hdr)->info & 0xFF))
+#define GC_HEADER_FLAGS(hdr)             (((hdr)->info >> 8) & 0xFF)
+#define GC_HEADER_SIZEMEM(hdr)           ((hdr)->info >> 16)
+#define GC_HEADER_SET_FLAG(hdr, flag)    ((hdr)->info |= (((size_t) (flag)) << 8))
+#define GC_HEADER_CLEAR_FLAG(hdr, flag)  ((hdr)->info &= ~(((size_t) (flag)) << 8))
+
+#define GC_HEADER_FROM_PTR(ptr) ((struct GC_HEADER*) (((char*) (ptr)) - sizeof(struct GC_HEADER)))
+#define GC_PTR_FROM_HEADER(hdr) ((void*) (((char*) (hdr)) + sizeof(struct GC_HEADER)))
+
+enum GARBAGE_COLLECTOR_ALLOCATION
+{
+    GARBAGE_COLLECTOR_ALLOCATION_FREE_LIST, /* boundary-tag allocator with free list. */
+    GARBAGE_COLLECTOR_ALLOCATION_BUMP,      /* bump-pointer semispaces.              */
+};
+
+/*
+  Blocks of at least this size (in practice backing stores of big arrays and objects)
+  are mapped separately and are never copied.
+*/
+#define GARBAGE_COLLECTOR_LARGE_SIZEMEM ((size_t) 32 * 1024)
+
+/*
+  Incremental collection makes step of TO space scanning after every
+  GARBAGE_COLLECTOR_STEP_SIZEMEM allocated bytes (or 1/8 of smaller TO space),
+  time is checked after every GARBAGE_COLLECTOR_STEP_BLOCKS scanned blocks.
+*/
+#define GARBAGE_COLLECTOR_STEP_SIZEMEM ((size_t) 16 * 1024)
+#define GARBAGE_COLLECTOR_STEP_BLOCKS  64
+
+/* collection with several threads is used, when FROM space has at least this number of used bytes. */
+#define GARBAGE_COLLECTOR_PARALLEL_SIZEMEM ((size_t) 1024 * 1024)
+
+/* pauses longer than this are counted separately to estimate tail latency. */
+#define GARBAGE_COLLECTOR_LONG_PAUSE_NS 1000000ULL
+
+/* idle spaces of at least this size are given back to OS between collections. */
+#define GARBAGE_COLLECTOR_RELEASE_SIZEMEM ((size_t) 16 * 1024 * 1024)
+
+struct GARBAGE_COLLECTOR_PARAMS
+{
+    size_t sizemem_start;
+    enum GARBAGE_COLLECTOR_ALLOCATION allocation;
+
+    /* generational mode always uses bump-pointer allocation. */
+    int generational;
+    size_t nursery_sizemem;
+
+    /*
+      Heap sizing policy: after collection space grows by growth_factor (or more),
+      if live data exceed target_occupancy of it, and shrinks by growth_factor
+      after shrink_after collections in a row with occupancy below target_occupancy / growth_factor^2.
+      Heap (both spaces and nursery) never exceeds max_sizemem bytes (0 means no limit).
+    */
+    double target_occupancy;
+    double growth_factor;
+    unsigned shrink_after;
+    size_t max_sizemem;
+
+    /* pools bigger than PAGES_HUGE_SIZE are backed by transparent huge pages. */
+    int huge_pages;
+
+    /*
+      Incremental collection with at most pause_budget_ns nanoseconds per step (0 disables it);
+      it always uses bump-pointer allocation and isn't generational.
+    */
+    unsigned long long pause_budget_ns;
+
+    /* mark-compact collection of one space instead of copying (forces bump-pointer allocation). */
+    int compacting;
+
+    /* number of threads, which evacuate big heaps in bump-pointer mode without generations and increments. */
+    size_t threads_num;
+
+    /* every pause is logged in collections of garbage collector. */
+    int stats;
+};
+
+void garbage_collector_default_params(struct GARBAGE_COLLECTOR_PARAMS*params);
+
+/* allocation, which has started collection. */
+enum GC_TRIGGER
+{
+    GC_TRIGGER_MALLOC_OBJ,
+    GC_TRIGGER_MALLOC_ARR,
+    GC_TRIGGER_REALLOC_OBJ,
+    GC_TRIGGER_REALLOC_ARR,
+    GC_TRIGGER_COLLECT,     /* garbage_collector_collect. */
+};
+
+enum GC_COLLECTION_KIND
+{
+    GC_COLLECTION_MAJOR,       /* whole heap is copied or compacted.         */
+    GC_COLLECTION_MINOR,       /* nursery is evacuated to old generation.    */
+    GC_COLLECTION_INCREMENTAL, /* flip, step or end of incremental collection. */
+};
+
+/*
+  One pause of mutator. Copied blocks include moved by compaction,
+  survivors are live bytes after pause (0 in the middle of incremental collection),
+  heap is all spaces with nursery and large object space.
+*/
+struct GC_COLLECTION
+{
+    enum GC_COLLECTION_KIND kind;
+    enum GC_TRIGGER trigger;
+    unsigned long long start_ns;
+    unsigned long long pause_ns;
+    size_t copied_sizemem;
+    size_t copied_num;
+    size_t survivors_sizemem;
+    size_t heap_before_sizemem;
+    size_t heap_after_sizemem;
+};
+
+struct GC_PAUSES
+{
+    size_t count;
+    size_t long_count;
+    unsigned long long total_ns;
+    unsigned long long max_ns;
+};
+
 struct GARBAGE_COLLECTOR
 {
     struct VALUE**stack;
     struct VALUE**stack_top;
 
+    enum GARBAGE_COLLECTOR_ALLOCATION allocation;
+
+    /* FROM (a) and TO (b) spaces for free-list allocation. */
     struct ALLOCATOR a;
     struct ALLOCATOR b;
 
-    struct PTRS_MAP ptrs_map;
+    /* FROM (sa) and TO (sb) spaces for bump-pointer allocation. */
+    struct SEMISPACE sa;
+    struct SEMISPACE sb;
+
+    /*
+      In generational mode new blocks are allocated in nursery,
+      survivors of minor collection are promoted to old generation (sa),
+      and major collection copies both generations from sa to sb.
+      Old blocks, which may point to nursery, are kept in remembered set.
+    */
+    int generational;
+    struct SEMISPACE nursery;
+
+    struct GC_HEADER**remembered;
+    size_t remembered_len;
+    size_t remembered_cap;
+
+    /*
+      Large object space: reachable large blocks are only marked by major collection,
+      the others are unmapped. Major collection is started, when large_sizemem would exceed large_limit.
+    */
+    struct GC_HEADER**large;
+    size_t large_len;
+    size_t large_cap;
+    size_t large_sizemem;
+    size_t large_limit;
+    size_t large_required; /* large block, for which major collection is running. */
+
+    /*
+      Incremental collection (Baker): when half of FROM space is used, spaces are flipped,
+      but only roots are evacuated at once. New blocks are allocated in TO space and
+      TO space is scanned step by step during allocations, until all reachable blocks are copied.
+      Read barrier evacuates every block, which is loaded by mutator, so mutator sees only TO space.
+      TO space always keeps room for all not yet copied blocks of FROM space, so copying can't fail.
+    */
+    size_t threads_num;
+
+    int compacting; /* one space is compacted by compact_mark and compact_slide, sb isn't used. */
+
+    int incremental;
+    int cycle;                         /* incremental collection is in progress.     */
+    unsigned long long pause_budget_ns;
+    char*unscanned;                    /* next block of TO space to scan.            */
+    size_t cycle_remaining;            /* FROM space bytes, which may be copied yet.  */
+    size_t step_allocated;             /* bytes allocated since last step.           */
+    size_t live_sizemem;               /* TO space bytes at the end of last cycle.   */
+
+    int minor;    /* minor collection is in progress.                  */
+    int pretenure; /* next blocks are allocated directly in old generation. */
+
+    int huge_pages;
+
+    /* heap sizing policy (sizes are for one space). */
+    size_t min_space_sizemem;
+    size_t max_sizemem;
+    double target_occupancy;
+    double growth_factor;
+    unsigned shrink_after;
+    unsigned low_occupancy_count;
+
+    struct GC_PAUSES minor_pauses;
+    struct GC_PAUSES major_pauses;
+    struct GC_PAUSES incremental_pauses;
+
+    /*
+      Every copied block is counted (also by read barrier), and with stats every pause is logged
+      in collections; log isn't kept by default, because incremental collection makes a lot of pauses.
+    */
+    size_t copied_sizemem;
+    size_t copied_num;
+    enum GC_TRIGGER trigger;
+    int stats;
+    struct GC_COLLECTION*collections;
+    size_t collections_len;
+    size_t collections_cap;
 
     int trace;
 };
@@ -25,14 +252,46 @@ typedef struct GARBAGE_COLLECTOR* garbage_collector_type_t;
 
 garbage_collector_type_t create_garbage_collector();
 
-void garbage_collector_conf(garbage_collector_type_t gc, size_t sizemem_start, struct VALUE**stack, struct VALUE**stack_top, int trace);
+void garbage_collector_conf(garbage_collector_type_t gc, const struct GARBAGE_COLLECTOR_PARAMS*params,
+                            struct VALUE**stack, struct VALUE**stack_top, int trace);
 
-struct OBJECT*garbage_collector_malloc_obj(garbage_collector_type_t gc, size_t start_properties_num);
+/* values of object's properties must be initialized by caller before next allocation. */
+struct OBJECT*garbage_collector_malloc_obj(garbage_collector_type_t gc, struct SHAPE*shape);
 struct OBJECT*garbage_collector_realloc_obj(garbage_collector_type_t gc, struct OBJECT*obj, size_t new_properties_num);
 
 struct ARRAY*garbage_collector_malloc_arr(garbage_collector_type_t gc, size_t arr_len);
 struct ARRAY*garbage_collector_realloc_arr(garbage_collector_type_t gc, struct ARRAY*arr, size_t new_arr_len);
 
+void garbage_collector_remember(garbage_collector_type_t gc, void*owner);
+
+void garbage_collector_read_barrier(garbage_collector_type_t gc, struct VALUE*val);
+
+/*
+  Write barrier must be used after every store of value into object or array,
+  so pointers from old generation to nursery are remembered.
+*/
+#define GARBAGE_COLLECTOR_WRITE_BARRIER(gc, owner, val)                 \
+    do {                                                                \
+        if ((gc)->generational &&                                       \
+            ((VALUE_GET_TYPE(val) == VALUE_TYPE_OBJ) ||                 \
+             (VALUE_GET_TYPE(val) == VALUE_TYPE_ARR))) {                \
+            garbage_collector_remember((gc), (owner));                  \
+        }                                                               \
+    } while (0)
+
+/*
+  Read barrier must be used before every load of value from object or array,
+  so incremental collection evacuates block, which value points to.
+*/
+#define GARBAGE_COLLECTOR_READ_BARRIER(gc, val)                         \
+    do {                                                                \
+        if ((gc)->cycle) {                                              \
+            garbage_collector_read_barrier((gc), (val));                \
+        }                                                               \
+    } while (0)
+
+void garbage_collector_collect(garbage_collector_type_t gc);
+
 void garbage_collector_free(garbage_collector_type_t gc);
 
 #endif  /* GARBAGE_COLLECTOR_H_INCLUDED */
@@ -0,0 +1,93 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _DEFAULT_SOURCE
+#define PAGES_MMAP
+#endif
+
+#include "pages.h"
+
+#include "utils.h"
+
+#ifdef PAGES_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#include <stdint.h>
+
+static size_t pages_round(size_t sizemem)
+{
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    return (sizemem + page - 1) & ~(page - 1);
+}
+
+static void*pages_map_inner(size_t sizemem)
+{
+    void*mem = mmap(NULL, sizemem, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        fprintf(stderr, "[%s:%d] unable to mmap %lu bytes\n", __FILE__, __LINE__, sizemem);
+        exit(EXIT_FAILURE);
+    }
+    return mem;
+}
+
+void*pages_map(size_t sizemem, int huge_pages)
+{
+    char*mem;
+    size_t head, tail;
+
+    sizemem = pages_round(sizemem);
+
+    if (!huge_pages || (sizemem < PAGES_HUGE_SIZE)) {
+        return pages_map_inner(sizemem);
+    }
+
+    /* huge page must be aligned, so mapping is made bigger and its ends are cut off. */
+    mem = pages_map_inner(sizemem + PAGES_HUGE_SIZE);
+    head = (PAGES_HUGE_SIZE - ((uintptr_t) mem & (PAGES_HUGE_SIZE - 1))) & (PAGES_HUGE_SIZE - 1);
+    tail = PAGES_HUGE_SIZE - head;
+    if (head != 0) {
+        munmap(mem, head);
+    }
+    munmap(mem + head + sizemem, tail);
+    mem += head;
+
+#ifdef MADV_HUGEPAGE
+    madvise(mem, sizemem, MADV_HUGEPAGE);
+#endif
+
+    return mem;
+}
+
+void pages_unmap(void*mem, size_t sizemem)
+{
+    if (mem != NULL) {
+        munmap(mem, pages_round(sizemem));
+    }
+}
+
+void pages_release(void*mem, size_t sizemem)
+{
+    madvise(mem, pages_round(sizemem), MADV_DONTNEED);
+}
+
+#else
+
+void*pages_map(size_t sizemem, int huge_pages)
+{
+    char*mem;
+    PREFIX_UNUSED(huge_pages);
+    SAFE_MALLOC(mem, sizemem);
+    return mem;
+}
+
+void pages_unmap(void*mem, size_t sizemem)
+{
+    PREFIX_UNUSED(sizemem);
+    free(mem);
+}
+
+void pages_release(void*mem, size_t sizemem)
+{
+    PREFIX_UNUSED(mem);
+    PREFIX_UNUSED(sizemem);
+}
+
+#endif  /* PAGES_MMAP */
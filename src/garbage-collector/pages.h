@@ -0,0 +1,22 @@
+#ifndef PAGES_H_INCLUDED
+#define PAGES_H_INCLUDED
+
+#include <stddef.h>
+
+/*
+  Pools of garbage collector are mapped directly from OS (with malloc fallback),
+  so memory of idle space can be given back to OS between collections.
+  Large mappings may be aligned to PAGES_HUGE_SIZE and backed by transparent huge pages,
+  which reduces TLB misses, when big heap is walked.
+*/
+
+#define PAGES_HUGE_SIZE ((size_t) 2 * 1024 * 1024)
+
+/* maps at least sizemem bytes; exits on failure. */
+void*pages_map(size_t sizemem, int huge_pages);
+void pages_unmap(void*mem, size_t sizemem);
+
+/* gives physical memory back to OS; mapping stays valid and reads as zeros after it. */
+void pages_release(void*mem, size_t sizemem);
+
+#endif  /* PAGES_H_INCLUDED */
@@ -0,0 +1,404 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _DEFAULT_SOURCE
+#define PARALLEL_PTHREADS
+#endif
+
+#include "parallel.h"
+
+#include "utils.h"
+
+#ifdef PARALLEL_PTHREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#define PARALLEL_DEQUE_START_SIZE 1024
+
+/* array of deque; arrays, which are replaced by bigger ones, are freed after evacuation, because thieves may read them. */
+struct PARALLEL_DEQUE_ARRAY
+{
+    long size;
+    struct PARALLEL_DEQUE_ARRAY*prev;
+    struct GC_HEADER*buf[];
+};
+
+struct PARALLEL_EVACUATION;
+
+struct PARALLEL_WORKER
+{
+    struct PARALLEL_EVACUATION*ev;
+
+    /* Chase-Lev deque: owner pushes and takes at bottom, thieves steal at top. */
+    long top;
+    long bottom;
+    struct PARALLEL_DEQUE_ARRAY*arr;
+
+    char*lab_top;
+    char*lab_end;
+
+    unsigned long long random;
+
+    /* copies, which have won the race; they are added to counters of gc after evacuation. */
+    size_t copied_sizemem;
+    size_t copied_num;
+
+#ifdef PARALLEL_PTHREADS
+    pthread_t thread;
+#endif
+
+    /* deques of different workers are on different cache lines. */
+    char padding[64];
+};
+
+struct PARALLEL_EVACUATION
+{
+    garbage_collector_type_t gc;
+    struct PARALLEL_WORKER*workers;
+    size_t workers_num;
+    size_t idle_num;
+};
+
+static struct PARALLEL_DEQUE_ARRAY*deque_array_create(long size, struct PARALLEL_DEQUE_ARRAY*prev)
+{
+    struct PARALLEL_DEQUE_ARRAY*arr = malloc(sizeof(struct PARALLEL_DEQUE_ARRAY) + sizeof(struct GC_HEADER*) * size);
+    if (arr == NULL) {
+        fprintf(stderr, "unable to malloc deque of %ld blocks\n", size);
+        exit(EXIT_FAILURE);
+    }
+    arr->size = size;
+    arr->prev = prev;
+    return arr;
+}
+
+static void deque_push(struct PARALLEL_WORKER*w, struct GC_HEADER*hdr)
+{
+    long bottom = __atomic_load_n(&(w->bottom), __ATOMIC_RELAXED);
+    long top = __atomic_load_n(&(w->top), __ATOMIC_ACQUIRE);
+    struct PARALLEL_DEQUE_ARRAY*arr = __atomic_load_n(&(w->arr), __ATOMIC_RELAXED);
+
+    if (bottom - top > arr->size - 1) {
+        struct PARALLEL_DEQUE_ARRAY*bigger = deque_array_create(arr->size * 2, arr);
+        long i;
+        for (i = top; i < bottom; i++) {
+            bigger->buf[i % bigger->size] = arr->buf[i % arr->size];
+        }
+        __atomic_store_n(&(w->arr), bigger, __ATOMIC_RELEASE);
+        arr = bigger;
+    }
+
+    /* copied block is published to thieves by release of bottom. */
+    __atomic_store_n(&(arr->buf[bottom % arr->size]), hdr, __ATOMIC_RELAXED);
+    __atomic_store_n(&(w->bottom), bottom + 1, __ATOMIC_RELEASE);
+}
+
+static struct GC_HEADER*deque_take(struct PARALLEL_WORKER*w)
+{
+    long bottom = __atomic_load_n(&(w->bottom), __ATOMIC_RELAXED) - 1;
+    struct PARALLEL_DEQUE_ARRAY*arr = __atomic_load_n(&(w->arr), __ATOMIC_RELAXED);
+    struct GC_HEADER*hdr = NULL;
+    long top;
+
+    __atomic_store_n(&(w->bottom), bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    top = __atomic_load_n(&(w->top), __ATOMIC_RELAXED);
+
+    if (top <= bottom) {
+        hdr = __atomic_load_n(&(arr->buf[bottom % arr->size]), __ATOMIC_RELAXED);
+        if (top == bottom) {
+            /* the last block may be stolen concurrently. */
+            if (!__atomic_compare_exchange_n(&(w->top), &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                hdr = NULL;
+            }
+            __atomic_store_n(&(w->bottom), bottom + 1, __ATOMIC_RELAXED);
+        }
+    } else {
+        __atomic_store_n(&(w->bottom), bottom + 1, __ATOMIC_RELAXED);
+    }
+
+    return hdr;
+}
+
+static struct GC_HEADER*deque_steal(struct PARALLEL_WORKER*w)
+{
+    long top = __atomic_load_n(&(w->top), __ATOMIC_ACQUIRE);
+    long bottom;
+    struct GC_HEADER*hdr = NULL;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    bottom = __atomic_load_n(&(w->bottom), __ATOMIC_ACQUIRE);
+
+    if (top < bottom) {
+        struct PARALLEL_DEQUE_ARRAY*arr = __atomic_load_n(&(w->arr), __ATOMIC_ACQUIRE);
+        hdr = __atomic_load_n(&(arr->buf[top % arr->size]), __ATOMIC_RELAXED);
+        if (!__atomic_compare_exchange_n(&(w->top), &top, top + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            /* other thief or owner was faster. */
+            return NULL;
+        }
+    }
+
+    return hdr;
+}
+
+static int deque_is_empty(struct PARALLEL_WORKER*w)
+{
+    return __atomic_load_n(&(w->bottom), __ATOMIC_ACQUIRE) <= __atomic_load_n(&(w->top), __ATOMIC_ACQUIRE);
+}
+
+/* cuts sizemem bytes (or less, but at least min_sizemem bytes) from TO space. */
+static char*to_space_cut(struct SEMISPACE*s, size_t min_sizemem, size_t*sizemem)
+{
+    char*end = s->mem + s->sizemem;
+    char*top = __atomic_load_n(&(s->top), __ATOMIC_RELAXED);
+    size_t n;
+
+    do {
+        n = (*sizemem <= (size_t) (end - top)) ? *sizemem : (size_t) (end - top);
+        if (n < min_sizemem) {
+            /* can't happen, when TO space has PARALLEL_TO_SPACE_SIZEMEM bytes. */
+            fprintf(stderr, "parallel GC: TO space overflow\n");
+            exit(EXIT_FAILURE);
+        }
+    } while (!__atomic_compare_exchange_n(&(s->top), &top, top + n, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    *sizemem = n;
+    return top;
+}
+
+static struct GC_HEADER*lab_malloc_block(struct PARALLEL_WORKER*w, size_t sizemem)
+{
+    struct GC_HEADER*hdr;
+
+    if (sizemem > PARALLEL_LAB_DIRECT_SIZEMEM) {
+        return (struct GC_HEADER*) to_space_cut(&(w->ev->gc->sb), sizemem, &sizemem);
+    }
+
+    if ((size_t) (w->lab_end - w->lab_top) < sizemem) {
+        /* tail of old LAB becomes hole. */
+        size_t lab_sizemem = PARALLEL_LAB_SIZEMEM;
+        w->lab_top = to_space_cut(&(w->ev->gc->sb), sizemem, &lab_sizemem);
+        w->lab_end = w->lab_top + lab_sizemem;
+    }
+
+    hdr = (struct GC_HEADER*) w->lab_top;
+    w->lab_top += sizemem;
+    return hdr;
+}
+
+static void*lookup_new_location(struct PARALLEL_WORKER*w, void*ptr)
+{
+    struct GC_HEADER*hdr = GC_HEADER_FROM_PTR(ptr);
+    void*forward = __atomic_load_n(&(hdr->forward), __ATOMIC_ACQUIRE);
+    size_t info;
+    size_t sizemem;
+    struct GC_HEADER*new_hdr;
+
+    if (forward != NULL) {
+        return forward;
+    }
+
+    /* large blocks are never moved, they are only marked (maybe by several threads at once). */
+    info = __atomic_load_n(&(hdr->info), __ATOMIC_RELAXED);
+    if ((info >> 8) & GC_FLAG_LARGE) {
+        __atomic_fetch_or(&(hdr->info), ((size_t) GC_FLAG_MARKED) << 8, __ATOMIC_RELAXED);
+        return ptr;
+    }
+
+    sizemem = GC_HEADER_SIZEMEM(hdr);
+    new_hdr = lab_malloc_block(w, sizemem);
+    new_hdr->forward = NULL;
+    new_hdr->info = info;
+    memcpy(GC_PTR_FROM_HEADER(new_hdr), ptr, sizemem - sizeof(struct GC_HEADER));
+
+    if (!__atomic_compare_exchange_n(&(hdr->forward), &forward, GC_PTR_FROM_HEADER(new_hdr), 0,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        /* other thread has copied block first, so copy is given back to LAB, if it is possible. */
+        if (((char*) new_hdr) + sizemem == w->lab_top) {
+            w->lab_top = (char*) new_hdr;
+        }
+        return forward;
+    }
+
+    w->copied_sizemem += sizemem;
+    w->copied_num++;
+
+    /* backing stores are scanned together with their owners. */
+    if ((GC_HEADER_TYPE(new_hdr) == GC_BLOCK_OBJ) || (GC_HEADER_TYPE(new_hdr) == GC_BLOCK_ARR)) {
+        deque_push(w, new_hdr);
+    }
+
+    return GC_PTR_FROM_HEADER(new_hdr);
+}
+
+static void scan_value(struct PARALLEL_WORKER*w, struct VALUE*val)
+{
+    if (VALUE_GET_TYPE(*val) == VALUE_TYPE_OBJ) {
+        (*val) = create_value_from_obj(lookup_new_location(w, VALUE_GET_OBJ(*val)));
+    } else if (VALUE_GET_TYPE(*val) == VALUE_TYPE_ARR) {
+        (*val) = create_value_from_arr(lookup_new_location(w, VALUE_GET_ARR(*val)));
+    }
+}
+
+/* block is copy, which is owned by this thread, so its store is copied only here. */
+static void scan_block(struct PARALLEL_WORKER*w, struct GC_HEADER*hdr)
+{
+    size_t i;
+
+    if (GC_HEADER_TYPE(hdr) == GC_BLOCK_OBJ) {
+        struct OBJECT*obj = GC_PTR_FROM_HEADER(hdr);
+        if (obj->properties != NULL) {
+            obj->properties = lookup_new_location(w, obj->properties);
+        }
+        for (i = 0; i < obj->shape->len; i++) {
+            scan_value(w, &(obj->properties[i]));
+        }
+    } else if (GC_HEADER_TYPE(hdr) == GC_BLOCK_ARR) {
+        struct ARRAY*arr = GC_PTR_FROM_HEADER(hdr);
+        if (arr->values != NULL) {
+            arr->values = lookup_new_location(w, arr->values);
+        }
+        for (i = 0; i < arr->len; i++) {
+            scan_value(w, &(arr->values[i]));
+        }
+    }
+}
+
+static struct GC_HEADER*steal(struct PARALLEL_WORKER*w)
+{
+    struct PARALLEL_EVACUATION*ev = w->ev;
+    size_t start;
+    size_t i;
+
+    /* xorshift, so thieves don't attack the same victim. */
+    w->random ^= w->random << 13;
+    w->random ^= w->random >> 7;
+    w->random ^= w->random << 17;
+    start = (size_t) (w->random % ev->workers_num);
+
+    for (i = 0; i < ev->workers_num; i++) {
+        struct PARALLEL_WORKER*victim = ev->workers + (start + i) % ev->workers_num;
+        struct GC_HEADER*hdr;
+        if (victim == w) {
+            continue;
+        }
+        if ((hdr = deque_steal(victim)) != NULL) {
+            return hdr;
+        }
+    }
+
+    return NULL;
+}
+
+static int has_work(struct PARALLEL_EVACUATION*ev)
+{
+    size_t i;
+    for (i = 0; i < ev->workers_num; i++) {
+        if (!deque_is_empty(ev->workers + i)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void worker_run(struct PARALLEL_WORKER*w)
+{
+    struct PARALLEL_EVACUATION*ev = w->ev;
+
+    for (;;) {
+        struct GC_HEADER*hdr = deque_take(w);
+        if (hdr == NULL) {
+            hdr = steal(w);
+        }
+        if (hdr != NULL) {
+            scan_block(w, hdr);
+            continue;
+        }
+
+        /*
+          Only busy worker makes new work and worker becomes idle with empty deque,
+          so evacuation is over, when all workers are idle.
+        */
+        __atomic_add_fetch(&(ev->idle_num), 1, __ATOMIC_SEQ_CST);
+        for (;;) {
+            if (__atomic_load_n(&(ev->idle_num), __ATOMIC_SEQ_CST) == ev->workers_num) {
+                return;
+            }
+            if (has_work(ev)) {
+                __atomic_sub_fetch(&(ev->idle_num), 1, __ATOMIC_SEQ_CST);
+                break;
+            }
+#ifdef PARALLEL_PTHREADS
+            sched_yield();
+#endif
+        }
+    }
+}
+
+#ifdef PARALLEL_PTHREADS
+static void*worker_thread(void*arg)
+{
+    worker_run(arg);
+    return NULL;
+}
+#endif
+
+void parallel_evacuate(garbage_collector_type_t gc, void**ptr)
+{
+    struct VALUE*stack = (*(gc->stack));
+    struct VALUE*stack_top = (*(gc->stack_top));
+    struct VALUE*val;
+
+    struct PARALLEL_EVACUATION ev;
+    size_t i;
+
+    ev.gc = gc;
+    ev.idle_num = 0;
+#ifdef PARALLEL_PTHREADS
+    ev.workers_num = gc->threads_num;
+#else
+    ev.workers_num = 1;
+#endif
+    SAFE_CALLOC(ev.workers, ev.workers_num);
+
+    for (i = 0; i < ev.workers_num; i++) {
+        ev.workers[i].ev = &ev;
+        ev.workers[i].arr = deque_array_create(PARALLEL_DEQUE_START_SIZE, NULL);
+        ev.workers[i].random = i + 1;
+    }
+
+    /* roots are evacuated by the first worker, others steal them. */
+    for (val = stack; val != stack_top; val++) {
+        scan_value(ev.workers, val);
+    }
+
+    if (ptr != NULL) {
+        (*ptr) = lookup_new_location(ev.workers, *ptr);
+    }
+
+#ifdef PARALLEL_PTHREADS
+    for (i = 1; i < ev.workers_num; i++) {
+        if (pthread_create(&(ev.workers[i].thread), NULL, worker_thread, ev.workers + i) != 0) {
+            fprintf(stderr, "unable to create GC thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+#endif
+
+    worker_run(ev.workers);
+
+#ifdef PARALLEL_PTHREADS
+    for (i = 1; i < ev.workers_num; i++) {
+        pthread_join(ev.workers[i].thread, NULL);
+    }
+#endif
+
+    for (i = 0; i < ev.workers_num; i++) {
+        gc->copied_sizemem += ev.workers[i].copied_sizemem;
+        gc->copied_num += ev.workers[i].copied_num;
+        while (ev.workers[i].arr != NULL) {
+            struct PARALLEL_DEQUE_ARRAY*prev = ev.workers[i].arr->prev;
+            free(ev.workers[i].arr);
+            ev.workers[i].arr = prev;
+        }
+    }
+    SAFE_FREE(ev.workers);
+}
@@ -0,0 +1,30 @@
+#ifndef PARALLEL_H_INCLUDED
+#define PARALLEL_H_INCLUDED
+
+#include "garbage-collector.h"
+
+/*
+  Parallel evacuation of FROM space (sa) to TO space (sb) by gc->threads_num threads:
+  - every thread copies blocks into its own LAB (local allocation buffer), which is cut from TO space;
+  - forwarding pointer is installed by CAS, thread, which loses the race, forgets its copy;
+  - copied objects and arrays wait for scanning in Chase-Lev deque of thread, which copied them,
+    idle threads steal them from deques of others.
+  Tails of LABs are left as holes, so TO space can't be walked linearly after parallel evacuation.
+*/
+
+/*
+  Blocks bigger than 1/64 of LAB are copied to TO space directly, so every hole is smaller than 1/64 of LAB.
+  Only objects and arrays can be copied by several threads at once, they are small and always go to LAB,
+  where copy of thread, which loses the race, is given back.
+*/
+#define PARALLEL_LAB_SIZEMEM ((size_t) 32 * 1024)
+#define PARALLEL_LAB_DIRECT_SIZEMEM (PARALLEL_LAB_SIZEMEM / 64)
+
+/* TO space, which takes used bytes of FROM space with holes and unused tails of last LABs. */
+#define PARALLEL_TO_SPACE_SIZEMEM(used, threads_num) \
+    ((used) + (used) / 63 + (threads_num) * PARALLEL_LAB_SIZEMEM)
+
+/* evacuates blocks, which are reachable from stack and ptr (additional root); TO space must be clean. */
+void parallel_evacuate(garbage_collector_type_t gc, void**ptr);
+
+#endif  /* PARALLEL_H_INCLUDED */
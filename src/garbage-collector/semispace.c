@@ -0,0 +1,48 @@
+#include "semispace.h"
+#include "pages.h"
+
+#include "utils.h"
+
+void semispace_malloc_pool(semispace_type_t s, size_t sizemem, int huge_pages)
+{
+    s->sizemem = SEMISPACE_ALIGN_SIZEMEM(sizemem);
+    if (s->sizemem == 0) {
+        s->sizemem = SEMISPACE_ALIGN;
+    }
+    s->mem = pages_map(s->sizemem, huge_pages);
+
+    semispace_clean_pool(s);
+}
+
+void semispace_free_pool(semispace_type_t s)
+{
+    pages_unmap(s->mem, s->sizemem);
+    s->mem = NULL;
+    s->top = NULL;
+}
+
+void semispace_release_pool(semispace_type_t s)
+{
+    pages_release(s->mem, s->sizemem);
+    s->top = s->mem;
+}
+
+void semispace_clean_pool(semispace_type_t s)
+{
+    s->top = s->mem;
+}
+
+void*semispace_malloc_block(semispace_type_t s, size_t sizemem)
+{
+    void*ptr;
+
+    sizemem = SEMISPACE_ALIGN_SIZEMEM(sizemem);
+    if (sizemem > SEMISPACE_FREE(s)) {
+        return NULL;
+    }
+
+    ptr = s->top;
+    s->top += sizemem;
+
+    return ptr;
+}
@@ -0,0 +1,40 @@
+#ifndef SEMISPACE_H_INCLUDED
+#define SEMISPACE_H_INCLUDED
+
+#include <string.h>
+
+/*
+  Semispace is a contiguous pool with bump-pointer allocation:
+  [block][block]...[block][free memory], where
+  every block is allocated by incrementing [top] pointer,
+  so allocation is just a pointer increment plus a limit check
+  and blocks can be walked linearly from [mem] to [top].
+  Sizes of blocks are rounded to SEMISPACE_ALIGN bytes.
+*/
+
+#define SEMISPACE_ALIGN 8
+#define SEMISPACE_ALIGN_SIZEMEM(sizemem) (((sizemem) + SEMISPACE_ALIGN - 1) & ~((size_t) (SEMISPACE_ALIGN - 1)))
+
+struct SEMISPACE
+{
+    char*mem;
+    char*top;
+    size_t sizemem;
+};
+
+typedef struct SEMISPACE* semispace_type_t;
+
+void semispace_malloc_pool(semispace_type_t s, size_t sizemem, int huge_pages);
+void semispace_free_pool(semispace_type_t s);
+
+/* gives memory of idle pool back to OS; pool must be cleaned before next use. */
+void semispace_release_pool(semispace_type_t s);
+
+void semispace_clean_pool(semispace_type_t s);
+
+#define SEMISPACE_USED(s) ((size_t) ((s)->top - (s)->mem))
+#define SEMISPACE_FREE(s) ((s)->sizemem - SEMISPACE_USED(s))
+
+void*semispace_malloc_block(semispace_type_t s, size_t sizemem);
+
+#endif  /* SEMISPACE_H_INCLUDED */
@@ -0,0 +1,142 @@
+#include "stats.h"
+
+#include "utils.h"
+
+#include <stdlib.h>
+
+static const char*kind_names[] = {
+    "major",
+    "minor",
+    "incremental",
+};
+
+static const char*trigger_names[] = {
+    "malloc_obj",
+    "malloc_arr",
+    "realloc_obj",
+    "realloc_arr",
+    "collect",
+};
+
+#define KINDS_NUM    (sizeof(kind_names) / sizeof(kind_names[0]))
+#define TRIGGERS_NUM (sizeof(trigger_names) / sizeof(trigger_names[0]))
+
+static int compare_pauses(const void*a, const void*b)
+{
+    unsigned long long x = *((const unsigned long long*) a);
+    unsigned long long y = *((const unsigned long long*) b);
+    return (x > y) - (x < y);
+}
+
+unsigned long long stats_pause_percentile(const garbage_collector_type_t gc, double percent)
+{
+    unsigned long long*pauses;
+    unsigned long long pause;
+    size_t i, rank;
+
+    if (gc->collections_len == 0) {
+        return 0;
+    }
+
+    SAFE_MALLOC(pauses, gc->collections_len);
+    for (i = 0; i < gc->collections_len; i++) {
+        pauses[i] = gc->collections[i].pause_ns;
+    }
+    qsort(pauses, gc->collections_len, sizeof(unsigned long long), compare_pauses);
+
+    /* rank is ceil(percent of pauses number), but at least 1. */
+    rank = (size_t) (percent / 100.0 * gc->collections_len);
+    if ((rank == 0) || (rank < percent / 100.0 * gc->collections_len)) {
+        rank++;
+    }
+    rank = (rank > gc->collections_len) ? gc->collections_len : rank;
+    pause = pauses[rank - 1];
+
+    SAFE_FREE(pauses);
+
+    return pause;
+}
+
+static size_t histogram_bucket(unsigned long long pause_ns)
+{
+    unsigned long long us = pause_ns / 1000;
+    size_t bucket = 0;
+
+    while ((us != 0) && (bucket + 1 < STATS_HISTOGRAM_BUCKETS)) {
+        us >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+void dump_garbage_collector_stats_to_xml_file(FILE*f, const garbage_collector_type_t gc)
+{
+    size_t histogram[STATS_HISTOGRAM_BUCKETS] = {0};
+    size_t kind_count[KINDS_NUM] = {0};
+    unsigned long long kind_pause_ns[KINDS_NUM] = {0};
+    size_t trigger_count[TRIGGERS_NUM] = {0};
+
+    unsigned long long total_ns = 0, max_ns = 0;
+    size_t copied_sizemem = 0, copied_num = 0, max_heap_sizemem = 0;
+    size_t first = STATS_HISTOGRAM_BUCKETS, last = 0;
+    size_t i;
+
+    for (i = 0; i < gc->collections_len; i++) {
+        const struct GC_COLLECTION*c = gc->collections + i;
+        size_t bucket = histogram_bucket(c->pause_ns);
+
+        histogram[bucket]++;
+        first = (bucket < first) ? bucket : first;
+        last = (bucket > last) ? bucket : last;
+
+        kind_count[c->kind]++;
+        kind_pause_ns[c->kind] += c->pause_ns;
+        trigger_count[c->trigger]++;
+
+        total_ns += c->pause_ns;
+        max_ns = (c->pause_ns > max_ns) ? c->pause_ns : max_ns;
+        copied_sizemem += c->copied_sizemem;
+        copied_num += c->copied_num;
+        max_heap_sizemem = (c->heap_before_sizemem > max_heap_sizemem) ? c->heap_before_sizemem : max_heap_sizemem;
+        max_heap_sizemem = (c->heap_after_sizemem > max_heap_sizemem) ? c->heap_after_sizemem : max_heap_sizemem;
+    }
+
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(f, "<gc_stats collections=\"%zu\" pause_ns=\"%llu\" copied_bytes=\"%zu\" copied_blocks=\"%zu\" "
+            "max_heap_bytes=\"%zu\">\n",
+            gc->collections_len, total_ns, copied_sizemem, copied_num, max_heap_sizemem);
+
+    for (i = 0; i < KINDS_NUM; i++) {
+        if (kind_count[i] != 0) {
+            fprintf(f, "\t<kind name=\"%s\" count=\"%zu\" pause_ns=\"%llu\"/>\n",
+                    kind_names[i], kind_count[i], kind_pause_ns[i]);
+        }
+    }
+    for (i = 0; i < TRIGGERS_NUM; i++) {
+        if (trigger_count[i] != 0) {
+            fprintf(f, "\t<trigger name=\"%s\" count=\"%zu\"/>\n", trigger_names[i], trigger_count[i]);
+        }
+    }
+
+    fprintf(f, "\t<pauses p50_ns=\"%llu\" p99_ns=\"%llu\" max_ns=\"%llu\"/>\n",
+            stats_pause_percentile(gc, 50.0), stats_pause_percentile(gc, 99.0), max_ns);
+
+    fprintf(f, "\t<histogram>\n");
+    for (i = first; i <= last; i++) {
+        fprintf(f, "\t\t<bucket below_us=\"%llu\" count=\"%zu\"/>\n", 1ULL << i, histogram[i]);
+    }
+    fprintf(f, "\t</histogram>\n");
+
+    fprintf(f, "\t<collections>\n");
+    for (i = 0; i < gc->collections_len; i++) {
+        const struct GC_COLLECTION*c = gc->collections + i;
+        fprintf(f, "\t\t<collection kind=\"%s\" trigger=\"%s\" pause_ns=\"%llu\" copied_bytes=\"%zu\" "
+                "copied_blocks=\"%zu\" survivors_bytes=\"%zu\" heap_before=\"%zu\" heap_after=\"%zu\"/>\n",
+                kind_names[c->kind], trigger_names[c->trigger], c->pause_ns, c->copied_sizemem,
+                c->copied_num, c->survivors_sizemem, c->heap_before_sizemem, c->heap_after_sizemem);
+    }
+    fprintf(f, "\t</collections>\n");
+
+    fprintf(f, "</gc_stats>\n");
+}
@@ -0,0 +1,20 @@
+#ifndef STATS_H_INCLUDED
+#define STATS_H_INCLUDED
+
+#include "garbage-collector.h"
+
+#include <stdio.h>
+
+/* pauses are put into buckets by powers of two microseconds: [0, 1), [1, 2), [2, 4) and so on. */
+#define STATS_HISTOGRAM_BUCKETS 40
+
+/* pause (in ns), which isn't exceeded by percent of logged pauses (nearest rank); 0 without pauses. */
+unsigned long long stats_pause_percentile(const garbage_collector_type_t gc, double percent);
+
+/*
+  Summary of logged pauses (gc must be configured with stats): counts by kind and trigger,
+  copied bytes, pause histogram and percentiles, and then every pause.
+*/
+void dump_garbage_collector_stats_to_xml_file(FILE*f, const garbage_collector_type_t gc);
+
+#endif  /* STATS_H_INCLUDED */
@@ -1,6 +1,7 @@
 #include "lexer.h"
 #include "parser.h"
 #include "bytecode-generator.h"
+#include "register-generator.h"
 #include "virtual-machine.h"
 
 #include <stdio.h>
@@ -25,6 +26,32 @@ enum INTERPRETER_MODE
 
 #define STACKSIZE_STR "stacksize"
 #define HEAPSIZE_STR "heapsize"
+#define GC_ALLOC_STR "gc-alloc"
+#define GC_GENERATIONAL_STR "gc-generational"
+#define NURSERY_SIZE_STR "nursery-size"
+#define IC_STATS_STR "ic-stats"
+#define MAX_HEAP_STR "max-heap"
+#define HEAP_TARGET_STR "heap-target"
+#define HEAP_GROWTH_STR "heap-growth"
+#define HEAP_SHRINK_AFTER_STR "heap-shrink-after"
+#define GC_HUGE_PAGES_STR "gc-huge-pages"
+#define GC_PAUSE_BUDGET_STR "gc-pause-budget"
+#define GC_THREADS_STR "gc-threads"
+#define GC_COMPACT_STR "gc-compact"
+#define GC_STATS_STR "gc-stats"
+#define NO_SUPERINSTRUCTIONS_STR "no-superinstructions"
+#define REGISTER_VM_STR "register-vm"
+#define NO_QUICKENING_STR "no-quickening"
+#define QUICK_STATS_STR "quick-stats"
+#define JIT_HOTNESS_STR "jit-hotness"
+#define JIT_MODE_STR "jit-mode"
+#define JIT_STATS_STR "jit-stats"
+
+#define GC_ALLOC_BUMP_STR      "bump"
+#define GC_ALLOC_FREE_LIST_STR "freelist"
+
+#define JIT_MODE_TEMPLATE_STR "template"
+#define JIT_MODE_TRACING_STR  "tracing"
 
 struct INTERPRETER_PARAMS
 {
@@ -32,7 +59,16 @@ struct INTERPRETER_PARAMS
     char out[STR_BUF_SIZE];
     enum INTERPRETER_MODE mode;
     size_t stacksize;
-    size_t heapsize;
+    int superinstructions;
+    int register_vm;
+    int quickening;
+    size_t jit_hotness;
+    enum VIRTUAL_MACHINE_JIT_MODE jit_mode;
+    struct GARBAGE_COLLECTOR_PARAMS gc_params;
+    char ic_stats[STR_BUF_SIZE];
+    char gc_stats[STR_BUF_SIZE];
+    char quick_stats[STR_BUF_SIZE];
+    char jit_stats[STR_BUF_SIZE];
 };
 
 static void print_version(char*interpreter_name)
@@ -63,10 +99,54 @@ static void print_help(char*interpreter_name)
     fprintf(stderr, "            Path to output file (stdout|stderr) (default: stdout).\n");
     fprintf(stderr, "  --mode    (-m)\n");
     fprintf(stderr, "            Mode (lex|parse|bc|trace|interpret) (default: interpret).\n");
+    fprintf(stderr, "            Binary trace is written to output file, it is decoded by trace-decoder.\n");
+    fprintf(stderr, "  --no-superinstructions\n");
+    fprintf(stderr, "            Don't fuse common opcode sequences (e.g. to count their n-grams in trace).\n");
+    fprintf(stderr, "  --register-vm\n");
+    fprintf(stderr, "            Generate register bytecode and run it by register VM (no trace mode).\n");
+    fprintf(stderr, "  --no-quickening\n");
+    fprintf(stderr, "            Don't rewrite generic arithmetic opcodes to integer ones at runtime.\n");
+    fprintf(stderr, "  --jit-hotness\n");
+    fprintf(stderr, "            Loop is compiled to machine code after this number of iterations, 0 - never\n");
+    fprintf(stderr, "            (default: %d, if VM is built by make JIT=1, and 0 otherwise).\n", VIRTUAL_MACHINE_JIT_HOTNESS);
+    fprintf(stderr, "  --jit-mode\n");
+    fprintf(stderr, "            JIT compiles whole loops or records traces of their iterations (template|tracing)\n");
+    fprintf(stderr, "            (default: template).\n");
     fprintf(stderr, "  --stacksize\n");
     fprintf(stderr, "            Size of stack in vars(default: 1024).\n");
     fprintf(stderr, "  --heapsize\n");
     fprintf(stderr, "            Size of heap in bytes (default: 1 MB).\n");
+    fprintf(stderr, "  --max-heap\n");
+    fprintf(stderr, "            Limit of heap in bytes, exceeding it is out of memory error (default: none).\n");
+    fprintf(stderr, "  --heap-target\n");
+    fprintf(stderr, "            Heap grows, when live data exceed this part of it after GC (default: 0.5).\n");
+    fprintf(stderr, "  --heap-growth\n");
+    fprintf(stderr, "            Factor of heap growth and shrinking (default: 2).\n");
+    fprintf(stderr, "  --heap-shrink-after\n");
+    fprintf(stderr, "            Heap shrinks after this number of GCs in a row with low occupancy (default: 4).\n");
+    fprintf(stderr, "  --gc-alloc\n");
+    fprintf(stderr, "            GC allocation mode (bump|freelist) (default: bump).\n");
+    fprintf(stderr, "  --gc-generational\n");
+    fprintf(stderr, "            Enable generational GC with nursery (forces bump allocation).\n");
+    fprintf(stderr, "  --nursery-size\n");
+    fprintf(stderr, "            Size of nursery in bytes (default: 256 KB).\n");
+    fprintf(stderr, "  --gc-pause-budget\n");
+    fprintf(stderr, "            Enable incremental GC with pause budget in microseconds (forces bump allocation).\n");
+    fprintf(stderr, "  --gc-threads\n");
+    fprintf(stderr, "            Number of threads, which copy big heaps in bump-pointer mode (default: 1).\n");
+    fprintf(stderr, "  --gc-compact\n");
+    fprintf(stderr, "            Enable mark-compact GC in one space instead of copying (forces bump allocation).\n");
+    fprintf(stderr, "  --gc-huge-pages\n");
+    fprintf(stderr, "            Back big heaps by transparent huge pages.\n");
+    fprintf(stderr, "  --ic-stats\n");
+    fprintf(stderr, "            Path to file (stdout|stderr) for inline caches hits/misses (default: none).\n");
+    fprintf(stderr, "  --gc-stats\n");
+    fprintf(stderr, "            Path to file (stdout|stderr) for GC pauses with histogram and percentiles (default: none).\n");
+    fprintf(stderr, "  --quick-stats\n");
+    fprintf(stderr, "            Path to file (stdout|stderr) for numbers of quickened opcodes and deopts (default: none).\n");
+    fprintf(stderr, "  --jit-stats\n");
+    fprintf(stderr, "            Path to file (stdout|stderr) for numbers of compiled loops and their runs, side exits of traces\n");
+    fprintf(stderr, "            (default: none).\n");
     exit(0);
 }
 
@@ -78,8 +158,28 @@ int parse_args(int argc, char**argv, struct INTERPRETER_PARAMS*params)
         {"in",        1, 0, 'i'},
         {"out",       1, 0, 'o'},
         {"mode",      1, 0, 'm'},
+        {"no-superinstructions", 0, 0, 0},
+        {"register-vm", 0, 0, 0},
+        {"no-quickening", 0, 0, 0},
+        {"jit-hotness", 1, 0, 0},
+        {"jit-mode", 1, 0, 0},
         {"stacksize", 1, 0,  0},
         {"heapsize",  1, 0,  0},
+        {"max-heap",  1, 0,  0},
+        {"heap-target", 1, 0, 0},
+        {"heap-growth", 1, 0, 0},
+        {"heap-shrink-after", 1, 0, 0},
+        {"gc-alloc",  1, 0,  0},
+        {"gc-generational", 0, 0, 0},
+        {"nursery-size", 1, 0, 0},
+        {"gc-pause-budget", 1, 0, 0},
+        {"gc-threads", 1, 0, 0},
+        {"gc-compact", 0, 0, 0},
+        {"gc-huge-pages", 0, 0, 0},
+        {"ic-stats",  1, 0,  0},
+        {"gc-stats",  1, 0,  0},
+        {"quick-stats", 1, 0, 0},
+        {"jit-stats", 1, 0, 0},
         {0,0,0,0}
     };
 
@@ -90,7 +190,16 @@ int parse_args(int argc, char**argv, struct INTERPRETER_PARAMS*params)
     strncpy(params->out, "stdout", sizeof(params->out));
     params->mode = INTERPRETER_INTERPRET;
     params->stacksize = 1024;
-    params->heapsize = 1024 * 1024;
+    params->superinstructions = 1;
+    params->register_vm = 0;
+    params->quickening = 1;
+    params->jit_hotness = VIRTUAL_MACHINE_JIT ? VIRTUAL_MACHINE_JIT_HOTNESS : 0;
+    params->jit_mode = VIRTUAL_MACHINE_JIT_TEMPLATE;
+    params->ic_stats[0] = '\0';
+    params->gc_stats[0] = '\0';
+    params->quick_stats[0] = '\0';
+    params->jit_stats[0] = '\0';
+    garbage_collector_default_params(&(params->gc_params));
     
     while ((c = getopt_long(argc, argv, "i:o:m:vh", opts, &idx)) != -1) {
         switch (c) {
@@ -126,8 +235,83 @@ int parse_args(int argc, char**argv, struct INTERPRETER_PARAMS*params)
         case 0: {
             if (strcmp(STACKSIZE_STR, opts[idx].name) == 0) {
                 params->stacksize = atoll(optarg);
+            } else if (strcmp(NO_SUPERINSTRUCTIONS_STR, opts[idx].name) == 0) {
+                params->superinstructions = 0;
+            } else if (strcmp(REGISTER_VM_STR, opts[idx].name) == 0) {
+                params->register_vm = 1;
+            } else if (strcmp(NO_QUICKENING_STR, opts[idx].name) == 0) {
+                params->quickening = 0;
+            } else if (strcmp(JIT_HOTNESS_STR, opts[idx].name) == 0) {
+                params->jit_hotness = atoll(optarg);
+                if (!VIRTUAL_MACHINE_JIT && (params->jit_hotness != 0)) {
+                    fprintf(stderr, "Interpreter is built without JIT (make JIT=1)");
+                    exit(EXIT_FAILURE);
+                }
+            } else if (strcmp(JIT_MODE_STR, opts[idx].name) == 0) {
+                if (strcmp(optarg, JIT_MODE_TEMPLATE_STR) == 0) {
+                    params->jit_mode = VIRTUAL_MACHINE_JIT_TEMPLATE;
+                } else if (strcmp(optarg, JIT_MODE_TRACING_STR) == 0) {
+                    params->jit_mode = VIRTUAL_MACHINE_JIT_TRACING;
+                } else {
+                    fprintf(stderr, "Invalid JIT mode \"%s\"", optarg);
+                    exit(EXIT_FAILURE);
+                }
             } else if (strcmp(HEAPSIZE_STR, opts[idx].name) == 0) {
-                params->heapsize = atoll(optarg);
+                params->gc_params.sizemem_start = atoll(optarg);
+            } else if (strcmp(MAX_HEAP_STR, opts[idx].name) == 0) {
+                params->gc_params.max_sizemem = atoll(optarg);
+            } else if (strcmp(HEAP_TARGET_STR, opts[idx].name) == 0) {
+                params->gc_params.target_occupancy = atof(optarg);
+                if ((params->gc_params.target_occupancy <= 0.0) || (params->gc_params.target_occupancy > 1.0)) {
+                    fprintf(stderr, "Invalid heap target \"%s\"", optarg);
+                    exit(EXIT_FAILURE);
+                }
+            } else if (strcmp(HEAP_GROWTH_STR, opts[idx].name) == 0) {
+                params->gc_params.growth_factor = atof(optarg);
+                if (params->gc_params.growth_factor <= 1.0) {
+                    fprintf(stderr, "Invalid heap growth \"%s\"", optarg);
+                    exit(EXIT_FAILURE);
+                }
+            } else if (strcmp(HEAP_SHRINK_AFTER_STR, opts[idx].name) == 0) {
+                params->gc_params.shrink_after = atoll(optarg);
+            } else if (strcmp(GC_ALLOC_STR, opts[idx].name) == 0) {
+                if (strcmp(optarg, GC_ALLOC_BUMP_STR) == 0) {
+                    params->gc_params.allocation = GARBAGE_COLLECTOR_ALLOCATION_BUMP;
+                } else if (strcmp(optarg, GC_ALLOC_FREE_LIST_STR) == 0) {
+                    params->gc_params.allocation = GARBAGE_COLLECTOR_ALLOCATION_FREE_LIST;
+                } else {
+                    fprintf(stderr, "Invalid GC allocation mode \"%s\"", optarg);
+                    exit(EXIT_FAILURE);
+                }
+            } else if (strcmp(GC_GENERATIONAL_STR, opts[idx].name) == 0) {
+                params->gc_params.generational = 1;
+            } else if (strcmp(NURSERY_SIZE_STR, opts[idx].name) == 0) {
+                params->gc_params.nursery_sizemem = atoll(optarg);
+            } else if (strcmp(GC_PAUSE_BUDGET_STR, opts[idx].name) == 0) {
+                params->gc_params.pause_budget_ns = atoll(optarg) * 1000;
+                if (params->gc_params.pause_budget_ns == 0) {
+                    fprintf(stderr, "Invalid GC pause budget \"%s\"", optarg);
+                    exit(EXIT_FAILURE);
+                }
+            } else if (strcmp(GC_THREADS_STR, opts[idx].name) == 0) {
+                params->gc_params.threads_num = atoll(optarg);
+                if (params->gc_params.threads_num == 0) {
+                    fprintf(stderr, "Invalid GC threads number \"%s\"", optarg);
+                    exit(EXIT_FAILURE);
+                }
+            } else if (strcmp(GC_COMPACT_STR, opts[idx].name) == 0) {
+                params->gc_params.compacting = 1;
+            } else if (strcmp(GC_HUGE_PAGES_STR, opts[idx].name) == 0) {
+                params->gc_params.huge_pages = 1;
+            } else if (strcmp(IC_STATS_STR, opts[idx].name) == 0) {
+                snprintf(params->ic_stats, sizeof(params->ic_stats), "%s", optarg);
+            } else if (strcmp(GC_STATS_STR, opts[idx].name) == 0) {
+                snprintf(params->gc_stats, sizeof(params->gc_stats), "%s", optarg);
+                params->gc_params.stats = 1;
+            } else if (strcmp(QUICK_STATS_STR, opts[idx].name) == 0) {
+                snprintf(params->quick_stats, sizeof(params->quick_stats), "%s", optarg);
+            } else if (strcmp(JIT_STATS_STR, opts[idx].name) == 0) {
+                snprintf(params->jit_stats, sizeof(params->jit_stats), "%s", optarg);
             }
         }
         default:
@@ -136,6 +320,11 @@ int parse_args(int argc, char**argv, struct INTERPRETER_PARAMS*params)
         }
     }
 
+    if (params->register_vm && (params->mode == INTERPRETER_TRACE)) {
+        fprintf(stderr, "Trace of register VM isn't supported");
+        exit(EXIT_FAILURE);
+    }
+
     return 0;
 }
 
@@ -160,8 +349,48 @@ void print_bytecode_result(const char*fname, const bytecode_type_t bc)
     fclose(f);
 }
 
+/* stats of finished run are dumped by one of dump_*_to_xml_file. */
+void print_vm_stats_result(const char*fname, const virtual_machine_type_t vm,
+                           void (*dump)(FILE*f, const virtual_machine_type_t vm))
+{
+    FILE*f = file_open(fname, "w");
+    dump(f, vm);
+    /* result is printed after stats. */
+    if ((f != stdout) && (f != stderr)) {
+        fclose(f);
+    }
+}
+
 void run_tests();
 
+/* stack or register bytecode; error of generator is printed. */
+static int generate_bytecode(const struct INTERPRETER_PARAMS*params, struct UNIT_AST*unit, bytecode_type_t*bc)
+{
+    int r;
+
+    if (params->register_vm) {
+        register_generator_type_t rg = create_register_generator();
+        register_generator_conf(rg, unit);
+        r = register_generator_generate(rg, bc);
+        if (r != BYTECODE_GENERATOR_OK) {
+            struct BYTECODE_ERROR err = register_generator_get_error(rg);
+            print_bytecode_error(&err);
+        }
+        register_generator_free(rg);
+    } else {
+        bytecode_generator_type_t bc_gen = create_bytecode_generator();
+        bytecode_generator_conf(bc_gen, unit, params->superinstructions);
+        r = bytecode_generator_generate(bc_gen, bc);
+        if (r != BYTECODE_GENERATOR_OK) {
+            struct BYTECODE_ERROR err = bytecode_generator_get_error(bc_gen);
+            print_bytecode_error(&err);
+        }
+        bytecode_generator_free(bc_gen);
+    }
+
+    return r;
+}
+
 int main(int argc, char**argv)
 {
     int r = 0;
@@ -169,12 +398,13 @@ int main(int argc, char**argv)
     struct INTERPRETER_PARAMS params;
     lexer_type_t  lexer;
     parser_type_t parser;
-    bytecode_generator_type_t bc_gen;
     virtual_machine_type_t vm;
 
     struct UNIT_AST*unit;
     bytecode_type_t bc;
 
+    FILE*trace = NULL;
+
     parse_args(argc, argv, &params);
 
     lexer = create_lexer();
@@ -208,15 +438,9 @@ int main(int argc, char**argv)
     lexer_free(lexer);
     parser_free(parser);
 
-    bc_gen = create_bytecode_generator();
-    bytecode_generator_conf(bc_gen, unit);
-    
-    r = bytecode_generator_generate(bc_gen, &bc);
+    r = generate_bytecode(&params, unit, &bc);
     if (r != BYTECODE_GENERATOR_OK) {
-        struct BYTECODE_ERROR err = bytecode_generator_get_error(bc_gen);
-        print_bytecode_error(&err);
         unit_ast_free(unit);
-        bytecode_generator_free(bc_gen);
         return 2;
     }
 
@@ -224,16 +448,33 @@ int main(int argc, char**argv)
 
     if (params.mode == INTERPRETER_BC) {
         print_bytecode_result(params.out, bc);
-        bytecode_generator_free(bc_gen);
         bytecode_free(bc);
         return 0;
     }
-    
-    bytecode_generator_free(bc_gen);
+
+    if (params.mode == INTERPRETER_TRACE) {
+        trace = file_open(params.out, "wb");
+    }
 
     vm = create_virtual_machine();
-    virtual_machine_conf(vm, bc, params.stacksize, params.heapsize, params.mode == INTERPRETER_TRACE);
+    virtual_machine_conf(vm, bc, params.stacksize, &(params.gc_params), trace, params.quickening);
+    virtual_machine_conf_jit(vm, params.jit_hotness, params.jit_mode);
     r = virtual_machine_run(vm);
+    if ((trace != NULL) && (trace != stdout) && (trace != stderr)) {
+        fclose(trace);
+    }
+    if (params.ic_stats[0] != '\0') {
+        print_vm_stats_result(params.ic_stats, vm, dump_inline_caches_to_xml_file);
+    }
+    if (params.gc_stats[0] != '\0') {
+        print_vm_stats_result(params.gc_stats, vm, dump_gc_stats_to_xml_file);
+    }
+    if (params.quick_stats[0] != '\0') {
+        print_vm_stats_result(params.quick_stats, vm, dump_quickening_stats_to_xml_file);
+    }
+    if (params.jit_stats[0] != '\0') {
+        print_vm_stats_result(params.jit_stats, vm, dump_jit_stats_to_xml_file);
+    }
     bytecode_free(bc);
     virtual_machine_free(vm);
 
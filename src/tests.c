@@ -1,6 +1,7 @@
 #include "lexer.h"
 #include "parser.h"
 #include "bytecode-generator.h"
+#include "register-generator.h"
 #include "virtual-machine.h"
 
 #include <stdio.h>
@@ -8,15 +9,47 @@
 #define MAX_FNAME_SIZE 1024
 
 #define STACKSIZE 1024
-#define HEAPSIZE  35
+/* large tests build array literals of thousands of elements on stack. */
+#define LARGE_STACKSIZE 8192
+#define HEAPSIZE  48
+#define NURSERY_SIZE 256
+#define MAX_HEAPSIZE (4 * 1024 * 1024)
 
-void run_single_test(unsigned num, const char*fname, int exp)
+/* bytecode of every configuration is generated with superinstructions, except the last ones. */
+static int superinstructions = 1;
+/* the last configurations run register bytecode. */
+static int register_vm = 0;
+/* generic opcodes are rewritten to integer ones, except the last configurations. */
+static int quickening = 1;
+/* the JIT configurations compile (or record) every loop on its first back-edge. */
+static size_t jit_hotness = 0;
+static enum VIRTUAL_MACHINE_JIT_MODE jit_mode = VIRTUAL_MACHINE_JIT_TEMPLATE;
+
+static int generate_bytecode(struct UNIT_AST*unit, bytecode_type_t*bc)
+{
+    int r;
+
+    if (register_vm) {
+        register_generator_type_t rg = create_register_generator();
+        register_generator_conf(rg, unit);
+        r = register_generator_generate(rg, bc);
+        register_generator_free(rg);
+    } else {
+        bytecode_generator_type_t bc_gen = create_bytecode_generator();
+        bytecode_generator_conf(bc_gen, unit, superinstructions);
+        r = bytecode_generator_generate(bc_gen, bc);
+        bytecode_generator_free(bc_gen);
+    }
+
+    return r;
+}
+
+void run_single_test(unsigned num, const char*fname, int exp, size_t stacksize, const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
 {
     int r;
     
     lexer_type_t  lexer;
     parser_type_t parser;
-    bytecode_generator_type_t bc_gen;
     virtual_machine_type_t vm;
 
     struct UNIT_AST*unit;
@@ -32,34 +65,32 @@ void run_single_test(unsigned num, const char*fname, int exp)
     r = parser_parse(parser, &unit);
     if (r != PARSER_OK) {
         printf("%u) PARSER ERROR\n", num);
-        exit(0);
+        exit(EXIT_FAILURE);
     }
 
     lexer_free(lexer);
     parser_free(parser);
 
-    bc_gen = create_bytecode_generator();
-    bytecode_generator_conf(bc_gen, unit);
-
-    r = bytecode_generator_generate(bc_gen, &bc);
+    r = generate_bytecode(unit, &bc);
     if (r != BYTECODE_GENERATOR_OK) {
         printf("%u) BYTECODE GENERATOR ERROR\n", num);
-        exit(0);
+        exit(EXIT_FAILURE);
     }
 
     vm = create_virtual_machine();
-    virtual_machine_conf(vm, bc, STACKSIZE, HEAPSIZE, 0);
+    virtual_machine_conf(vm, bc, stacksize, gc_params, NULL, quickening);
+    virtual_machine_conf_jit(vm, jit_hotness, jit_mode);
     got = virtual_machine_run(vm);
     bytecode_free(bc);
     virtual_machine_free(vm);
     
     printf("%u) EXP = %d; GOT = %d; %s\n", num, exp, got, exp == got ? "PASSED" : "FAILED");
     if (exp != got) {
-        exit(0);
+        exit(EXIT_FAILURE);
     }
 }
 
-#define SYNTAX_TESTS_NUM 10
+#define SYNTAX_TESTS_NUM 15
 
 static const char syntax_tests_fnames[SYNTAX_TESTS_NUM][MAX_FNAME_SIZE] = {
     "data/tests/syntax/01.js",
@@ -72,6 +103,11 @@ static const char syntax_tests_fnames[SYNTAX_TESTS_NUM][MAX_FNAME_SIZE] = {
     "data/tests/syntax/08.js",
     "data/tests/syntax/09.js",
     "data/tests/syntax/10.js",
+    "data/tests/syntax/11.js",
+    "data/tests/syntax/12.js",
+    "data/tests/syntax/13.js",
+    "data/tests/syntax/14.js",
+    "data/tests/syntax/15.js",
 };
 
 static const int syntax_tests_results[SYNTAX_TESTS_NUM] = {
@@ -85,20 +121,25 @@ static const int syntax_tests_results[SYNTAX_TESTS_NUM] = {
     25,
     15,
     -100,
+    10816,
+    103334,
+    480,
+    775,
+    4858,
 };
 
-void run_syntax_tests()
+void run_syntax_tests(const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
 {
     unsigned i;
     
     printf("RUNNING SYNTAX TESTS:\n");
     for (i = 0; i < SYNTAX_TESTS_NUM; i++) {
-        run_single_test(i + 1, syntax_tests_fnames[i], syntax_tests_results[i]);
+        run_single_test(i + 1, syntax_tests_fnames[i], syntax_tests_results[i], STACKSIZE, gc_params);
     }
     printf("ALL SYNTAX TESTS PASSED!\n");
 }
 
-#define GC_TESTS_NUM 10
+#define GC_TESTS_NUM 14
 
 static const char gc_tests_fnames[GC_TESTS_NUM][MAX_FNAME_SIZE] = {
     "data/tests/gc/01.js",
@@ -111,6 +152,10 @@ static const char gc_tests_fnames[GC_TESTS_NUM][MAX_FNAME_SIZE] = {
     "data/tests/gc/08.js",
     "data/tests/gc/09.js",
     "data/tests/gc/10.js",
+    "data/tests/gc/11.js",
+    "data/tests/gc/12.js",
+    "data/tests/gc/13.js",
+    "data/tests/gc/14.js",
 };
 
 static const int gc_tests_results[GC_TESTS_NUM] = {
@@ -124,30 +169,146 @@ static const int gc_tests_results[GC_TESTS_NUM] = {
     30,
     2,
     66,
+    213,
+    6002997,
+    50850,
+    6141,
 };
 
 void convention() { FILE*f = file_open("conv", "w"); fclose(f); }
 
-void run_gc_tests()
+void run_gc_tests(const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
 {
     unsigned i;
     
     printf("RUNNING GC TESTS:\n");
     for (i = 0; i < GC_TESTS_NUM; i++) {
-        run_single_test(i + 1, gc_tests_fnames[i], gc_tests_results[i]);
+        run_single_test(i + 1, gc_tests_fnames[i], gc_tests_results[i], STACKSIZE, gc_params);
     }
     printf("ALL GC TESTS PASSED!\n");
 }
 
+#define LARGE_TESTS_NUM 1
+
+static const char large_tests_fnames[LARGE_TESTS_NUM][MAX_FNAME_SIZE] = {
+    "data/tests/large/01.js",
+};
+
+static const int large_tests_results[LARGE_TESTS_NUM] = {
+    40198,
+};
+
+void run_large_tests(const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    unsigned i;
+    
+    printf("RUNNING LARGE TESTS:\n");
+    for (i = 0; i < LARGE_TESTS_NUM; i++) {
+        run_single_test(i + 1, large_tests_fnames[i], large_tests_results[i], LARGE_STACKSIZE, gc_params);
+    }
+    printf("ALL LARGE TESTS PASSED!\n");
+}
+
+void run_all_tests(const char*conf_name, const struct GARBAGE_COLLECTOR_PARAMS*gc_params)
+{
+    printf("RUNNING TESTS (%s):\n\n", conf_name);
+    run_syntax_tests(gc_params);
+    run_gc_tests(gc_params);
+    run_large_tests(gc_params);
+    printf("ALL TESTS PASSED (%s):\n\n", conf_name);
+}
+
 int main(int argc, char**argv)
 {
+    struct GARBAGE_COLLECTOR_PARAMS gc_params;
+
     PREFIX_UNUSED(argc);
     PREFIX_UNUSED(argv);
 
-    printf("RUNNING TESTS:\n\n");
-    run_syntax_tests();
-    run_gc_tests();
-    printf("ALL TESTS PASSED:\n\n");
+    garbage_collector_default_params(&gc_params);
+    gc_params.sizemem_start = HEAPSIZE;
+    /* every pause of every configuration is logged. */
+    gc_params.stats = 1;
+
+    gc_params.allocation = GARBAGE_COLLECTOR_ALLOCATION_FREE_LIST;
+    run_all_tests("FREE-LIST GC", &gc_params);
+
+    gc_params.allocation = GARBAGE_COLLECTOR_ALLOCATION_BUMP;
+    run_all_tests("BUMP-POINTER GC", &gc_params);
+
+    gc_params.generational = 1;
+    gc_params.nursery_sizemem = NURSERY_SIZE;
+    run_all_tests("GENERATIONAL GC", &gc_params);
+
+    /* heap grows slowly and shrinks after every collection with low occupancy. */
+    gc_params.generational = 0;
+    gc_params.growth_factor = 1.5;
+    gc_params.shrink_after = 1;
+    gc_params.max_sizemem = MAX_HEAPSIZE;
+    run_all_tests("SHRINKING LIMITED GC", &gc_params);
+
+    /* incremental steps are made on almost every allocation in tiny heap. */
+    gc_params.pause_budget_ns = 1000;
+    gc_params.max_sizemem = 0;
+    run_all_tests("INCREMENTAL GC", &gc_params);
+
+    /* heap grows over GARBAGE_COLLECTOR_PARALLEL_SIZEMEM in some tests, then it is copied by several threads. */
+    gc_params.pause_budget_ns = 0;
+    gc_params.threads_num = 4;
+    run_all_tests("PARALLEL GC", &gc_params);
+
+    /* the only space is compacted in place, resized space is limited by the whole heap limit. */
+    gc_params.threads_num = 1;
+    gc_params.compacting = 1;
+    gc_params.max_sizemem = MAX_HEAPSIZE;
+    run_all_tests("MARK-COMPACT GC", &gc_params);
+
+    /* plain generic opcodes must give the same results as superinstructions and quickened ones. */
+    garbage_collector_default_params(&gc_params);
+    gc_params.sizemem_start = HEAPSIZE;
+    gc_params.stats = 1;
+    superinstructions = 0;
+    quickening = 0;
+    run_all_tests("WITHOUT SUPERINSTRUCTIONS AND QUICKENING", &gc_params);
+
+    /* registers are roots, which GC must find in every frame. */
+    register_vm = 1;
+    run_all_tests("REGISTER VM", &gc_params);
+
+    /* read barriers of register VM are only checked in the middle of incremental cycle. */
+    gc_params.pause_budget_ns = 1000;
+    run_all_tests("REGISTER VM, INCREMENTAL GC", &gc_params);
+
+    gc_params.pause_budget_ns = 0;
+    gc_params.generational = 1;
+    gc_params.nursery_sizemem = NURSERY_SIZE;
+    run_all_tests("REGISTER VM, GENERATIONAL GC", &gc_params);
+
+    /* machine code exits to interpreter for calls and heap access, which may run GC. */
+    if (VIRTUAL_MACHINE_JIT) {
+        garbage_collector_default_params(&gc_params);
+        gc_params.sizemem_start = HEAPSIZE;
+        gc_params.stats = 1;
+        register_vm = 0;
+        jit_hotness = 1;
+        run_all_tests("JIT WITHOUT SUPERINSTRUCTIONS AND QUICKENING", &gc_params);
+
+        superinstructions = 1;
+        quickening = 1;
+        gc_params.generational = 1;
+        gc_params.nursery_sizemem = NURSERY_SIZE;
+        run_all_tests("JIT, GENERATIONAL GC", &gc_params);
+
+        /* side exits of traces must leave stack as interpreter would, traces aren't entered during GC cycle. */
+        jit_mode = VIRTUAL_MACHINE_JIT_TRACING;
+        run_all_tests("TRACING JIT, GENERATIONAL GC", &gc_params);
+
+        superinstructions = 0;
+        quickening = 0;
+        gc_params.generational = 0;
+        gc_params.pause_budget_ns = 1000;
+        run_all_tests("TRACING JIT WITHOUT SUPERINSTRUCTIONS AND QUICKENING, INCREMENTAL GC", &gc_params);
+    }
 
     return 0;
 }
@@ -0,0 +1,357 @@
+#include "trace.h"
+#include "bytecode-generator.h"
+
+#include "utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <string.h>
+
+enum DECODER_FORMAT
+{
+    DECODER_XML,
+    DECODER_CSV,
+    DECODER_NGRAMS,
+};
+
+#define DECODER_XML_STR    "xml"
+#define DECODER_CSV_STR    "csv"
+#define DECODER_NGRAMS_STR "ngrams"
+
+/* records, which are read from trace at once. */
+#define DECODER_BUF_RECORDS 4096
+
+#define DECODER_MAX_INS 64
+
+struct DECODER_PARAMS
+{
+    char ins[DECODER_MAX_INS][STR_BUF_SIZE];
+    size_t ins_len;
+    char out[STR_BUF_SIZE];
+    enum DECODER_FORMAT format;
+    size_t top;
+};
+
+static void print_help(char*decoder_name)
+{
+    fprintf(stderr, "Usage: %s [options] [trace...]\n", decoder_name);
+    fprintf(stderr, "Converts binary trace of interpreter (--mode trace) to text.\n");
+    fprintf(stderr, "In ngrams format opcode bigrams and trigrams are counted over all given traces.\n");
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --help    (-h)\n");
+    fprintf(stderr, "            Print this help info.\n");
+    fprintf(stderr, "  --in      (-i)\n");
+    fprintf(stderr, "            Path to trace file (stdin) (default: stdin).\n");
+    fprintf(stderr, "  --out     (-o)\n");
+    fprintf(stderr, "            Path to output file (stdout|stderr) (default: stdout).\n");
+    fprintf(stderr, "  --format  (-f)\n");
+    fprintf(stderr, "            Output format (xml|csv|ngrams) (default: xml).\n");
+    fprintf(stderr, "  --top     (-n)\n");
+    fprintf(stderr, "            Number of the most frequent bigrams and trigrams in ngrams format (default: 20).\n");
+    exit(0);
+}
+
+static void add_in(struct DECODER_PARAMS*params, const char*in)
+{
+    if (params->ins_len == DECODER_MAX_INS) {
+        fprintf(stderr, "Too many traces, at most %d are decoded at once\n", DECODER_MAX_INS);
+        exit(EXIT_FAILURE);
+    }
+    strncpy(params->ins[params->ins_len], in, STR_BUF_SIZE - 1);
+    params->ins[params->ins_len][STR_BUF_SIZE - 1] = '\0';
+    params->ins_len++;
+}
+
+static void parse_args(int argc, char**argv, struct DECODER_PARAMS*params)
+{
+    struct option opts[] = {
+        {"help",   0, 0, 'h'},
+        {"in",     1, 0, 'i'},
+        {"out",    1, 0, 'o'},
+        {"format", 1, 0, 'f'},
+        {"top",    1, 0, 'n'},
+        {0,0,0,0}
+    };
+
+    int c;
+    int idx;
+
+    params->ins_len = 0;
+    strncpy(params->out, "stdout", sizeof(params->out));
+    params->format = DECODER_XML;
+    params->top = 20;
+
+    while ((c = getopt_long(argc, argv, "i:o:f:n:h", opts, &idx)) != -1) {
+        switch (c) {
+        case 'h':
+            print_help(argv[0]);
+            break;
+        case 'i':
+            add_in(params, optarg);
+            break;
+        case 'o':
+            strncpy(params->out, optarg, sizeof(params->out) - 1);
+            break;
+        case 'f':
+            if (strcmp(optarg, DECODER_XML_STR) == 0) {
+                params->format = DECODER_XML;
+            } else if (strcmp(optarg, DECODER_CSV_STR) == 0) {
+                params->format = DECODER_CSV;
+            } else if (strcmp(optarg, DECODER_NGRAMS_STR) == 0) {
+                params->format = DECODER_NGRAMS;
+            } else {
+                fprintf(stderr, "Invalid output format \"%s\"", optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'n':
+            params->top = atoll(optarg);
+            break;
+        default:
+            /* do nothing. */
+            break;
+        }
+    }
+
+    for (; optind < argc; optind++) {
+        add_in(params, argv[optind]);
+    }
+    if (params->ins_len == 0) {
+        add_in(params, "stdin");
+    }
+    if ((params->format != DECODER_NGRAMS) && (params->ins_len != 1)) {
+        fprintf(stderr, "Only one trace can be converted to %s\n", (params->format == DECODER_XML) ? DECODER_XML_STR : DECODER_CSV_STR);
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* returns 1, if trace has end record. */
+static int decode(FILE*in, FILE*out, enum DECODER_FORMAT format)
+{
+    uint64_t buf[DECODER_BUF_RECORDS];
+    size_t heap_used = 0;
+    size_t n, i;
+
+    if (format == DECODER_XML) {
+        fprintf(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+        fprintf(out, "<trace>\n");
+    } else {
+        fprintf(out, "op,ip,stack,heap_used\n");
+    }
+
+    while ((n = fread(buf, sizeof(uint64_t), DECODER_BUF_RECORDS, in)) != 0) {
+        for (i = 0; i < n; i++) {
+            uint64_t r = buf[i];
+
+            switch (TRACE_RECORD_OP(r)) {
+            case TRACE_OP_HEAP:
+                heap_used = TRACE_RECORD_HEAP(r);
+                break;
+            case TRACE_OP_END:
+                if (format == DECODER_XML) {
+                    fprintf(out, "</trace>\n");
+                }
+                return 1;
+            default:
+                if (format == DECODER_XML) {
+                    fprintf(out, "\t<step op=\"%u\" ip=\"%zu\" stack=\"%zu\" heap_used=\"%zu\"/>\n",
+                            TRACE_RECORD_OP(r), TRACE_RECORD_IP(r), TRACE_RECORD_STACK(r), heap_used);
+                } else {
+                    fprintf(out, "%u,%zu,%zu,%zu\n",
+                            TRACE_RECORD_OP(r), TRACE_RECORD_IP(r), TRACE_RECORD_STACK(r), heap_used);
+                }
+                break;
+            }
+        }
+    }
+
+    if (format == DECODER_XML) {
+        fprintf(out, "</trace>\n");
+    }
+    return 0;
+}
+
+/*
+  Opcode n-grams of executed instructions. N-gram doesn't cross boundary of trace,
+  so the first steps of every trace don't start bigrams and trigrams. Quickened opcodes
+  are counted as their generic ones, which generator emits and superinstructions replace.
+*/
+struct NGRAMS
+{
+    unsigned long long steps;
+    unsigned long long bigrams_num;
+    unsigned long long trigrams_num;
+
+    unsigned long long*bigrams;  /* indexed by op1 * BC_OPS_NUM + op2.                      */
+    unsigned long long*trigrams; /* indexed by (op1 * BC_OPS_NUM + op2) * BC_OPS_NUM + op3. */
+};
+
+struct NGRAM
+{
+    size_t idx;
+    unsigned long long count;
+};
+
+/* returns 1, if trace has end record. */
+static int count_ngrams(FILE*in, struct NGRAMS*ng)
+{
+    uint64_t buf[DECODER_BUF_RECORDS];
+    size_t n, i;
+
+    /* BC_OPS_NUM means, that there is no previous step. */
+    unsigned prev1 = BC_OPS_NUM, prev2 = BC_OPS_NUM;
+
+    while ((n = fread(buf, sizeof(uint64_t), DECODER_BUF_RECORDS, in)) != 0) {
+        for (i = 0; i < n; i++) {
+            unsigned op = TRACE_RECORD_OP(buf[i]);
+
+            if (op == TRACE_OP_HEAP) {
+                continue;
+            }
+            if (op == TRACE_OP_END) {
+                return 1;
+            }
+            if (op >= BC_OPS_NUM) {
+                fprintf(stderr, "unknown opcode %u in trace\n", op);
+                exit(EXIT_FAILURE);
+            }
+            if (op >= BC_OP_LOGICAL_OR_INT) {
+                op = BC_OP_DEOPTIMIZED(op);
+            }
+
+            ng->steps++;
+            if (prev1 != BC_OPS_NUM) {
+                ng->bigrams[prev1 * BC_OPS_NUM + op]++;
+                ng->bigrams_num++;
+                if (prev2 != BC_OPS_NUM) {
+                    ng->trigrams[(prev2 * BC_OPS_NUM + prev1) * BC_OPS_NUM + op]++;
+                    ng->trigrams_num++;
+                }
+            }
+            prev2 = prev1;
+            prev1 = op;
+        }
+    }
+
+    return 0;
+}
+
+static int compare_ngrams(const void*a, const void*b)
+{
+    const struct NGRAM*x = a;
+    const struct NGRAM*y = b;
+
+    if (x->count != y->count) {
+        return (x->count < y->count) - (x->count > y->count);
+    }
+    return (x->idx > y->idx) - (x->idx < y->idx);
+}
+
+/* prints top of n-grams with nonzero counts in descending order. */
+static void dump_ngrams(FILE*out, const char*tag, const unsigned long long*counts, size_t counts_len,
+                        unsigned long long total, size_t n, size_t top)
+{
+    struct NGRAM*ngrams;
+    size_t ngrams_len = 0;
+    size_t i, j;
+
+    SAFE_MALLOC(ngrams, counts_len);
+    for (i = 0; i < counts_len; i++) {
+        if (counts[i] != 0) {
+            ngrams[ngrams_len].idx = i;
+            ngrams[ngrams_len].count = counts[i];
+            ngrams_len++;
+        }
+    }
+    qsort(ngrams, ngrams_len, sizeof(struct NGRAM), compare_ngrams);
+
+    for (i = 0; (i < ngrams_len) && (i < top); i++) {
+        unsigned ops[3];
+        size_t idx = ngrams[i].idx;
+
+        for (j = n; j > 0; j--) {
+            ops[j - 1] = idx % BC_OPS_NUM;
+            idx /= BC_OPS_NUM;
+        }
+
+        fprintf(out, "\t<%s count=\"%llu\" percent=\"%.2lf\">", tag, ngrams[i].count, 100.0 * ngrams[i].count / total);
+        for (j = 0; j < n; j++) {
+            fprintf(out, "%s%s", (j == 0) ? "" : " ", bytecode_op_name(ops[j]));
+        }
+        fprintf(out, "</%s>\n", tag);
+    }
+
+    SAFE_FREE(ngrams);
+}
+
+static FILE*open_trace(const char*in)
+{
+    FILE*f = file_open(in, "rb");
+    if (!trace_read_header(f)) {
+        fprintf(stderr, "\"%s\" is not a trace of version %u\n", in, TRACE_VERSION);
+        exit(EXIT_FAILURE);
+    }
+    return f;
+}
+
+static void close_file(FILE*f)
+{
+    if ((f != stdin) && (f != stdout) && (f != stderr)) {
+        fclose(f);
+    }
+}
+
+int main(int argc, char**argv)
+{
+    struct DECODER_PARAMS params;
+    FILE*in;
+    FILE*out;
+    size_t i;
+
+    parse_args(argc, argv, &params);
+
+    if (params.format != DECODER_NGRAMS) {
+        int complete;
+
+        in = open_trace(params.ins[0]);
+        out = file_open(params.out, "w");
+        complete = decode(in, out, params.format);
+        close_file(in);
+        close_file(out);
+
+        if (!complete) {
+            fprintf(stderr, "trace is truncated: no end record\n");
+            return 1;
+        }
+    } else {
+        struct NGRAMS ng;
+
+        memset(&ng, 0, sizeof(ng));
+        SAFE_CALLOC(ng.bigrams, BC_OPS_NUM * BC_OPS_NUM);
+        SAFE_CALLOC(ng.trigrams, BC_OPS_NUM * BC_OPS_NUM * BC_OPS_NUM);
+
+        for (i = 0; i < params.ins_len; i++) {
+            in = open_trace(params.ins[i]);
+            if (!count_ngrams(in, &ng)) {
+                fprintf(stderr, "trace \"%s\" is truncated: no end record\n", params.ins[i]);
+                return 1;
+            }
+            close_file(in);
+        }
+
+        out = file_open(params.out, "w");
+        fprintf(out, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+        fprintf(out, "<ngrams traces=\"%zu\" steps=\"%llu\" bigrams=\"%llu\" trigrams=\"%llu\">\n",
+                params.ins_len, ng.steps, ng.bigrams_num, ng.trigrams_num);
+        dump_ngrams(out, "bigram", ng.bigrams, BC_OPS_NUM * BC_OPS_NUM, ng.bigrams_num, 2, params.top);
+        dump_ngrams(out, "trigram", ng.trigrams, BC_OPS_NUM * BC_OPS_NUM * BC_OPS_NUM, ng.trigrams_num, 3, params.top);
+        fprintf(out, "</ngrams>\n");
+        close_file(out);
+
+        SAFE_FREE(ng.bigrams);
+        SAFE_FREE(ng.trigrams);
+    }
+
+    return 0;
+}
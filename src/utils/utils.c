@@ -1,6 +1,9 @@
+#define _POSIX_C_SOURCE 199309L
+
 #include "utils.h"
 
 #include <string.h>
+#include <time.h>
 
 FILE*file_open(const char*fname, const char*mode)
 {
@@ -20,3 +23,10 @@ FILE*file_open(const char*fname, const char*mode)
         return f;
     }
 }
+
+unsigned long long get_time_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((unsigned long long) ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
@@ -43,6 +43,9 @@
 
 FILE*file_open(const char*fname, const char*mode);
 
+/* monotonic time in nanoseconds. */
+unsigned long long get_time_ns();
+
 /*
   This macro is not safe for expressions!!!
   Use it only for variables!!!
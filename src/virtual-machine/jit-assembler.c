@@ -0,0 +1,157 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "jit-private.h"
+
+#if VIRTUAL_MACHINE_JIT
+
+#include "utils.h"
+
+#include <string.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* executable mapping of one compiled loop or trace. */
+struct JIT_CHUNK
+{
+    struct JIT_CHUNK*next;
+    void*mem;
+    size_t sizemem;
+};
+
+void jit_emit_byte(struct JIT_BUFFER*buf, uint8_t byte)
+{
+    PUSH_BACK(buf->code, byte);
+}
+
+void jit_emit_bytes(struct JIT_BUFFER*buf, const uint8_t*bytes, size_t len)
+{
+    size_t i;
+    for (i = 0; i < len; i++) {
+        jit_emit_byte(buf, bytes[i]);
+    }
+}
+
+/* x86-64 is little endian, as host. */
+void jit_emit_u32(struct JIT_BUFFER*buf, uint32_t val)
+{
+    uint8_t bytes[sizeof(val)];
+    memcpy(bytes, &val, sizeof(val));
+    jit_emit_bytes(buf, bytes, sizeof(bytes));
+}
+
+void jit_emit_u64(struct JIT_BUFFER*buf, uint64_t val)
+{
+    uint8_t bytes[sizeof(val)];
+    memcpy(bytes, &val, sizeof(val));
+    jit_emit_bytes(buf, bytes, sizeof(bytes));
+}
+
+void jit_emit_mem(struct JIT_BUFFER*buf, int w, uint8_t op, int reg, int base, int32_t disp)
+{
+    uint8_t rex = 0x40 | (w ? 0x08 : 0x00) | ((reg & 8) ? 0x04 : 0x00) | ((base & 8) ? 0x01 : 0x00);
+    if (rex != 0x40) {
+        jit_emit_byte(buf, rex);
+    }
+    jit_emit_byte(buf, op);
+    jit_emit_byte(buf, 0x80 | ((reg & 7) << 3) | (base & 7));
+    /* rsp and r12 as base need SIB byte. */
+    if ((base & 7) == JIT_RSP) {
+        jit_emit_byte(buf, 0x24);
+    }
+    jit_emit_u32(buf, (uint32_t) disp);
+}
+
+void jit_emit_reg(struct JIT_BUFFER*buf, uint8_t op, int dst, int src)
+{
+    jit_emit_byte(buf, 0x48 | ((src & 8) ? 0x04 : 0x00) | ((dst & 8) ? 0x01 : 0x00));
+    jit_emit_byte(buf, op);
+    jit_emit_byte(buf, 0xC0 | ((src & 7) << 3) | (dst & 7));
+}
+
+void jit_emit_ext(struct JIT_BUFFER*buf, uint8_t op, int ext, int reg)
+{
+    jit_emit_byte(buf, 0x48 | ((reg & 8) ? 0x01 : 0x00));
+    jit_emit_byte(buf, op);
+    jit_emit_byte(buf, 0xC0 | (ext << 3) | (reg & 7));
+}
+
+void jit_emit_mov_imm64(struct JIT_BUFFER*buf, int reg, uint64_t imm)
+{
+    jit_emit_byte(buf, 0x48 | ((reg & 8) ? 0x01 : 0x00));
+    jit_emit_byte(buf, 0xB8 + (reg & 7));
+    jit_emit_u64(buf, imm);
+}
+
+size_t jit_emit_jump(struct JIT_BUFFER*buf, enum JIT_CONDITION cc)
+{
+    if (cc == JIT_CC_ALWAYS) {
+        jit_emit_byte(buf, 0xE9);
+    } else {
+        jit_emit_byte(buf, 0x0F);
+        jit_emit_byte(buf, 0x80 + cc);
+    }
+    jit_emit_u32(buf, 0);
+    return buf->code_len - sizeof(uint32_t);
+}
+
+void jit_patch_rel32(struct JIT_BUFFER*buf, size_t pos, size_t target)
+{
+    int32_t rel = (int32_t) ((long long) target - (long long) (pos + sizeof(rel)));
+    memcpy(buf->code + pos, &rel, sizeof(rel));
+}
+
+void*jit_map_code(struct JIT*jit, const struct JIT_BUFFER*buf)
+{
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t sizemem = (buf->code_len + page - 1) & ~(page - 1);
+    struct JIT_CHUNK*chunk;
+
+    void*mem = mmap(NULL, sizemem, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) {
+        return NULL;
+    }
+    memcpy(mem, buf->code, buf->code_len);
+    if (mprotect(mem, sizemem, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, sizemem);
+        return NULL;
+    }
+
+    SAFE_MALLOC(chunk, 1);
+    chunk->mem = mem;
+    chunk->sizemem = sizemem;
+    chunk->next = jit->chunks;
+    jit->chunks = chunk;
+
+    jit->code_sizemem += buf->code_len;
+
+    return mem;
+}
+
+void jit_buffer_free(struct JIT_BUFFER*buf)
+{
+    SAFE_FREE(buf->code);
+    buf->code_len = 0;
+    buf->code_cap = 0;
+}
+
+void jit_free(struct JIT*jit)
+{
+    while (jit->chunks != NULL) {
+        struct JIT_CHUNK*next = jit->chunks->next;
+        munmap(jit->chunks->mem, jit->chunks->sizemem);
+        SAFE_FREE(jit->chunks);
+        jit->chunks = next;
+    }
+    while (jit->traces != NULL) {
+        struct JIT_TRACE*next = jit->traces->next;
+        SAFE_FREE(jit->traces->exits);
+        SAFE_FREE(jit->traces->exit_ips);
+        SAFE_FREE(jit->traces);
+        jit->traces = next;
+    }
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef JIT_PRIVATE_H_INCLUDED
+#define JIT_PRIVATE_H_INCLUDED
+
+#include "jit.h"
+
+#if VIRTUAL_MACHINE_JIT
+
+/* x86-64 encoder, which is shared by template and tracing JIT. */
+
+/* registers by their numbers in ModRM/REX. */
+enum JIT_REGISTER
+{
+    JIT_RAX,
+    JIT_RCX,
+    JIT_RDX,
+    JIT_RBX,
+    JIT_RSP,
+    JIT_RBP,
+    JIT_RSI,
+    JIT_RDI,
+    JIT_R8,
+    JIT_R9,
+    JIT_R10,
+    JIT_R11,
+    JIT_R12,
+    JIT_R13,
+    JIT_R14,
+    JIT_R15,
+};
+
+/* condition codes of Jcc and SETcc; negated condition differs in the lowest bit. */
+enum JIT_CONDITION
+{
+    JIT_CC_B  = 0x2,
+    JIT_CC_AE = 0x3,
+    JIT_CC_E  = 0x4,
+    JIT_CC_NE = 0x5,
+    JIT_CC_L  = 0xC,
+    JIT_CC_GE = 0xD,
+    JIT_CC_LE = 0xE,
+    JIT_CC_G  = 0xF,
+    JIT_CC_ALWAYS = -1, /* JMP. */
+};
+
+#define JIT_CC_NOT(cc) ((enum JIT_CONDITION) ((cc) ^ 1))
+
+#define JIT_VALUE_SIZE ((int32_t) sizeof(struct VALUE))
+
+struct JIT_BUFFER
+{
+    uint8_t*code;
+    size_t code_len;
+    size_t code_cap;
+};
+
+void jit_emit_byte(struct JIT_BUFFER*buf, uint8_t byte);
+void jit_emit_bytes(struct JIT_BUFFER*buf, const uint8_t*bytes, size_t len);
+void jit_emit_u32(struct JIT_BUFFER*buf, uint32_t val);
+void jit_emit_u64(struct JIT_BUFFER*buf, uint64_t val);
+
+/* op reg, [base + disp32]; w - 64-bit operand size. */
+void jit_emit_mem(struct JIT_BUFFER*buf, int w, uint8_t op, int reg, int base, int32_t disp);
+
+/* 64-bit op dst, src, where dst is r/m operand. */
+void jit_emit_reg(struct JIT_BUFFER*buf, uint8_t op, int dst, int src);
+
+/* 64-bit op, whose ModRM keeps opcode extension and register (shifts, neg, arithmetic with immediate). */
+void jit_emit_ext(struct JIT_BUFFER*buf, uint8_t op, int ext, int reg);
+
+void jit_emit_mov_imm64(struct JIT_BUFFER*buf, int reg, uint64_t imm);
+
+/* Jcc or JMP with zero rel32; returns position of rel32 to be patched. */
+size_t jit_emit_jump(struct JIT_BUFFER*buf, enum JIT_CONDITION cc);
+
+void jit_patch_rel32(struct JIT_BUFFER*buf, size_t pos, size_t target);
+
+/* copies code into new pages, which are made executable and read-only; NULL on failure. */
+void*jit_map_code(struct JIT*jit, const struct JIT_BUFFER*buf);
+
+void jit_buffer_free(struct JIT_BUFFER*buf);
+
+#endif
+
+#endif  /* JIT_PRIVATE_H_INCLUDED */
@@ -0,0 +1,452 @@
+#include "jit-private.h"
+
+#if VIRTUAL_MACHINE_JIT
+
+#include "utils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* callee-saved registers keep state of interpreter in machine code; rax, rcx and rdx are scratch. */
+#define JIT_SP     JIT_RBX /* top of operand stack. */
+#define JIT_BP     JIT_R14 /* locals of function.   */
+#define JIT_SP_OUT JIT_R15 /* where sp is stored, when machine code exits. */
+
+/* push rbx; push r14; push r15; mov r14, rdi; mov r15, rsi; mov rbx, [rsi]. */
+static const uint8_t prologue_template[] = {
+    0x53, 0x41, 0x56, 0x41, 0x57,
+    0x49, 0x89, 0xFE,
+    0x49, 0x89, 0xF7,
+    0x48, 0x8B, 0x1E,
+};
+
+/* mov [r15], rbx; pop r15; pop r14; pop rbx; ret (ip is already in rax). */
+static const uint8_t epilogue_template[] = {
+    0x49, 0x89, 0x1F,
+    0x41, 0x5F, 0x41, 0x5E, 0x5B,
+    0xC3,
+};
+
+/* rel32, which is patched after the whole loop is emitted. */
+struct JIT_FIXUP
+{
+    size_t pos;
+    uint8_t*ip; /* instruction of loop or ip, which machine code exits with. */
+};
+
+struct JIT_COMPILER
+{
+    struct JIT_BUFFER buf;
+
+    uint8_t*start;
+    uint8_t*end;
+    size_t*positions; /* offset of machine code of every instruction of loop. */
+
+    struct JIT_FIXUP*jumps; /* to instructions of loop. */
+    size_t jumps_len;
+    size_t jumps_cap;
+
+    struct JIT_FIXUP*exits; /* to exit stubs after loop. */
+    size_t exits_len;
+    size_t exits_cap;
+
+    size_t pushes; /* bound of stack growth during one iteration. */
+};
+
+/* add/sub rbx, imm8. */
+static void emit_sp_move(struct JIT_COMPILER*jc, int values)
+{
+    uint8_t bytes[] = {0x48, 0x83, 0xC3, 0x00};
+    if (values < 0) {
+        bytes[2] = 0xEB;
+        values = -values;
+    } else {
+        jc->pushes += values;
+    }
+    bytes[3] = (uint8_t) (values * JIT_VALUE_SIZE);
+    jit_emit_bytes(&(jc->buf), bytes, sizeof(bytes));
+}
+
+/* returns to interpreter with ip. */
+static void emit_exit(struct JIT_COMPILER*jc, const uint8_t*ip)
+{
+    jit_emit_mov_imm64(&(jc->buf), JIT_RAX, (uint64_t) (uintptr_t) ip);
+    jit_emit_bytes(&(jc->buf), epilogue_template, sizeof(epilogue_template));
+}
+
+/* conditional exit; stub is emitted after loop, so fall-through path has no jumps. */
+static void emit_exit_if(struct JIT_COMPILER*jc, enum JIT_CONDITION cc, uint8_t*ip)
+{
+    struct JIT_FIXUP fixup;
+
+    fixup.pos = jit_emit_jump(&(jc->buf), cc);
+    fixup.ip = ip;
+    PUSH_BACK(jc->exits, fixup);
+}
+
+/* jump to target, which is either instruction of loop or ip to exit with. */
+static void emit_jump(struct JIT_COMPILER*jc, enum JIT_CONDITION cc, uint8_t*target)
+{
+    struct JIT_FIXUP fixup;
+
+    if ((target < jc->start) || (target >= jc->end)) {
+        if (cc == JIT_CC_ALWAYS) {
+            emit_exit(jc, target);
+        } else {
+            emit_exit_if(jc, cc, target);
+        }
+        return;
+    }
+
+    fixup.pos = jit_emit_jump(&(jc->buf), cc);
+    fixup.ip = target;
+    PUSH_BACK(jc->jumps, fixup);
+}
+
+/* templates, which depend on representation of VALUE. */
+
+#ifdef VALUE_NAN_BOXING
+
+/* shift of scratch register by 16: ext is 4 (shl), 5 (shr) or 7 (sar). */
+static void emit_shift16(struct JIT_COMPILER*jc, int ext, int reg)
+{
+    uint8_t bytes[] = {0x48, 0xC1, 0xC0 | (ext << 3) | reg, 16};
+    jit_emit_bytes(&(jc->buf), bytes, sizeof(bytes));
+}
+
+/* reg = integer of value at [base + disp]; exits with ip, when value isn't integer. Clobbers rcx. */
+static void emit_load_int(struct JIT_COMPILER*jc, int reg, int base, int32_t disp, uint8_t*ip)
+{
+    /* mov reg, [m]; mov rcx, reg; shr rcx, 48; cmp ecx, tag; jne exit; shl reg, 16; sar reg, 16. */
+    uint8_t check[] = {0x48, 0xC1, 0xE9, 48, 0x81, 0xF9};
+
+    jit_emit_mem(&(jc->buf), 1, 0x8B, reg, base, disp);
+    jit_emit_reg(&(jc->buf), 0x89, JIT_RCX, reg);
+    jit_emit_bytes(&(jc->buf), check, sizeof(check));
+    jit_emit_u32(&(jc->buf), (uint32_t) (VALUE_NAN_BOXING_TAG_INTEGER >> 48));
+    emit_exit_if(jc, JIT_CC_NE, ip);
+    emit_shift16(jc, 4, reg);
+    emit_shift16(jc, 7, reg);
+}
+
+/* [base + disp] = integer in reg, truncated to payload. Clobbers reg and rcx. */
+static void emit_store_int(struct JIT_COMPILER*jc, int reg, int base, int32_t disp)
+{
+    emit_shift16(jc, 4, reg);
+    emit_shift16(jc, 5, reg);
+    jit_emit_mov_imm64(&(jc->buf), JIT_RCX, VALUE_NAN_BOXING_TAG_INTEGER);
+    jit_emit_reg(&(jc->buf), 0x09, reg, JIT_RCX);
+    jit_emit_mem(&(jc->buf), 1, 0x89, reg, base, disp);
+}
+
+/* ZF is set, when integer of value at [base + disp] is zero. Clobbers rax. */
+static void emit_test_int(struct JIT_COMPILER*jc, int base, int32_t disp)
+{
+    jit_emit_mem(&(jc->buf), 1, 0x8B, JIT_RAX, base, disp);
+    emit_shift16(jc, 4, JIT_RAX);
+}
+
+#else
+
+#define JIT_VALUE_INT_OFFSET  ((int32_t) offsetof(struct VALUE, int_val))
+#define JIT_VALUE_TYPE_OFFSET ((int32_t) offsetof(struct VALUE, type))
+
+/* reg = integer of value at [base + disp]; exits with ip, when value isn't integer. */
+static void emit_load_int(struct JIT_COMPILER*jc, int reg, int base, int32_t disp, uint8_t*ip)
+{
+    /* cmp dword [m + type], VALUE_TYPE_INTEGER; jne exit; mov reg, [m + int_val]. */
+    jit_emit_mem(&(jc->buf), 0, 0x83, 7, base, disp + JIT_VALUE_TYPE_OFFSET);
+    jit_emit_byte(&(jc->buf), VALUE_TYPE_INTEGER);
+    emit_exit_if(jc, JIT_CC_NE, ip);
+    jit_emit_mem(&(jc->buf), 1, 0x8B, reg, base, disp + JIT_VALUE_INT_OFFSET);
+}
+
+/* [base + disp] = integer in reg. */
+static void emit_store_int(struct JIT_COMPILER*jc, int reg, int base, int32_t disp)
+{
+    jit_emit_mem(&(jc->buf), 1, 0x89, reg, base, disp + JIT_VALUE_INT_OFFSET);
+    jit_emit_mem(&(jc->buf), 0, 0xC7, 0, base, disp + JIT_VALUE_TYPE_OFFSET);
+    jit_emit_u32(&(jc->buf), VALUE_TYPE_INTEGER);
+}
+
+/* ZF is set, when integer of value at [base + disp] is zero. */
+static void emit_test_int(struct JIT_COMPILER*jc, int base, int32_t disp)
+{
+    jit_emit_mem(&(jc->buf), 1, 0x83, 7, base, disp + JIT_VALUE_INT_OFFSET);
+    jit_emit_byte(&(jc->buf), 0);
+}
+
+#endif
+
+/* [dst_base + dst_disp] = [src_base + src_disp] by 8-byte words. Clobbers rax. */
+static void emit_copy_value(struct JIT_COMPILER*jc, int dst_base, int32_t dst_disp, int src_base, int32_t src_disp)
+{
+    int32_t i;
+    for (i = 0; i < JIT_VALUE_SIZE; i += 8) {
+        jit_emit_mem(&(jc->buf), 1, 0x8B, JIT_RAX, src_base, src_disp + i);
+        jit_emit_mem(&(jc->buf), 1, 0x89, JIT_RAX, dst_base, dst_disp + i);
+    }
+}
+
+/* rax = rax op rdx for binary opcode; exits with ip on division by zero. */
+static void emit_binary(struct JIT_COMPILER*jc, size_t op, uint8_t*ip)
+{
+    /* setcc al; movzx eax, al. */
+    uint8_t setcc[] = {0x0F, 0x90, 0xC0, 0x0F, 0xB6, 0xC0};
+    /* test rax, rax; setne al; test rdx, rdx; setne dl; and al, dl; movzx eax, al. */
+    static const uint8_t logical_and[] = {
+        0x48, 0x85, 0xC0, 0x0F, 0x95, 0xC0,
+        0x48, 0x85, 0xD2, 0x0F, 0x95, 0xC2,
+        0x20, 0xD0, 0x0F, 0xB6, 0xC0,
+    };
+    /* imul rax, rdx. */
+    static const uint8_t mul[] = {0x48, 0x0F, 0xAF, 0xC2};
+    /* test rdx, rdx. */
+    static const uint8_t test_divisor[] = {0x48, 0x85, 0xD2};
+    /* mov rcx, rdx; cqo; idiv rcx. */
+    static const uint8_t div[] = {0x48, 0x89, 0xD1, 0x48, 0x99, 0x48, 0xF7, 0xF9};
+
+    enum JIT_CONDITION cc;
+
+    switch (op) {
+    case BC_OP_ADDITIVE_PLUS:
+        jit_emit_reg(&(jc->buf), 0x01, JIT_RAX, JIT_RDX);
+        return;
+    case BC_OP_ADDITIVE_MINUS:
+        jit_emit_reg(&(jc->buf), 0x29, JIT_RAX, JIT_RDX);
+        return;
+    case BC_OP_MULTIPLICATIVE_MUL:
+        jit_emit_bytes(&(jc->buf), mul, sizeof(mul));
+        return;
+    case BC_OP_MULTIPLICATIVE_DIV:
+    case BC_OP_MULTIPLICATIVE_MOD:
+        /* interpreter reports division by zero. */
+        jit_emit_bytes(&(jc->buf), test_divisor, sizeof(test_divisor));
+        emit_exit_if(jc, JIT_CC_E, ip);
+        jit_emit_bytes(&(jc->buf), div, sizeof(div));
+        if (op == BC_OP_MULTIPLICATIVE_MOD) {
+            jit_emit_reg(&(jc->buf), 0x89, JIT_RAX, JIT_RDX);
+        }
+        return;
+    case BC_OP_LOGICAL_AND:
+        jit_emit_bytes(&(jc->buf), logical_and, sizeof(logical_and));
+        return;
+    case BC_OP_LOGICAL_OR:
+        jit_emit_reg(&(jc->buf), 0x09, JIT_RAX, JIT_RDX);
+        cc = JIT_CC_NE;
+        break;
+    case BC_OP_EQ_EQEQ: cc = JIT_CC_E;  break;
+    case BC_OP_EQ_NEQ:  cc = JIT_CC_NE; break;
+    case BC_OP_REL_LT:  cc = JIT_CC_L;  break;
+    case BC_OP_REL_GT:  cc = JIT_CC_G;  break;
+    case BC_OP_REL_LE:  cc = JIT_CC_LE; break;
+    case BC_OP_REL_GE:
+    default:
+        cc = JIT_CC_GE;
+        break;
+    }
+
+    if (op != BC_OP_LOGICAL_OR) {
+        jit_emit_reg(&(jc->buf), 0x39, JIT_RAX, JIT_RDX);
+    }
+    setcc[1] = 0x90 + cc;
+    jit_emit_bytes(&(jc->buf), setcc, sizeof(setcc));
+}
+
+/* condition, when fused compare of local and constant doesn't hold and jumps. */
+static enum JIT_CONDITION fused_jump_condition(size_t op)
+{
+    switch (op) {
+    case BC_OP_LT_LOCAL_CONST_JUMP:  return JIT_CC_GE;
+    case BC_OP_GT_LOCAL_CONST_JUMP:  return JIT_CC_LE;
+    case BC_OP_LE_LOCAL_CONST_JUMP:  return JIT_CC_G;
+    case BC_OP_GE_LOCAL_CONST_JUMP:  return JIT_CC_L;
+    case BC_OP_EQ_LOCAL_CONST_JUMP:  return JIT_CC_NE;
+    case BC_OP_NEQ_LOCAL_CONST_JUMP:
+    default:
+        return JIT_CC_E;
+    }
+}
+
+/* opcodes, which have templates; quickened ones are compiled as generic ones. */
+static int is_supported(size_t op)
+{
+    if ((op >= BC_OP_LOGICAL_OR_INT) && (op <= BC_OP_NEGATE_INT)) {
+        return 1;
+    }
+    switch (op) {
+    case BC_OP_POP:
+    case BC_OP_CONSTANT:
+    case BC_OP_GET_LOCAL:
+    case BC_OP_SET_LOCAL:
+    case BC_OP_JUMP_IF_FALSE:
+    case BC_OP_JUMP:
+    case BC_OP_JUMP_IF_FALSE_WIDE:
+    case BC_OP_JUMP_WIDE:
+    case BC_OP_INC_LOCAL:
+        return 1;
+    default:
+        return ((op >= BC_OP_LOGICAL_OR) && (op <= BC_OP_NEGATE)) ||
+            ((op >= BC_OP_LT_LOCAL_CONST_JUMP) && (op <= BC_OP_NEQ_LOCAL_CONST_JUMP));
+    }
+}
+
+/* emits template of instruction at ip and returns the next instruction. */
+static uint8_t*emit_instruction(struct JIT_COMPILER*jc, const bytecode_type_t bc, uint8_t*ip)
+{
+    uint8_t*instruction = ip;
+    size_t op = *(ip++);
+
+    if (!is_supported(op)) {
+        emit_exit(jc, instruction);
+        return instruction + bytecode_instruction_len(instruction);
+    }
+    if ((op >= BC_OP_LOGICAL_OR_INT) && (op <= BC_OP_NEGATE_INT)) {
+        op = BC_OP_DEOPTIMIZED(op);
+    }
+
+    switch (op) {
+    case BC_OP_POP:
+        emit_sp_move(jc, -1);
+        break;
+
+    case BC_OP_CONSTANT: {
+        long long cnst = bc->constant_pool[bytecode_read_uleb128(&ip)].int_cnst;
+        jit_emit_mov_imm64(&(jc->buf), JIT_RAX, (uint64_t) cnst);
+        emit_store_int(jc, JIT_RAX, JIT_SP, 0);
+        emit_sp_move(jc, 1);
+        break;
+    }
+
+    case BC_OP_GET_LOCAL: {
+        int32_t disp = (int32_t) bytecode_read_uleb128(&ip) * JIT_VALUE_SIZE;
+        emit_copy_value(jc, JIT_SP, 0, JIT_BP, disp);
+        emit_sp_move(jc, 1);
+        break;
+    }
+    case BC_OP_SET_LOCAL: {
+        int32_t disp = (int32_t) bytecode_read_uleb128(&ip) * JIT_VALUE_SIZE;
+        /* lea rax, [bp + disp + size]; cmp rax, rbx; je +4 (value is local itself, it stays on stack). */
+        static const uint8_t keep[] = {0x48, 0x39, 0xD8, 0x74, 0x04};
+        emit_copy_value(jc, JIT_BP, disp, JIT_SP, -JIT_VALUE_SIZE);
+        jit_emit_mem(&(jc->buf), 1, 0x8D, JIT_RAX, JIT_BP, disp + JIT_VALUE_SIZE);
+        jit_emit_bytes(&(jc->buf), keep, sizeof(keep));
+        emit_sp_move(jc, -1);
+        break;
+    }
+
+    case BC_OP_NEGATE: {
+        /* neg rax. */
+        static const uint8_t neg[] = {0x48, 0xF7, 0xD8};
+        emit_load_int(jc, JIT_RAX, JIT_SP, -JIT_VALUE_SIZE, instruction);
+        jit_emit_bytes(&(jc->buf), neg, sizeof(neg));
+        emit_store_int(jc, JIT_RAX, JIT_SP, -JIT_VALUE_SIZE);
+        break;
+    }
+
+    case BC_OP_JUMP_IF_FALSE:
+    case BC_OP_JUMP_IF_FALSE_WIDE: {
+        int offset = (op == BC_OP_JUMP_IF_FALSE) ? bytecode_read_i8(&ip) : bytecode_read_i32(&ip);
+        emit_test_int(jc, JIT_SP, -JIT_VALUE_SIZE);
+        emit_jump(jc, JIT_CC_E, ip + offset);
+        break;
+    }
+    case BC_OP_JUMP:
+    case BC_OP_JUMP_WIDE: {
+        int offset = (op == BC_OP_JUMP) ? bytecode_read_i8(&ip) : bytecode_read_i32(&ip);
+        emit_jump(jc, JIT_CC_ALWAYS, ip + offset);
+        break;
+    }
+
+    case BC_OP_INC_LOCAL: {
+        int32_t disp = (int32_t) bytecode_read_uleb128(&ip) * JIT_VALUE_SIZE;
+        long long cnst = bc->constant_pool[bytecode_read_uleb128(&ip)].int_cnst;
+        emit_load_int(jc, JIT_RAX, JIT_BP, disp, instruction);
+        jit_emit_mov_imm64(&(jc->buf), JIT_RDX, (uint64_t) cnst);
+        jit_emit_reg(&(jc->buf), 0x01, JIT_RAX, JIT_RDX);
+        emit_store_int(jc, JIT_RAX, JIT_BP, disp);
+        break;
+    }
+
+    default:
+        if ((op >= BC_OP_LT_LOCAL_CONST_JUMP) && (op <= BC_OP_NEQ_LOCAL_CONST_JUMP)) {
+            int32_t disp = (int32_t) bytecode_read_uleb128(&ip) * JIT_VALUE_SIZE;
+            long long cnst = bc->constant_pool[bytecode_read_uleb128(&ip)].int_cnst;
+            int offset = bytecode_read_i32(&ip);
+            emit_load_int(jc, JIT_RAX, JIT_BP, disp, instruction);
+            jit_emit_mov_imm64(&(jc->buf), JIT_RDX, (uint64_t) cnst);
+            jit_emit_reg(&(jc->buf), 0x39, JIT_RAX, JIT_RDX);
+            emit_jump(jc, fused_jump_condition(op), ip + offset);
+        } else {
+            /* binary operator: both operands stay on stack, until they are checked. */
+            emit_load_int(jc, JIT_RDX, JIT_SP, -JIT_VALUE_SIZE, instruction);
+            emit_load_int(jc, JIT_RAX, JIT_SP, -2 * JIT_VALUE_SIZE, instruction);
+            emit_binary(jc, op, instruction);
+            emit_store_int(jc, JIT_RAX, JIT_SP, -2 * JIT_VALUE_SIZE);
+            emit_sp_move(jc, -1);
+        }
+        break;
+    }
+
+    return ip;
+}
+
+jit_code_type_t jit_compile_loop(struct JIT*jit, const bytecode_type_t bc, uint8_t*start, uint8_t*end)
+{
+    struct JIT_COMPILER jc;
+    uint8_t*ip;
+    size_t i;
+    void*mem;
+
+    /* such loop would exit at once on every entry. */
+    if (!is_supported(*start)) {
+        jit->rejected_num++;
+        return NULL;
+    }
+
+    memset(&jc, 0, sizeof(jc));
+    jc.start = start;
+    jc.end = end;
+    SAFE_CALLOC(jc.positions, end - start);
+
+    jit_emit_bytes(&(jc.buf), prologue_template, sizeof(prologue_template));
+    for (ip = start; ip < end; ) {
+        jc.positions[ip - start] = jc.buf.code_len;
+        ip = emit_instruction(&jc, bc, ip);
+    }
+    /* back-edge is unconditional, but loop may end with exit of unsupported opcode. */
+    emit_exit(&jc, end);
+
+    /* loop is entered only with VIRTUAL_MACHINE_CALL_STACK_RESERVE free slots. */
+    if (jc.pushes > VIRTUAL_MACHINE_CALL_STACK_RESERVE) {
+        jit->rejected_num++;
+        jit_buffer_free(&(jc.buf));
+        SAFE_FREE(jc.positions);
+        SAFE_FREE(jc.jumps);
+        SAFE_FREE(jc.exits);
+        return NULL;
+    }
+
+    for (i = 0; i < jc.exits_len; i++) {
+        jit_patch_rel32(&(jc.buf), jc.exits[i].pos, jc.buf.code_len);
+        emit_exit(&jc, jc.exits[i].ip);
+    }
+    for (i = 0; i < jc.jumps_len; i++) {
+        jit_patch_rel32(&(jc.buf), jc.jumps[i].pos, jc.positions[jc.jumps[i].ip - start]);
+    }
+
+    mem = jit_map_code(jit, &(jc.buf));
+    if (mem != NULL) {
+        jit->loops_num++;
+    }
+
+    jit_buffer_free(&(jc.buf));
+    SAFE_FREE(jc.positions);
+    SAFE_FREE(jc.jumps);
+    SAFE_FREE(jc.exits);
+
+    return (jit_code_type_t) mem;
+}
+
+#endif
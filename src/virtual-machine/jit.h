@@ -0,0 +1,86 @@
+#ifndef JIT_H_INCLUDED
+#define JIT_H_INCLUDED
+
+#include "virtual-machine.h"
+
+#if VIRTUAL_MACHINE_JIT
+
+/*
+  Baseline template JIT for x86-64. Every opcode of hot loop is translated to
+  pre-assembled sequence of machine instructions (template), whose immediates,
+  displacements and jumps are patched. Operand stack and locals stay in memory,
+  so interpreter and machine code may hand over loop at any instruction:
+    - jumps inside loop are native jumps;
+    - jumps out of loop, failed integer checks and unsupported opcodes
+      (calls, heap access, allocations) exit to interpreter.
+
+  Tracing JIT (see tracing-jit.c) instead records one iteration of hot loop
+  with types, which were observed, and compiles it to straight-line code,
+  whose locals stay unboxed in registers; every assumption is a guard,
+  whose failure is side exit to interpreter.
+*/
+
+/*
+  Machine code of loop starts from loop header with locals at bp and top of
+  operand stack at *sp; it returns ip, where interpreter continues, and updates *sp.
+*/
+typedef uint8_t*(*jit_code_type_t)(struct VALUE*bp, struct VALUE**sp);
+
+/* back-edge of stack bytecode. */
+struct JIT_LOOP
+{
+    size_t hotness;       /* times, back-edge was taken by interpreter. */
+    jit_code_type_t code; /* NULL, until loop is compiled.              */
+    size_t aborts;        /* tracing JIT only: failed recordings.      */
+};
+
+/* counters of compiled trace, which are incremented by its machine code. */
+struct JIT_TRACE
+{
+    struct JIT_TRACE*next;
+
+    size_t header; /* offset of loop header in bytecode. */
+    size_t ir_len;
+    size_t exits_num;
+
+    unsigned long long entries;
+    unsigned long long iterations;
+    unsigned long long*exits; /* by side exit, the last one is failed entry. */
+    uint8_t**exit_ips;
+};
+
+struct JIT_CHUNK;
+
+struct JIT
+{
+    struct JIT_CHUNK*chunks; /* executable pages of compiled loops and traces. */
+
+    size_t loops_num;
+    size_t rejected_num; /* loops, whose header isn't supported or which push too much, or traces, which can't be compiled. */
+    size_t code_sizemem;
+    unsigned long long entries;
+
+    /* tracing JIT. */
+    struct JIT_TRACE*traces;
+    size_t traces_num;
+    size_t aborts_num; /* recordings, which met unsupported instruction or left loop. */
+};
+
+/* compiles loop [start, end), where end follows its back-edge; NULL, when loop can't be compiled. */
+jit_code_type_t jit_compile_loop(struct JIT*jit, const bytecode_type_t bc, uint8_t*start, uint8_t*end);
+
+/*
+  Tracing JIT: executes the next iteration of loop [header, end) and records it.
+  When iteration returns to header, trace is compiled into loop->code; otherwise
+  recording is aborted before unsupported instruction. Returns ip, where interpreter
+  continues, and updates *sp. GC must not be in the middle of cycle.
+*/
+uint8_t*jit_record_trace(struct JIT*jit, struct JIT_LOOP*loop, const bytecode_type_t bc,
+                         uint8_t*header, uint8_t*end, struct VALUE*bp, struct VALUE**sp);
+
+/* unmaps code of all compiled loops and traces. */
+void jit_free(struct JIT*jit);
+
+#endif
+
+#endif  /* JIT_H_INCLUDED */
@@ -0,0 +1,335 @@
+/*
+  Interpreter loop of register bytecode (see register-generator.h),
+  which is included into virtual-machine.c. Registers of current function
+  are bp[0..regs_num); vm->stack_top covers registers of all active frames,
+  so GC finds every register, which might keep reference.
+  Opcodes are dispatched as in virtual-machine-loop.h. Trace isn't written.
+*/
+
+#define VM_FETCH()          (*(ip++))
+#define VM_FETCH_ULEB128()  ((*ip < 0x80) ? *(ip++) : bytecode_read_uleb128(&ip))
+#define VM_FETCH_I32()      bytecode_read_i32(&ip)
+#define VM_REG()            (bp + VM_FETCH_ULEB128())
+
+#if VIRTUAL_MACHINE_THREADED_DISPATCH
+#define VM_SWITCH(instruction) goto *labels[instruction];
+#define VM_CASE(op)            label_##op:
+#define VM_NEXT()                               \
+    do {                                        \
+        instruction = VM_FETCH();              \
+        goto *labels[instruction];              \
+    } while (0)
+#else
+#define VM_SWITCH(instruction) switch (instruction)
+#define VM_CASE(op)            case op:
+#define VM_NEXT()              break
+#endif
+
+/*
+  Operands are read before result is written, because r_dst may be r_a or r_b.
+  Check is run on val1 and val2 after their types.
+*/
+#define VM_BINARY_OP(op, name) VM_CHECKED_BINARY_OP(op, name, (void) 0)
+#define VM_CHECKED_BINARY_OP(op, name, check)                           \
+    do {                                                                \
+        struct VALUE*dst = VM_REG();                                    \
+        struct VALUE val1 = *VM_REG();                                  \
+        struct VALUE val2 = *VM_REG();                                  \
+        if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) { \
+            printf("invalid value for " name "!\n");                    \
+            exit(1);                                                    \
+        }                                                               \
+        check;                                                          \
+        *dst = create_value_from_int(VALUE_GET_INT(val1) op VALUE_GET_INT(val2)); \
+    } while (0)
+
+static long long run_registers(virtual_machine_type_t vm)
+{
+#if VIRTUAL_MACHINE_THREADED_DISPATCH
+    /* must be in the same order as enum RC_OP_CODES. */
+    static const void*labels[] = {
+        &&label_RC_OP_MOVE,
+        &&label_RC_OP_CONSTANT,
+        &&label_RC_OP_CREATE_OBJ,
+        &&label_RC_OP_CREATE_ARR,
+        &&label_RC_OP_GET_HEAP,
+        &&label_RC_OP_SET_HEAP,
+        &&label_RC_OP_OR,
+        &&label_RC_OP_AND,
+        &&label_RC_OP_EQ,
+        &&label_RC_OP_NEQ,
+        &&label_RC_OP_LT,
+        &&label_RC_OP_GT,
+        &&label_RC_OP_LE,
+        &&label_RC_OP_GE,
+        &&label_RC_OP_ADD,
+        &&label_RC_OP_SUB,
+        &&label_RC_OP_MUL,
+        &&label_RC_OP_DIV,
+        &&label_RC_OP_MOD,
+        &&label_RC_OP_NEG,
+        &&label_RC_OP_HAS_PROPERTY,
+        &&label_RC_OP_LEN,
+        &&label_RC_OP_JUMP_IF_FALSE,
+        &&label_RC_OP_JUMP,
+        &&label_RC_OP_CALL,
+        &&label_RC_OP_RETURN,
+    };
+#endif
+
+    uint8_t*ip = vm->ip;
+    struct VALUE*bp = vm->bp;
+    size_t instruction;
+
+    while (1) {
+        instruction = VM_FETCH();
+
+        VM_SWITCH(instruction) {
+        VM_CASE(RC_OP_MOVE) {
+            struct VALUE*dst = VM_REG();
+            *dst = *VM_REG();
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_CONSTANT) {
+            struct VALUE*dst = VM_REG();
+            *dst = create_value_from_int(vm->bc->constant_pool[VM_FETCH_ULEB128()].int_cnst);
+            VM_NEXT();
+        }
+
+        VM_CASE(RC_OP_CREATE_OBJ) {
+            size_t dst = VM_FETCH_ULEB128();
+            size_t first = VM_FETCH_ULEB128();
+            struct OBJECT*obj;
+            vm->ip = ip;
+            obj = create_obj_from_registers(vm, bp + first);
+            ip = vm->ip;
+            bp[dst] = create_value_from_obj(obj);
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_CREATE_ARR) {
+            size_t dst = VM_FETCH_ULEB128();
+            size_t first = VM_FETCH_ULEB128();
+            size_t arr_len = VM_FETCH_ULEB128();
+            size_t i;
+            struct ARRAY*arr = garbage_collector_malloc_arr(vm->gc, arr_len);
+            /* registers are read after GC, which might move their values. */
+            for (i = 0; i < arr_len; i++) {
+                arr->values[i] = bp[first + i];
+            }
+            arr->len = arr_len;
+            bp[dst] = create_value_from_arr(arr);
+            VM_NEXT();
+        }
+
+        VM_CASE(RC_OP_SET_HEAP) {
+            size_t i;
+            struct VALUE val = *VM_REG();
+            size_t src = VM_FETCH_ULEB128();
+            size_t len = VM_FETCH_ULEB128();
+            for (i = 0; i < len; i++) {
+                enum BC_HEAP_OP hop = VM_FETCH();
+                if (hop == BC_ARRAY_INDEX) {
+                    struct VALUE*element = heap_element(val, *VM_REG());
+                    if (i < len - 1) {
+                        val = heap_read(vm, element);
+                    } else {
+                        heap_write_element(vm, val, element, bp[src]);
+                    }
+                } else if (hop == BC_OBJECT_FIELD) {
+                    size_t key = VM_FETCH_ULEB128();
+                    struct INLINE_CACHE*ic = vm->inline_caches + VM_FETCH_ULEB128();
+                    struct SHAPE*transition;
+                    int slot = heap_field(val, key, ic, &transition);
+                    if (i < len - 1) {
+                        if (transition != NULL) {
+                            printf("need to create to many fields\n");
+                            exit(1);
+                        }
+                        val = heap_read(vm, &(VALUE_GET_OBJ(val)->properties[slot]));
+                    } else {
+                        heap_write_field(vm, val, slot, transition, bp + src);
+                    }
+                }
+            }
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_GET_HEAP) {
+            size_t i;
+            struct VALUE*dst = VM_REG();
+            struct VALUE val = *VM_REG();
+            size_t len = VM_FETCH_ULEB128();
+            for (i = 0; i < len; i++) {
+                enum BC_HEAP_OP hop = VM_FETCH();
+                if (hop == BC_ARRAY_INDEX) {
+                    val = heap_read(vm, heap_element(val, *VM_REG()));
+                } else if (hop == BC_OBJECT_FIELD) {
+                    size_t key = VM_FETCH_ULEB128();
+                    struct INLINE_CACHE*ic = vm->inline_caches + VM_FETCH_ULEB128();
+                    int slot = heap_field(val, key, ic, NULL);
+                    val = heap_read(vm, &(VALUE_GET_OBJ(val)->properties[slot]));
+                }
+            }
+            *dst = val;
+            VM_NEXT();
+        }
+
+        VM_CASE(RC_OP_OR) {
+            VM_BINARY_OP(||, "OR");
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_AND) {
+            VM_BINARY_OP(&&, "AND");
+            VM_NEXT();
+        }
+
+        VM_CASE(RC_OP_EQ) {
+            VM_BINARY_OP(==, "EQEQ");
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_NEQ) {
+            VM_BINARY_OP(!=, "NEQ");
+            VM_NEXT();
+        }
+
+        VM_CASE(RC_OP_LT) {
+            VM_BINARY_OP(<, "LT");
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_GT) {
+            VM_BINARY_OP(>, "GT");
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_LE) {
+            VM_BINARY_OP(<=, "LE");
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_GE) {
+            VM_BINARY_OP(>=, "GE");
+            VM_NEXT();
+        }
+
+        VM_CASE(RC_OP_ADD) {
+            VM_BINARY_OP(+, "PLUS");
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_SUB) {
+            VM_BINARY_OP(-, "MINUS");
+            VM_NEXT();
+        }
+
+        VM_CASE(RC_OP_MUL) {
+            VM_BINARY_OP(*, "MUL");
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_DIV) {
+            VM_CHECKED_BINARY_OP(/, "DIV", check_divisor(val2));
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_MOD) {
+            VM_CHECKED_BINARY_OP(%, "MOD", check_divisor(val2));
+            VM_NEXT();
+        }
+
+        VM_CASE(RC_OP_NEG) {
+            struct VALUE*dst = VM_REG();
+            struct VALUE val = *VM_REG();
+            if (VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) {
+                printf("invalid value for NEGATE!\n");
+                exit(1);
+            }
+            *dst = create_value_from_int(-VALUE_GET_INT(val));
+            VM_NEXT();
+        }
+
+        VM_CASE(RC_OP_HAS_PROPERTY) {
+            struct VALUE*dst = VM_REG();
+            struct VALUE val = *VM_REG();
+            size_t key = VM_FETCH_ULEB128();
+            if (VALUE_GET_TYPE(val) == VALUE_TYPE_OBJ) {
+                *dst = create_value_from_int(shape_lookup(VALUE_GET_OBJ(val)->shape, key) != -1);
+            } else {
+                *dst = create_value_from_int(-1);
+            }
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_LEN) {
+            struct VALUE*dst = VM_REG();
+            struct VALUE val = *VM_REG();
+            if (VALUE_GET_TYPE(val) == VALUE_TYPE_ARR) {
+                *dst = create_value_from_int(VALUE_GET_ARR(val)->len);
+            } else {
+                *dst = create_value_from_int(-1);
+            }
+            VM_NEXT();
+        }
+
+        VM_CASE(RC_OP_JUMP_IF_FALSE) {
+            struct VALUE val = *VM_REG();
+            int offset = VM_FETCH_I32();
+            if (!VALUE_GET_INT(val)) {
+                ip += offset;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_JUMP) {
+            int offset = VM_FETCH_I32();
+            ip += offset;
+            VM_NEXT();
+        }
+
+        VM_CASE(RC_OP_CALL) {
+            size_t dst = VM_FETCH_ULEB128();
+            const struct FUNCTION_REF*f = vm->functions + VM_FETCH_ULEB128();
+            struct VALUE*callee_bp = bp + VM_FETCH_ULEB128();
+            struct FRAME*frame;
+            if ((vm->frames_len == vm->frames_cap) || ((size_t) (callee_bp - vm->stack) + f->regs_num > vm->stack_cap)) {
+                printf("stack overflow\n");
+                exit(1);
+            }
+            frame = vm->frames + vm->frames_len++;
+            frame->ip = ip;
+            frame->bp = bp;
+            frame->top = vm->stack_top;
+            frame->ret = dst;
+            /*
+              Registers under stack_top are scanned by GC, so they keep valid values
+              (arguments or dead temporaries of caller); registers above it might be stale.
+              Frame may end under stack_top, then dead temporaries above it are still scanned.
+            */
+            if (vm->stack_top < callee_bp + f->regs_num) {
+                struct VALUE*reg;
+                for (reg = vm->stack_top; reg < callee_bp + f->regs_num; reg++) {
+                    *reg = create_value_from_int(0);
+                }
+                vm->stack_top = callee_bp + f->regs_num;
+            }
+            bp = callee_bp;
+            ip = f->start;
+            VM_NEXT();
+        }
+        VM_CASE(RC_OP_RETURN) {
+            struct VALUE val = *VM_REG();
+            const struct FRAME*frame;
+            if (vm->frames_len == 0) {
+                return VALUE_GET_INT(val);
+            }
+            frame = vm->frames + --vm->frames_len;
+            ip = frame->ip;
+            bp = frame->bp;
+            vm->stack_top = frame->top;
+            bp[frame->ret] = val;
+            VM_NEXT();
+        }
+        }
+    }
+}
+
+#undef VM_FETCH
+#undef VM_FETCH_ULEB128
+#undef VM_FETCH_I32
+#undef VM_REG
+#undef VM_SWITCH
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_BINARY_OP
+#undef VM_CHECKED_BINARY_OP
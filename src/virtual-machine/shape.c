@@ -0,0 +1,83 @@
+#include "shape.h"
+
+#include "utils.h"
+
+struct SHAPE*create_shape_root()
+{
+    struct SHAPE*shape;
+    SAFE_CALLOC(shape, 1);
+    return shape;
+}
+
+struct SHAPE*shape_add_property(struct SHAPE*shape, size_t key)
+{
+    size_t i;
+
+    struct SHAPE*child;
+    struct SHAPE_TRANSITION tr;
+
+    for (i = 0; i < shape->transitions_len; i++) {
+        if (shape->transitions[i].key == key) {
+            return shape->transitions[i].shape;
+        }
+    }
+
+    SAFE_CALLOC(child, 1);
+    child->key = key;
+    child->len = shape->len + 1;
+    child->parent = shape;
+
+    tr.key = key;
+    tr.shape = child;
+    PUSH_BACK(shape->transitions, tr);
+
+    return child;
+}
+
+/* objects have few properties and inline caches skip lookup, so walk to root is fast enough. */
+int shape_lookup(const struct SHAPE*shape, size_t key)
+{
+    for (; shape->len != 0; shape = shape->parent) {
+        if (shape->key == key) {
+            return shape->len - 1;
+        }
+    }
+
+    return -1;
+}
+
+/* tree is as deep as the biggest object, so it is freed without recursion. */
+void shape_tree_free(struct SHAPE*root)
+{
+    struct SHAPE*shape = root;
+
+    while (shape != NULL) {
+        struct SHAPE*parent = shape->parent;
+
+        if (shape->transitions_len != 0) {
+            shape = shape->transitions[--shape->transitions_len].shape;
+            continue;
+        }
+
+        SAFE_FREE(shape->transitions);
+        SAFE_FREE(shape);
+        shape = parent;
+    }
+}
+
+/* megamorphic sites just rotate entries. */
+void inline_cache_update(struct INLINE_CACHE*ic, const struct SHAPE*shape, int slot, struct SHAPE*transition)
+{
+    struct INLINE_CACHE_ENTRY*entry;
+
+    if (ic->len < INLINE_CACHE_ENTRIES) {
+        entry = &(ic->entries[ic->len++]);
+    } else {
+        entry = &(ic->entries[ic->next]);
+        ic->next = (ic->next + 1) % INLINE_CACHE_ENTRIES;
+    }
+
+    entry->shape = shape;
+    entry->transition = transition;
+    entry->slot = slot;
+}
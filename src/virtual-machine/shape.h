@@ -0,0 +1,58 @@
+#ifndef SHAPE_H_INCLUDED
+#define SHAPE_H_INCLUDED
+
+#include "data-types.h"
+
+/* creates empty shape, which is root of shape tree. */
+struct SHAPE*create_shape_root();
+
+/* returns shape with key appended to the end; transition is created only once. */
+struct SHAPE*shape_add_property(struct SHAPE*shape, size_t key);
+
+/* returns slot of key in shape or (-1). */
+int shape_lookup(const struct SHAPE*shape, size_t key);
+
+/* frees whole tree. */
+void shape_tree_free(struct SHAPE*root);
+
+#define INLINE_CACHE_ENTRIES 4
+
+/*
+  Inline cache remembers slot of field for shapes, seen by one access site.
+  Stores of new field also remember transition, so they skip shape tree too.
+*/
+struct INLINE_CACHE_ENTRY
+{
+    const struct SHAPE*shape;
+    struct SHAPE*transition; /* shape after adding field or NULL. */
+    int slot;
+};
+
+struct INLINE_CACHE
+{
+    struct INLINE_CACHE_ENTRY entries[INLINE_CACHE_ENTRIES];
+    size_t len;
+    size_t next; /* entry to be replaced, when cache is full. */
+
+    unsigned long long hits;
+    unsigned long long misses;
+};
+
+static inline const struct INLINE_CACHE_ENTRY*inline_cache_lookup(struct INLINE_CACHE*ic, const struct SHAPE*shape)
+{
+    size_t i;
+
+    for (i = 0; i < ic->len; i++) {
+        if (ic->entries[i].shape == shape) {
+            ic->hits++;
+            return &(ic->entries[i]);
+        }
+    }
+
+    ic->misses++;
+    return NULL;
+}
+
+void inline_cache_update(struct INLINE_CACHE*ic, const struct SHAPE*shape, int slot, struct SHAPE*transition);
+
+#endif  /* SHAPE_H_INCLUDED */
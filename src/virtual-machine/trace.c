@@ -0,0 +1,160 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _DEFAULT_SOURCE
+#define TRACE_PTHREADS
+#endif
+
+#include "trace.h"
+
+#include "utils.h"
+
+#ifdef TRACE_PTHREADS
+#include <pthread.h>
+#endif
+
+struct TRACE_RING
+{
+    FILE*f;
+    uint64_t*records;
+
+    size_t filled;  /* chunks, which are filled by VM.             */
+    size_t written; /* chunks, which are written by writer thread. */
+    int closed;
+
+#ifdef TRACE_PTHREADS
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond; /* chunk is filled, written or ring is closed. */
+#endif
+};
+
+static uint64_t*ring_chunk(struct TRACE_RING*ring, size_t n)
+{
+    return ring->records + (n % TRACE_CHUNKS) * TRACE_CHUNK_RECORDS;
+}
+
+static void write_records(struct TRACE_RING*ring, const uint64_t*records, size_t records_num)
+{
+    if (fwrite(records, sizeof(uint64_t), records_num, ring->f) != records_num) {
+        fprintf(stderr, "unable to write trace\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+#ifdef TRACE_PTHREADS
+static void*writer_thread(void*arg)
+{
+    struct TRACE_RING*ring = arg;
+
+    pthread_mutex_lock(&(ring->lock));
+    for (;;) {
+        while ((ring->written == ring->filled) && !ring->closed) {
+            pthread_cond_wait(&(ring->cond), &(ring->lock));
+        }
+        if (ring->written == ring->filled) {
+            break;
+        }
+
+        /* filled chunk isn't touched by VM, until it is written. */
+        pthread_mutex_unlock(&(ring->lock));
+        write_records(ring, ring_chunk(ring, ring->written), TRACE_CHUNK_RECORDS);
+        pthread_mutex_lock(&(ring->lock));
+
+        ring->written++;
+        pthread_cond_broadcast(&(ring->cond));
+    }
+    pthread_mutex_unlock(&(ring->lock));
+
+    return NULL;
+}
+#endif
+
+void trace_writer_open(struct TRACE_WRITER*w, FILE*f)
+{
+    struct TRACE_HEADER header;
+    struct TRACE_RING*ring;
+
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    if (fwrite(&header, sizeof(header), 1, f) != 1) {
+        fprintf(stderr, "unable to write trace\n");
+        exit(EXIT_FAILURE);
+    }
+
+    SAFE_CALLOC(ring, 1);
+    SAFE_MALLOC(ring->records, TRACE_CHUNKS * TRACE_CHUNK_RECORDS);
+    ring->f = f;
+
+#ifdef TRACE_PTHREADS
+    pthread_mutex_init(&(ring->lock), NULL);
+    pthread_cond_init(&(ring->cond), NULL);
+    if (pthread_create(&(ring->thread), NULL, writer_thread, ring) != 0) {
+        fprintf(stderr, "unable to create trace thread\n");
+        exit(EXIT_FAILURE);
+    }
+#endif
+
+    w->ring = ring;
+    w->pos = ring_chunk(ring, 0);
+    w->end = w->pos + TRACE_CHUNK_RECORDS;
+    w->heap_used = 0;
+}
+
+void trace_writer_next_chunk(struct TRACE_WRITER*w)
+{
+    struct TRACE_RING*ring = w->ring;
+
+#ifdef TRACE_PTHREADS
+    pthread_mutex_lock(&(ring->lock));
+    ring->filled++;
+    pthread_cond_broadcast(&(ring->cond));
+    while (ring->filled - ring->written == TRACE_CHUNKS) {
+        pthread_cond_wait(&(ring->cond), &(ring->lock));
+    }
+    pthread_mutex_unlock(&(ring->lock));
+#else
+    write_records(ring, ring_chunk(ring, ring->filled), TRACE_CHUNK_RECORDS);
+    ring->filled++;
+    ring->written++;
+#endif
+
+    w->pos = ring_chunk(ring, ring->filled);
+    w->end = w->pos + TRACE_CHUNK_RECORDS;
+}
+
+void trace_writer_close(struct TRACE_WRITER*w)
+{
+    struct TRACE_RING*ring = w->ring;
+
+    TRACE_WRITE(w, (uint64_t) TRACE_OP_END);
+
+#ifdef TRACE_PTHREADS
+    pthread_mutex_lock(&(ring->lock));
+    ring->closed = 1;
+    pthread_cond_broadcast(&(ring->cond));
+    pthread_mutex_unlock(&(ring->lock));
+
+    pthread_join(ring->thread, NULL);
+    pthread_cond_destroy(&(ring->cond));
+    pthread_mutex_destroy(&(ring->lock));
+#endif
+
+    /* current chunk (with end record) isn't given to writer thread. */
+    write_records(ring, ring_chunk(ring, ring->filled), w->pos - ring_chunk(ring, ring->filled));
+    fflush(ring->f);
+
+    SAFE_FREE(ring->records);
+    SAFE_FREE(ring);
+    w->ring = NULL;
+    w->pos = w->end = NULL;
+}
+
+int trace_read_header(FILE*f)
+{
+    struct TRACE_HEADER header;
+
+    if (fread(&header, sizeof(header), 1, f) != 1) {
+        return 0;
+    }
+
+    return (header.magic == TRACE_MAGIC) && (header.version == TRACE_VERSION);
+}
@@ -0,0 +1,77 @@
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+  Binary trace of execution: struct TRACE_HEADER and then 64-bit records in host byte order.
+  Step record is written before every instruction:
+    op (bits 0-7), operand stack depth in values (bits 8-31), offset of instruction in bytecode (bits 32-63).
+  Heap record (op TRACE_OP_HEAP) keeps used bytes of heap in bits 8-63,
+  it is written before step only when heap usage has changed since previous heap record.
+  End record (op TRACE_OP_END) is the last record of complete trace,
+  so any bytes after it (e.g. result of interpreter on stdout) are ignored.
+*/
+
+#define TRACE_MAGIC   0x54494347u /* "GCIT" in little endian; reversed magic means other byte order. */
+#define TRACE_VERSION 1u
+
+#define TRACE_OP_HEAP 0xFE
+#define TRACE_OP_END  0xFF
+
+#define TRACE_STEP_RECORD(op, stack, ip) \
+    (((uint64_t) (op)) | ((((uint64_t) (stack)) & 0xFFFFFF) << 8) | (((uint64_t) (ip)) << 32))
+#define TRACE_HEAP_RECORD(heap_used) (((uint64_t) TRACE_OP_HEAP) | (((uint64_t) (heap_used)) << 8))
+
+#define TRACE_RECORD_OP(r)    ((unsigned) ((r) & 0xFF))
+#define TRACE_RECORD_STACK(r) ((size_t) (((r) >> 8) & 0xFFFFFF))
+#define TRACE_RECORD_IP(r)    ((size_t) ((r) >> 32))
+#define TRACE_RECORD_HEAP(r)  ((size_t) ((r) >> 8))
+
+struct TRACE_HEADER
+{
+    uint32_t magic;
+    uint32_t version;
+};
+
+/*
+  Records are put into ring of TRACE_CHUNKS chunks by VM, filled chunks are written
+  to file by writer thread, so VM waits only when the whole ring isn't written yet.
+*/
+#define TRACE_CHUNK_RECORDS 8192
+#define TRACE_CHUNKS        32
+
+struct TRACE_RING;
+
+struct TRACE_WRITER
+{
+    uint64_t*pos; /* next record of current chunk. */
+    uint64_t*end; /* end of current chunk.         */
+
+    size_t heap_used; /* value of last heap record. */
+
+    struct TRACE_RING*ring;
+};
+
+/* writes header to f and starts writer thread. */
+void trace_writer_open(struct TRACE_WRITER*w, FILE*f);
+
+/* gives filled chunk to writer thread and takes next one. */
+void trace_writer_next_chunk(struct TRACE_WRITER*w);
+
+/* writes end record and all chunks to f (f isn't closed). */
+void trace_writer_close(struct TRACE_WRITER*w);
+
+#define TRACE_WRITE(w, record)                                          \
+    do {                                                                \
+        if ((w)->pos == (w)->end) {                                     \
+            trace_writer_next_chunk(w);                                 \
+        }                                                               \
+        *((w)->pos++) = (record);                                       \
+    } while (0)
+
+/* reads and checks header; returns 0, if f has no trace of this version and byte order. */
+int trace_read_header(FILE*f);
+
+#endif  /* TRACE_H_INCLUDED */
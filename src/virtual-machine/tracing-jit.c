@@ -0,0 +1,1288 @@
+#include "jit-private.h"
+
+#if VIRTUAL_MACHINE_JIT
+
+#include "data-types.h"
+#include "shape.h"
+#include "utils.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+  Tracing JIT for integer loops of stack bytecode.
+
+  Recorder interprets supported subset of opcodes from loop header and, besides
+  executing every instruction, appends typed SSA instructions (IR) to trace. Stack
+  slots are mapped to refs of IR, so GET_LOCAL, SET_LOCAL and POP produce no code.
+  Locals below stack depth at header are ENTRY instructions: they are loaded and
+  unboxed once at trace entry and stay in fixed registers through iterations.
+
+  Every guard (direction of branch, type of loaded value, shape of object, array
+  bounds, divisor) refers to snapshot: refs of stack slots before the instruction,
+  which produced guard. Side exit boxes them back to stack and returns ip of that
+  instruction, so interpreter re-executes it.
+
+  Optimizations: constant folding into immediates, types are guarded only where
+  value is loaded from memory (types of locals once at trace entry), repeated shape
+  guards of object are dropped, compare is fused with its guard, temporaries get
+  registers by linear scan. Loop, whose locals change type, isn't compiled.
+*/
+
+#define TRACE_NONE        (-1)
+#define TRACE_MAX_IR      512 /* longer iteration isn't compiled.                 */
+#define TRACE_MAX_ABORTS  4   /* loop isn't recorded again after so many aborts. */
+
+/* operand stack above loop header depth, which recorder can follow; it is reserved by VM on entry. */
+#define TRACE_MAX_STACK   VIRTUAL_MACHINE_CALL_STACK_RESERVE
+
+enum TRACE_OP
+{
+    TRACE_OP_ENTRY,  /* local a at loop header.                 */
+    TRACE_OP_CONST,  /* integer cnst.                           */
+    TRACE_OP_BINARY, /* bc_op of a and b.                       */
+    TRACE_OP_NEGATE, /* -a.                                     */
+    TRACE_OP_GUARD,  /* exits, unless truth of a is cnst.       */
+    TRACE_OP_LEN,    /* length of array a.                      */
+    TRACE_OP_FIELD,  /* property in slot cnst of object a.      */
+    TRACE_OP_INDEX,  /* element b of array a.                   */
+};
+
+struct TRACE_INS
+{
+    enum TRACE_OP op;
+    enum VALUE_TYPE type; /* of result. */
+    size_t bc_op;
+    int a;
+    int b;
+    long long cnst;
+    const struct SHAPE*shape; /* FIELD: expected shape of object. */
+    int snapshot;             /* TRACE_NONE - instruction can't exit. */
+    int shape_known;          /* FIELD: object has been checked for the same shape. */
+
+    /* filled by compiler. */
+    int reg;
+    size_t last_use;
+    int fused; /* compare, which sets flags for the following guard. */
+};
+
+/* state of stack before guarded instruction. */
+struct TRACE_SNAPSHOT
+{
+    uint8_t*ip;
+    size_t depth;
+    size_t refs;   /* of every slot in snapshot_refs, starting from this offset. */
+    size_t guards;
+};
+
+struct TRACE_RECORDER
+{
+    bytecode_type_t bc;
+    uint8_t*header;
+    struct VALUE*bp;
+    struct VALUE*sp;
+    size_t depth0; /* stack depth at loop header. */
+
+    struct TRACE_INS*ins;
+    size_t ins_len;
+    size_t ins_cap;
+
+    int*slots;    /* ref of every stack slot; TRACE_NONE - local isn't touched yet. */
+    int*entries;  /* ENTRY of every local below depth0. */
+    char*written; /* local below depth0 is stored by trace. */
+
+    struct TRACE_SNAPSHOT*snapshots;
+    size_t snapshots_len;
+    size_t snapshots_cap;
+
+    int*snapshot_refs;
+    size_t snapshot_refs_len;
+    size_t snapshot_refs_cap;
+
+    uint8_t*instruction; /* being recorded. */
+    int snapshot;        /* of instruction, TRACE_NONE until its first guard. */
+};
+
+static size_t trace_depth(const struct TRACE_RECORDER*tr)
+{
+    return (size_t) (tr->sp - tr->bp);
+}
+
+static int trace_add(struct TRACE_RECORDER*tr, enum TRACE_OP op, enum VALUE_TYPE type, int a, int b)
+{
+    struct TRACE_INS ins;
+    memset(&ins, 0, sizeof(ins));
+    ins.op = op;
+    ins.type = type;
+    ins.a = a;
+    ins.b = b;
+    ins.snapshot = TRACE_NONE;
+    PUSH_BACK(tr->ins, ins);
+    return (int) tr->ins_len - 1;
+}
+
+static int trace_const(struct TRACE_RECORDER*tr, long long cnst)
+{
+    int ref = trace_add(tr, TRACE_OP_CONST, VALUE_TYPE_INTEGER, TRACE_NONE, TRACE_NONE);
+    tr->ins[ref].cnst = cnst;
+    return ref;
+}
+
+static int trace_is_const(const struct TRACE_RECORDER*tr, int ref)
+{
+    return tr->ins[ref].op == TRACE_OP_CONST;
+}
+
+/* snapshot of current instruction is taken before it changes any slot. */
+static int trace_snapshot(struct TRACE_RECORDER*tr)
+{
+    if (tr->snapshot == TRACE_NONE) {
+        struct TRACE_SNAPSHOT snap;
+        size_t i;
+
+        snap.ip = tr->instruction;
+        snap.depth = trace_depth(tr);
+        snap.refs = tr->snapshot_refs_len;
+        snap.guards = 0;
+        for (i = 0; i < snap.depth; i++) {
+            PUSH_BACK(tr->snapshot_refs, tr->slots[i]);
+        }
+        PUSH_BACK(tr->snapshots, snap);
+        tr->snapshot = (int) tr->snapshots_len - 1;
+    }
+    tr->snapshots[tr->snapshot].guards++;
+    return tr->snapshot;
+}
+
+/* ENTRY of local below loop header, which is created on the first touch, while memory keeps value from header. */
+static int trace_entry(struct TRACE_RECORDER*tr, size_t idx)
+{
+    if (tr->entries[idx] == TRACE_NONE) {
+        enum VALUE_TYPE type = VALUE_GET_TYPE(tr->bp[idx]);
+        if (type == VALUE_TYPE_DOUBLE) {
+            return TRACE_NONE;
+        }
+        tr->entries[idx] = trace_add(tr, TRACE_OP_ENTRY, type, (int) idx, TRACE_NONE);
+        tr->slots[idx] = tr->entries[idx];
+    }
+    return tr->entries[idx];
+}
+
+static int trace_slot(struct TRACE_RECORDER*tr, size_t idx)
+{
+    if ((tr->slots[idx] == TRACE_NONE) && (idx < tr->depth0)) {
+        return trace_entry(tr, idx);
+    }
+    return tr->slots[idx];
+}
+
+static int is_compare(size_t op)
+{
+    return (op >= BC_OP_EQ_EQEQ) && (op <= BC_OP_REL_GE);
+}
+
+/* the same arithmetic as interpreter, including truncation of NaN-boxed integers. */
+static long long fold_binary(size_t op, long long a, long long b)
+{
+    long long res;
+    switch (op) {
+    case BC_OP_LOGICAL_OR:         res = a || b; break;
+    case BC_OP_LOGICAL_AND:        res = a && b; break;
+    case BC_OP_EQ_EQEQ:            res = a == b; break;
+    case BC_OP_EQ_NEQ:             res = a != b; break;
+    case BC_OP_REL_LT:             res = a < b;  break;
+    case BC_OP_REL_GT:             res = a > b;  break;
+    case BC_OP_REL_LE:             res = a <= b; break;
+    case BC_OP_REL_GE:             res = a >= b; break;
+    case BC_OP_ADDITIVE_PLUS:      res = a + b;  break;
+    case BC_OP_ADDITIVE_MINUS:     res = a - b;  break;
+    case BC_OP_MULTIPLICATIVE_MUL: res = a * b;  break;
+    case BC_OP_MULTIPLICATIVE_DIV: res = a / b;  break;
+    case BC_OP_MULTIPLICATIVE_MOD:
+    default:
+        res = a % b;
+        break;
+    }
+    return VALUE_GET_INT(create_value_from_int(res));
+}
+
+/* integer operation with constant folding and algebraic identities; divisor is known to be non-zero now. */
+static int trace_binary(struct TRACE_RECORDER*tr, size_t op, int a, int b)
+{
+    int ref;
+
+    if (trace_is_const(tr, a) && trace_is_const(tr, b)) {
+        return trace_const(tr, fold_binary(op, tr->ins[a].cnst, tr->ins[b].cnst));
+    }
+    if (trace_is_const(tr, b)) {
+        long long cnst = tr->ins[b].cnst;
+        if ((cnst == 0) && ((op == BC_OP_ADDITIVE_PLUS) || (op == BC_OP_ADDITIVE_MINUS))) {
+            return a;
+        }
+        if ((cnst == 1) && ((op == BC_OP_MULTIPLICATIVE_MUL) || (op == BC_OP_MULTIPLICATIVE_DIV))) {
+            return a;
+        }
+    }
+    if (trace_is_const(tr, a)) {
+        long long cnst = tr->ins[a].cnst;
+        if (((cnst == 0) && (op == BC_OP_ADDITIVE_PLUS)) || ((cnst == 1) && (op == BC_OP_MULTIPLICATIVE_MUL))) {
+            return b;
+        }
+    }
+
+    ref = trace_add(tr, TRACE_OP_BINARY, VALUE_TYPE_INTEGER, a, b);
+    tr->ins[ref].bc_op = op;
+    if (((op == BC_OP_MULTIPLICATIVE_DIV) || (op == BC_OP_MULTIPLICATIVE_MOD)) && !trace_is_const(tr, b)) {
+        tr->ins[ref].snapshot = trace_snapshot(tr);
+    }
+    return ref;
+}
+
+/* guard of branch direction, which is dropped for constant. */
+static void trace_guard(struct TRACE_RECORDER*tr, int ref, int truth)
+{
+    int guard;
+    if (trace_is_const(tr, ref)) {
+        return;
+    }
+    guard = trace_add(tr, TRACE_OP_GUARD, VALUE_TYPE_INTEGER, ref, TRACE_NONE);
+    tr->ins[guard].cnst = truth;
+    tr->ins[guard].snapshot = trace_snapshot(tr);
+}
+
+static void trace_push(struct TRACE_RECORDER*tr, int ref, struct VALUE val)
+{
+    tr->slots[trace_depth(tr)] = ref;
+    *(tr->sp++) = val;
+}
+
+static int record_binary(struct TRACE_RECORDER*tr, size_t op)
+{
+    size_t depth = trace_depth(tr);
+    struct VALUE val1 = *(tr->sp - 1);
+    struct VALUE val2 = *(tr->sp - 2);
+    long long res;
+    int ref;
+
+    /* interpreter reports these errors. */
+    if (!VALUE_BOTH_INT(val1, val2)) {
+        return 0;
+    }
+    if (((op == BC_OP_MULTIPLICATIVE_DIV) || (op == BC_OP_MULTIPLICATIVE_MOD)) && (VALUE_GET_INT(val1) == 0)) {
+        return 0;
+    }
+
+    res = fold_binary(op, VALUE_GET_INT(val2), VALUE_GET_INT(val1));
+    ref = trace_binary(tr, op, tr->slots[depth - 2], tr->slots[depth - 1]);
+
+    tr->sp--;
+    *(tr->sp - 1) = create_value_from_int(res);
+    tr->slots[depth - 2] = ref;
+    return 1;
+}
+
+/* GET_HEAP reads through arrays and objects; inline caches are left to interpreter. */
+static uint8_t*record_get_heap(struct TRACE_RECORDER*tr, uint8_t*ip)
+{
+    size_t depth = trace_depth(tr);
+    size_t idx = bytecode_read_uleb128(&ip);
+    size_t len = bytecode_read_uleb128(&ip);
+    size_t pops = 0;
+    size_t i;
+    struct VALUE val;
+    int ref;
+
+    if (idx >= depth) {
+        return NULL;
+    }
+    val = tr->bp[idx];
+    ref = trace_slot(tr, idx);
+    if (ref == TRACE_NONE) {
+        return NULL;
+    }
+
+    for (i = 0; i < len; i++) {
+        enum BC_HEAP_OP hop = *(ip++);
+        struct VALUE elem;
+        int elem_ref;
+
+        if (hop == BC_ARRAY_INDEX) {
+            size_t offset = bytecode_read_uleb128(&ip);
+            struct VALUE index;
+            if (offset >= depth) {
+                return NULL;
+            }
+            index = *(tr->sp - offset - 1);
+            if ((VALUE_GET_TYPE(val) != VALUE_TYPE_ARR) || (VALUE_GET_TYPE(index) != VALUE_TYPE_INTEGER) ||
+                (VALUE_GET_INT(index) < 0) || ((size_t) VALUE_GET_INT(index) >= VALUE_GET_ARR(val)->len)) {
+                return NULL;
+            }
+            elem = VALUE_GET_ARR(val)->values[VALUE_GET_INT(index)];
+            if (VALUE_GET_TYPE(elem) == VALUE_TYPE_DOUBLE) {
+                return NULL;
+            }
+            elem_ref = trace_add(tr, TRACE_OP_INDEX, VALUE_GET_TYPE(elem), ref, tr->slots[depth - offset - 1]);
+            pops++;
+        } else {
+            size_t key = bytecode_read_uleb128(&ip);
+            const struct OBJECT*obj;
+            int slot;
+            size_t j;
+
+            bytecode_read_uleb128(&ip);
+            if (VALUE_GET_TYPE(val) != VALUE_TYPE_OBJ) {
+                return NULL;
+            }
+            obj = VALUE_GET_OBJ(val);
+            slot = shape_lookup(obj->shape, key);
+            if (slot == -1) {
+                return NULL;
+            }
+            elem = obj->properties[slot];
+            if (VALUE_GET_TYPE(elem) == VALUE_TYPE_DOUBLE) {
+                return NULL;
+            }
+            elem_ref = trace_add(tr, TRACE_OP_FIELD, VALUE_GET_TYPE(elem), ref, TRACE_NONE);
+            tr->ins[elem_ref].cnst = slot;
+            tr->ins[elem_ref].shape = obj->shape;
+            /* trace is straight line, so earlier check of the same object dominates this one. */
+            for (j = 0; j < (size_t) elem_ref; j++) {
+                if ((tr->ins[j].op == TRACE_OP_FIELD) && (tr->ins[j].a == ref) && (tr->ins[j].shape == obj->shape)) {
+                    tr->ins[elem_ref].shape_known = 1;
+                    break;
+                }
+            }
+        }
+        tr->ins[elem_ref].snapshot = trace_snapshot(tr);
+        val = elem;
+        ref = elem_ref;
+    }
+
+    tr->sp -= pops;
+    trace_push(tr, ref, val);
+    return ip;
+}
+
+/* compare of fused <cmp>_LOCAL_CONST_JUMP. */
+static size_t fused_compare(size_t op)
+{
+    switch (op) {
+    case BC_OP_LT_LOCAL_CONST_JUMP:  return BC_OP_REL_LT;
+    case BC_OP_GT_LOCAL_CONST_JUMP:  return BC_OP_REL_GT;
+    case BC_OP_LE_LOCAL_CONST_JUMP:  return BC_OP_REL_LE;
+    case BC_OP_GE_LOCAL_CONST_JUMP:  return BC_OP_REL_GE;
+    case BC_OP_EQ_LOCAL_CONST_JUMP:  return BC_OP_EQ_EQEQ;
+    case BC_OP_NEQ_LOCAL_CONST_JUMP:
+    default:
+        return BC_OP_EQ_NEQ;
+    }
+}
+
+/* executes and records instruction at ip; returns the next one or NULL, if instruction isn't supported or would fail. */
+static uint8_t*record_instruction(struct TRACE_RECORDER*tr, uint8_t*ip)
+{
+    size_t op = *(ip++);
+    size_t depth = trace_depth(tr);
+
+    tr->instruction = ip - 1;
+    tr->snapshot = TRACE_NONE;
+
+    if (depth + 1 >= tr->depth0 + TRACE_MAX_STACK) {
+        return NULL;
+    }
+    if ((op >= BC_OP_LOGICAL_OR_INT) && (op <= BC_OP_NEGATE_INT)) {
+        op = BC_OP_DEOPTIMIZED(op);
+    }
+
+    switch (op) {
+    case BC_OP_POP:
+        if (depth <= tr->depth0) {
+            return NULL;
+        }
+        tr->sp--;
+        return ip;
+
+    case BC_OP_CONSTANT: {
+        long long cnst = VALUE_GET_INT(create_value_from_int(tr->bc->constant_pool[bytecode_read_uleb128(&ip)].int_cnst));
+        trace_push(tr, trace_const(tr, cnst), create_value_from_int(cnst));
+        return ip;
+    }
+
+    case BC_OP_GET_LOCAL: {
+        size_t idx = bytecode_read_uleb128(&ip);
+        int ref;
+        if (idx >= depth) {
+            return NULL;
+        }
+        ref = trace_slot(tr, idx);
+        if (ref == TRACE_NONE) {
+            return NULL;
+        }
+        trace_push(tr, ref, tr->bp[idx]);
+        return ip;
+    }
+    case BC_OP_SET_LOCAL: {
+        size_t idx = bytecode_read_uleb128(&ip);
+        int ref;
+        if ((idx >= depth) || (depth <= tr->depth0)) {
+            return NULL;
+        }
+        ref = tr->slots[depth - 1];
+        if (idx < tr->depth0) {
+            if (trace_entry(tr, idx) == TRACE_NONE) {
+                return NULL;
+            }
+            tr->written[idx] = 1;
+        }
+        tr->bp[idx] = *(tr->sp - 1);
+        tr->slots[idx] = ref;
+        if (idx != depth - 1) {
+            tr->sp--;
+        }
+        return ip;
+    }
+
+    case BC_OP_NEGATE: {
+        struct VALUE val = *(tr->sp - 1);
+        int ref = tr->slots[depth - 1];
+        if (VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) {
+            return NULL;
+        }
+        if (trace_is_const(tr, ref)) {
+            ref = trace_const(tr, VALUE_GET_INT(create_value_from_int(-tr->ins[ref].cnst)));
+        } else {
+            ref = trace_add(tr, TRACE_OP_NEGATE, VALUE_TYPE_INTEGER, ref, TRACE_NONE);
+        }
+        *(tr->sp - 1) = create_value_from_int(-VALUE_GET_INT(val));
+        tr->slots[depth - 1] = ref;
+        return ip;
+    }
+
+    case BC_OP_LEN: {
+        struct VALUE val = *(tr->sp - 1);
+        int ref = tr->slots[depth - 1];
+        if (VALUE_GET_TYPE(val) == VALUE_TYPE_ARR) {
+            ref = trace_add(tr, TRACE_OP_LEN, VALUE_TYPE_INTEGER, ref, TRACE_NONE);
+            *(tr->sp - 1) = create_value_from_int(VALUE_GET_ARR(val)->len);
+        } else {
+            /* type of ref is fixed by trace, so length of non-array is constant. */
+            ref = trace_const(tr, -1);
+            *(tr->sp - 1) = create_value_from_int(-1);
+        }
+        tr->slots[depth - 1] = ref;
+        return ip;
+    }
+
+    case BC_OP_GET_HEAP:
+        return record_get_heap(tr, ip);
+
+    case BC_OP_JUMP_IF_FALSE:
+    case BC_OP_JUMP_IF_FALSE_WIDE: {
+        int offset = (op == BC_OP_JUMP_IF_FALSE) ? bytecode_read_i8(&ip) : bytecode_read_i32(&ip);
+        struct VALUE val = *(tr->sp - 1);
+        int taken = !VALUE_GET_INT(val);
+        if (VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) {
+            return NULL;
+        }
+        trace_guard(tr, tr->slots[depth - 1], !taken);
+        return taken ? ip + offset : ip;
+    }
+    case BC_OP_JUMP:
+    case BC_OP_JUMP_WIDE: {
+        int offset = (op == BC_OP_JUMP) ? bytecode_read_i8(&ip) : bytecode_read_i32(&ip);
+        /* nested loop would be unrolled. */
+        if ((offset < 0) && (ip + offset != tr->header)) {
+            return NULL;
+        }
+        return ip + offset;
+    }
+
+    case BC_OP_INC_LOCAL: {
+        size_t idx = bytecode_read_uleb128(&ip);
+        long long cnst = tr->bc->constant_pool[bytecode_read_uleb128(&ip)].int_cnst;
+        struct VALUE val;
+        int ref;
+        if (idx >= depth) {
+            return NULL;
+        }
+        val = tr->bp[idx];
+        ref = trace_slot(tr, idx);
+        if ((VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) || (ref == TRACE_NONE)) {
+            return NULL;
+        }
+        if (idx < tr->depth0) {
+            tr->written[idx] = 1;
+        }
+        tr->slots[idx] = trace_binary(tr, BC_OP_ADDITIVE_PLUS, ref, trace_const(tr, cnst));
+        tr->bp[idx] = create_value_from_int(VALUE_GET_INT(val) + cnst);
+        return ip;
+    }
+
+    default:
+        if ((op >= BC_OP_LT_LOCAL_CONST_JUMP) && (op <= BC_OP_NEQ_LOCAL_CONST_JUMP)) {
+            size_t idx = bytecode_read_uleb128(&ip);
+            long long cnst = tr->bc->constant_pool[bytecode_read_uleb128(&ip)].int_cnst;
+            int offset = bytecode_read_i32(&ip);
+            size_t cmp = fused_compare(op);
+            struct VALUE val;
+            int ref;
+            int cond;
+            if (idx >= depth) {
+                return NULL;
+            }
+            val = tr->bp[idx];
+            ref = trace_slot(tr, idx);
+            if ((VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) || (ref == TRACE_NONE)) {
+                return NULL;
+            }
+            cond = (int) fold_binary(cmp, VALUE_GET_INT(val), cnst);
+            trace_guard(tr, trace_binary(tr, cmp, ref, trace_const(tr, cnst)), cond);
+            return cond ? ip : ip + offset;
+        }
+        if ((op >= BC_OP_LOGICAL_OR) && (op <= BC_OP_MULTIPLICATIVE_MOD)) {
+            return record_binary(tr, op) ? ip : NULL;
+        }
+        /* calls, allocations and stores to heap. */
+        return NULL;
+    }
+}
+
+/* compiler of recorded trace. */
+
+struct TRACE_FIXUP
+{
+    size_t pos;
+    size_t snapshot; /* snapshots_len - failed entry. */
+};
+
+struct TRACE_COMPILER
+{
+    struct JIT_BUFFER buf;
+    struct TRACE_RECORDER*tr;
+    struct JIT_TRACE*trace;
+
+    struct TRACE_FIXUP*fixups;
+    size_t fixups_len;
+    size_t fixups_cap;
+};
+
+/* registers, which are allocated to values; r15 keeps bp, rax, rcx and rdx are scratch. */
+static const enum JIT_REGISTER trace_registers[] = {
+    JIT_RBX, JIT_RSI, JIT_RDI, JIT_R8, JIT_R9, JIT_R10, JIT_R11, JIT_R12, JIT_R13, JIT_R14, JIT_RBP,
+};
+
+#define TRACE_REGISTERS_NUM (sizeof(trace_registers) / sizeof(trace_registers[0]))
+#define TRACE_BP            JIT_R15
+
+/* push rbp; push rbx; push r12; push r13; push r14; push r15; push rsi; mov r15, rdi. */
+static const uint8_t trace_prologue[] = {
+    0x55, 0x53, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57, 0x56,
+    0x49, 0x89, 0xFF,
+};
+
+/* pop r15; pop r14; pop r13; pop r12; pop rbx; pop rbp; ret (ip is already in rax). */
+static const uint8_t trace_epilogue[] = {
+    0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5B, 0x5D, 0xC3,
+};
+
+/* ref, which side exit of snapshot stores to slot, or TRACE_NONE, if slot in memory is up to date. */
+static int snapshot_ref(const struct TRACE_RECORDER*tr, const struct TRACE_SNAPSHOT*snap, size_t slot)
+{
+    int ref = tr->snapshot_refs[snap->refs + slot];
+    if (slot < tr->depth0) {
+        if (!tr->written[slot]) {
+            return TRACE_NONE;
+        }
+        return (ref == TRACE_NONE) ? tr->entries[slot] : ref;
+    }
+    return ref;
+}
+
+static void emit_jump_to_exit(struct TRACE_COMPILER*tc, enum JIT_CONDITION cc, size_t snapshot)
+{
+    struct TRACE_FIXUP fixup;
+    fixup.pos = jit_emit_jump(&(tc->buf), cc);
+    fixup.snapshot = snapshot;
+    PUSH_BACK(tc->fixups, fixup);
+}
+
+/* [rax] += 1 for counter at address. */
+static void emit_count(struct TRACE_COMPILER*tc, unsigned long long*counter)
+{
+    static const uint8_t add[] = {0x48, 0x83, 0x00, 0x01};
+    jit_emit_mov_imm64(&(tc->buf), JIT_RAX, (uint64_t) (uintptr_t) counter);
+    jit_emit_bytes(&(tc->buf), add, sizeof(add));
+}
+
+static void emit_shift(struct TRACE_COMPILER*tc, int ext, int reg, uint8_t count)
+{
+    jit_emit_ext(&(tc->buf), 0xC1, ext, reg);
+    jit_emit_byte(&(tc->buf), count);
+}
+
+/* NaN-boxed integers keep 48 bits, as after every store in interpreter. */
+static void emit_truncate(struct TRACE_COMPILER*tc, int reg)
+{
+#ifdef VALUE_NAN_BOXING
+    emit_shift(tc, 4, reg, 16);
+    emit_shift(tc, 7, reg, 16);
+#else
+    PREFIX_UNUSED(tc);
+    PREFIX_UNUSED(reg);
+#endif
+}
+
+static void emit_mov(struct TRACE_COMPILER*tc, int dst, int src)
+{
+    if (dst != src) {
+        jit_emit_reg(&(tc->buf), 0x89, dst, src);
+    }
+}
+
+/* scratch = value of ref. */
+static void emit_operand(struct TRACE_COMPILER*tc, int scratch, int ref)
+{
+    const struct TRACE_INS*ins = tc->tr->ins + ref;
+    if (ins->op == TRACE_OP_CONST) {
+        jit_emit_mov_imm64(&(tc->buf), scratch, (uint64_t) ins->cnst);
+    } else {
+        emit_mov(tc, scratch, ins->reg);
+    }
+}
+
+static int is_imm32(long long cnst)
+{
+    return (cnst >= INT32_MIN) && (cnst <= INT32_MAX);
+}
+
+/* rax = rax op ref, where op is given by register form and extension of form with imm32. Clobbers rcx. */
+static void emit_alu(struct TRACE_COMPILER*tc, uint8_t op, int ext, int ref)
+{
+    const struct TRACE_INS*ins = tc->tr->ins + ref;
+    if ((ins->op == TRACE_OP_CONST) && is_imm32(ins->cnst)) {
+        jit_emit_ext(&(tc->buf), 0x81, ext, JIT_RAX);
+        jit_emit_u32(&(tc->buf), (uint32_t) ins->cnst);
+    } else if (ins->op == TRACE_OP_CONST) {
+        jit_emit_mov_imm64(&(tc->buf), JIT_RCX, (uint64_t) ins->cnst);
+        jit_emit_reg(&(tc->buf), op, JIT_RAX, JIT_RCX);
+    } else {
+        jit_emit_reg(&(tc->buf), op, JIT_RAX, ins->reg);
+    }
+}
+
+/* rax = rax * ref. Clobbers rcx. */
+static void emit_mul(struct TRACE_COMPILER*tc, int ref)
+{
+    const struct TRACE_INS*ins = tc->tr->ins + ref;
+    int src = ins->reg;
+    if ((ins->op == TRACE_OP_CONST) && is_imm32(ins->cnst)) {
+        /* imul rax, rax, imm32. */
+        static const uint8_t mul_imm[] = {0x48, 0x69, 0xC0};
+        jit_emit_bytes(&(tc->buf), mul_imm, sizeof(mul_imm));
+        jit_emit_u32(&(tc->buf), (uint32_t) ins->cnst);
+        return;
+    }
+    if (ins->op == TRACE_OP_CONST) {
+        jit_emit_mov_imm64(&(tc->buf), JIT_RCX, (uint64_t) ins->cnst);
+        src = JIT_RCX;
+    }
+    /* imul rax, src. */
+    jit_emit_byte(&(tc->buf), 0x48 | ((src & 8) ? 0x01 : 0x00));
+    jit_emit_byte(&(tc->buf), 0x0F);
+    jit_emit_byte(&(tc->buf), 0xAF);
+    jit_emit_byte(&(tc->buf), 0xC0 | (src & 7));
+}
+
+/* dst = condition as 0 or 1. */
+static void emit_setcc(struct TRACE_COMPILER*tc, enum JIT_CONDITION cc, int dst)
+{
+    /* setcc al; movzx eax, al. */
+    uint8_t setcc[] = {0x0F, 0x90, 0xC0, 0x0F, 0xB6, 0xC0};
+    setcc[1] = 0x90 + cc;
+    jit_emit_bytes(&(tc->buf), setcc, sizeof(setcc));
+    emit_mov(tc, dst, JIT_RAX);
+}
+
+static enum JIT_CONDITION compare_condition(size_t op)
+{
+    switch (op) {
+    case BC_OP_EQ_EQEQ: return JIT_CC_E;
+    case BC_OP_EQ_NEQ:  return JIT_CC_NE;
+    case BC_OP_REL_LT:  return JIT_CC_L;
+    case BC_OP_REL_GT:  return JIT_CC_G;
+    case BC_OP_REL_LE:  return JIT_CC_LE;
+    case BC_OP_REL_GE:
+    default:
+        return JIT_CC_GE;
+    }
+}
+
+/* layout-specific boxing and unboxing. */
+
+#ifdef VALUE_NAN_BOXING
+
+/* dst = unboxed value at [base + disp], which must be of type. Base isn't rcx or rdx. */
+static void emit_load_value(struct TRACE_COMPILER*tc, int dst, int base, int32_t disp, enum VALUE_TYPE type, size_t snapshot)
+{
+    /* cmp ecx, imm32. */
+    static const uint8_t cmp_tag[] = {0x81, 0xF9};
+
+    jit_emit_mem(&(tc->buf), 1, 0x8B, JIT_RDX, base, disp);
+    emit_mov(tc, JIT_RCX, JIT_RDX);
+    emit_shift(tc, 5, JIT_RCX, 48);
+    jit_emit_bytes(&(tc->buf), cmp_tag, sizeof(cmp_tag));
+    jit_emit_u32(&(tc->buf), (uint32_t) (VALUE_NAN_BOXING_TAG_BASE + type));
+    emit_jump_to_exit(tc, JIT_CC_NE, snapshot);
+    /* integer is sign-extended, pointer is payload. */
+    emit_shift(tc, 4, JIT_RDX, 16);
+    emit_shift(tc, (type == VALUE_TYPE_INTEGER) ? 7 : 5, JIT_RDX, 16);
+    emit_mov(tc, dst, JIT_RDX);
+}
+
+/* [TRACE_BP + disp] = boxed value of ref. Clobbers rax and rcx. */
+static void emit_store_value(struct TRACE_COMPILER*tc, int ref, int32_t disp, long long cnst)
+{
+    const struct TRACE_INS*ins = tc->tr->ins + ref;
+    if (ins->op == TRACE_OP_CONST) {
+        cnst = ins->cnst;
+    }
+    if ((ins->op == TRACE_OP_CONST) || ins->fused) {
+        jit_emit_mov_imm64(&(tc->buf), JIT_RAX, create_value_from_int(cnst).bits);
+    } else {
+        emit_mov(tc, JIT_RAX, ins->reg);
+        emit_shift(tc, 4, JIT_RAX, 16);
+        emit_shift(tc, 5, JIT_RAX, 16);
+        jit_emit_mov_imm64(&(tc->buf), JIT_RCX, (VALUE_NAN_BOXING_TAG_BASE + ins->type) << 48);
+        jit_emit_reg(&(tc->buf), 0x09, JIT_RAX, JIT_RCX);
+    }
+    jit_emit_mem(&(tc->buf), 1, 0x89, JIT_RAX, TRACE_BP, disp);
+}
+
+#else
+
+#define TRACE_VALUE_INT_OFFSET  ((int32_t) offsetof(struct VALUE, int_val))
+#define TRACE_VALUE_TYPE_OFFSET ((int32_t) offsetof(struct VALUE, type))
+
+/* dst = unboxed value at [base + disp], which must be of type. */
+static void emit_load_value(struct TRACE_COMPILER*tc, int dst, int base, int32_t disp, enum VALUE_TYPE type, size_t snapshot)
+{
+    /* cmp dword [m + type], imm8; jne exit; mov dst, [m + int_val] (pointers share union). */
+    jit_emit_mem(&(tc->buf), 0, 0x83, 7, base, disp + TRACE_VALUE_TYPE_OFFSET);
+    jit_emit_byte(&(tc->buf), (uint8_t) type);
+    emit_jump_to_exit(tc, JIT_CC_NE, snapshot);
+    jit_emit_mem(&(tc->buf), 1, 0x8B, dst, base, disp + TRACE_VALUE_INT_OFFSET);
+}
+
+/* [TRACE_BP + disp] = boxed value of ref; constant and fused compare store cnst. Clobbers rax. */
+static void emit_store_value(struct TRACE_COMPILER*tc, int ref, int32_t disp, long long cnst)
+{
+    const struct TRACE_INS*ins = tc->tr->ins + ref;
+    int src = ins->reg;
+    if (ins->op == TRACE_OP_CONST) {
+        cnst = ins->cnst;
+    }
+    if ((ins->op == TRACE_OP_CONST) || ins->fused) {
+        jit_emit_mov_imm64(&(tc->buf), JIT_RAX, (uint64_t) cnst);
+        src = JIT_RAX;
+    }
+    jit_emit_mem(&(tc->buf), 1, 0x89, src, TRACE_BP, disp + TRACE_VALUE_INT_OFFSET);
+    jit_emit_mem(&(tc->buf), 0, 0xC7, 0, TRACE_BP, disp + TRACE_VALUE_TYPE_OFFSET);
+    jit_emit_u32(&(tc->buf), (uint32_t) ins->type);
+}
+
+#endif
+
+static void emit_binary(struct TRACE_COMPILER*tc, const struct TRACE_INS*ins)
+{
+    size_t snapshot = (size_t) ins->snapshot;
+
+    switch (ins->bc_op) {
+    case BC_OP_ADDITIVE_PLUS:
+        emit_operand(tc, JIT_RAX, ins->a);
+        emit_alu(tc, 0x01, 0, ins->b);
+        break;
+    case BC_OP_ADDITIVE_MINUS:
+        emit_operand(tc, JIT_RAX, ins->a);
+        emit_alu(tc, 0x29, 5, ins->b);
+        break;
+    case BC_OP_MULTIPLICATIVE_MUL:
+        emit_operand(tc, JIT_RAX, ins->a);
+        emit_mul(tc, ins->b);
+        break;
+    case BC_OP_MULTIPLICATIVE_DIV:
+    case BC_OP_MULTIPLICATIVE_MOD: {
+        /* cqo; idiv rcx. */
+        static const uint8_t div[] = {0x48, 0x99, 0x48, 0xF7, 0xF9};
+        emit_operand(tc, JIT_RCX, ins->b);
+        if (ins->snapshot != TRACE_NONE) {
+            /* interpreter reports division by zero. */
+            jit_emit_reg(&(tc->buf), 0x85, JIT_RCX, JIT_RCX);
+            emit_jump_to_exit(tc, JIT_CC_E, snapshot);
+        }
+        emit_operand(tc, JIT_RAX, ins->a);
+        jit_emit_bytes(&(tc->buf), div, sizeof(div));
+        if (ins->bc_op == BC_OP_MULTIPLICATIVE_MOD) {
+            emit_mov(tc, JIT_RAX, JIT_RDX);
+        }
+        break;
+    }
+    case BC_OP_LOGICAL_AND: {
+        /* test rax, rax; setne al; test rcx, rcx; setne cl; and al, cl; movzx eax, al. */
+        static const uint8_t logical_and[] = {
+            0x48, 0x85, 0xC0, 0x0F, 0x95, 0xC0,
+            0x48, 0x85, 0xC9, 0x0F, 0x95, 0xC1,
+            0x20, 0xC8, 0x0F, 0xB6, 0xC0,
+        };
+        emit_operand(tc, JIT_RAX, ins->a);
+        emit_operand(tc, JIT_RCX, ins->b);
+        jit_emit_bytes(&(tc->buf), logical_and, sizeof(logical_and));
+        emit_mov(tc, ins->reg, JIT_RAX);
+        return;
+    }
+    case BC_OP_LOGICAL_OR:
+        emit_operand(tc, JIT_RAX, ins->a);
+        emit_alu(tc, 0x09, 1, ins->b);
+        emit_setcc(tc, JIT_CC_NE, ins->reg);
+        return;
+    default:
+        /* compare; fused one leaves flags for guard. */
+        emit_operand(tc, JIT_RAX, ins->a);
+        emit_alu(tc, 0x39, 7, ins->b);
+        if (!ins->fused) {
+            emit_setcc(tc, compare_condition(ins->bc_op), ins->reg);
+        }
+        return;
+    }
+
+    emit_truncate(tc, JIT_RAX);
+    emit_mov(tc, ins->reg, JIT_RAX);
+}
+
+static void emit_ins(struct TRACE_COMPILER*tc, const struct TRACE_INS*ins)
+{
+    const struct TRACE_INS*ins_a = (ins->a != TRACE_NONE) ? tc->tr->ins + ins->a : NULL;
+    size_t snapshot = (size_t) ins->snapshot;
+
+    switch (ins->op) {
+    case TRACE_OP_ENTRY:
+    case TRACE_OP_CONST:
+        break;
+
+    case TRACE_OP_BINARY:
+        emit_binary(tc, ins);
+        break;
+
+    case TRACE_OP_NEGATE:
+        emit_operand(tc, JIT_RAX, ins->a);
+        jit_emit_ext(&(tc->buf), 0xF7, 3, JIT_RAX);
+        emit_truncate(tc, JIT_RAX);
+        emit_mov(tc, ins->reg, JIT_RAX);
+        break;
+
+    case TRACE_OP_GUARD:
+        if (ins_a->fused) {
+            enum JIT_CONDITION cc = compare_condition(ins_a->bc_op);
+            emit_jump_to_exit(tc, ins->cnst ? JIT_CC_NOT(cc) : cc, snapshot);
+        } else {
+            jit_emit_reg(&(tc->buf), 0x85, ins_a->reg, ins_a->reg);
+            emit_jump_to_exit(tc, ins->cnst ? JIT_CC_E : JIT_CC_NE, snapshot);
+        }
+        break;
+
+    case TRACE_OP_LEN:
+        jit_emit_mem(&(tc->buf), 1, 0x8B, ins->reg, ins_a->reg, (int32_t) offsetof(struct ARRAY, len));
+        break;
+
+    case TRACE_OP_FIELD:
+        if (!ins->shape_known) {
+            jit_emit_mov_imm64(&(tc->buf), JIT_RAX, (uint64_t) (uintptr_t) ins->shape);
+            jit_emit_mem(&(tc->buf), 1, 0x39, JIT_RAX, ins_a->reg, (int32_t) offsetof(struct OBJECT, shape));
+            emit_jump_to_exit(tc, JIT_CC_NE, snapshot);
+        }
+        jit_emit_mem(&(tc->buf), 1, 0x8B, JIT_RAX, ins_a->reg, (int32_t) offsetof(struct OBJECT, properties));
+        emit_load_value(tc, ins->reg, JIT_RAX, (int32_t) ins->cnst * JIT_VALUE_SIZE, ins->type, snapshot);
+        break;
+
+    case TRACE_OP_INDEX:
+    default:
+        /* unsigned compare with length rejects negative index too. */
+        emit_operand(tc, JIT_RCX, ins->b);
+        jit_emit_mem(&(tc->buf), 1, 0x3B, JIT_RCX, ins_a->reg, (int32_t) offsetof(struct ARRAY, len));
+        emit_jump_to_exit(tc, JIT_CC_AE, snapshot);
+        jit_emit_mem(&(tc->buf), 1, 0x8B, JIT_RAX, ins_a->reg, (int32_t) offsetof(struct ARRAY, values));
+        emit_shift(tc, 4, JIT_RCX, (JIT_VALUE_SIZE == 16) ? 4 : 3);
+        jit_emit_reg(&(tc->buf), 0x01, JIT_RAX, JIT_RCX);
+        emit_load_value(tc, ins->reg, JIT_RAX, 0, ins->type, snapshot);
+        break;
+    }
+}
+
+/* move of back-edge: register of local gets its value for the next iteration. */
+struct TRACE_MOVE
+{
+    int dst;
+    int src; /* register or TRACE_NONE for constant. */
+    long long cnst;
+};
+
+/* parallel move; cycles are broken through rax. */
+static void emit_moves(struct TRACE_COMPILER*tc, struct TRACE_MOVE*moves, size_t len)
+{
+    while (len > 0) {
+        size_t i;
+        size_t j;
+        for (i = 0; i < len; i++) {
+            for (j = 0; j < len; j++) {
+                if ((j != i) && (moves[j].src == moves[i].dst)) {
+                    break;
+                }
+            }
+            if (j == len) {
+                break;
+            }
+        }
+        if (i == len) {
+            /* every destination is still read: save one of them. */
+            emit_mov(tc, JIT_RAX, moves[0].dst);
+            for (j = 1; j < len; j++) {
+                if (moves[j].src == moves[0].dst) {
+                    moves[j].src = JIT_RAX;
+                }
+            }
+            continue;
+        }
+        if (moves[i].src == TRACE_NONE) {
+            jit_emit_mov_imm64(&(tc->buf), moves[i].dst, (uint64_t) moves[i].cnst);
+        } else {
+            emit_mov(tc, moves[i].dst, moves[i].src);
+        }
+        moves[i] = moves[--len];
+    }
+}
+
+/* side exit: boxes snapshot back to stack, sets sp and returns ip of guarded instruction. */
+static void emit_exit_stub(struct TRACE_COMPILER*tc, size_t snapshot)
+{
+    const struct TRACE_RECORDER*tr = tc->tr;
+    /* pop rcx; mov [rcx], rax. */
+    static const uint8_t store_sp[] = {0x59, 0x48, 0x89, 0x01};
+    uint8_t*ip = tr->header;
+    size_t depth = tr->depth0;
+
+    emit_count(tc, tc->trace->exits + snapshot);
+    if (snapshot < tr->snapshots_len) {
+        const struct TRACE_SNAPSHOT*snap = tr->snapshots + snapshot;
+        size_t i;
+        for (i = 0; i < snap->depth; i++) {
+            int ref = snapshot_ref(tr, snap, i);
+            if (ref != TRACE_NONE) {
+                /* failed guard of fused compare tells its value. */
+                long long cnst = tr->ins[ref].fused ? !tr->ins[ref + 1].cnst : 0;
+                emit_store_value(tc, ref, (int32_t) i * JIT_VALUE_SIZE, cnst);
+            }
+        }
+        ip = snap->ip;
+        depth = snap->depth;
+    }
+    tc->trace->exit_ips[snapshot] = ip;
+
+    jit_emit_mem(&(tc->buf), 1, 0x8D, JIT_RAX, TRACE_BP, (int32_t) depth * JIT_VALUE_SIZE);
+    jit_emit_bytes(&(tc->buf), store_sp, sizeof(store_sp));
+    jit_emit_mov_imm64(&(tc->buf), JIT_RAX, (uint64_t) (uintptr_t) ip);
+    jit_emit_bytes(&(tc->buf), trace_epilogue, sizeof(trace_epilogue));
+}
+
+/* liveness, fusion of compares and registers; returns 0, if trace doesn't fit registers. */
+static int trace_allocate(struct TRACE_RECORDER*tr)
+{
+    size_t end = tr->ins_len;
+    size_t*snapshot_pos;
+    size_t*uses;
+    int*snapshot_user;
+    int owner[16];
+    size_t i;
+    size_t k;
+    int ok = 1;
+
+    SAFE_CALLOC(snapshot_pos, tr->snapshots_len);
+    SAFE_CALLOC(uses, tr->ins_len);
+    SAFE_MALLOC(snapshot_user, tr->ins_len);
+
+    for (i = 0; i < tr->ins_len; i++) {
+        struct TRACE_INS*ins = tr->ins + i;
+        ins->last_use = i;
+        ins->reg = TRACE_NONE;
+        snapshot_user[i] = TRACE_NONE;
+    }
+    for (i = 0; i < tr->ins_len; i++) {
+        const struct TRACE_INS*ins = tr->ins + i;
+        if (ins->op == TRACE_OP_ENTRY) {
+            continue;
+        }
+        if (ins->a != TRACE_NONE) {
+            tr->ins[ins->a].last_use = i;
+            uses[ins->a]++;
+        }
+        if (ins->b != TRACE_NONE) {
+            tr->ins[ins->b].last_use = i;
+            uses[ins->b]++;
+        }
+        if (ins->snapshot != TRACE_NONE) {
+            snapshot_pos[ins->snapshot] = i;
+        }
+    }
+    for (k = 0; k < tr->snapshots_len; k++) {
+        const struct TRACE_SNAPSHOT*snap = tr->snapshots + k;
+        for (i = 0; i < snap->depth; i++) {
+            int ref = snapshot_ref(tr, snap, i);
+            if (ref == TRACE_NONE) {
+                continue;
+            }
+            if (tr->ins[ref].last_use < snapshot_pos[k]) {
+                tr->ins[ref].last_use = snapshot_pos[k];
+            }
+            /* another snapshot or the same value in two slots. */
+            snapshot_user[ref] = (snapshot_user[ref] == TRACE_NONE) ? (int) k : -2;
+        }
+    }
+    for (i = 0; i < tr->depth0; i++) {
+        if (tr->entries[i] != TRACE_NONE) {
+            tr->ins[tr->slots[i]].last_use = end;
+            uses[tr->slots[i]]++;
+        }
+    }
+
+    /* compare, which only feeds the next guard, keeps result in flags; its exit knows value. */
+    for (i = 0; i + 1 < tr->ins_len; i++) {
+        struct TRACE_INS*ins = tr->ins + i;
+        const struct TRACE_INS*next = ins + 1;
+        if ((ins->op == TRACE_OP_BINARY) && is_compare(ins->bc_op) && (uses[i] == 1) &&
+            (next->op == TRACE_OP_GUARD) && (next->a == (int) i) &&
+            ((snapshot_user[i] == TRACE_NONE) ||
+             ((snapshot_user[i] == next->snapshot) && (tr->snapshots[next->snapshot].guards == 1)))) {
+            ins->fused = 1;
+        }
+    }
+
+    for (i = 0; i < 16; i++) {
+        owner[i] = TRACE_NONE;
+    }
+    /* loop-carried locals get fixed registers first. */
+    for (i = 0; (i < tr->ins_len) && ok; i++) {
+        struct TRACE_INS*ins = tr->ins + i;
+        if (ins->op == TRACE_OP_ENTRY) {
+            for (k = 0; k < TRACE_REGISTERS_NUM; k++) {
+                if (owner[trace_registers[k]] == TRACE_NONE) {
+                    break;
+                }
+            }
+            if (k == TRACE_REGISTERS_NUM) {
+                ok = 0;
+                break;
+            }
+            ins->reg = trace_registers[k];
+            owner[ins->reg] = (int) i;
+            ins->last_use = end;
+        }
+    }
+    /* linear scan: registers of values, whose last use is here, are free for result. */
+    for (i = 0; (i < tr->ins_len) && ok; i++) {
+        struct TRACE_INS*ins = tr->ins + i;
+        int needs_reg = ((ins->op == TRACE_OP_BINARY) && !ins->fused) || (ins->op == TRACE_OP_NEGATE) ||
+            (ins->op == TRACE_OP_LEN) || (ins->op == TRACE_OP_FIELD) || (ins->op == TRACE_OP_INDEX);
+        for (k = 0; k < 16; k++) {
+            if ((owner[k] != TRACE_NONE) && (tr->ins[owner[k]].last_use <= i)) {
+                owner[k] = TRACE_NONE;
+            }
+        }
+        if (!needs_reg) {
+            continue;
+        }
+        for (k = 0; k < TRACE_REGISTERS_NUM; k++) {
+            if (owner[trace_registers[k]] == TRACE_NONE) {
+                break;
+            }
+        }
+        if (k == TRACE_REGISTERS_NUM) {
+            ok = 0;
+            break;
+        }
+        ins->reg = trace_registers[k];
+        if (ins->last_use > i) {
+            owner[ins->reg] = (int) i;
+        }
+    }
+
+    SAFE_FREE(snapshot_pos);
+    SAFE_FREE(uses);
+    SAFE_FREE(snapshot_user);
+
+    return ok;
+}
+
+/* compiles closed trace; NULL, when locals change type or values don't fit registers. */
+static jit_code_type_t trace_compile(struct JIT*jit, struct TRACE_RECORDER*tr)
+{
+    struct TRACE_COMPILER tc;
+    struct JIT_TRACE*trace;
+    struct TRACE_MOVE*moves;
+    size_t moves_len = 0;
+    size_t loop_pos;
+    size_t i;
+    void*mem;
+
+    for (i = 0; i < tr->depth0; i++) {
+        if ((tr->entries[i] != TRACE_NONE) && (tr->ins[tr->slots[i]].type != tr->ins[tr->entries[i]].type)) {
+            return NULL;
+        }
+    }
+    if ((tr->ins_len > TRACE_MAX_IR) || !trace_allocate(tr)) {
+        return NULL;
+    }
+
+    SAFE_CALLOC(trace, 1);
+    trace->header = (size_t) (tr->header - tr->bc->op_codes);
+    trace->ir_len = tr->ins_len;
+    trace->exits_num = tr->snapshots_len + 1;
+    SAFE_CALLOC(trace->exits, trace->exits_num);
+    SAFE_CALLOC(trace->exit_ips, trace->exits_num);
+
+    memset(&tc, 0, sizeof(tc));
+    tc.tr = tr;
+    tc.trace = trace;
+
+    jit_emit_bytes(&(tc.buf), trace_prologue, sizeof(trace_prologue));
+    emit_count(&tc, &(trace->entries));
+    for (i = 0; i < tr->ins_len; i++) {
+        const struct TRACE_INS*ins = tr->ins + i;
+        if (ins->op == TRACE_OP_ENTRY) {
+            emit_load_value(&tc, ins->reg, TRACE_BP, ins->a * JIT_VALUE_SIZE, ins->type, tr->snapshots_len);
+        }
+    }
+
+    loop_pos = tc.buf.code_len;
+    for (i = 0; i < tr->ins_len; i++) {
+        emit_ins(&tc, tr->ins + i);
+    }
+
+    emit_count(&tc, &(trace->iterations));
+    SAFE_MALLOC(moves, tr->depth0 + 1);
+    for (i = 0; i < tr->depth0; i++) {
+        const struct TRACE_INS*ins;
+        if ((tr->entries[i] == TRACE_NONE) || (tr->slots[i] == tr->entries[i])) {
+            continue;
+        }
+        ins = tr->ins + tr->slots[i];
+        moves[moves_len].dst = tr->ins[tr->entries[i]].reg;
+        moves[moves_len].src = (ins->op == TRACE_OP_CONST) ? TRACE_NONE : ins->reg;
+        moves[moves_len].cnst = ins->cnst;
+        if (moves[moves_len].src != moves[moves_len].dst) {
+            moves_len++;
+        }
+    }
+    emit_moves(&tc, moves, moves_len);
+    SAFE_FREE(moves);
+    jit_patch_rel32(&(tc.buf), jit_emit_jump(&(tc.buf), JIT_CC_ALWAYS), loop_pos);
+
+    /* stub of every snapshot, then of failed entry. */
+    for (i = 0; i <= tr->snapshots_len; i++) {
+        size_t j;
+        int used = 0;
+        for (j = 0; j < tc.fixups_len; j++) {
+            if (tc.fixups[j].snapshot == i) {
+                jit_patch_rel32(&(tc.buf), tc.fixups[j].pos, tc.buf.code_len);
+                used = 1;
+            }
+        }
+        if (used) {
+            emit_exit_stub(&tc, i);
+        }
+    }
+
+    mem = jit_map_code(jit, &(tc.buf));
+    jit_buffer_free(&(tc.buf));
+    SAFE_FREE(tc.fixups);
+
+    if (mem == NULL) {
+        SAFE_FREE(trace->exits);
+        SAFE_FREE(trace->exit_ips);
+        SAFE_FREE(trace);
+        return NULL;
+    }
+    trace->next = jit->traces;
+    jit->traces = trace;
+    jit->traces_num++;
+
+    return (jit_code_type_t) mem;
+}
+
+uint8_t*jit_record_trace(struct JIT*jit, struct JIT_LOOP*loop, const bytecode_type_t bc,
+                         uint8_t*header, uint8_t*end, struct VALUE*bp, struct VALUE**sp)
+{
+    struct TRACE_RECORDER tr;
+    uint8_t*ip = header;
+    int closed = 0;
+    size_t i;
+
+    if (loop->aborts >= TRACE_MAX_ABORTS) {
+        return header;
+    }
+
+    memset(&tr, 0, sizeof(tr));
+    tr.bc = bc;
+    tr.header = header;
+    tr.bp = bp;
+    tr.sp = *sp;
+    tr.depth0 = trace_depth(&tr);
+    SAFE_MALLOC(tr.slots, tr.depth0 + TRACE_MAX_STACK);
+    SAFE_MALLOC(tr.entries, tr.depth0 + 1);
+    SAFE_CALLOC(tr.written, tr.depth0 + 1);
+    for (i = 0; i < tr.depth0 + TRACE_MAX_STACK; i++) {
+        tr.slots[i] = TRACE_NONE;
+    }
+    for (i = 0; i < tr.depth0; i++) {
+        tr.entries[i] = TRACE_NONE;
+    }
+
+    /* every instruction is either executed and recorded or left to interpreter. */
+    while (1) {
+        uint8_t*next = record_instruction(&tr, ip);
+        if (next == NULL) {
+            break;
+        }
+        ip = next;
+        if (ip == header) {
+            closed = (trace_depth(&tr) == tr.depth0);
+            break;
+        }
+        if ((ip < header) || (ip >= end) || (tr.ins_len > TRACE_MAX_IR)) {
+            break;
+        }
+    }
+    *sp = tr.sp;
+
+    if (closed) {
+        loop->code = trace_compile(jit, &tr);
+        if (loop->code == NULL) {
+            jit->rejected_num++;
+            loop->aborts = TRACE_MAX_ABORTS;
+        }
+    } else {
+        /* loop is recorded again after the same number of back-edges. */
+        jit->aborts_num++;
+        loop->aborts++;
+        loop->hotness = 0;
+    }
+
+    SAFE_FREE(tr.ins);
+    SAFE_FREE(tr.slots);
+    SAFE_FREE(tr.entries);
+    SAFE_FREE(tr.written);
+    SAFE_FREE(tr.snapshots);
+    SAFE_FREE(tr.snapshot_refs);
+
+    return ip;
+}
+
+#endif
@@ -0,0 +1,764 @@
+/*
+  Interpreter loop, which is included into virtual-machine.c
+  once for every flavour of loop. Before including define:
+    VM_LOOP_NAME  - name of generated function;
+    VM_LOOP_TRACE - 1, if every step must be traced.
+  Opcodes are dispatched by labels-as-values (direct threading),
+  when VIRTUAL_MACHINE_THREADED_DISPATCH is set, and by switch otherwise.
+*/
+
+/*
+  Instruction and stack pointers live in registers and are
+  synced with vm only around helpers, which can run GC.
+*/
+#define VM_FETCH()          (*(ip++))
+#define VM_FETCH_ULEB128()  bytecode_read_uleb128(&ip)
+#define VM_FETCH_I8()       bytecode_read_i8(&ip)
+#define VM_FETCH_I32()      bytecode_read_i32(&ip)
+#define VM_PUSH(val)                            \
+    do {                                        \
+        if (sp == stack_end) {                  \
+            printf("stack overflow\n");         \
+            exit(1);                            \
+        }                                       \
+        *(sp++) = (val);                        \
+    } while (0)
+#define VM_POP()     (*(--sp))
+#define VM_DROP()    (--sp)
+#define VM_SAVE()                               \
+    do {                                        \
+        vm->ip = ip;                            \
+        vm->stack_top = sp;                     \
+    } while (0)
+#define VM_LOAD()                               \
+    do {                                        \
+        ip = vm->ip;                            \
+        sp = vm->stack_top;                     \
+    } while (0)
+
+/*
+  Position of trace writer lives in registers too and is synced
+  with vm->tracer only around chunk switch, heap record and return.
+  Heap usage is checked only after instructions, which may allocate.
+*/
+#if VM_LOOP_TRACE
+#define VM_TRACE_SYNC(call)                                             \
+    do {                                                                \
+        vm->tracer.pos = trace_pos;                                     \
+        call;                                                           \
+        trace_pos = vm->tracer.pos;                                     \
+        trace_end = vm->tracer.end;                                     \
+    } while (0)
+#define VM_TRACE_STEP()                                                 \
+    do {                                                                \
+        if (trace_allocated) {                                          \
+            VM_TRACE_SYNC(trace_heap(vm));                              \
+        }                                                               \
+        trace_allocated = may_allocate(instruction);                    \
+        if (trace_pos == trace_end) {                                   \
+            VM_TRACE_SYNC(trace_writer_next_chunk(&(vm->tracer)));      \
+        }                                                               \
+        /* instruction is already fetched. */                           \
+        *(trace_pos++) = TRACE_STEP_RECORD(instruction, sp - stack, ip - 1 - op_codes); \
+    } while (0)
+#define VM_TRACE_FINISH() (vm->tracer.pos = trace_pos)
+#else
+#define VM_TRACE_STEP()   ((void) 0)
+#define VM_TRACE_FINISH() ((void) 0)
+#endif
+
+/*
+  Generic arithmetic and compare opcode, which has no operands, rewrites itself
+  into quickened one after integer operands are checked.
+*/
+#define VM_QUICKEN(op)                                  \
+    do {                                                \
+        if (vm->quickening) {                           \
+            *(ip - 1) = BC_OP_QUICKENED(op);            \
+            vm->quickened++;                            \
+        }                                               \
+    } while (0)
+
+/*
+  Back-edge has just jumped by negative offset: hot loop is compiled (or its iteration
+  is recorded) and then run by machine code from header at ip, until it returns ip,
+  where interpreter continues. Traces aren't entered in the middle of GC cycle, which
+  needs read barrier. Traced loop only interprets, so every step is in trace.
+  Machine code and recorder push without checks, so they need stack reserve.
+*/
+#if VIRTUAL_MACHINE_JIT && !VM_LOOP_TRACE
+#define VM_JIT_BACK_EDGE(offset)                                        \
+    do {                                                                \
+        if (((offset) < 0) && (vm->jit_loops != NULL) &&                \
+            ((size_t) (stack_end - sp) >= VIRTUAL_MACHINE_CALL_STACK_RESERVE)) { \
+            uint8_t*end = ip - (offset);                                \
+            struct JIT_LOOP*loop = vm->jit_loops + (end - vm->bc->op_codes); \
+            if (loop->code != NULL) {                                   \
+                if ((vm->jit_mode == VIRTUAL_MACHINE_JIT_TEMPLATE) || !vm->gc->cycle) { \
+                    vm->jit.entries++;                                  \
+                    ip = loop->code(bp, &sp);                           \
+                }                                                       \
+            } else if (++(loop->hotness) == vm->jit_hotness) {          \
+                ip = jit_hot_loop(vm, loop, ip, end, bp, &sp);          \
+            }                                                           \
+        }                                                               \
+    } while (0)
+#else
+#define VM_JIT_BACK_EDGE(offset) ((void) 0)
+#endif
+
+#if VIRTUAL_MACHINE_THREADED_DISPATCH
+#define VM_SWITCH(instruction) goto *labels[instruction];
+#define VM_CASE(op)            label_##op:
+#define VM_NEXT()                               \
+    do {                                        \
+        instruction = VM_FETCH();              \
+        VM_TRACE_STEP();                        \
+        goto *labels[instruction];              \
+    } while (0)
+#else
+#define VM_SWITCH(instruction) switch (instruction)
+#define VM_CASE(op)            case op:
+#define VM_NEXT()              break
+#endif
+
+/*
+  Quickened opcode, whose guard failed, is rewritten back and generic one
+  is executed instead. It isn't fetched again, so trace has one step for it.
+*/
+#define VM_DEOPT(op)                                    \
+    do {                                                \
+        *(ip - 1) = (op);                               \
+        instruction = (op);                             \
+        vm->deopts++;                                   \
+        goto dispatch;                                  \
+    } while (0)
+
+/* operands stay on stack until guard passes, so generic opcode finds them after deoptimization. */
+#define VM_CASE_INT_BINARY(quick, generic, op) VM_CASE_INT_GUARDED(quick, generic, op, 1)
+/* guard of DIV and MOD fails on zero divisor too, so generic opcode reports it. */
+#define VM_CASE_INT_DIVISION(quick, generic, op) VM_CASE_INT_GUARDED(quick, generic, op, VALUE_GET_INT(val1) != 0)
+#define VM_CASE_INT_GUARDED(quick, generic, op, guard)                  \
+    VM_CASE(quick) {                                                    \
+        struct VALUE val1 = *(sp - 1);                                  \
+        struct VALUE val2 = *(sp - 2);                                  \
+        if (!VALUE_BOTH_INT(val1, val2) || !(guard)) {                  \
+            VM_DEOPT(generic);                                          \
+        }                                                               \
+        VM_DROP();                                                      \
+        *(sp - 1) = create_value_from_int(VALUE_GET_INT(val2) op VALUE_GET_INT(val1)); \
+        VM_NEXT();                                                      \
+    }
+
+static long long VM_LOOP_NAME(virtual_machine_type_t vm)
+{
+#if VIRTUAL_MACHINE_THREADED_DISPATCH
+    /* must be in the same order as enum BC_OP_CODES. */
+    static const void*labels[] = {
+        &&label_BC_OP_POP,
+        &&label_BC_OP_CONSTANT,
+        &&label_BC_OP_CREATE_LOCAL,
+        &&label_BC_OP_GET_LOCAL,
+        &&label_BC_OP_SET_LOCAL,
+        &&label_BC_OP_CREATE_OBJ,
+        &&label_BC_OP_INIT_OBJ_PROP,
+        &&label_BC_OP_CREATE_ARR,
+        &&label_BC_OP_GET_HEAP,
+        &&label_BC_OP_SET_HEAP,
+        &&label_BC_OP_APPEND,
+        &&label_BC_OP_DELETE,
+        &&label_BC_OP_LOGICAL_OR,
+        &&label_BC_OP_LOGICAL_AND,
+        &&label_BC_OP_EQ_EQEQ,
+        &&label_BC_OP_EQ_NEQ,
+        &&label_BC_OP_REL_LT,
+        &&label_BC_OP_REL_GT,
+        &&label_BC_OP_REL_LE,
+        &&label_BC_OP_REL_GE,
+        &&label_BC_OP_ADDITIVE_PLUS,
+        &&label_BC_OP_ADDITIVE_MINUS,
+        &&label_BC_OP_MULTIPLICATIVE_MUL,
+        &&label_BC_OP_MULTIPLICATIVE_DIV,
+        &&label_BC_OP_MULTIPLICATIVE_MOD,
+        &&label_BC_OP_NEGATE,
+        &&label_BC_OP_HAS_PROPERTY,
+        &&label_BC_OP_LEN,
+        &&label_BC_OP_JUMP_IF_FALSE,
+        &&label_BC_OP_JUMP,
+        &&label_BC_OP_JUMP_IF_FALSE_WIDE,
+        &&label_BC_OP_JUMP_WIDE,
+        &&label_BC_OP_CALL,
+        &&label_BC_OP_RETURN,
+        &&label_BC_OP_LT_LOCAL_CONST_JUMP,
+        &&label_BC_OP_GT_LOCAL_CONST_JUMP,
+        &&label_BC_OP_LE_LOCAL_CONST_JUMP,
+        &&label_BC_OP_GE_LOCAL_CONST_JUMP,
+        &&label_BC_OP_EQ_LOCAL_CONST_JUMP,
+        &&label_BC_OP_NEQ_LOCAL_CONST_JUMP,
+        &&label_BC_OP_INC_LOCAL,
+        &&label_BC_OP_LOGICAL_OR_INT,
+        &&label_BC_OP_LOGICAL_AND_INT,
+        &&label_BC_OP_EQ_EQEQ_INT,
+        &&label_BC_OP_EQ_NEQ_INT,
+        &&label_BC_OP_REL_LT_INT,
+        &&label_BC_OP_REL_GT_INT,
+        &&label_BC_OP_REL_LE_INT,
+        &&label_BC_OP_REL_GE_INT,
+        &&label_BC_OP_ADDITIVE_PLUS_INT,
+        &&label_BC_OP_ADDITIVE_MINUS_INT,
+        &&label_BC_OP_MULTIPLICATIVE_MUL_INT,
+        &&label_BC_OP_MULTIPLICATIVE_DIV_INT,
+        &&label_BC_OP_MULTIPLICATIVE_MOD_INT,
+        &&label_BC_OP_NEGATE_INT,
+    };
+#endif
+
+    uint8_t*ip = vm->ip;
+    struct VALUE*sp = vm->stack_top;
+    struct VALUE*bp = vm->bp;
+    struct VALUE*const stack_end = vm->stack + vm->stack_cap;
+    size_t instruction;
+#if VM_LOOP_TRACE
+    struct VALUE*const stack = vm->stack;
+    const uint8_t*const op_codes = vm->bc->op_codes;
+    uint64_t*trace_pos = vm->tracer.pos;
+    uint64_t*trace_end = vm->tracer.end;
+    int trace_allocated = 0; /* previous instruction might allocate, so heap usage might change. */
+#endif
+
+    while (1) {
+        instruction = VM_FETCH();
+        VM_TRACE_STEP();
+
+    dispatch:
+        VM_SWITCH(instruction) {
+        /* not generated yet. */
+        VM_CASE(BC_OP_CREATE_LOCAL)
+        VM_CASE(BC_OP_APPEND)
+        VM_CASE(BC_OP_DELETE) {
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_POP) {
+            VM_DROP();
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_CONSTANT) {
+            struct CONSTANT cnst = vm->bc->constant_pool[VM_FETCH_ULEB128()];
+            struct VALUE val = create_value_from_int(cnst.int_cnst);
+            VM_PUSH(val);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_SET_LOCAL) {
+            size_t idx = VM_FETCH_ULEB128();
+            bp[idx] = *(sp - 1);
+            if (idx != (size_t) (sp - bp - 1)) {
+                VM_DROP();
+            }
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_GET_LOCAL) {
+            size_t idx = VM_FETCH_ULEB128();
+            VM_PUSH(bp[idx]);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_CREATE_OBJ) {
+            struct OBJECT*obj;
+            VM_SAVE();
+            obj = create_obj(vm);
+            VM_LOAD();
+            struct VALUE val = create_value_from_obj(obj);
+            VM_PUSH(val);
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_INIT_OBJ_PROP) {
+            struct VALUE val = create_value_from_int(VM_FETCH_ULEB128());
+            VM_PUSH(val);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_CREATE_ARR) {
+            struct ARRAY*arr;
+            VM_SAVE();
+            arr = create_arr(vm);
+            VM_LOAD();
+            struct VALUE val = create_value_from_arr(arr);
+            VM_PUSH(val);
+            VM_NEXT();
+        }
+            
+        VM_CASE(BC_OP_SET_HEAP) {
+            size_t i, k;
+            size_t idx = VM_FETCH_ULEB128();
+            size_t len = VM_FETCH_ULEB128();
+            size_t pops = 0;
+            struct VALUE val = bp[idx];
+            for (i = 0; i < len; i++) {
+                enum BC_HEAP_OP hop = VM_FETCH();
+                if (hop == BC_ARRAY_INDEX) {
+                    size_t offset = VM_FETCH_ULEB128();
+                    struct VALUE*element = heap_element(val, *(sp - offset - 1));
+                    pops++;
+                    if (i < len - 1) {
+                        val = heap_read(vm, element);
+                    } else {
+                        for (k = 0; k < pops; k++) {
+                            VM_DROP();
+                        }
+
+                        heap_write_element(vm, val, element, VM_POP());
+                    }
+                } else if (hop == BC_OBJECT_FIELD) {
+                    size_t key = VM_FETCH_ULEB128();
+                    struct INLINE_CACHE*ic = vm->inline_caches + VM_FETCH_ULEB128();
+                    struct SHAPE*transition;
+                    int slot = heap_field(val, key, ic, &transition);
+                    if (i < len - 1) {
+                        if (transition != NULL) {
+                            printf("need to create to many fields\n");
+                            exit(1);
+                        }
+                        val = heap_read(vm, &(VALUE_GET_OBJ(val)->properties[slot]));
+                    } else {
+                        for (k = 0; k < pops; k++) {
+                            VM_DROP();
+                        }
+
+                        /* GC scans stack up to vm->stack_top. */
+                        VM_SAVE();
+                        heap_write_field(vm, val, slot, transition, sp - 1);
+                        VM_DROP();
+                    }
+                }
+            }
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_GET_HEAP) {
+            size_t i;
+            size_t idx = VM_FETCH_ULEB128();
+            size_t len = VM_FETCH_ULEB128();
+            size_t pops = 0;
+            struct VALUE val = bp[idx];
+            for (i = 0; i < len; i++) {
+                enum BC_HEAP_OP hop = VM_FETCH();
+                if (hop == BC_ARRAY_INDEX) {
+                    size_t offset = VM_FETCH_ULEB128();
+                    val = heap_read(vm, heap_element(val, *(sp - offset - 1)));
+                    pops++;
+                } else if (hop == BC_OBJECT_FIELD) {
+                    size_t key = VM_FETCH_ULEB128();
+                    struct INLINE_CACHE*ic = vm->inline_caches + VM_FETCH_ULEB128();
+                    int slot = heap_field(val, key, ic, NULL);
+                    val = heap_read(vm, &(VALUE_GET_OBJ(val)->properties[slot]));
+                }
+            }
+
+            for (i = 0; i < pops; i++) {
+                VM_DROP();
+            }
+            
+            VM_PUSH(val);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_LOGICAL_OR) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res = create_value_from_int(VALUE_GET_INT(val2) || VALUE_GET_INT(val1));
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for OR!\n");
+                exit(1);
+            }
+            VM_QUICKEN(BC_OP_LOGICAL_OR);
+            VM_PUSH(res);                        
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_LOGICAL_AND) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res = create_value_from_int(VALUE_GET_INT(val2) && VALUE_GET_INT(val1));
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for AND!\n");
+                exit(1);
+            }
+            VM_QUICKEN(BC_OP_LOGICAL_AND);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_EQ_EQEQ) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res = create_value_from_int(VALUE_GET_INT(val2) == VALUE_GET_INT(val1));
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for EQEQ!\n");
+                exit(1);
+            }
+            VM_QUICKEN(BC_OP_EQ_EQEQ);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_EQ_NEQ) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res = create_value_from_int(VALUE_GET_INT(val2) != VALUE_GET_INT(val1));
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for NEQ!\n");
+                exit(1);
+            }
+            VM_QUICKEN(BC_OP_EQ_NEQ);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_REL_LT) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res = create_value_from_int(VALUE_GET_INT(val2) < VALUE_GET_INT(val1));
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for LT!\n");
+                exit(1);
+            }
+            VM_QUICKEN(BC_OP_REL_LT);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_REL_GT) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res = create_value_from_int(VALUE_GET_INT(val2) > VALUE_GET_INT(val1));
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for GT!\n");
+                exit(1);
+            }
+            VM_QUICKEN(BC_OP_REL_GT);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_REL_LE) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res = create_value_from_int(VALUE_GET_INT(val2) <= VALUE_GET_INT(val1));
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for LE!\n");
+                exit(1);
+            }
+            VM_QUICKEN(BC_OP_REL_LE);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_REL_GE) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res = create_value_from_int(VALUE_GET_INT(val2) >= VALUE_GET_INT(val1));
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for GE!\n");
+                exit(1);
+            }
+            VM_QUICKEN(BC_OP_REL_GE);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_ADDITIVE_PLUS) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res = create_value_from_int(VALUE_GET_INT(val2) + VALUE_GET_INT(val1));
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for PLUS!\n");
+                exit(1);
+            }            
+            VM_QUICKEN(BC_OP_ADDITIVE_PLUS);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_ADDITIVE_MINUS) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res = create_value_from_int(VALUE_GET_INT(val2) - VALUE_GET_INT(val1));
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for MINUS!\n");
+                exit(1);
+            }            
+            VM_QUICKEN(BC_OP_ADDITIVE_MINUS);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_MULTIPLICATIVE_MUL) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res = create_value_from_int(VALUE_GET_INT(val2) * VALUE_GET_INT(val1));
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for MUL!\n");
+                exit(1);
+            }
+            VM_QUICKEN(BC_OP_MULTIPLICATIVE_MUL);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_MULTIPLICATIVE_DIV) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res;
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for DIV!\n");
+                exit(1);
+            }
+            check_divisor(val1);
+            res = create_value_from_int(VALUE_GET_INT(val2) / VALUE_GET_INT(val1));
+            VM_QUICKEN(BC_OP_MULTIPLICATIVE_DIV);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_MULTIPLICATIVE_MOD) {
+            struct VALUE val1 = VM_POP();
+            struct VALUE val2 = VM_POP();
+            struct VALUE res;
+            if ((VALUE_GET_TYPE(val1) != VALUE_TYPE_INTEGER) || (VALUE_GET_TYPE(val2) != VALUE_TYPE_INTEGER)) {
+                printf("invalid value for MOD!\n");
+                exit(1);
+            }
+            check_divisor(val1);
+            res = create_value_from_int(VALUE_GET_INT(val2) % VALUE_GET_INT(val1));
+            VM_QUICKEN(BC_OP_MULTIPLICATIVE_MOD);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_NEGATE) {
+            struct VALUE val = VM_POP();
+            struct VALUE res = create_value_from_int(-VALUE_GET_INT(val));
+            if (VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) {
+                printf("invalid value for NEGATE!\n");
+                exit(1);
+            }            
+            VM_QUICKEN(BC_OP_NEGATE);
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_HAS_PROPERTY) {
+            struct VALUE val = VM_POP();
+            size_t key = VM_FETCH_ULEB128();
+            struct VALUE res;
+            if (VALUE_GET_TYPE(val) == VALUE_TYPE_OBJ) {
+                res = create_value_from_int(shape_lookup(VALUE_GET_OBJ(val)->shape, key) != -1);
+            } else {
+                res = create_value_from_int(-1);
+            }
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_LEN) {
+            struct VALUE val = VM_POP();
+            struct VALUE res;
+            if (VALUE_GET_TYPE(val) == VALUE_TYPE_ARR) {
+                res = create_value_from_int(VALUE_GET_ARR(val)->len);
+            } else {
+                res = create_value_from_int(-1);
+            }
+            VM_PUSH(res);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_JUMP_IF_FALSE) {
+            int offset = VM_FETCH_I8();
+            struct VALUE val = *(sp - 1);
+            if (!VALUE_GET_INT(val)) {
+                ip += offset;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_JUMP) {
+            int offset = VM_FETCH_I8();
+            ip += offset;
+            VM_JIT_BACK_EDGE(offset);
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_JUMP_IF_FALSE_WIDE) {
+            int offset = VM_FETCH_I32();
+            struct VALUE val = *(sp - 1);
+            if (!VALUE_GET_INT(val)) {
+                ip += offset;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_JUMP_WIDE) {
+            int offset = VM_FETCH_I32();
+            ip += offset;
+            VM_JIT_BACK_EDGE(offset);
+            VM_NEXT();
+        }
+
+        VM_CASE(BC_OP_CALL) {
+            const struct FUNCTION_REF*f = vm->functions + VM_FETCH_ULEB128();
+            struct FRAME*frame;
+            if ((vm->frames_len == vm->frames_cap) ||
+                ((size_t) (sp - vm->stack) + VIRTUAL_MACHINE_CALL_STACK_RESERVE > vm->stack_cap)) {
+                printf("stack overflow\n");
+                exit(1);
+            }
+            frame = vm->frames + vm->frames_len++;
+            frame->ip = ip;
+            frame->bp = bp;
+            /* arguments are already on stack. */
+            bp = sp - f->args_num;
+            ip = f->start;
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_RETURN) {
+            struct VALUE val = VM_POP();
+            const struct FRAME*frame;
+            if (vm->frames_len == 0) {
+                VM_TRACE_FINISH();
+                return VALUE_GET_INT(val);
+            }
+            frame = vm->frames + --vm->frames_len;
+            sp = bp;
+            VM_PUSH(val);
+            ip = frame->ip;
+            bp = frame->bp;
+            VM_NEXT();
+        }
+
+        /* superinstructions. */
+        VM_CASE(BC_OP_LT_LOCAL_CONST_JUMP) {
+            struct VALUE val = bp[VM_FETCH_ULEB128()];
+            long long cnst = vm->bc->constant_pool[VM_FETCH_ULEB128()].int_cnst;
+            int offset = VM_FETCH_I32();
+            if (VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) {
+                printf("invalid value for LT!\n");
+                exit(1);
+            }
+            if (!(VALUE_GET_INT(val) < cnst)) {
+                ip += offset;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_GT_LOCAL_CONST_JUMP) {
+            struct VALUE val = bp[VM_FETCH_ULEB128()];
+            long long cnst = vm->bc->constant_pool[VM_FETCH_ULEB128()].int_cnst;
+            int offset = VM_FETCH_I32();
+            if (VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) {
+                printf("invalid value for GT!\n");
+                exit(1);
+            }
+            if (!(VALUE_GET_INT(val) > cnst)) {
+                ip += offset;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_LE_LOCAL_CONST_JUMP) {
+            struct VALUE val = bp[VM_FETCH_ULEB128()];
+            long long cnst = vm->bc->constant_pool[VM_FETCH_ULEB128()].int_cnst;
+            int offset = VM_FETCH_I32();
+            if (VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) {
+                printf("invalid value for LE!\n");
+                exit(1);
+            }
+            if (!(VALUE_GET_INT(val) <= cnst)) {
+                ip += offset;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_GE_LOCAL_CONST_JUMP) {
+            struct VALUE val = bp[VM_FETCH_ULEB128()];
+            long long cnst = vm->bc->constant_pool[VM_FETCH_ULEB128()].int_cnst;
+            int offset = VM_FETCH_I32();
+            if (VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) {
+                printf("invalid value for GE!\n");
+                exit(1);
+            }
+            if (!(VALUE_GET_INT(val) >= cnst)) {
+                ip += offset;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_EQ_LOCAL_CONST_JUMP) {
+            struct VALUE val = bp[VM_FETCH_ULEB128()];
+            long long cnst = vm->bc->constant_pool[VM_FETCH_ULEB128()].int_cnst;
+            int offset = VM_FETCH_I32();
+            if (VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) {
+                printf("invalid value for EQEQ!\n");
+                exit(1);
+            }
+            if (!(VALUE_GET_INT(val) == cnst)) {
+                ip += offset;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_NEQ_LOCAL_CONST_JUMP) {
+            struct VALUE val = bp[VM_FETCH_ULEB128()];
+            long long cnst = vm->bc->constant_pool[VM_FETCH_ULEB128()].int_cnst;
+            int offset = VM_FETCH_I32();
+            if (VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) {
+                printf("invalid value for NEQ!\n");
+                exit(1);
+            }
+            if (!(VALUE_GET_INT(val) != cnst)) {
+                ip += offset;
+            }
+            VM_NEXT();
+        }
+        VM_CASE(BC_OP_INC_LOCAL) {
+            struct VALUE*local = bp + VM_FETCH_ULEB128();
+            long long cnst = vm->bc->constant_pool[VM_FETCH_ULEB128()].int_cnst;
+            if (VALUE_GET_TYPE(*local) != VALUE_TYPE_INTEGER) {
+                printf("invalid value for PLUS!\n");
+                exit(1);
+            }
+            *local = create_value_from_int(VALUE_GET_INT(*local) + cnst);
+            VM_NEXT();
+        }
+
+        /* quickened opcodes. */
+        VM_CASE_INT_BINARY(BC_OP_LOGICAL_OR_INT,         BC_OP_LOGICAL_OR,         ||)
+        VM_CASE_INT_BINARY(BC_OP_LOGICAL_AND_INT,        BC_OP_LOGICAL_AND,        &&)
+        VM_CASE_INT_BINARY(BC_OP_EQ_EQEQ_INT,            BC_OP_EQ_EQEQ,            ==)
+        VM_CASE_INT_BINARY(BC_OP_EQ_NEQ_INT,             BC_OP_EQ_NEQ,             !=)
+        VM_CASE_INT_BINARY(BC_OP_REL_LT_INT,             BC_OP_REL_LT,             <)
+        VM_CASE_INT_BINARY(BC_OP_REL_GT_INT,             BC_OP_REL_GT,             >)
+        VM_CASE_INT_BINARY(BC_OP_REL_LE_INT,             BC_OP_REL_LE,             <=)
+        VM_CASE_INT_BINARY(BC_OP_REL_GE_INT,             BC_OP_REL_GE,             >=)
+        VM_CASE_INT_BINARY(BC_OP_ADDITIVE_PLUS_INT,      BC_OP_ADDITIVE_PLUS,      +)
+        VM_CASE_INT_BINARY(BC_OP_ADDITIVE_MINUS_INT,     BC_OP_ADDITIVE_MINUS,     -)
+        VM_CASE_INT_BINARY(BC_OP_MULTIPLICATIVE_MUL_INT, BC_OP_MULTIPLICATIVE_MUL, *)
+        VM_CASE_INT_DIVISION(BC_OP_MULTIPLICATIVE_DIV_INT, BC_OP_MULTIPLICATIVE_DIV, /)
+        VM_CASE_INT_DIVISION(BC_OP_MULTIPLICATIVE_MOD_INT, BC_OP_MULTIPLICATIVE_MOD, %)
+        VM_CASE(BC_OP_NEGATE_INT) {
+            struct VALUE val = *(sp - 1);
+            if (VALUE_GET_TYPE(val) != VALUE_TYPE_INTEGER) {
+                VM_DEOPT(BC_OP_NEGATE);
+            }
+            *(sp - 1) = create_value_from_int(-VALUE_GET_INT(val));
+            VM_NEXT();
+        }
+        }
+    }
+}
+
+#undef VM_FETCH
+#undef VM_FETCH_ULEB128
+#undef VM_FETCH_I8
+#undef VM_FETCH_I32
+#undef VM_PUSH
+#undef VM_POP
+#undef VM_DROP
+#undef VM_SAVE
+#undef VM_LOAD
+#undef VM_TRACE_SYNC
+#undef VM_TRACE_STEP
+#undef VM_TRACE_FINISH
+#undef VM_SWITCH
+#undef VM_CASE
+#undef VM_NEXT
+#undef VM_QUICKEN
+#undef VM_DEOPT
+#undef VM_CASE_INT_BINARY
+#undef VM_CASE_INT_DIVISION
+#undef VM_CASE_INT_GUARDED
+#undef VM_JIT_BACK_EDGE
@@ -3,55 +3,70 @@
 #include "data-types.h"
 
 #include "garbage-collector.h"
+#include "stats.h"
 
-#include "utils.h"
+#include "register-generator.h"
 
-static struct VALUE create_value_from_int(long long int_val)
-{
-    struct VALUE val;
-    val.type = VALUE_TYPE_INTEGER;
-    val.int_val = int_val;
-    return val;
-}
+#include "jit.h"
+#include "shape.h"
+#include "trace.h"
 
-/*
-static struct VALUE create_value_from_double(double double_val)
-{
-    struct VALUE val;
-    val.type = VALUE_TYPE_DOUBLE;
-    val.double_val = double_val;
-    return val;    
-}
-*/
+#include "utils.h"
 
-static struct VALUE create_value_from_obj(struct OBJECT*obj_val)
+/* FUNCTIONREF constant, resolved when bytecode is loaded. */
+struct FUNCTION_REF
 {
-    struct VALUE val;
-    val.obj_val = obj_val;
-    val.type = VALUE_TYPE_OBJ;
-    return val;
-}
+    uint8_t*start;
+    size_t args_num;
+    size_t regs_num; /* register bytecode only. */
+};
 
-static struct VALUE create_value_from_arr(struct ARRAY*arr_val)
+/* caller's state, saved by CALL and restored by RETURN. */
+struct FRAME
 {
-    struct VALUE val;
-    val.arr_val = arr_val;
-    val.type = VALUE_TYPE_ARR;
-    return val;
-}
+    uint8_t*ip;
+    struct VALUE*bp;
+
+    /* register bytecode only. */
+    struct VALUE*top;
+    size_t ret; /* register of caller for result. */
+};
 
 struct VIRTUAL_MACHINE
 {
     bytecode_type_t bc;
-    size_t*ip;
+    uint8_t*ip;
     
     struct VALUE*stack;
     struct VALUE*stack_top;
     size_t stack_cap;
 
+    struct VALUE*bp; /* locals of current function start here. */
+
+    struct FUNCTION_REF*functions; /* indexed by constant. */
+
+    struct FRAME*frames;
+    size_t frames_len;
+    size_t frames_cap;
+
     garbage_collector_type_t gc;
 
-    int trace;
+    struct SHAPE*shapes;
+    struct INLINE_CACHE*inline_caches;
+
+    FILE*trace; /* file for binary trace (NULL - no trace). */
+    struct TRACE_WRITER tracer;
+
+    int quickening; /* generic arithmetic is rewritten to integer one after first execution. */
+    unsigned long long quickened;
+    unsigned long long deopts;
+
+#if VIRTUAL_MACHINE_JIT
+    size_t jit_hotness;
+    enum VIRTUAL_MACHINE_JIT_MODE jit_mode;
+    struct JIT_LOOP*jit_loops; /* indexed by offset of instruction after back-edge; NULL - no JIT. */
+    struct JIT jit;
+#endif
 };
 
 virtual_machine_type_t create_virtual_machine()
@@ -61,25 +76,94 @@ virtual_machine_type_t create_virtual_machine()
     return vm;
 }
 
-void virtual_machine_conf(virtual_machine_type_t vm, bytecode_type_t bc, size_t stack_size, size_t start_heap_size_b, int trace)
+void virtual_machine_conf(virtual_machine_type_t vm, bytecode_type_t bc, size_t stack_size,
+                          const struct GARBAGE_COLLECTOR_PARAMS*gc_params, FILE*trace, int quickening)
 {
+    size_t i;
+
     vm->bc = bc;
-    vm->ip = bc->op_codes;
+
+    if (bc->functions_len == 0) {
+        printf("no function to run\n");
+        exit(1);
+    }
+
+    SAFE_CALLOC(vm->functions, bc->constant_pool_len);
+    for (i = 0; i < bc->constant_pool_len; i++) {
+        if (bc->constant_pool[i].type == CONSTANT_TYPE_FUNCTIONREF) {
+            size_t j;
+            for (j = 0; j < bc->functions_len; j++) {
+                if (strcmp(bc->functions[j].name, bc->constant_pool[i].str_cnst) == 0) {
+                    vm->functions[i].start = bc->op_codes + bc->functions[j].start;
+                    vm->functions[i].args_num = bc->functions[j].args_num;
+                    vm->functions[i].regs_num = bc->functions[j].regs_num;
+                    break;
+                }
+            }
+            if (j == bc->functions_len) {
+                printf("unknown function: %s\n", bc->constant_pool[i].str_cnst);
+                exit(1);
+            }
+        }
+    }
     
     vm->stack_cap = stack_size;
     SAFE_MALLOC(vm->stack, vm->stack_cap);
     vm->stack_top = vm->stack;
 
+    /* recursion without arguments doesn't grow operand stack, so frames are limited too. */
+    vm->frames_cap = stack_size;
+    SAFE_MALLOC(vm->frames, vm->frames_cap);
+    vm->frames_len = 0;
+
+    /* entry point is the first function; its arguments are zeros. */
+    vm->ip = bc->op_codes + bc->functions[0].start;
+    vm->bp = vm->stack;
+    for (i = 0; i < bc->functions[0].args_num; i++) {
+        *(vm->stack_top++) = create_value_from_int(0);
+    }
+    /* all registers of entry point are in use, others are zeros. */
+    if (bc->kind == BYTECODE_REGISTER) {
+        if (bc->functions[0].regs_num > vm->stack_cap) {
+            printf("stack overflow\n");
+            exit(1);
+        }
+        while (vm->stack_top < vm->stack + bc->functions[0].regs_num) {
+            *(vm->stack_top++) = create_value_from_int(0);
+        }
+    }
+
+    /* text trace of GC would break binary trace, pauses are reported by GC stats instead. */
     vm->gc = create_garbage_collector();
-    garbage_collector_conf(vm->gc, start_heap_size_b, &(vm->stack), &(vm->stack_top), trace);
+    garbage_collector_conf(vm->gc, gc_params, &(vm->stack), &(vm->stack_top), 0);
+
+    vm->shapes = create_shape_root();
+    if (bc->inline_caches_num != 0) {
+        SAFE_CALLOC(vm->inline_caches, bc->inline_caches_num);
+    }
 
     vm->trace = trace;
+
+    vm->quickening = quickening;
 }
 
-static void virtual_machine_stack_push(virtual_machine_type_t vm, struct VALUE val)
+void virtual_machine_conf_jit(virtual_machine_type_t vm, size_t hotness, enum VIRTUAL_MACHINE_JIT_MODE mode)
 {
-    *vm->stack_top = val;
-    vm->stack_top++;
+#if VIRTUAL_MACHINE_JIT
+    vm->jit_hotness = hotness;
+    vm->jit_mode = mode;
+    /* register bytecode is only interpreted. */
+    if ((hotness != 0) && (vm->bc->kind == BYTECODE_STACK)) {
+        SAFE_CALLOC(vm->jit_loops, vm->bc->op_codes_len + 1);
+    }
+#else
+    if (hotness != 0) {
+        printf("VM is built without JIT\n");
+        exit(1);
+    }
+    PREFIX_UNUSED(vm);
+    PREFIX_UNUSED(mode);
+#endif
 }
 
 static struct VALUE virtual_machine_stack_pop(virtual_machine_type_t vm)
@@ -88,26 +172,32 @@ static struct VALUE virtual_machine_stack_pop(virtual_machine_type_t vm)
     return *vm->stack_top;
 }
 
-#define READ_BYTE() (*(vm->ip++))
+#define READ_ULEB128() bytecode_read_uleb128(&(vm->ip))
 
 struct OBJECT*create_obj(virtual_machine_type_t vm)
 {
     size_t i;
 
-    size_t properties_num = READ_BYTE();
-    
-    struct OBJECT*obj = garbage_collector_malloc_obj(vm->gc, properties_num);
-    
+    size_t properties_num = READ_ULEB128();
+    struct SHAPE*shape = vm->shapes;
+    struct OBJECT*obj;
+
+    /* same literals walk same transitions, so they share shape. */
     for (i = 0; i < properties_num; i++) {
-        struct VALUE key = virtual_machine_stack_pop(vm);
-        struct VALUE val = virtual_machine_stack_pop(vm);
-        
-        obj->properties[i].key = key.int_val;
-        obj->properties[i].val = val;
+        size_t key = VALUE_GET_INT(*(vm->stack_top - 1 - 2 * i));
+        if (shape_lookup(shape, key) == -1) {
+            shape = shape_add_property(shape, key);
+        }
     }
-    
-    obj->properties_len = properties_num;
-    obj->properties_cap = properties_num * 2;
+
+    obj = garbage_collector_malloc_obj(vm->gc, shape);
+
+    /* in reverse order, so first popped value wins, as before. */
+    for (i = properties_num; i > 0; i--) {
+        size_t key = VALUE_GET_INT(*(vm->stack_top - 1 - 2 * (i - 1)));
+        obj->properties[shape_lookup(shape, key)] = *(vm->stack_top - 2 - 2 * (i - 1));
+    }
+    vm->stack_top -= 2 * properties_num;
 
     return obj;
 }
@@ -116,7 +206,7 @@ struct ARRAY*create_arr(virtual_machine_type_t vm)
 {
     size_t i;
 
-    size_t arr_len = READ_BYTE();
+    size_t arr_len = READ_ULEB128();
 
     struct ARRAY*arr = garbage_collector_malloc_arr(vm->gc, arr_len);
 
@@ -129,434 +219,317 @@ struct ARRAY*create_arr(virtual_machine_type_t vm)
     return arr;
 }
 
-long long virtual_machine_run(virtual_machine_type_t vm)
+/* CREATE_OBJ of register bytecode: values of properties are in registers from first. */
+static struct OBJECT*create_obj_from_registers(virtual_machine_type_t vm, const struct VALUE*first)
 {
-    if (vm->trace) {
-        printf("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
-        printf("<trace>\n");
-    }
-    
-    while (1) {   
-        size_t instruction = READ_BYTE();
+    size_t i;
 
-        if (vm->trace) {
-            printf("\t<step>OP: %zu; SS: %ld b; HS: %zu b; FB: %zu; BB: %zu</step>\n",
-                   instruction, vm->stack_top - vm->stack, vm->gc->a.sizemem,
-                   vm->gc->a.free_list.count, vm->gc->a.busy_list.count);
-        }
-        
-        switch (instruction) {
-        case BC_OP_POP: {
-            virtual_machine_stack_pop(vm);
-            break;
-        }
+    size_t properties_num = READ_ULEB128();
+    uint8_t*keys = vm->ip;
+    struct SHAPE*shape = vm->shapes;
+    struct OBJECT*obj;
 
-        case BC_OP_CONSTANT: {
-            struct CONSTANT cnst = vm->bc->constant_pool[READ_BYTE()];
-            struct VALUE val = create_value_from_int(cnst.int_cnst);
-            virtual_machine_stack_push(vm, val);
-            break;
+    for (i = 0; i < properties_num; i++) {
+        size_t key = READ_ULEB128();
+        if (shape_lookup(shape, key) == -1) {
+            shape = shape_add_property(shape, key);
         }
+    }
 
-        case BC_OP_SET_LOCAL: {
-            size_t idx = READ_BYTE();
-            vm->stack[idx] = *(vm->stack_top - 1);
-            if (idx != (size_t) (vm->stack_top - vm->stack - 1)) {
-                virtual_machine_stack_pop(vm);
-            }
-            break;
-        }
-        case BC_OP_GET_LOCAL: {
-            size_t idx = READ_BYTE();
-            virtual_machine_stack_push(vm, vm->stack[idx]);
-            break;
-        }
+    obj = garbage_collector_malloc_obj(vm->gc, shape);
 
-        case BC_OP_CREATE_OBJ: {
-            struct OBJECT*obj = create_obj(vm);
-            struct VALUE val = create_value_from_obj(obj);
-            virtual_machine_stack_push(vm, val);
-            break;
-        }
-        case BC_OP_INIT_OBJ_PROP: {
-            struct VALUE val = create_value_from_int(READ_BYTE());
-            virtual_machine_stack_push(vm, val);
-            break;
-        }
+    /* registers are read after GC; the last duplicated key wins, as in literal. */
+    vm->ip = keys;
+    for (i = 0; i < properties_num; i++) {
+        size_t key = READ_ULEB128();
+        obj->properties[shape_lookup(shape, key)] = first[i];
+    }
 
-        case BC_OP_CREATE_ARR: {
-            struct ARRAY*arr = create_arr(vm);
-            struct VALUE val = create_value_from_arr(arr);
-            virtual_machine_stack_push(vm, val);
-            break;            
-        }
-            
-        case BC_OP_SET_HEAP: {
-            size_t i, j, k;
-            size_t idx = READ_BYTE();
-            size_t len = READ_BYTE();
-            size_t pops = 0;
-            struct VALUE val = vm->stack[idx];
-            for (i = 0; i < len; i++) {
-                enum BC_HEAP_OP hop = READ_BYTE();
-                if (hop == BC_ARRAY_INDEX) {
-                    size_t offset = READ_BYTE();
-                    struct VALUE index = *(vm->stack_top - offset - 1);
-                    if (val.type != VALUE_TYPE_ARR) {
-                        printf("attempt to index non-array value\n");
-                        exit(1);
-                    }
-                    if (index.type != VALUE_TYPE_INTEGER) {
-                        printf("attempt to use non-integer value as array index\n");
-                        exit(1);
-                    }
-                    if (index.int_val < 0) {
-                        printf("invalid array index: %lld\n", index.int_val);
-                        exit(1);
-                    }
-                    if ((size_t) index.int_val > val.arr_val->len) {
-                        printf("array index to unitialized data: %lld\n", index.int_val);
-                        exit(1);
-                    }
-                    pops++;
-                    if (i < len - 1) {
-                        val = val.arr_val->values[index.int_val];
-                    } else if (i == len - 1) {
-                        for (k = 0; k < pops; k++) {
-                            virtual_machine_stack_pop(vm);
-                        }
-
-                        val.arr_val->values[index.int_val] = virtual_machine_stack_pop(vm);
-                    }
-                } else if (hop == BC_OBJECT_FIELD) {
-                    size_t key = READ_BYTE();
-                    int found = 0;
-                    if (val.type != VALUE_TYPE_OBJ) {
-                        printf("attempt to query field of non-object value\n");
-                        exit(1);
-                    }                    
-                    for (j = 0; j < val.obj_val->properties_len; j++) {
-                        if (val.obj_val->properties[j].key == key) {
-                            if (i < len - 1) {
-                                val = val.obj_val->properties[j].val;
-                                found = 1;
-                                break;
-                            } else if (i == len - 1) {
-                                for (k = 0; k < pops; k++) {
-                                    virtual_machine_stack_pop(vm);
-                                }
-                                
-                                val.obj_val->properties[j].val = virtual_machine_stack_pop(vm);
-                                found = 1;
-                                break;                            
-                            }
-                        }
-                    }
-                    if (!found) {
-                        for (k = 0; k < pops; k++) {
-                            virtual_machine_stack_pop(vm);
-                        }
-                        
-                        if (i < len - 1) {
-                            printf("need to create to many fields\n");
-                            exit(1);
-                        } else {
-                            if (val.obj_val->properties_len == val.obj_val->properties_cap) {
-                                val.obj_val = garbage_collector_realloc_obj(vm->gc, val.obj_val, val.obj_val->properties_len + 1);
-                                val.obj_val->properties_len++;
-                                val.obj_val->properties[j].key = key;
-                                val.obj_val->properties[j].val = virtual_machine_stack_pop(vm);
-                            } else {
-                                val.obj_val->properties_len++;
-                                val.obj_val->properties[j].key = key;
-                                val.obj_val->properties[j].val = virtual_machine_stack_pop(vm);
-                            }
-                        }
-                    }
-                }
-            }
-            break;
-        }
-        case BC_OP_GET_HEAP: {
-            size_t i, j;
-            size_t idx = READ_BYTE();
-            size_t len = READ_BYTE();
-            size_t pops = 0;
-            struct VALUE val = vm->stack[idx];
-            for (i = 0; i < len; i++) {
-                enum BC_HEAP_OP hop = READ_BYTE();
-                if (hop == BC_ARRAY_INDEX) {
-                    size_t offset = READ_BYTE();
-                    struct VALUE index = *(vm->stack_top - offset - 1);
-                    if (val.type != VALUE_TYPE_ARR) {
-                        printf("attempt to index non-array value\n");
-                        exit(1);
-                    }
-                    if (index.type != VALUE_TYPE_INTEGER) {
-                        printf("attempt to use non-integer value as array index\n");
-                        exit(1);
-                    }                    
-                    if (index.int_val < 0) {
-                        printf("invalid array index: %lld\n", index.int_val);
-                        exit(1);
-                    }
-                    if ((size_t) index.int_val > val.arr_val->len) {
-                        printf("array index to unitialized data: %lld\n", index.int_val);
-                        exit(1);
-                    }
-                    val = val.arr_val->values[index.int_val];
-                    pops++;
-                } else if (hop == BC_OBJECT_FIELD) {
-                    size_t key = READ_BYTE();
-                    int found = 0;
-                    if (val.type != VALUE_TYPE_OBJ) {
-                        printf("attempt to query field of non-object value\n");
-                        exit(1);
-                    }
-                    for (j = 0; j < val.obj_val->properties_len; j++) {
-                        if (val.obj_val->properties[j].key == key) {
-                            val = val.obj_val->properties[j].val;
-                            found = 1;
-                            break;
-                        }
-                    }
-                    if (!found) {
-                        printf("unknown fieldref: %zu\n", key);
-                        exit(1);
-                    }
-                }
-            }
+    return obj;
+}
 
-            for (i = 0; i < pops; i++) {
-                virtual_machine_stack_pop(vm);
-            }
-            
-            virtual_machine_stack_push(vm, val);
-            break;
-        }
+/* used bytes of all spaces, where blocks are allocated now, and of large object space. */
+static size_t heap_used_sizemem(const garbage_collector_type_t gc)
+{
+    if (gc->allocation == GARBAGE_COLLECTOR_ALLOCATION_FREE_LIST) {
+        return gc->a.busy_sizemem + gc->large_sizemem;
+    }
 
-        case BC_OP_LOGICAL_OR: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val || val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for OR!\n");
-                exit(1);
-            }
-            virtual_machine_stack_push(vm, res);                        
-            break;
-        }
-        case BC_OP_LOGICAL_AND: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val && val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for AND!\n");
-                exit(1);
-            }
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
+    return SEMISPACE_USED(&(gc->sa)) + (gc->cycle ? SEMISPACE_USED(&(gc->sb)) : 0) +
+        (gc->generational ? SEMISPACE_USED(&(gc->nursery)) : 0) + gc->large_sizemem;
+}
 
-        case BC_OP_EQ_EQEQ: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val == val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for EQEQ!\n");
-                exit(1);
-            }
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
-        case BC_OP_EQ_NEQ: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val != val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for NEQ!\n");
-                exit(1);
-            }
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
+/* instructions, which call garbage collector; heap usage isn't checked after others. */
+static int may_allocate(size_t instruction)
+{
+    return (instruction == BC_OP_CREATE_OBJ) || (instruction == BC_OP_CREATE_ARR) || (instruction == BC_OP_SET_HEAP);
+}
 
-        case BC_OP_REL_LT: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val < val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for LT!\n");
-                exit(1);
-            }
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
-        case BC_OP_REL_GT: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val > val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for GT!\n");
-                exit(1);
-            }
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
-        case BC_OP_REL_LE: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val <= val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for LE!\n");
-                exit(1);
-            }
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
-        case BC_OP_REL_GE: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val >= val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for GE!\n");
-                exit(1);
-            }
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
+/* heap record is written only when heap usage has changed since the previous one. */
+static void trace_heap(virtual_machine_type_t vm)
+{
+    size_t heap_used = heap_used_sizemem(vm->gc);
+    if (heap_used != vm->tracer.heap_used) {
+        vm->tracer.heap_used = heap_used;
+        TRACE_WRITE(&(vm->tracer), TRACE_HEAP_RECORD(heap_used));
+    }
+}
 
-        case BC_OP_ADDITIVE_PLUS: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val + val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for PLUS!\n");
-                exit(1);
-            }            
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
-        case BC_OP_ADDITIVE_MINUS: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val - val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for MINUS!\n");
-                exit(1);
-            }            
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
+/* DIV and MOD of both VMs; JIT exits to interpreter before zero divisor. */
+static void check_divisor(struct VALUE divisor)
+{
+    if (VALUE_GET_INT(divisor) == 0) {
+        printf("division by zero!\n");
+        exit(1);
+    }
+}
 
-        case BC_OP_MULTIPLICATIVE_MUL: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val * val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for MUL!\n");
-                exit(1);
-            }
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
-        case BC_OP_MULTIPLICATIVE_DIV: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val / val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for DIV!\n");
-                exit(1);
-            }
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
-        case BC_OP_MULTIPLICATIVE_MOD: {
-            struct VALUE val1 = virtual_machine_stack_pop(vm);
-            struct VALUE val2 = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(val2.int_val % val1.int_val);
-            if ((val1.type != VALUE_TYPE_INTEGER) || (val2.type != VALUE_TYPE_INTEGER)) {
-                printf("invalid value for MOD!\n");
+/*
+  Heap access of GET_HEAP/SET_HEAP in both loops: access path goes from local
+  (or register) through array elements and object fields to the last part,
+  which is read or written.
+*/
+
+/* element of array val; types and bounds are checked. */
+static struct VALUE*heap_element(struct VALUE val, struct VALUE index)
+{
+    if (VALUE_GET_TYPE(val) != VALUE_TYPE_ARR) {
+        printf("attempt to index non-array value\n");
+        exit(1);
+    }
+    if (VALUE_GET_TYPE(index) != VALUE_TYPE_INTEGER) {
+        printf("attempt to use non-integer value as array index\n");
+        exit(1);
+    }
+    if (VALUE_GET_INT(index) < 0) {
+        printf("invalid array index: %lld\n", VALUE_GET_INT(index));
+        exit(1);
+    }
+    if ((size_t) VALUE_GET_INT(index) >= VALUE_GET_ARR(val)->len) {
+        printf("array index to unitialized data: %lld\n", VALUE_GET_INT(index));
+        exit(1);
+    }
+
+    return &(VALUE_GET_ARR(val)->values[VALUE_GET_INT(index)]);
+}
+
+/*
+  Slot of field in object val, which is found by inline cache of access site.
+  Missing field is added (at the end of the store) only for stores, which pass
+  transition: shape after store is returned there, or NULL for existing field.
+*/
+static inline int heap_field(struct VALUE val, size_t key, struct INLINE_CACHE*ic, struct SHAPE**transition)
+{
+    const struct INLINE_CACHE_ENTRY*entry;
+    struct SHAPE*shape;
+    struct SHAPE*added = NULL;
+    int slot;
+
+    if (VALUE_GET_TYPE(val) != VALUE_TYPE_OBJ) {
+        printf("attempt to query field of non-object value\n");
+        exit(1);
+    }
+    shape = VALUE_GET_OBJ(val)->shape;
+    entry = inline_cache_lookup(ic, shape);
+    if (entry != NULL) {
+        slot = entry->slot;
+        added = entry->transition;
+    } else {
+        slot = shape_lookup(shape, key);
+        if (slot == -1) {
+            if (transition == NULL) {
+                printf("unknown fieldref: %zu\n", key);
                 exit(1);
             }
-            virtual_machine_stack_push(vm, res);
-            break;
+            /* new field always goes to the end of the store. */
+            slot = shape->len;
+            added = shape_add_property(shape, key);
         }
+        inline_cache_update(ic, shape, slot, added);
+    }
 
-        case BC_OP_NEGATE: {
-            struct VALUE val = virtual_machine_stack_pop(vm);
-            struct VALUE res = create_value_from_int(-val.int_val);
-            if (val.type != VALUE_TYPE_INTEGER) {
-                printf("invalid value for NEGATE!\n");
-                exit(1);
-            }            
-            virtual_machine_stack_push(vm, res);
-            break;
-        }
+    if (transition != NULL) {
+        *transition = added;
+    }
+    return slot;
+}
 
-        case BC_OP_HAS_PROPERTY: {
-            struct VALUE val = virtual_machine_stack_pop(vm);
-            size_t key = READ_BYTE();
-            struct VALUE res;
-            if (val.type == VALUE_TYPE_OBJ) {
-                size_t j;
-                int found = 0;
-                for (j = 0; j < val.obj_val->properties_len; j++) {
-                    if (val.obj_val->properties[j].key == key) {
-                        val = val.obj_val->properties[j].val;
-                        found = 1;
-                        break;
-                    }
-                }
+static struct VALUE heap_read(virtual_machine_type_t vm, struct VALUE*slot)
+{
+    GARBAGE_COLLECTOR_READ_BARRIER(vm->gc, slot);
+    return *slot;
+}
 
-                res = create_value_from_int(found);
-            } else {
-                res = create_value_from_int(-1);
-            }
-            virtual_machine_stack_push(vm, res);
-            break;
+static void heap_write_element(virtual_machine_type_t vm, struct VALUE arr, struct VALUE*element, struct VALUE src)
+{
+    *element = src;
+    GARBAGE_COLLECTOR_WRITE_BARRIER(vm->gc, VALUE_GET_ARR(arr), *element);
+}
+
+/* store may grow and run GC, so *src is read after it and vm->stack_top must cover it. */
+static void heap_write_field(virtual_machine_type_t vm, struct VALUE val, int slot, struct SHAPE*transition,
+                             const struct VALUE*src)
+{
+    struct OBJECT*obj = VALUE_GET_OBJ(val);
+
+    if (transition != NULL) {
+        if (obj->shape->len == obj->properties_cap) {
+            obj = garbage_collector_realloc_obj(vm->gc, obj, obj->shape->len + 1);
         }
-        case BC_OP_LEN: {
-            struct VALUE val = virtual_machine_stack_pop(vm);
-            struct VALUE res;
-            if (val.type == VALUE_TYPE_ARR) {
-                res = create_value_from_int(val.arr_val->len);
-            } else {
-                res = create_value_from_int(-1);
-            }
-            virtual_machine_stack_push(vm, res);
-            break;            
+        obj->shape = transition;
+    }
+    obj->properties[slot] = *src;
+    GARBAGE_COLLECTOR_WRITE_BARRIER(vm->gc, obj, obj->properties[slot]);
+}
+
+#if VIRTUAL_MACHINE_JIT
+/* back-edge of loop has become hot: template JIT compiles loop, tracing JIT records its next iteration. */
+static uint8_t*jit_hot_loop(virtual_machine_type_t vm, struct JIT_LOOP*loop, uint8_t*header, uint8_t*end,
+                            struct VALUE*bp, struct VALUE**sp)
+{
+    if (vm->jit_mode == VIRTUAL_MACHINE_JIT_TEMPLATE) {
+        loop->code = jit_compile_loop(&(vm->jit), vm->bc, header, end);
+        return header;
+    }
+    /* recorder reads heap without read barrier. */
+    if (vm->gc->cycle) {
+        loop->hotness = 0;
+        return header;
+    }
+    return jit_record_trace(&(vm->jit), loop, vm->bc, header, end, bp, sp);
+}
+#endif
+
+/* fast loop has no tracing at all. */
+#define VM_LOOP_NAME  run_fast
+#define VM_LOOP_TRACE 0
+#include "virtual-machine-loop.h"
+#undef VM_LOOP_NAME
+#undef VM_LOOP_TRACE
+
+#define VM_LOOP_NAME  run_traced
+#define VM_LOOP_TRACE 1
+#include "virtual-machine-loop.h"
+#undef VM_LOOP_NAME
+#undef VM_LOOP_TRACE
+
+#include "register-machine-loop.h"
+
+long long virtual_machine_run(virtual_machine_type_t vm)
+{
+    if (vm->bc->kind == BYTECODE_REGISTER) {
+        if (vm->trace != NULL) {
+            printf("trace of register bytecode isn't supported\n");
+            exit(1);
         }
+        return run_registers(vm);
+    }
+
+    if (vm->trace != NULL) {
+        long long r;
+
+        trace_writer_open(&(vm->tracer), vm->trace);
+        r = run_traced(vm);
+        trace_writer_close(&(vm->tracer));
 
-        case BC_OP_JUMP_IF_FALSE: {
-            int offset = (int) READ_BYTE();
-            struct VALUE val = *(vm->stack_top - 1);
-            if (!val.int_val) {
-                vm->ip += offset;
+        return r;
+    }
+
+    return run_fast(vm);
+}
+
+void dump_inline_caches_to_xml_file(FILE*f, const virtual_machine_type_t vm)
+{
+    size_t i;
+
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(f, "<inline_caches len=\"%zu\">\n", vm->bc->inline_caches_num);
+    for (i = 0; i < vm->bc->inline_caches_num; i++) {
+        const struct INLINE_CACHE*ic = vm->inline_caches + i;
+        fprintf(f, "\t<site id=\"%zu\" shapes=\"%zu\" hits=\"%llu\" misses=\"%llu\"/>\n",
+                i, ic->len, ic->hits, ic->misses);
+    }
+    fprintf(f, "</inline_caches>\n");
+}
+
+void dump_quickening_stats_to_xml_file(FILE*f, const virtual_machine_type_t vm)
+{
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(f, "<quickening enabled=\"%d\" quickened=\"%llu\" deopts=\"%llu\"/>\n",
+            vm->quickening, vm->quickened, vm->deopts);
+}
+
+void dump_jit_stats_to_xml_file(FILE*f, const virtual_machine_type_t vm)
+{
+    fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+#if VIRTUAL_MACHINE_JIT
+    if (vm->jit_mode == VIRTUAL_MACHINE_JIT_TEMPLATE) {
+        fprintf(f, "<jit mode=\"template\" hotness=\"%zu\" loops=\"%zu\" rejected=\"%zu\" code_sizemem=\"%zu\" entries=\"%llu\"/>\n",
+                vm->jit_hotness, vm->jit.loops_num, vm->jit.rejected_num, vm->jit.code_sizemem, vm->jit.entries);
+    } else {
+        const struct JIT_TRACE*trace;
+        fprintf(f, "<jit mode=\"tracing\" hotness=\"%zu\" traces=\"%zu\" aborts=\"%zu\" rejected=\"%zu\" "
+                "code_sizemem=\"%zu\" entries=\"%llu\">\n", vm->jit_hotness, vm->jit.traces_num, vm->jit.aborts_num,
+                vm->jit.rejected_num, vm->jit.code_sizemem, vm->jit.entries);
+        for (trace = vm->jit.traces; trace != NULL; trace = trace->next) {
+            size_t i;
+            fprintf(f, "\t<trace header=\"%zu\" ir=\"%zu\" entries=\"%llu\" iterations=\"%llu\">\n",
+                    trace->header, trace->ir_len, trace->entries, trace->iterations);
+            for (i = 0; i < trace->exits_num; i++) {
+                if (trace->exits[i] != 0) {
+                    fprintf(f, "\t\t<exit ip=\"%zu\" count=\"%llu\"/>\n",
+                            (size_t) (trace->exit_ips[i] - vm->bc->op_codes), trace->exits[i]);
+                }
             }
-            break;
-        }
-        case BC_OP_JUMP: {
-            int offset = (int) READ_BYTE();
-            vm->ip += offset;
-            break;
+            fprintf(f, "\t</trace>\n");
         }
+        fprintf(f, "</jit>\n");
+    }
+#else
+    PREFIX_UNUSED(vm);
+    fprintf(f, "<jit hotness=\"0\"/>\n");
+#endif
+}
 
-        case BC_OP_RETURN: {
-            struct VALUE val = virtual_machine_stack_pop(vm);
-            if (vm->trace) {
-                printf("</trace>\n");
+void virtual_machine_get_jit_stats(const virtual_machine_type_t vm, struct VIRTUAL_MACHINE_JIT_STATS*stats)
+{
+    memset(stats, 0, sizeof(*stats));
+#if VIRTUAL_MACHINE_JIT
+    {
+        const struct JIT_TRACE*trace;
+        stats->compiled = (vm->jit_mode == VIRTUAL_MACHINE_JIT_TEMPLATE) ? vm->jit.loops_num : vm->jit.traces_num;
+        stats->rejected = vm->jit.rejected_num;
+        stats->aborts = vm->jit.aborts_num;
+        stats->entries = vm->jit.entries;
+        for (trace = vm->jit.traces; trace != NULL; trace = trace->next) {
+            size_t i;
+            stats->iterations += trace->iterations;
+            for (i = 0; i < trace->exits_num; i++) {
+                stats->exits += trace->exits[i];
             }
-            return val.int_val;
-            break;
-        }
         }
     }
+#else
+    PREFIX_UNUSED(vm);
+#endif
+}
+
+void dump_gc_stats_to_xml_file(FILE*f, const virtual_machine_type_t vm)
+{
+    dump_garbage_collector_stats_to_xml_file(f, vm->gc);
 }
 
 void virtual_machine_free(virtual_machine_type_t vm)
 {
     SAFE_FREE(vm->stack);
+    SAFE_FREE(vm->frames);
+    SAFE_FREE(vm->functions);
     garbage_collector_free(vm->gc);
+    SAFE_FREE(vm->inline_caches);
+    shape_tree_free(vm->shapes);
+#if VIRTUAL_MACHINE_JIT
+    SAFE_FREE(vm->jit_loops);
+    jit_free(&(vm->jit));
+#endif
     SAFE_FREE(vm);
 }
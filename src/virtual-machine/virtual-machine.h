@@ -2,6 +2,47 @@
 #define VIRTUAL_MACHINE_H_INCLUDED
 
 #include "bytecode-generator.h"
+#include "garbage-collector.h"
+
+/* direct threading needs labels-as-values, which are GCC extension. */
+#if defined(__GNUC__) && !defined(VIRTUAL_MACHINE_SWITCH_DISPATCH)
+#define VIRTUAL_MACHINE_THREADED_DISPATCH 1
+#else
+#define VIRTUAL_MACHINE_THREADED_DISPATCH 0
+#endif
+
+/* JIT (make JIT=1) emits x86-64 code into mmap'ed pages, on other machines VM only interprets. */
+#if defined(VIRTUAL_MACHINE_BUILD_JIT) && defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#define VIRTUAL_MACHINE_JIT 1
+#else
+#define VIRTUAL_MACHINE_JIT 0
+#endif
+
+/* default number of back-edges, after which loop is compiled. */
+#define VIRTUAL_MACHINE_JIT_HOTNESS 1000
+
+enum VIRTUAL_MACHINE_JIT_MODE
+{
+    VIRTUAL_MACHINE_JIT_TEMPLATE, /* the whole loop, opcode by opcode.                       */
+    VIRTUAL_MACHINE_JIT_TRACING,  /* one recorded iteration with guards and unboxed locals. */
+};
+
+/* totals of JIT, which are reported by --jit-stats and benchmarks. */
+struct VIRTUAL_MACHINE_JIT_STATS
+{
+    size_t compiled; /* loops or traces. */
+    size_t rejected;
+    size_t aborts;   /* tracing only: recordings, which didn't return to header. */
+    unsigned long long entries;
+    unsigned long long iterations; /* tracing only. */
+    unsigned long long exits;      /* tracing only: side exits and failed entries. */
+};
+
+/*
+  CALL fails, when less stack slots are left for callee's locals and temporaries.
+  JIT enters loop only with such reserve, so its machine code can push without checks.
+*/
+#define VIRTUAL_MACHINE_CALL_STACK_RESERVE 64
 
 struct VIRTUAL_MACHINE;
 
@@ -9,10 +50,37 @@ typedef struct VIRTUAL_MACHINE* virtual_machine_type_t;
 
 virtual_machine_type_t create_virtual_machine();
 
-void virtual_machine_conf(virtual_machine_type_t vm, bytecode_type_t bc, size_t stack_size, size_t heap_size_b, int trace);
+/*
+  every executed instruction is written to binary trace file (see trace.h), if trace isn't NULL.
+  Generic arithmetic and compare opcodes of stack bytecode are patched in place to integer ones
+  (quickened), if quickening is set.
+*/
+void virtual_machine_conf(virtual_machine_type_t vm, bytecode_type_t bc, size_t stack_size,
+                          const struct GARBAGE_COLLECTOR_PARAMS*gc_params, FILE*trace, int quickening);
+
+/*
+  Loop of stack bytecode is compiled to machine code, when its back-edge is taken hotness times
+  (0 - never); tracing mode records its next iteration first. It must be called after
+  virtual_machine_conf; VM without JIT accepts only 0.
+*/
+void virtual_machine_conf_jit(virtual_machine_type_t vm, size_t hotness, enum VIRTUAL_MACHINE_JIT_MODE mode);
 
 long long virtual_machine_run(virtual_machine_type_t vm);
 
+/* hit/miss counters of every field access site. */
+void dump_inline_caches_to_xml_file(FILE*f, const virtual_machine_type_t vm);
+
+/* how many opcodes were quickened and how many of them were deoptimized back. */
+void dump_quickening_stats_to_xml_file(FILE*f, const virtual_machine_type_t vm);
+
+/* numbers of compiled loops, bytes of their code and entries to it; side exits of every trace. */
+void dump_jit_stats_to_xml_file(FILE*f, const virtual_machine_type_t vm);
+
+void virtual_machine_get_jit_stats(const virtual_machine_type_t vm, struct VIRTUAL_MACHINE_JIT_STATS*stats);
+
+/* pauses of garbage collector, which must be configured with stats. */
+void dump_gc_stats_to_xml_file(FILE*f, const virtual_machine_type_t vm);
+
 void virtual_machine_free(virtual_machine_type_t vm);
 
 #endif  /* VIRTUAL_MACHINE_H_INCLUDED */